@@ -0,0 +1,216 @@
+/**
+ * @file  larsim/DetSim/NoiseWaveformBank.cxx
+ * @brief Bank of noise waveforms to synthesize the noise of many channels.
+ * @see   larsim/DetSim/NoiseWaveformBank.h
+ */
+
+// library header
+#include "larsim/DetSim/NoiseWaveformBank.h"
+
+// ROOT libraries
+#include "TFFTComplexReal.h"
+
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+// POSIX
+#include <unistd.h> // getpid()
+
+namespace {
+  // .. header of the cache file
+  constexpr char BankMagic[8] = {'L', 'A', 'R', 'N', 'O', 'I', 'S', 'B'};
+  constexpr std::uint32_t BankVersion = 3;
+  constexpr std::uint32_t BankMaxKeyLength = 4096;
+}
+
+namespace detsim {
+
+  //-------------------------------------------------
+  void NoiseWaveformBank::build(std::vector<double> const& spectraRe,
+                                std::vector<double> const& spectraIm,
+                                unsigned int nThreads)
+  {
+    std::size_t const nTicks = fNTicks;
+    std::size_t const nFreq = nFrequencies();
+    bool const hasNyquist = (nTicks % 2 == 0);
+    if ((nTicks == 0) || (spectraRe.size() % nFreq != 0) ||
+        (spectraIm.size() != spectraRe.size())) {
+      throw cet::exception("NoiseWaveformBank")
+        << "Spectra of " << spectraRe.size() << " and " << spectraIm.size()
+        << " components do not make waveforms of " << nTicks << " samples\n";
+    }
+    std::size_t const nWaveforms = spectraRe.size() / nFreq;
+
+    fWaveforms.resize(nWaveforms * 2 * nTicks);
+    fDC.resize(nWaveforms);
+    fNyquist.resize(nWaveforms);
+
+    // ... one inverse FFT plan per thread; plans are created in this thread
+    std::vector<std::unique_ptr<TFFTComplexReal>> plans;
+    for (unsigned int i = 0; i < std::max(nThreads, 1U); ++i) {
+      plans.push_back(std::make_unique<TFFTComplexReal>(nTicks, false));
+      plans.back()->Init("ES", 1, nullptr);
+    }
+
+    auto transform = [&](std::size_t b, TFFTComplexReal& plan) {
+      double const* re = spectraRe.data() + b * nFreq;
+      double const* im = spectraIm.data() + b * nFreq;
+      std::vector<double> buffer(nTicks), quadRe(nFreq), quadIm(nFreq);
+      float* waveform = fWaveforms.data() + b * 2 * nTicks;
+      float* quadrature = waveform + nTicks;
+
+      plan.SetPointsComplex(re, im);
+      plan.Transform();
+      plan.GetPoints(buffer.data());
+      std::copy(buffer.begin(), buffer.end(), waveform);
+
+      // .. quadrature: (re + i im) * (-i) = im - i re
+      for (std::size_t i = 0; i < nFreq; ++i) {
+        quadRe[i] = im[i];
+        quadIm[i] = -re[i];
+      }
+      quadRe[0] = quadIm[0] = 0.;
+      if (hasNyquist) quadRe[nFreq - 1] = quadIm[nFreq - 1] = 0.;
+      plan.SetPointsComplex(quadRe.data(), quadIm.data());
+      plan.Transform();
+      plan.GetPoints(buffer.data());
+      std::copy(buffer.begin(), buffer.end(), quadrature);
+
+      fDC[b] = re[0];
+      fNyquist[b] = hasNyquist ? re[nFreq - 1] : 0.;
+    };
+
+    if (nThreads > 0) {
+      tbb::task_arena arena(nThreads);
+      arena.execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, nWaveforms),
+                          [&](tbb::blocked_range<std::size_t> const& range) {
+                            TFFTComplexReal& plan =
+                              *plans[tbb::this_task_arena::current_thread_index()];
+                            for (std::size_t b = range.begin(); b < range.end(); ++b)
+                              transform(b, plan);
+                          });
+      });
+    }
+    else {
+      for (std::size_t b = 0; b < nWaveforms; ++b)
+        transform(b, *plans.front());
+    }
+  }
+
+  //-------------------------------------------------
+  void NoiseWaveformBank::synthesize(float* noise,
+                                     std::size_t waveform,
+                                     std::size_t shift,
+                                     double phase) const
+  {
+    // noise(t) = base(u) + cos(phase) (x(u) - base(u)) + sin(phase) quadrature(u)
+    // with u = t + shift
+    int const nTicks = fNTicks;
+    int const start = shift % fNTicks;
+    double const c = std::cos(phase);
+    double const s = std::sin(phase);
+
+    float const* x = fWaveforms.data() + waveform * 2 * nTicks;
+    float const* quadrature = x + nTicks;
+    double const dc = fDC[waveform];
+    double const nyquist = fNyquist[waveform];
+
+    auto synthesize = [&](int tBegin, int tEnd, int u) {
+      for (int t = tBegin; t < tEnd; ++t, ++u) {
+        double const base = dc + ((u & 1) ? -nyquist : nyquist);
+        noise[t] = base + c * (x[u] - base) + s * quadrature[u];
+      }
+    };
+    synthesize(0, nTicks - start, start);
+    synthesize(nTicks - start, nTicks, 0);
+  }
+
+  //-------------------------------------------------
+  bool NoiseWaveformBank::read(std::string const& fileName,
+                               std::size_t nWaveforms,
+                               std::string const& key)
+  {
+    clear();
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) return false;
+
+    char magic[8];
+    std::uint32_t version = 0, nTicks = 0, bankSize = 0, keyLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&nTicks), sizeof(nTicks));
+    file.read(reinterpret_cast<char*>(&bankSize), sizeof(bankSize));
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+    if (!file || (keyLength > BankMaxKeyLength)) keyLength = 0;
+    std::string fileKey(keyLength, '\0');
+    file.read(fileKey.data(), fileKey.size());
+    if (!file || (std::memcmp(magic, BankMagic, sizeof(magic)) != 0) ||
+        (version != BankVersion) || (nTicks != fNTicks) || (bankSize != nWaveforms) ||
+        (fileKey != key)) {
+      return false;
+    }
+
+    fWaveforms.resize(std::size_t(bankSize) * 2 * nTicks);
+    fDC.resize(bankSize);
+    fNyquist.resize(bankSize);
+    file.read(reinterpret_cast<char*>(fDC.data()), bankSize * sizeof(double));
+    file.read(reinterpret_cast<char*>(fNyquist.data()), bankSize * sizeof(double));
+    file.read(reinterpret_cast<char*>(fWaveforms.data()), fWaveforms.size() * sizeof(float));
+    if (!file) {
+      clear();
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------
+  bool NoiseWaveformBank::write(std::string const& fileName, std::string const& key) const
+  {
+    std::uint32_t const nTicks = fNTicks;
+    std::uint32_t const bankSize = size();
+    std::uint32_t const keyLength = key.size();
+    if (keyLength > BankMaxKeyLength) return false;
+
+    std::string const tempName = fileName + ".tmp" + std::to_string(::getpid());
+    std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+    file.write(BankMagic, sizeof(BankMagic));
+    file.write(reinterpret_cast<char const*>(&BankVersion), sizeof(BankVersion));
+    file.write(reinterpret_cast<char const*>(&nTicks), sizeof(nTicks));
+    file.write(reinterpret_cast<char const*>(&bankSize), sizeof(bankSize));
+    file.write(reinterpret_cast<char const*>(&keyLength), sizeof(keyLength));
+    file.write(key.data(), key.size());
+    file.write(reinterpret_cast<char const*>(fDC.data()), bankSize * sizeof(double));
+    file.write(reinterpret_cast<char const*>(fNyquist.data()), bankSize * sizeof(double));
+    file.write(reinterpret_cast<char const*>(fWaveforms.data()), fWaveforms.size() * sizeof(float));
+    file.close();
+    if (!file || (std::rename(tempName.c_str(), fileName.c_str()) != 0)) {
+      std::remove(tempName.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------
+  void NoiseWaveformBank::clear()
+  {
+    fWaveforms.clear();
+    fDC.clear();
+    fNyquist.clear();
+  }
+
+} // namespace detsim
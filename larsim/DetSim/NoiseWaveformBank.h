@@ -0,0 +1,109 @@
+/**
+ * @file  larsim/DetSim/NoiseWaveformBank.h
+ * @brief Bank of noise waveforms to synthesize the noise of many channels.
+ * @see   larsim/DetSim/NoiseWaveformBank.cxx
+ */
+
+#ifndef LARSIM_DETSIM_NOISEWAVEFORMBANK_H
+#define LARSIM_DETSIM_NOISEWAVEFORMBANK_H
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace detsim {
+
+  /**
+   * @brief Noise waveforms, from which new waveforms are synthesized.
+   *
+   * The bank is built from the frequency spectra of its waveforms (as the
+   * noise of `SimWire`, the unnormalized inverse FFT of each spectrum).
+   * A new waveform is synthesized from one of the bank by shifting it
+   * circularly in time and rotating all its frequency components, but the
+   * constant and the Nyquist ones, by the same phase. Both operations keep
+   * the power spectrum of the waveform.
+   *
+   * For each waveform the bank stores the waveform and its quadrature, that
+   * is the waveform with all the components rotated by -pi/2 and the
+   * constant and Nyquist ones removed. Then the rotation by a phase `phi` is
+   * `base + cos(phi) (waveform - base) + sin(phi) quadrature`, where `base`
+   * holds the constant and Nyquist components.
+   */
+  class NoiseWaveformBank {
+  public:
+    /// Creates an empty bank of waveforms with `nTicks` samples.
+    explicit NoiseWaveformBank(std::size_t nTicks = 0) : fNTicks{nTicks} {}
+
+    /// Returns the number of samples of each waveform.
+    std::size_t nTicks() const { return fNTicks; }
+
+    /// Returns the number of frequency components of each waveform.
+    std::size_t nFrequencies() const { return fNTicks / 2 + 1; }
+
+    /// Returns the number of waveforms in the bank.
+    std::size_t size() const { return fDC.size(); }
+
+    /// Returns whether there is no waveform in the bank.
+    bool empty() const { return fDC.empty(); }
+
+    /**
+     * @brief Fills the bank with the waveforms of the specified spectra.
+     * @param spectraRe real part of the spectra
+     * @param spectraIm imaginary part of the spectra
+     * @param nThreads number of threads to use (`0`: only the current one)
+     *
+     * Each spectrum is `nFrequencies()` components long, and the spectra
+     * follow each other. The result does not depend on `nThreads`.
+     */
+    void build(std::vector<double> const& spectraRe,
+               std::vector<double> const& spectraIm,
+               unsigned int nThreads = 0);
+
+    /**
+     * @brief Synthesizes a waveform from one in the bank.
+     * @param noise where to write the `nTicks()` samples of the waveform
+     * @param waveform index of the waveform in the bank
+     * @param shift the synthesized sample `t` is the bank sample `t + shift`
+     * @param phase all components but the constant and Nyquist ones are
+     *              multiplied by `exp(-i phase)`
+     */
+    void synthesize(float* noise, std::size_t waveform, std::size_t shift, double phase) const;
+
+    /**
+     * @brief Reads the bank from a cache file.
+     * @param fileName name of the cache file
+     * @param nWaveforms number of waveforms the bank must have
+     * @param key description of the configuration the bank must be built with
+     * @return whether the bank was read
+     *
+     * If the file does not match the waveform size, `nWaveforms` and `key`,
+     * or it is truncated, the bank is left empty.
+     */
+    bool read(std::string const& fileName, std::size_t nWaveforms, std::string const& key);
+
+    /**
+     * @brief Writes the bank into a cache file.
+     * @param fileName name of the cache file
+     * @param key description of the configuration the bank was built with
+     * @return whether the bank was written
+     *
+     * The bank is written into a temporary file which then replaces
+     * `fileName`, so that jobs sharing the cache never read a partially
+     * written bank.
+     */
+    bool write(std::string const& fileName, std::string const& key) const;
+
+    /// Removes all the waveforms.
+    void clear();
+
+  private:
+    std::size_t fNTicks;          ///< Samples in each waveform.
+    std::vector<float> fWaveforms; ///< Each waveform followed by its quadrature.
+    std::vector<double> fDC;       ///< Constant component of each waveform.
+    std::vector<double> fNyquist;  ///< Nyquist component of each waveform.
+  }; // NoiseWaveformBank
+
+} // namespace detsim
+
+#endif // LARSIM_DETSIM_NOISEWAVEFORMBANK_H
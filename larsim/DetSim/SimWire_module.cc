@@ -25,15 +25,29 @@
 //   as in a typical SignalShapingXXX service for a particular XXX
 //   experiment
 //
+// - Unique noise for each channel can be synthesized from a bank of noise
+//   waveforms built once per job ("NoiseBankSize" in fcl): each channel
+//   gets a random waveform of the bank, circularly shifted in time and with
+//   all its frequency components rotated by the same random phase; the bank
+//   is drawn from its own random engine with a fixed seed ("NoiseBankSeed"),
+//   so that it depends only on the configuration and can be cached, and the
+//   noise of the events is the same whether the bank is built or read
+//
 ////////////////////////////////////////////////////////////////////////
 
 // ROOT includes
 #include "TComplex.h"
+#include "TFFTComplexReal.h"
+#include "TFFTRealComplex.h"
 #include "TMath.h"
+#include "TRandom.h"
+#include "TRandom3.h"
 
 // C++ includes
 #include <algorithm>
+#include <cmath>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -51,6 +65,7 @@
 // art extensions
 #include "nurandom/RandomUtils/NuRandomService.h"
 
+#include "CLHEP/Random/HepJamesRandom.h"
 #include "CLHEP/Random/RandFlat.h"
 
 // LArSoft includes
@@ -62,6 +77,21 @@
 #include "lardataobj/RawData/RawDigit.h"
 #include "lardataobj/RawData/raw.h"
 #include "lardataobj/Simulation/SimChannel.h"
+#include "larsim/DetSim/NoiseWaveformBank.h"
+
+namespace {
+  // .. replaces ROOT's gRandom while in scope (TF1::GetRandom() draws from it)
+  class GlobalRandomReplacement {
+  public:
+    explicit GlobalRandomReplacement(TRandom* random) : fSaved{gRandom} { gRandom = random; }
+    ~GlobalRandomReplacement() { gRandom = fSaved; }
+    GlobalRandomReplacement(GlobalRandomReplacement const&) = delete;
+    GlobalRandomReplacement& operator=(GlobalRandomReplacement const&) = delete;
+
+  private:
+    TRandom* fSaved;
+  };
+}
 
 // Detector simulation of raw signals on wires
 namespace detsim {
@@ -80,6 +110,19 @@ namespace detsim {
     void SetElectResponse(); ///< response of electronics
 
     void GenNoise(std::vector<float>& array, CLHEP::HepRandomEngine& engine);
+    /// noise in frequency space, as used by GenNoise()
+    void GenNoiseSpectrum(std::vector<TComplex>& noiseFrequency, CLHEP::HepRandomEngine& engine);
+
+    void BuildNoiseBank();            ///< fill the noise bank (or read it from cache)
+    std::string NoiseBankKey() const; ///< configuration the noise bank was built with
+    /// synthesize the noise of one channel from the noise bank
+    void SynthesizeNoise(float* noise, CLHEP::RandFlat& flat) const;
+    /// compare the power spectra of GenNoise() and of the noise bank
+    void ValidateNoiseBank(unsigned int nWaveforms);
+
+    void SetConvolutionKernels(); ///< prepare plans and kernels of the batched convolution
+    /// convolute the charge of the channels of a batch, in place
+    void ConvoluteBatch(std::vector<const sim::SimChannel*> const& batch);
 
     std::string fDriftEModuleLabel; ///< module making the ionization electrons
     raw::Compress_t fCompression;   ///< compression type to use
@@ -97,6 +140,12 @@ namespace detsim {
     double fADCPerPCAtLowestASICGain;     ///< ADCs/pC at lowest gain setting of 4.7 mV/fC
     double fASICGainInMVPerFC;            ///< actual gain setting used in mV/fC
     int fNoiseNchToSim;                   ///< number of noise channels to generate
+    unsigned int fConvolutionBatchSize;   ///< number of channels convoluted together
+    unsigned int fNoiseBankSize;          ///< waveforms in the noise bank (0: no bank)
+    std::string fNoiseBankCacheFile;      ///< file to read the noise bank from, or write it to
+    unsigned int fNoiseBankThreads;       ///< threads transforming the noise bank
+    unsigned int fNoiseBankValidation;    ///< waveforms compared to validate the noise bank
+    long fNoiseBankSeed;                  ///< seed of the noise bank (the same for all jobs)
     std::string fNoiseModelChoice;        ///< choice for noise model
     std::string fNoiseFluctChoice;        ///< choice for noise freq component mag fluctuations
 
@@ -121,6 +170,19 @@ namespace detsim {
     TH1D* fNoiseDist;    ///< distribution of noise counts
     TF1* fNoiseFluct;    ///< Poisson dist for fluctuations in magnitude of noise freq components
 
+    // ... batched convolution of the channel charge with the response
+    std::unique_ptr<TFFTRealComplex> fForwardFFT; ///< real to complex plan, created once
+    std::unique_ptr<TFFTComplexReal> fInverseFFT; ///< complex to real plan, created once
+    std::vector<double> fColKernelRe, fColKernelIm; ///< collection response / fNTicks
+    std::vector<double> fIndKernelRe, fIndKernelIm; ///< induction response / fNTicks
+    std::vector<char> fIsInduction;                 ///< whether each channel is induction
+    std::vector<double> fChargeBatch;   ///< charge of the batch channels, one row per channel
+    std::vector<double> fSpectrumRe, fSpectrumIm; ///< frequency components being convoluted
+
+    // ... noise bank
+    NoiseWaveformBank fNoiseBank;  ///< waveforms the noise of the channels is made from
+    std::vector<float> fNoiseWork; ///< noise of the current channel
+
     CLHEP::HepRandomEngine& fEngine; ///< Random-number engine owned by art
   };                                 // class SimWire
 
@@ -141,6 +203,12 @@ namespace detsim {
     , fADCPerPCAtLowestASICGain{pset.get<double>("ADCPerPCAtLowestASICGain")}
     , fASICGainInMVPerFC{pset.get<double>("ASICGainInMVPerFC")}
     , fNoiseNchToSim{pset.get<int>("NoiseNchToSim")}
+    , fConvolutionBatchSize{pset.get<unsigned int>("ConvolutionBatchSize", 64U)}
+    , fNoiseBankSize{pset.get<unsigned int>("NoiseBankSize", 0U)}
+    , fNoiseBankCacheFile{pset.get<std::string>("NoiseBankCacheFile", "")}
+    , fNoiseBankThreads{pset.get<unsigned int>("NoiseBankThreads", 0U)}
+    , fNoiseBankValidation{pset.get<unsigned int>("NoiseBankValidation", 0U)}
+    , fNoiseBankSeed{pset.get<long>("NoiseBankSeed", 20210204L)}
     , fNoiseModelChoice{pset.get<std::string>("NoiseModelChoice")}
     , fNoiseFluctChoice{pset.get<std::string>("NoiseFluctChoice")}
     , fFieldRespTOffset{pset.get<std::vector<int>>("FieldRespTOffset")}
@@ -166,6 +234,11 @@ namespace detsim {
                               << "its own version of this module to simulate electronics "
                               << "response.";
 
+    if (fConvolutionBatchSize < 1) {
+      throw cet::exception("SimWire")
+        << "ConvolutionBatchSize must be at least 1 (" << fConvolutionBatchSize << " configured)\n";
+    }
+
     produces<std::vector<raw::RawDigit>>();
   }
 
@@ -225,6 +298,13 @@ namespace detsim {
     SetFieldResponse();
     SetElectResponse();
     ConvoluteResponseFunctions();
+    SetConvolutionKernels();
+
+    // ... unique noise for each channel synthesized from a bank of waveforms
+    if ((fNoiseNchToSim < 0) && (fNoiseBankSize > 0)) {
+      BuildNoiseBank();
+      if (fNoiseBankValidation > 0) ValidateNoiseBank(fNoiseBankValidation);
+    }
   }
 
   //-------------------------------------------------
@@ -234,7 +314,9 @@ namespace detsim {
     art::ServiceHandle<geo::Geometry const> geo;
 
     // ... generate unique noise for each channel in each event
-    if (fNoiseNchToSim < 0) {
+    //     (unless it is synthesized from the noise bank channel by channel)
+    bool const useNoiseBank = !fNoiseBank.empty();
+    if ((fNoiseNchToSim < 0) && !useNoiseBank) {
       fNoise.clear();
       fNoise.resize(geo->Nchannels());
       for (unsigned int p = 0; p < geo->Nchannels(); ++p) {
@@ -257,80 +339,86 @@ namespace detsim {
     // ... make an unique_ptr of sim::SimDigits that allows ownership of the produced
     //     digits to be transferred to the art::Event after the put statement below
     auto digcol = std::make_unique<std::vector<raw::RawDigit>>();
-
-    art::ServiceHandle<util::LArFFT> fFFT;
+    digcol->reserve(geo->Nchannels());
 
     // ... Add all channels
     CLHEP::RandFlat flat(fEngine);
 
-    std::map<int, double>::iterator mapIter;
-    for (unsigned int chan = 0; chan < geo->Nchannels(); chan++) {
-
-      std::vector<short> adcvec(fNTicks, 0);
-      std::vector<double> fChargeWork(fNTicks, 0.);
-
-      if (channels[chan]) {
-
-        // .. get the sim::SimChannel for this channel
-        const sim::SimChannel* sc = channels[chan];
+    unsigned int const nSamples = std::min(fNSamplesReadout, (unsigned int)fNTicks);
+    std::vector<const sim::SimChannel*> batch;
+    for (unsigned int batchStart = 0; batchStart < geo->Nchannels();
+         batchStart += fConvolutionBatchSize) {
+      unsigned int const batchEnd =
+        std::min(batchStart + fConvolutionBatchSize, (unsigned int)geo->Nchannels());
+
+      // .. convolute together the channels of the batch with signal;
+      //    the others only get noise
+      batch.clear();
+      for (unsigned int chan = batchStart; chan < batchEnd; ++chan) {
+        if (channels[chan] && !channels[chan]->TDCIDEMap().empty())
+          batch.push_back(channels[chan]);
+      }
+      ConvoluteBatch(batch);
 
-        // .. loop over the tdcs and grab the number of electrons for each
-        for (int t = 0; t < fNTicks; ++t)
-          fChargeWork[t] = sc->Charge(t);
+      auto nextSignal = batch.begin();
+      for (unsigned int chan = batchStart; chan < batchEnd; ++chan) {
 
+        // .. field response offset applied as index shift:
+        //    sample i comes from the convoluted charge at i - time_offset
+        double const* charge = nullptr;
         int time_offset = 0;
-
-        // .. Convolve charge with appropriate response function
-        if (geo->SignalType(chan) == geo::kInduction) {
-          fFFT->Convolute(fChargeWork, fIndShape);
-          time_offset = fFieldRespTOffset[1] + fCalibRespTOffset[1];
-        }
-        else {
-          fFFT->Convolute(fChargeWork, fColShape);
-          time_offset = fFieldRespTOffset[0] + fCalibRespTOffset[0];
+        if ((nextSignal != batch.end()) && (*nextSignal == channels[chan])) {
+          charge = fChargeBatch.data() + (nextSignal - batch.begin()) * fNTicks;
+          ++nextSignal;
+          int const iPlane = fIsInduction[chan] ? 1 : 0;
+          time_offset = (fFieldRespTOffset[iPlane] + fCalibRespTOffset[iPlane]) % fNTicks;
+          if (time_offset < 0) time_offset += fNTicks;
         }
 
-        // .. Apply field response offset
-        std::vector<int> temp;
-        if (time_offset <= 0) {
-          temp.assign(fChargeWork.begin(), fChargeWork.begin() - time_offset);
-          fChargeWork.erase(fChargeWork.begin(), fChargeWork.begin() - time_offset);
-          fChargeWork.insert(fChargeWork.end(), temp.begin(), temp.end());
+        std::vector<short> adcvec(fNSamplesReadout, 0);
+
+        // ... Add noise to signal depending on value of fNoiseNchToSim
+        float const* noise = nullptr;
+        if (useNoiseBank) {
+          SynthesizeNoise(fNoiseWork.data(), flat);
+          noise = fNoiseWork.data();
         }
-        else {
-          temp.assign(fChargeWork.end() - time_offset, fChargeWork.end());
-          fChargeWork.erase(fChargeWork.end() - time_offset, fChargeWork.end());
-          fChargeWork.insert(fChargeWork.begin(), temp.begin(), temp.end());
+        else if (fNoiseNchToSim != 0) {
+          int noisechan = chan;
+          if (fNoiseNchToSim > 0) {
+            noisechan = TMath::Nint(flat.fire() * (1. * (fNoise.size() - 1) + 0.1));
+          }
+          noise = fNoise[noisechan].data();
         }
-      }
 
-      // ... Add noise to signal depending on value of fNoiseNchToSim
-      if (fNoiseNchToSim != 0) {
-        int noisechan = chan;
-        if (fNoiseNchToSim > 0) {
-          noisechan = TMath::Nint(flat.fire() * (1. * (fNoise.size() - 1) + 0.1));
+        if (charge && noise) {
+          for (unsigned int i = 0; i < nSamples; ++i) {
+            int const t = (int(i) >= time_offset) ? i - time_offset : i - time_offset + fNTicks;
+            adcvec[i] = (short)TMath::Nint(noise[i] + charge[t]);
+          }
         }
-        for (int i = 0; i < fNTicks; ++i) {
-          adcvec[i] = (short)TMath::Nint(fNoise[noisechan][i] + fChargeWork[i]);
+        else if (charge) {
+          for (unsigned int i = 0; i < nSamples; ++i) {
+            int const t = (int(i) >= time_offset) ? i - time_offset : i - time_offset + fNTicks;
+            adcvec[i] = (short)TMath::Nint(charge[t]);
+          }
         }
-      }
-      else {
-        for (int i = 0; i < fNTicks; ++i) {
-          adcvec[i] = (short)TMath::Nint(fChargeWork[i]);
+        else if (noise) {
+          // .. fast path: no signal on this channel
+          for (unsigned int i = 0; i < nSamples; ++i)
+            adcvec[i] = (short)TMath::Nint(noise[i]);
         }
-      }
 
-      adcvec.resize(fNSamplesReadout);
+        // ... compress the adc vector using the desired compression scheme,
+        //     if raw::kNone is selected nothing happens to adcvec
+        //     This shrinks adcvec, if fCompression is not kNone.
+        raw::Compress(adcvec, fCompression);
 
-      // ... compress the adc vector using the desired compression scheme,
-      //     if raw::kNone is selected nothing happens to adcvec
-      //     This shrinks adcvec, if fCompression is not kNone.
-      raw::Compress(adcvec, fCompression);
+        // ... add this digit to the collection
+        digcol->emplace_back(chan, fNTicks, move(adcvec), fCompression);
 
-      // ... add this digit to the collection
-      digcol->emplace_back(chan, fNTicks, move(adcvec), fCompression);
-
-    } //end loop over channels
+      } // end loop over channels
+    }   // end loop over batches
 
     evt.put(std::move(digcol));
 
@@ -405,13 +493,112 @@ namespace detsim {
   }
 
   //-------------------------------------------------
-  void SimWire::GenNoise(std::vector<float>& noise, CLHEP::HepRandomEngine& engine)
+  void SimWire::SetConvolutionKernels()
   {
-    CLHEP::RandFlat flat(engine);
+    // ... plans are measured once and reused for all the channels
+    fForwardFFT = std::make_unique<TFFTRealComplex>(fNTicks, false);
+    fInverseFFT = std::make_unique<TFFTComplexReal>(fNTicks, false);
+    fForwardFFT->Init("M", -1, nullptr);
+    fInverseFFT->Init("M", 1, nullptr);
+
+    // ... response kernels, including the 1/fNTicks normalization of the inverse FFT
+    std::size_t const nFreq = fNTicks / 2 + 1;
+    auto const setKernel =
+      [nFreq, norm = 1.0 / fNTicks](
+        std::vector<TComplex> const& shape, std::vector<double>& re, std::vector<double>& im) {
+        re.resize(nFreq);
+        im.resize(nFreq);
+        for (std::size_t i = 0; i < nFreq; ++i) {
+          re[i] = shape[i].Re() * norm;
+          im[i] = shape[i].Im() * norm;
+        }
+      };
+    setKernel(fColShape, fColKernelRe, fColKernelIm);
+    setKernel(fIndShape, fIndKernelRe, fIndKernelIm);
+
+    fSpectrumRe.resize(nFreq);
+    fSpectrumIm.resize(nFreq);
 
+    // ... the plane type of each channel
+    art::ServiceHandle<geo::Geometry const> geo;
+    fIsInduction.resize(geo->Nchannels());
+    for (unsigned int chan = 0; chan < geo->Nchannels(); ++chan)
+      fIsInduction[chan] = (geo->SignalType(chan) == geo::kInduction);
+  }
+
+  //-------------------------------------------------
+  void SimWire::ConvoluteBatch(std::vector<const sim::SimChannel*> const& batch)
+  {
+    std::size_t const nTicks = fNTicks;
+    std::size_t const nFreq = fSpectrumRe.size();
+
+    // ... gather the charge of all the channels in one matrix
+    fChargeBatch.assign(batch.size() * nTicks, 0.);
+    for (std::size_t row = 0; row < batch.size(); ++row) {
+      double* charge = fChargeBatch.data() + row * nTicks;
+      for (auto const& [tdc, ides] : batch[row]->TDCIDEMap()) {
+        if (tdc >= nTicks) break;
+        double q = 0.;
+        for (auto const& ide : ides)
+          q += ide.numElectrons;
+        charge[tdc] = q;
+      }
+    }
+
+    // ... convolute each row with the response of its plane
+    for (std::size_t row = 0; row < batch.size(); ++row) {
+      double* charge = fChargeBatch.data() + row * nTicks;
+      bool const induction = fIsInduction[batch[row]->Channel()];
+      double const* kernRe = induction ? fIndKernelRe.data() : fColKernelRe.data();
+      double const* kernIm = induction ? fIndKernelIm.data() : fColKernelIm.data();
+
+      fForwardFFT->SetPoints(charge);
+      fForwardFFT->Transform();
+      fForwardFFT->GetPointsComplex(fSpectrumRe.data(), fSpectrumIm.data());
+
+      double* specRe = fSpectrumRe.data();
+      double* specIm = fSpectrumIm.data();
+      for (std::size_t i = 0; i < nFreq; ++i) {
+        double const re = specRe[i] * kernRe[i] - specIm[i] * kernIm[i];
+        double const im = specRe[i] * kernIm[i] + specIm[i] * kernRe[i];
+        specRe[i] = re;
+        specIm[i] = im;
+      }
+
+      fInverseFFT->SetPointsComplex(specRe, specIm);
+      fInverseFFT->Transform();
+      fInverseFFT->GetPoints(charge);
+    }
+  }
+
+  //-------------------------------------------------
+  void SimWire::GenNoise(std::vector<float>& noise, CLHEP::HepRandomEngine& engine)
+  {
     noise.clear();
     noise.resize(fNTicks, 0.);
     std::vector<TComplex> noiseFrequency(fNTicks / 2 + 1, 0.); // noise in frequency space
+    GenNoiseSpectrum(noiseFrequency, engine);
+
+    // .. inverse FFT MCSignal
+    art::ServiceHandle<util::LArFFT> fFFT;
+    fFFT->DoInvFFT(noiseFrequency, noise);
+
+    noiseFrequency.clear();
+
+    // .. multiply each noise value by fNTicks as the InvFFT
+    //    divides each bin by fNTicks assuming that a forward FFT
+    //    has already been done.
+    for (unsigned int i = 0; i < noise.size(); ++i)
+      noise[i] *= 1. * fNTicks;
+  }
+
+  //-------------------------------------------------
+  void SimWire::GenNoiseSpectrum(std::vector<TComplex>& noiseFrequency,
+                                 CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+
+    noiseFrequency.assign(fNTicks / 2 + 1, 0.);
 
     double pval = 0.;
     double phase = 0.;
@@ -466,18 +653,145 @@ namespace detsim {
       TComplex tc(pval * cos(phase), pval * sin(phase));
       noiseFrequency[i] += tc;
     }
+  }
 
-    // .. inverse FFT MCSignal
-    art::ServiceHandle<util::LArFFT> fFFT;
-    fFFT->DoInvFFT(noiseFrequency, noise);
+  //-------------------------------------------------
+  void SimWire::BuildNoiseBank()
+  {
+    std::size_t const nTicks = fNTicks;
+    std::size_t const nFreq = nTicks / 2 + 1;
+    fNoiseWork.resize(nTicks);
+    fNoiseBank = NoiseWaveformBank{nTicks};
+
+    std::string const key = NoiseBankKey();
+    if (!fNoiseBankCacheFile.empty()) {
+      if (fNoiseBank.read(fNoiseBankCacheFile, fNoiseBankSize, key)) {
+        mf::LogInfo("SimWire") << "Noise bank of " << fNoiseBankSize << " waveforms read from '"
+                               << fNoiseBankCacheFile << "'";
+        return;
+      }
+      mf::LogInfo("SimWire") << "Noise bank in '" << fNoiseBankCacheFile
+                             << "' is missing or does not match the configuration.";
+    }
 
-    noiseFrequency.clear();
+    // ... the spectra are drawn in order, from the noise bank engine and from the
+    //     fluctuation function, which is not thread safe; the function draws from
+    //     gRandom, replaced meanwhile by a generator seeded from the noise bank
+    //     engine, so that the bank depends only on the configuration and its seed
+    std::vector<double> spectraRe(fNoiseBankSize * nFreq), spectraIm(fNoiseBankSize * nFreq);
+    {
+      CLHEP::HepJamesRandom bankEngine{fNoiseBankSeed};
+      TRandom3 bankRandom{std::max(1U, static_cast<unsigned int>(bankEngine))};
+      GlobalRandomReplacement const useBankRandom{&bankRandom};
+      std::vector<TComplex> noiseFrequency;
+      for (std::size_t b = 0; b < fNoiseBankSize; ++b) {
+        GenNoiseSpectrum(noiseFrequency, bankEngine);
+        for (std::size_t i = 0; i < nFreq; ++i) {
+          spectraRe[b * nFreq + i] = noiseFrequency[i].Re();
+          spectraIm[b * nFreq + i] = noiseFrequency[i].Im();
+        }
+      }
+    }
 
-    // .. multiply each noise value by fNTicks as the InvFFT
-    //    divides each bin by fNTicks assuming that a forward FFT
-    //    has already been done.
-    for (unsigned int i = 0; i < noise.size(); ++i)
-      noise[i] *= 1. * fNTicks;
+    // .. the unnormalized inverse FFT gives the same noise as GenNoise()
+    fNoiseBank.build(spectraRe, spectraIm, fNoiseBankThreads);
+    mf::LogInfo("SimWire") << "Built a bank of " << fNoiseBankSize << " noise waveforms";
+
+    if (fNoiseBankCacheFile.empty()) return;
+    if (fNoiseBank.write(fNoiseBankCacheFile, key)) {
+      mf::LogInfo("SimWire") << "Noise bank written into '" << fNoiseBankCacheFile << "'";
+    }
+    else {
+      // .. the bank is still usable, only not cached
+      mf::LogWarning("SimWire") << "Failed to write the noise bank into '" << fNoiseBankCacheFile
+                                << "'";
+    }
+  }
+
+  //-------------------------------------------------
+  std::string SimWire::NoiseBankKey() const
+  {
+    std::ostringstream key;
+    key << std::hexfloat << fNoiseModelChoice << ';' << fNoiseFluctChoice << ';' << fSampleRate
+        << ';' << fNoiseBankSeed;
+    for (double par : fNoiseModelPar)
+      key << ';' << par;
+    for (double par : fNoiseFluctPar)
+      key << ';' << par;
+    return key.str();
+  }
+
+  //-------------------------------------------------
+  void SimWire::SynthesizeNoise(float* noise, CLHEP::RandFlat& flat) const
+  {
+    // .. a random waveform, starting at a random tick, with all the (non-constant,
+    //    non-Nyquist) frequency components rotated by a random phase
+    std::size_t const b = flat.fireInt(fNoiseBank.size());
+    std::size_t const shift = flat.fireInt(fNTicks);
+    double const phase = flat.fire() * 2. * TMath::Pi();
+    fNoiseBank.synthesize(noise, b, shift, phase);
+  }
+
+  //-------------------------------------------------
+  void SimWire::ValidateNoiseBank(unsigned int nWaveforms)
+  {
+    std::size_t const nTicks = fNTicks;
+    std::size_t const nFreq = nTicks / 2 + 1;
+
+    // .. the validation draws from its own engine and generator, so that it does
+    //    not change the noise of the events
+    CLHEP::HepJamesRandom validationEngine{fNoiseBankSeed + 1};
+    TRandom3 validationRandom{std::max(1U, static_cast<unsigned int>(validationEngine))};
+    GlobalRandomReplacement const useValidationRandom{&validationRandom};
+    CLHEP::RandFlat flat(validationEngine);
+
+    // .. average power spectrum of GenNoise() and of the bank
+    std::vector<double> powerGen(nFreq, 0.), powerBank(nFreq, 0.);
+    std::vector<float> noise(nTicks);
+    std::vector<double> buffer(nTicks);
+    auto addPower = [&](std::vector<double>& power) {
+      std::copy(noise.begin(), noise.end(), buffer.begin());
+      fForwardFFT->SetPoints(buffer.data());
+      fForwardFFT->Transform();
+      fForwardFFT->GetPointsComplex(fSpectrumRe.data(), fSpectrumIm.data());
+      for (std::size_t i = 0; i < nFreq; ++i)
+        power[i] += (fSpectrumRe[i] * fSpectrumRe[i] + fSpectrumIm[i] * fSpectrumIm[i]) / nWaveforms;
+    };
+    for (unsigned int n = 0; n < nWaveforms; ++n) {
+      GenNoise(noise, validationEngine);
+      addPower(powerGen);
+      SynthesizeNoise(noise.data(), flat);
+      addPower(powerBank);
+    }
+
+    art::ServiceHandle<art::TFileService const> tfs;
+    TH1D* hGen = tfs->make<TH1D>(
+      "NoisePowerGenNoise", ";frequency bin;average power (GenNoise)", nFreq, 0, nFreq);
+    TH1D* hBank = tfs->make<TH1D>(
+      "NoisePowerBank", ";frequency bin;average power (noise bank)", nFreq, 0, nFreq);
+
+    // .. compare in bands of frequency bins, to average out the fluctuations
+    std::size_t const bandWidth = std::max(nFreq / 64, std::size_t(1));
+    double maxDeviation = 0., totalGen = 0., totalBank = 0.;
+    double bandGen = 0., bandBank = 0.;
+    for (std::size_t i = 0; i < nFreq; ++i) {
+      hGen->SetBinContent(i + 1, powerGen[i]);
+      hBank->SetBinContent(i + 1, powerBank[i]);
+      totalGen += powerGen[i];
+      totalBank += powerBank[i];
+      bandGen += powerGen[i];
+      bandBank += powerBank[i];
+      if (((i + 1) % bandWidth == 0) || (i + 1 == nFreq)) {
+        if (bandGen > 0.) maxDeviation = std::max(maxDeviation, std::abs(bandBank / bandGen - 1.));
+        bandGen = bandBank = 0.;
+      }
+    }
+
+    mf::LogInfo("SimWire") << "Noise bank validation with " << nWaveforms
+                           << " waveforms: total power ratio (bank / GenNoise) "
+                           << (totalGen > 0. ? totalBank / totalGen : 0.)
+                           << ", largest deviation in bands of " << bandWidth
+                           << " frequency bins " << maxDeviation;
   }
 
   //-------------------------------------------------
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  SimChannelAccumulator.cc
+/// \brief Collects drifted electron clusters by channel and turns them
+///        into `sim::SimChannel` objects in one pass
+///
+////////////////////////////////////////////////////////////////////////
+
+#include "larsim/ElectronDrift/SimChannelAccumulator.h"
+
+#include "lardataobj/Simulation/SimChannel.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+
+#include <algorithm> // std::stable_sort(), std::is_sorted()
+#include <array>
+
+namespace detsim {
+
+  //----------------------------------------------------------------------
+  SimChannelAccumulator::SimChannelAccumulator(std::size_t nChannels /* = 0U */)
+    : fSlots(nChannels, NoSlot)
+  {}
+
+  //----------------------------------------------------------------------
+  void SimChannelAccumulator::add(raw::ChannelID_t channel,
+                                  std::size_t deposit,
+                                  int trackID,
+                                  unsigned int tdc,
+                                  double numElectrons,
+                                  double energy)
+  {
+    if (channel >= fSlots.size()) fSlots.resize(channel + 1, NoSlot);
+
+    std::uint32_t& slot = fSlots[channel];
+    if (slot == NoSlot) {
+      slot = fChannels.size();
+      fChannels.push_back(channel);
+      // buckets from previous events are reused with their memory
+      if (fBuckets.size() < fChannels.size()) fBuckets.emplace_back();
+    }
+    fBuckets[slot].push_back({tdc, trackID, deposit, numElectrons, energy});
+  }
+
+  //----------------------------------------------------------------------
+  void SimChannelAccumulator::flush(std::vector<sim::SimChannel>& channels,
+                                    std::vector<sim::SimEnergyDeposit> const& deposits)
+  {
+    auto const byTDC = [](Cluster_t const& a, Cluster_t const& b) { return a.tdc < b.tdc; };
+
+    channels.reserve(channels.size() + fChannels.size());
+    for (std::size_t slot = 0; slot < fChannels.size(); ++slot) {
+      std::vector<Cluster_t>& bucket = fBuckets[slot];
+      if (!std::is_sorted(bucket.begin(), bucket.end(), byTDC))
+        std::stable_sort(bucket.begin(), bucket.end(), byTDC);
+
+      // with increasing TDC each cluster lands at the end of the channel
+      sim::SimChannel& simChannel = channels.emplace_back(fChannels[slot]);
+      std::size_t lastDeposit = deposits.size();
+      std::array<double, 3> xyz;
+      for (Cluster_t const& cluster : bucket) {
+        if (cluster.deposit != lastDeposit) {
+          lastDeposit = cluster.deposit;
+          deposits[lastDeposit].MidPoint().GetCoordinates(xyz.data());
+        }
+        simChannel.AddIonizationElectrons(
+          cluster.trackID, cluster.tdc, cluster.numElectrons, xyz.data(), cluster.energy);
+      }
+    }
+    clear();
+  }
+
+  //----------------------------------------------------------------------
+  void SimChannelAccumulator::clear()
+  {
+    for (std::size_t slot = 0; slot < fChannels.size(); ++slot) {
+      fSlots[fChannels[slot]] = NoSlot;
+      fBuckets[slot].clear();
+    }
+    fChannels.clear();
+  }
+
+} // namespace detsim
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  SimChannelAccumulator.h
+/// \brief Collects drifted electron clusters by channel and turns them
+///        into `sim::SimChannel` objects in one pass
+///
+////////////////////////////////////////////////////////////////////////
+#ifndef DETSIM_SIMCHANNELACCUMULATOR_H
+#define DETSIM_SIMCHANNELACCUMULATOR_H
+
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace sim {
+  class SimChannel;
+  class SimEnergyDeposit;
+}
+
+namespace detsim {
+
+  /**
+   * @brief Accumulates electron clusters into per-channel buckets.
+   *
+   * Adding a cluster to a `sim::SimChannel` directly costs a sorted insertion
+   * into its TDC list, and finding the channel costs a map lookup.
+   * This accumulator instead looks up channels in a table indexed by channel
+   * ID and appends clusters to a bucket for each channel. When the event is
+   * complete, `flush()` sorts each bucket by TDC and adds the clusters to the
+   * `sim::SimChannel` objects in TDC order.
+   *
+   * The sort is stable, so the clusters on the same TDC and channel are added
+   * in the same order as they were collected, and the resulting channels are
+   * the same as the ones filled cluster by cluster. Channels are also produced
+   * in the order they were first hit.
+   *
+   * Memory of the table and of the buckets is kept between events.
+   */
+  class SimChannelAccumulator {
+  public:
+    /// Prepares a table for channel IDs up to `nChannels` (it grows if needed).
+    explicit SimChannelAccumulator(std::size_t nChannels = 0U);
+
+    /// Adds a cluster of electrons from the energy deposit with the specified index.
+    void add(raw::ChannelID_t channel,
+             std::size_t deposit,
+             int trackID,
+             unsigned int tdc,
+             double numElectrons,
+             double energy);
+
+    /// Returns the number of channels with clusters.
+    std::size_t NChannels() const { return fChannels.size(); }
+
+    /// Returns whether no cluster was collected.
+    bool empty() const { return fChannels.empty(); }
+
+    /**
+     * @brief Appends to `channels` one `sim::SimChannel` per hit channel.
+     * @param channels the collection to be extended
+     * @param deposits the energy deposits the clusters were drifted from
+     *
+     * The position of each cluster is the middle point of its energy deposit.
+     * The accumulator is empty afterwards.
+     */
+    void flush(std::vector<sim::SimChannel>& channels,
+               std::vector<sim::SimEnergyDeposit> const& deposits);
+
+    /// Discards all the collected clusters.
+    void clear();
+
+  private:
+    struct Cluster_t {
+      unsigned int tdc;
+      int trackID;
+      std::size_t deposit;
+      double numElectrons;
+      double energy;
+    };
+
+    static constexpr std::uint32_t NoSlot = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::uint32_t> fSlots;           ///< Channel ID -> bucket index.
+    std::vector<raw::ChannelID_t> fChannels;     ///< Bucket index -> channel ID.
+    std::vector<std::vector<Cluster_t>> fBuckets; ///< Clusters of each bucket.
+
+  }; // class SimChannelAccumulator
+
+} // namespace detsim
+
+#endif // DETSIM_SIMCHANNELACCUMULATOR_H
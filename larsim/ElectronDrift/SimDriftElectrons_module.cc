@@ -46,6 +46,13 @@
  *   is actually off it by less than the chosen margin, it's accounted for by
  *   that plane; by default the margin is 0 and all the charge off the plane
  *   is lost (with a warning)
+ * * parallel drift: with `NThreads` larger than 0, the deposits are grouped by
+ *   TPC and the TPCs are drifted in parallel, each one with its own random
+ *   stream seeded from the module seed, the event and the TPC; the result
+ *   depends neither on the number of threads nor on their scheduling, but it
+ *   is different from the one of the default sequential mode; the space
+ *   charge offsets are looked up sequentially before the parallel drift,
+ *   since the space charge service is not safe to use from several threads
  *
  * Update:
  * Christoph Alt, September 2018 (christoph.alt@cern.ch)
@@ -58,6 +65,7 @@
 #include "lardataobj/Simulation/SimChannel.h"
 #include "lardataobj/Simulation/SimDriftedElectronCluster.h"
 #include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "larsim/ElectronDrift/SimChannelAccumulator.h"
 #include "larsim/Simulation/LArG4Parameters.h"
 #include "larsim/Utils/SCEOffsetBounds.h"
 
@@ -78,14 +86,17 @@
 #include "nurandom/RandomUtils/NuRandomService.h"
 
 // External libraries
+#include "CLHEP/Random/MixMaxRng.h"
 #include "CLHEP/Random/RandGauss.h"
 #include "TMath.h"
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
 
 // C++ includes
-#include <algorithm> // std::find
+#include <algorithm> // std::min
 #include <cmath>
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -120,40 +131,132 @@ namespace detsim {
     double fRecipDriftVel[3];
 
     bool fStoreDriftedElectronClusters;
+    unsigned int fNThreads;
 
     // double fOffPlaneMargin;
 
-    // In order to create the associations, for each channel we create
-    // we have to keep track of its index in the output vector, and the
-    // indexes of all the steps that contributed to it.
-    struct ChannelBookKeeping {
-      size_t channelIndex;
-      std::vector<size_t> stepList;
+    // Electron clusters of the current event, collected by channel and
+    // turned into sim::SimChannel objects at the end of the event.
+    SimChannelAccumulator fChannelAccumulator;
+
+    // Per-cluster information.
+    struct Scratch_t {
+      std::vector<double> longDiff;
+      std::vector<double> transDiff1;
+      std::vector<double> transDiff2;
+      std::vector<double> nElDiff;
+      std::vector<double> nEnDiff;
+      double driftClusterPos[3];
     };
+    Scratch_t fScratch;
 
-    // Define type: channel -> sim::SimChannel's bookkeeping.
-    typedef std::unordered_map<raw::ChannelID_t, ChannelBookKeeping> ChannelMap_t;
+    // Random engine and scratch space of one thread of the parallel drift.
+    struct Worker_t {
+      CLHEP::MixMaxRng engine;
+      long seeds[4]; // seeds of the current TPC (the engine keeps a pointer)
+      Scratch_t scratch;
+    };
 
-    // Array of maps of channel data indexed by [cryostat,tpc]
-    std::vector<ChannelMap_t> fChannelMaps;
-    // The above ensemble may be thought of as a 3D array of
-    // ChannelBookKeepings: e.g., SimChannel[cryostat,tpc,channel ID].
+    // Cluster drifted to a channel, before it is added to fChannelAccumulator.
+    struct DriftedCluster_t {
+      raw::ChannelID_t channel;
+      unsigned int tdc;
+      int trackID;
+      size_t deposit;
+      double numElectrons;
+      double energy;
+    };
 
-    // Save the number of cryostats, and the number of TPCs within
-    // each cryostat.
-    size_t fNCryostats;
-    std::vector<size_t> fNTPCs;
+    // Clusters drifted in one TPC by the parallel drift.
+    struct TPCResult_t {
+      std::vector<DriftedCluster_t> clusters;
+      std::vector<sim::SimDriftedElectronCluster> driftedClusters;
+    };
 
-    // Per-cluster information.
-    std::vector<double> fLongDiff;
-    std::vector<double> fTransDiff1;
-    std::vector<double> fTransDiff2;
-    std::vector<double> fnElDiff;
-    std::vector<double> fnEnDiff;
+    std::unique_ptr<tbb::task_arena> fArena;
+    std::vector<std::unique_ptr<Worker_t>> fWorkers; // one per arena slot
+    std::vector<std::vector<size_t>> fTPCDeposits;  // deposits in each TPC
+    std::vector<geo::Vector_t> fSCEOffsets;         // SCE offset of each deposit
+
+    // Projection of a point on the wires of one plane.
+    struct PlaneDrift_t {
+      double firstWire[3];   // center of the first wire
+      double wireDir[3];     // direction of increasing wire number
+      double wirePitch;      // distance between wires
+      double interPlaneTime; // drift time from the previous plane [ns]
+      std::vector<raw::ChannelID_t> channels; // channel of each wire
+
+      // Returns the channel of the wire nearest to pos, or
+      // raw::InvalidChannelID if pos is beyond the wires of the plane.
+      raw::ChannelID_t nearestChannel(double const* pos) const
+      {
+        double const wireCoord = ((pos[0] - firstWire[0]) * wireDir[0] +
+                                  (pos[1] - firstWire[1]) * wireDir[1] +
+                                  (pos[2] - firstWire[2]) * wireDir[2]) /
+                                 wirePitch;
+        // rounded as geo::PlaneGeo::NearestWireID() does, also below the first wire
+        long const wire = std::lround(wireCoord);
+        if ((wire < 0) || (wire >= static_cast<long>(channels.size())))
+          return raw::InvalidChannelID;
+        return channels[wire];
+      }
+    };
 
-    double fDriftClusterPos[3];
+    // Drift geometry of one TPC.
+    struct TPCDrift_t {
+      bool valid = false;     // drift is along one of the axes
+      int driftCoord = 0;     // x:0, y:1, z:2
+      int transCoord1 = 0;    // coordinates perpendicular to the drift
+      int transCoord2 = 0;
+      int driftSign = 0;      // 1: +x, +y or +z, -1: -x, -y or -z
+      double planeCoord = 0.; // drift coordinate of the first plane
+      bool argoNeuT = false;  // two planes, drift along x: plane 0 is the second one
+      double argoNeuTPitch = 0.; // distance between the two planes
+      std::vector<PlaneDrift_t> planes;
+    };
+
+    // Drift geometry of all TPCs, built at the beginning of the job.
+    std::vector<TPCDrift_t> fTPCDrift;
+    std::vector<size_t> fFirstTPCDrift; // index of first TPC of each cryostat
+
+    void buildDriftGeometry();
+    size_t tpcIndex(geo::TPCID const& tpcid) const
+    {
+      return fFirstTPCDrift[tpcid.Cryostat] + tpcid.TPC;
+    }
+
+    // Returns the TPC of the deposit, nullptr if it is not in any.
+    geo::TPCGeo const* findTPC(sim::SimEnergyDeposit const& energyDeposit) const;
+
+    // Drifts the deposits in order, with the module random engine.
+    void driftSequential(detinfo::DetectorClocksData const& clockData,
+                         std::vector<sim::SimEnergyDeposit> const& energyDeposits,
+                         std::vector<sim::SimDriftedElectronCluster>& driftedClusters);
+
+    // Drifts the deposits of each TPC in parallel.
+    void driftParallel(art::EventID const& eventID,
+                       detinfo::DetectorClocksData const& clockData,
+                       std::vector<sim::SimEnergyDeposit> const& energyDeposits,
+                       std::vector<sim::SimDriftedElectronCluster>& driftedClusters);
+
+    // Drifts the electron clusters of one deposit in the specified TPC;
+    // storeCluster(channel, deposit, trackID, tdc, numElectrons, energy)
+    // is called for each cluster reaching a channel.
+    // The space charge offsets are taken from sceOffsets if not null,
+    // otherwise they are looked up from the service.
+    template <typename StoreCluster>
+    void driftDeposit(CLHEP::RandGauss& randGauss,
+                      Scratch_t& scratch,
+                      detinfo::DetectorClocksData const& clockData,
+                      size_t edIndex,
+                      sim::SimEnergyDeposit const& energyDeposit,
+                      geo::TPCID const& tpcid,
+                      geo::Vector_t const* sceOffsets,
+                      std::vector<sim::SimDriftedElectronCluster>* driftedClusters,
+                      StoreCluster&& storeCluster) const;
 
     art::ServiceHandle<geo::Geometry const> fGeometry; ///< Handle to the Geometry service
+    spacecharge::SpaceCharge const* fSCE = nullptr;    ///< Space charge of the current event
 
   }; // class SimDriftElectrons
 
@@ -168,6 +271,7 @@ namespace detsim {
                                                                                     pset,
                                                                                     "Seed")}
     , fStoreDriftedElectronClusters{pset.get<bool>("StoreDriftedElectronClusters", false)}
+    , fNThreads{pset.get<unsigned int>("NThreads", 0U)}
   {
     produces<std::vector<sim::SimChannel>>();
     if (fStoreDriftedElectronClusters) { produces<std::vector<sim::SimDriftedElectronCluster>>(); }
@@ -211,12 +315,78 @@ namespace detsim {
     fLDiff_const = std::sqrt(2. * fLongitudinalDiffusion);
     fTDiff_const = std::sqrt(2. * fTransverseDiffusion);
 
-    // For this detector's geometry, save the number of cryostats and
-    // the number of TPCs within each cryostat.
-    fNCryostats = fGeometry->Ncryostats();
-    fNTPCs.resize(fNCryostats);
-    for (size_t n = 0; n < fNCryostats; ++n)
-      fNTPCs[n] = fGeometry->NTPC(geo::CryostatID(n));
+    // Channel table covering all the channels of this detector.
+    fChannelAccumulator = SimChannelAccumulator{fGeometry->Nchannels()};
+
+    buildDriftGeometry();
+
+    // parallel mode: each slot of the arena has its own engine
+    if (fNThreads > 0) {
+      mf::LogInfo("SimDriftElectrons") << "Drifting TPCs on " << fNThreads << " threads";
+      fArena = std::make_unique<tbb::task_arena>(fNThreads);
+      fWorkers.clear();
+      for (unsigned int i = 0; i < fNThreads; ++i)
+        fWorkers.push_back(std::make_unique<Worker_t>());
+      fTPCDeposits.resize(fTPCDrift.size());
+    }
+  }
+
+  //-------------------------------------------------
+  void SimDriftElectrons::buildDriftGeometry()
+  {
+    fTPCDrift.clear();
+    fFirstTPCDrift.clear();
+    for (geo::CryostatGeo const& cryostat : fGeometry->Iterate<geo::CryostatGeo>()) {
+      fFirstTPCDrift.push_back(fTPCDrift.size());
+      for (geo::TPCGeo const& tpcGeo : fGeometry->Iterate<geo::TPCGeo>(cryostat.ID())) {
+        TPCDrift_t& drift = fTPCDrift.emplace_back();
+
+        // The drift direction can be either in the positive
+        // or negative direction in any coordinate x, y or z.
+        // Charge drift in ...
+        // +x: tpcGeo.DetectDriftDirection()==1
+        // -x: tpcGeo.DetectDriftDirection()==-1
+        // +y: tpcGeo.DetectDriftDirection()==2
+        // -y tpcGeo.DetectDriftDirection()==-2
+        // +z: tpcGeo.DetectDriftDirection()==3
+        // -z: tpcGeo.DetectDriftDirection()==-3
+        int const driftDirection = tpcGeo.DetectDriftDirection();
+        drift.driftCoord = std::abs(driftDirection) - 1;
+        drift.valid = (drift.driftCoord >= 0) && (drift.driftCoord <= 2);
+        if (!drift.valid) continue;
+        drift.transCoord1 = (drift.driftCoord == 0) ? 1 : 0;
+        drift.transCoord2 = (drift.driftCoord == 2) ? 1 : 2;
+        drift.driftSign = (driftDirection > 0) ? 1 : -1;
+
+        drift.planeCoord = geo::vect::coord(tpcGeo.Plane(0).GetCenter(), drift.driftCoord);
+
+        // special case for ArgoNeuT (Nplanes = 2 and drift direction = x):
+        // plane 0 is the second wire plane
+        unsigned int const nPlanes = tpcGeo.Nplanes();
+        drift.argoNeuT = (nPlanes == 2) && (drift.driftCoord == 0);
+        if (drift.argoNeuT) drift.argoNeuTPitch = tpcGeo.PlanePitch(0, 1);
+
+        drift.planes.resize(nPlanes);
+        for (unsigned int p = 0; p < nPlanes; ++p) {
+          geo::PlaneGeo const& plane = tpcGeo.Plane(p);
+          PlaneDrift_t& planeDrift = drift.planes[p];
+          plane.FirstWire().GetCenter().GetCoordinates(planeDrift.firstWire);
+          plane.GetIncreasingWireDirection().GetCoordinates(planeDrift.wireDir);
+          planeDrift.wirePitch = plane.WirePitch();
+
+          // Take into account different Efields between planes
+          planeDrift.interPlaneTime = 0.;
+          if (p > 0) {
+            unsigned int const field = std::min(drift.argoNeuT ? p + 1 : p, 2U);
+            planeDrift.interPlaneTime = tpcGeo.PlanePitch(p, p - 1) * fRecipDriftVel[field];
+          }
+
+          planeDrift.channels.resize(plane.Nwires());
+          for (unsigned int w = 0; w < plane.Nwires(); ++w)
+            planeDrift.channels[w] = fGeometry->PlaneWireToChannel(geo::WireID{plane.ID(), w});
+        } // for planes
+      }   // for TPCs
+    }     // for cryostats
   }
 
   //-------------------------------------------------
@@ -238,331 +408,384 @@ namespace detsim {
     std::unique_ptr<std::vector<sim::SimDriftedElectronCluster>>
       SimDriftedElectronClusterCollection(new std::vector<sim::SimDriftedElectronCluster>);
 
-    // Clear the channel maps from the last event. Remember,
-    // fChannelMaps is an array[cryo][tpc] of maps.
-    size_t cryo = 0;
-    fChannelMaps.resize(fNCryostats);
-    for (auto& cryoData : fChannelMaps) { // each, a vector of maps
-      cryoData.clear();
-    }
+    // Clear the clusters left from the last event, if any.
+    fChannelAccumulator.clear();
 
     auto const clockData =
       art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(event);
-    auto const& tpcClock = clockData.TPCClock();
+    fSCE = lar::providerFrom<spacecharge::SpaceChargeService>();
 
-    auto const detProp =
-      art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(event, clockData);
     // We're going through the input vector by index, rather than by
     // iterator, because we need the index number to compute the
     // associations near the end of this method.
     auto const& energyDeposits = *energyDepositHandle;
-    auto energyDepositsSize = energyDeposits.size();
+
+    if (fNThreads > 0)
+      driftParallel(event.id(), clockData, energyDeposits, *SimDriftedElectronClusterCollection);
+    else
+      driftSequential(clockData, energyDeposits, *SimDriftedElectronClusterCollection);
+
+    // Fill the sim::SimChannel collection and write it.
+    fChannelAccumulator.flush(*channels, energyDeposits);
+    event.put(std::move(channels));
+    if (fStoreDriftedElectronClusters) event.put(std::move(SimDriftedElectronClusterCollection));
+  }
+
+  //-------------------------------------------------
+  geo::TPCGeo const* SimDriftElectrons::findTPC(sim::SimEnergyDeposit const& energyDeposit) const
+  {
+    // From the position in world coordinates, determine the
+    // cryostat and tpc. If somehow the step is outside a tpc
+    // (e.g., cosmic rays in rock) just move on to the next one.
+    auto const mp = energyDeposit.MidPoint();
+    if (!fGeometry->PositionToCryostatPtr(mp)) {
+      mf::LogWarning("SimDriftElectrons") << "step " // << energyDeposit << "\n"
+                                          << "cannot be found in a cryostat";
+      return nullptr;
+    }
+
+    geo::TPCGeo const* tpcGeo = fGeometry->PositionToTPCptr(mp);
+    if (!tpcGeo) {
+      mf::LogWarning("SimDriftElectrons") << "step " // << energyDeposit << "\n"
+                                          << "cannot be found in a TPC";
+    }
+    return tpcGeo;
+  }
+
+  //-------------------------------------------------
+  void SimDriftElectrons::driftSequential(
+    detinfo::DetectorClocksData const& clockData,
+    std::vector<sim::SimEnergyDeposit> const& energyDeposits,
+    std::vector<sim::SimDriftedElectronCluster>& driftedClusters)
+  {
+    auto storeCluster = [this](raw::ChannelID_t channel,
+                               size_t edIndex,
+                               int trackID,
+                               unsigned int tdc,
+                               double numElectrons,
+                               double energy) {
+      fChannelAccumulator.add(channel, edIndex, trackID, tdc, numElectrons, energy);
+    };
 
     // For each energy deposit in this event
-    for (size_t edIndex = 0; edIndex < energyDepositsSize; ++edIndex) {
+    for (size_t edIndex = 0; edIndex < energyDeposits.size(); ++edIndex) {
       auto const& energyDeposit = energyDeposits[edIndex];
+      geo::TPCGeo const* tpcGeo = findTPC(energyDeposit);
+      if (!tpcGeo) continue;
+      driftDeposit(fRandGauss,
+                   fScratch,
+                   clockData,
+                   edIndex,
+                   energyDeposit,
+                   tpcGeo->ID(),
+                   nullptr,
+                   fStoreDriftedElectronClusters ? &driftedClusters : nullptr,
+                   storeCluster);
+    }
+  }
 
-      // "xyz" is the position of the energy deposit in world
-      // coordinates. Note that the units of distance in
-      // sim::SimEnergyDeposit are supposed to be cm.
-      auto const mp = energyDeposit.MidPoint();
-      std::array<double, 3> xyz;
-      mp.GetCoordinates(data(xyz));
-
-      // From the position in world coordinates, determine the
-      // cryostat and tpc. If somehow the step is outside a tpc
-      // (e.g., cosmic rays in rock) just move on to the next one.
-      unsigned int cryostat = 0;
-      try {
-        cryostat = fGeometry->PositionToCryostatID(mp).Cryostat;
-      }
-      catch (cet::exception& e) {
-        mf::LogWarning("SimDriftElectrons") << "step " // << energyDeposit << "\n"
-                                            << "cannot be found in a cryostat\n"
-                                            << e;
-        continue;
-      }
+  //-------------------------------------------------
+  // The engine of the thread is reseeded for each TPC from its index and the
+  // event ID, the deposits of each TPC are drifted in order, and the results
+  // of the TPCs are merged in TPC order, so that the result does not depend on
+  // the number of threads.
+  void SimDriftElectrons::driftParallel(
+    art::EventID const& eventID,
+    detinfo::DetectorClocksData const& clockData,
+    std::vector<sim::SimEnergyDeposit> const& energyDeposits,
+    std::vector<sim::SimDriftedElectronCluster>& driftedClusters)
+  {
+    long const baseSeed = fRandGauss.engine().getSeed();
+    long const eventSeed = (long(eventID.subRun()) * 0x9E3779B1L) ^ long(eventID.event());
+
+    // group the deposits by TPC, keeping their order
+    for (auto& deposits : fTPCDeposits)
+      deposits.clear();
+    for (size_t edIndex = 0; edIndex < energyDeposits.size(); ++edIndex) {
+      geo::TPCGeo const* tpcGeo = findTPC(energyDeposits[edIndex]);
+      if (tpcGeo) fTPCDeposits[tpcIndex(tpcGeo->ID())].push_back(edIndex);
+    }
+    std::vector<size_t> tpcs;
+    std::vector<geo::TPCID> tpcIDs;
+
+    // the space charge service is not thread-safe: offsets are looked up here
+    bool const sceOffsets = fSCE->EnableSimSpatialSCE();
+    if (sceOffsets) {
+      fSCEOffsets.resize(energyDeposits.size());
+      for (auto const& deposits : fTPCDeposits)
+        for (size_t edIndex : deposits)
+          fSCEOffsets[edIndex] = fSCE->GetPosOffsets(energyDeposits[edIndex].MidPoint());
+    }
+    for (geo::TPCGeo const& tpcGeo : fGeometry->Iterate<geo::TPCGeo>()) {
+      if (fTPCDeposits[tpcIndex(tpcGeo.ID())].empty()) continue;
+      tpcs.push_back(tpcIndex(tpcGeo.ID()));
+      tpcIDs.push_back(tpcGeo.ID());
+    }
 
-      geo::TPCID tpcid;
-      try {
-        tpcid = fGeometry->PositionToTPCID(mp);
-      }
-      catch (cet::exception& e) {
-        mf::LogWarning("SimDriftElectrons") << "step " // << energyDeposit << "\n"
-                                            << "cannot be found in a TPC\n"
-                                            << e;
-        continue;
+    auto driftTPC = [&](size_t iTPC, TPCResult_t& result) {
+      Worker_t& worker = *fWorkers[tbb::this_task_arena::current_thread_index()];
+      result.clusters.clear();
+      result.driftedClusters.clear();
+
+      worker.seeds[0] = baseSeed;
+      worker.seeds[1] = eventID.run();
+      worker.seeds[2] = eventSeed;
+      worker.seeds[3] = tpcs[iTPC];
+      worker.engine.setSeeds(worker.seeds, 4);
+      // a new generator, so that no value cached from another TPC is used
+      CLHEP::RandGauss randGauss{worker.engine};
+
+      auto storeCluster = [&result](raw::ChannelID_t channel,
+                                    size_t edIndex,
+                                    int trackID,
+                                    unsigned int tdc,
+                                    double numElectrons,
+                                    double energy) {
+        result.clusters.push_back({channel, tdc, trackID, edIndex, numElectrons, energy});
+      };
+      for (size_t edIndex : fTPCDeposits[tpcs[iTPC]]) {
+        driftDeposit(randGauss,
+                     worker.scratch,
+                     clockData,
+                     edIndex,
+                     energyDeposits[edIndex],
+                     tpcIDs[iTPC],
+                     sceOffsets ? &fSCEOffsets[edIndex] : nullptr,
+                     fStoreDriftedElectronClusters ? &result.driftedClusters : nullptr,
+                     storeCluster);
       }
+    };
 
-      const geo::TPCGeo& tpcGeo = fGeometry->TPC(tpcid);
-
-      // The drift direction can be either in the positive
-      // or negative direction in any coordinate x, y or z.
-      // Charge drift in ...
-      // +x: tpcGeo.DetectDriftDirection()==1
-      // -x: tpcGeo.DetectDriftDirection()==-1
-      // +y: tpcGeo.DetectDriftDirection()==2
-      // -y tpcGeo.DetectDriftDirection()==-2
-      // +z: tpcGeo.DetectDriftDirection()==3
-      // -z: tpcGeo.DetectDriftDirection()==-3
-
-      // Define charge drift direction: driftcoordinate (x, y or z) and
-      // driftsign (positive or negative). Also define coordinates perpendicular
-      // to drift direction.
-      int driftcoordinate = std::abs(tpcGeo.DetectDriftDirection()) - 1; // x:0, y:1, z:2
-
-      int transversecoordinate1 = 0;
-      int transversecoordinate2 = 0;
-      if (driftcoordinate == 0) {
-        transversecoordinate1 = 1;
-        transversecoordinate2 = 2;
-      }
-      else if (driftcoordinate == 1) {
-        transversecoordinate1 = 0;
-        transversecoordinate2 = 2;
-      }
-      else if (driftcoordinate == 2) {
-        transversecoordinate1 = 0;
-        transversecoordinate2 = 1;
+    // TPCs are drifted in rounds, to bound the memory held by their results
+    size_t const roundSize = 4 * fWorkers.size();
+    std::vector<TPCResult_t> results(std::min(roundSize, tpcs.size()));
+    for (size_t roundStart = 0; roundStart < tpcs.size(); roundStart += roundSize) {
+      size_t const roundEnd = std::min(roundStart + roundSize, tpcs.size());
+      fArena->execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(roundStart, roundEnd, 1),
+                          [&](tbb::blocked_range<size_t> const& range) {
+                            for (size_t iTPC = range.begin(); iTPC < range.end(); ++iTPC)
+                              driftTPC(iTPC, results[iTPC - roundStart]);
+                          });
+      });
+      for (size_t iTPC = roundStart; iTPC < roundEnd; ++iTPC) {
+        TPCResult_t const& result = results[iTPC - roundStart];
+        for (DriftedCluster_t const& cluster : result.clusters) {
+          fChannelAccumulator.add(cluster.channel,
+                                  cluster.deposit,
+                                  cluster.trackID,
+                                  cluster.tdc,
+                                  cluster.numElectrons,
+                                  cluster.energy);
+        }
+        driftedClusters.insert(
+          driftedClusters.end(), result.driftedClusters.begin(), result.driftedClusters.end());
       }
+    } // for rounds
+  }
 
-      if (transversecoordinate1 == transversecoordinate2)
-        continue; // this is the case when driftcoordinate != 0, 1 or 2
-
-      int driftsign = 0; // 1: +x, +y or +z, -1: -x, -y or -z
-      if (tpcGeo.DetectDriftDirection() > 0)
-        driftsign = 1;
-      else
-        driftsign = -1;
-
-      // Check for charge deposits behind charge readout planes
-      auto const& plane_location = tpcGeo.Plane(0).GetCenter();
-      auto const plane_location_coord = geo::vect::coord(plane_location, driftcoordinate);
-      if (driftsign == 1 && plane_location_coord < xyz[driftcoordinate]) continue;
-      if (driftsign == -1 && plane_location_coord > xyz[driftcoordinate]) continue;
-
-      /// \todo think about effects of drift between planes.
-      // Center of plane is also returned in cm units
-      double DriftDistance = std::abs(xyz[driftcoordinate] - plane_location_coord);
-
-      // Space-charge effect (SCE): Get SCE {x,y,z} offsets for
-      // particular location in TPC
-      geo::Vector_t posOffsets{0.0, 0.0, 0.0};
-      double posOffsetxyz[3] = {0.0, 0.0, 0.0}; // need this array for the driftcoordinate and
-                                                // transversecoordinates
-      auto const* SCE = lar::providerFrom<spacecharge::SpaceChargeService>();
-      if (SCE->EnableSimSpatialSCE() == true) {
-        posOffsets = SCE->GetPosOffsets(mp);
-        if (larsim::Utils::SCE::out_of_bounds(posOffsets)) { continue; }
-        posOffsetxyz[0] = posOffsets.X();
-        posOffsetxyz[1] = posOffsets.Y();
-        posOffsetxyz[2] = posOffsets.Z();
-      }
+  //-------------------------------------------------
+  template <typename StoreCluster>
+  void SimDriftElectrons::driftDeposit(CLHEP::RandGauss& randGauss,
+                                       Scratch_t& scratch,
+                                       detinfo::DetectorClocksData const& clockData,
+                                       size_t edIndex,
+                                       sim::SimEnergyDeposit const& energyDeposit,
+                                       geo::TPCID const& tpcid,
+                                       geo::Vector_t const* sceOffsets,
+                                       std::vector<sim::SimDriftedElectronCluster>* driftedClusters,
+                                       StoreCluster&& storeCluster) const
+  {
+    auto const& tpcClock = clockData.TPCClock();
 
-      double avegagetransversePos1 = 0.;
-      double avegagetransversePos2 = 0.;
+    // "xyz" is the position of the energy deposit in world
+    // coordinates. Note that the units of distance in
+    // sim::SimEnergyDeposit are supposed to be cm.
+    auto const mp = energyDeposit.MidPoint();
+    std::array<double, 3> xyz;
+    mp.GetCoordinates(data(xyz));
+
+    // Charge drift direction: driftcoordinate (x, y or z) and
+    // driftsign (positive or negative), and coordinates perpendicular
+    // to drift direction.
+    TPCDrift_t const& drift = fTPCDrift[tpcIndex(tpcid)];
+    if (!drift.valid) return; // drift direction not along x, y or z
+    int const driftcoordinate = drift.driftCoord;
+    int const transversecoordinate1 = drift.transCoord1;
+    int const transversecoordinate2 = drift.transCoord2;
+    int const driftsign = drift.driftSign;
+
+    // Check for charge deposits behind charge readout planes
+    auto const plane_location_coord = drift.planeCoord;
+    if (driftsign == 1 && plane_location_coord < xyz[driftcoordinate]) return;
+    if (driftsign == -1 && plane_location_coord > xyz[driftcoordinate]) return;
+
+    /// \todo think about effects of drift between planes.
+    // Center of plane is also returned in cm units
+    double DriftDistance = std::abs(xyz[driftcoordinate] - plane_location_coord);
+
+    // Space-charge effect (SCE): Get SCE {x,y,z} offsets for
+    // particular location in TPC
+    geo::Vector_t posOffsets{0.0, 0.0, 0.0};
+    double posOffsetxyz[3] = {0.0, 0.0, 0.0}; // need this array for the driftcoordinate and
+                                              // transversecoordinates
+    if (fSCE->EnableSimSpatialSCE() == true) {
+      posOffsets = sceOffsets ? *sceOffsets : fSCE->GetPosOffsets(mp);
+      if (larsim::Utils::SCE::out_of_bounds(posOffsets)) { return; }
+      posOffsetxyz[0] = posOffsets.X();
+      posOffsetxyz[1] = posOffsets.Y();
+      posOffsetxyz[2] = posOffsets.Z();
+    }
 
-      DriftDistance += -1. * posOffsetxyz[driftcoordinate];
-      avegagetransversePos1 = xyz[transversecoordinate1] + posOffsetxyz[transversecoordinate1];
-      avegagetransversePos2 = xyz[transversecoordinate2] + posOffsetxyz[transversecoordinate2];
+    double avegagetransversePos1 = 0.;
+    double avegagetransversePos2 = 0.;
 
-      // Space charge distortion could push the energy deposit beyond the wire
-      // plane (see issue #15131). Given that we don't have any subtlety in the
-      // simulation of this region, bringing the deposit exactly on the plane
-      // should be enough for the time being.
-      if (DriftDistance < 0.) DriftDistance = 0.;
+    DriftDistance += -1. * posOffsetxyz[driftcoordinate];
+    avegagetransversePos1 = xyz[transversecoordinate1] + posOffsetxyz[transversecoordinate1];
+    avegagetransversePos2 = xyz[transversecoordinate2] + posOffsetxyz[transversecoordinate2];
 
-      // Drift time in ns
-      double TDrift = DriftDistance * fRecipDriftVel[0];
+    // Space charge distortion could push the energy deposit beyond the wire
+    // plane (see issue #15131). Given that we don't have any subtlety in the
+    // simulation of this region, bringing the deposit exactly on the plane
+    // should be enough for the time being.
+    if (DriftDistance < 0.) DriftDistance = 0.;
 
-      if (tpcGeo.Nplanes() == 2 &&
-          driftcoordinate == 0) { // special case for ArgoNeuT (Nplanes = 2 and drift direction =
-                                  // x): plane 0 is the second wire plane
-        TDrift = ((DriftDistance - tpcGeo.PlanePitch(0, 1)) * fRecipDriftVel[0] +
-                  tpcGeo.PlanePitch(0, 1) * fRecipDriftVel[1]);
-      }
+    // Drift time in ns
+    double TDrift = DriftDistance * fRecipDriftVel[0];
 
-      const int nIonizedElectrons = energyDeposit.NumElectrons();
-      const double lifetimecorrection = TMath::Exp(TDrift / fLifetimeCorr_const);
-      const double energy = energyDeposit.Energy();
-
-      // if we have no electrons (too small energy or too large recombination)
-      // we are done already here
-      if (nIonizedElectrons <= 0) {
-        MF_LOG_DEBUG("SimDriftElectrons")
-          << "step " // << energyDeposit << "\n"
-          << "No electrons drifted to readout, " << energy << " MeV lost.";
-        continue;
-      }
+    if (drift.argoNeuT) { // special case for ArgoNeuT (Nplanes = 2 and drift direction =
+                          // x): plane 0 is the second wire plane
+      TDrift = ((DriftDistance - drift.argoNeuTPitch) * fRecipDriftVel[0] +
+                drift.argoNeuTPitch * fRecipDriftVel[1]);
+    }
 
-      // includes the effect of lifetime: lifetimecorrection = exp[-tdrift/tau]
-      const double nElectrons = nIonizedElectrons * lifetimecorrection;
-
-      // Longitudinal & transverse diffusion sigma (cm)
-      double SqrtT = std::sqrt(TDrift);
-      double LDiffSig = SqrtT * fLDiff_const;
-      double TDiffSig = SqrtT * fTDiff_const;
-      double electronclsize = fElectronClusterSize;
-
-      // Number of electron clusters.
-      int nClus = (int)std::ceil(nElectrons / electronclsize);
-      if (nClus < fMinNumberOfElCluster) {
-        electronclsize = nElectrons / fMinNumberOfElCluster;
-        if (electronclsize < 1.0) { electronclsize = 1.0; }
-        nClus = (int)std::ceil(nElectrons / electronclsize);
-      }
+    const int nIonizedElectrons = energyDeposit.NumElectrons();
+    const double lifetimecorrection = TMath::Exp(TDrift / fLifetimeCorr_const);
+    const double energy = energyDeposit.Energy();
+
+    // if we have no electrons (too small energy or too large recombination)
+    // we are done already here
+    if (nIonizedElectrons <= 0) {
+      MF_LOG_DEBUG("SimDriftElectrons")
+        << "step " // << energyDeposit << "\n"
+        << "No electrons drifted to readout, " << energy << " MeV lost.";
+      return;
+    }
 
-      // Empty and resize the electron-cluster vectors.
-      fLongDiff.clear();
-      fTransDiff1.clear();
-      fTransDiff2.clear();
-      fnElDiff.clear();
-      fnEnDiff.clear();
-      fLongDiff.resize(nClus);
-      fTransDiff1.resize(nClus);
-      fTransDiff2.resize(nClus);
-      fnElDiff.resize(nClus, electronclsize);
-      fnEnDiff.resize(nClus);
-
-      // fix the number of electrons in the last cluster, that has a smaller size
-      fnElDiff.back() = nElectrons - (nClus - 1) * electronclsize;
-
-      for (size_t xx = 0; xx < fnElDiff.size(); ++xx) {
-        if (nElectrons > 0)
-          fnEnDiff[xx] = energy / nElectrons * fnElDiff[xx];
-        else
-          fnEnDiff[xx] = 0.;
-      }
+    // includes the effect of lifetime: lifetimecorrection = exp[-tdrift/tau]
+    const double nElectrons = nIonizedElectrons * lifetimecorrection;
+
+    // Longitudinal & transverse diffusion sigma (cm)
+    double SqrtT = std::sqrt(TDrift);
+    double LDiffSig = SqrtT * fLDiff_const;
+    double TDiffSig = SqrtT * fTDiff_const;
+    double electronclsize = fElectronClusterSize;
+
+    // Number of electron clusters.
+    int nClus = (int)std::ceil(nElectrons / electronclsize);
+    if (nClus < fMinNumberOfElCluster) {
+      electronclsize = nElectrons / fMinNumberOfElCluster;
+      if (electronclsize < 1.0) { electronclsize = 1.0; }
+      nClus = (int)std::ceil(nElectrons / electronclsize);
+    }
 
-      // Smear drift times by longitudinal diffusion
-      if (LDiffSig > 0.0)
-        fRandGauss.fireArray(nClus, &fLongDiff[0], 0., LDiffSig);
+    // Empty and resize the electron-cluster vectors.
+    scratch.longDiff.clear();
+    scratch.transDiff1.clear();
+    scratch.transDiff2.clear();
+    scratch.nElDiff.clear();
+    scratch.nEnDiff.clear();
+    scratch.longDiff.resize(nClus);
+    scratch.transDiff1.resize(nClus);
+    scratch.transDiff2.resize(nClus);
+    scratch.nElDiff.resize(nClus, electronclsize);
+    scratch.nEnDiff.resize(nClus);
+
+    // fix the number of electrons in the last cluster, that has a smaller size
+    scratch.nElDiff.back() = nElectrons - (nClus - 1) * electronclsize;
+
+    for (size_t xx = 0; xx < scratch.nElDiff.size(); ++xx) {
+      if (nElectrons > 0)
+        scratch.nEnDiff[xx] = energy / nElectrons * scratch.nElDiff[xx];
       else
-        fLongDiff.assign(nClus, 0.0);
-
-      if (TDiffSig > 0.0) {
-        // Smear the coordinates in plane perpendicular to drift direction by the transverse diffusion
-        fRandGauss.fireArray(nClus, &fTransDiff1[0], avegagetransversePos1, TDiffSig);
-        fRandGauss.fireArray(nClus, &fTransDiff2[0], avegagetransversePos2, TDiffSig);
-      }
-      else {
-        fTransDiff1.assign(nClus, avegagetransversePos1);
-        fTransDiff2.assign(nClus, avegagetransversePos2);
-      }
-
-      // make a collection of electrons for each plane
-      for (unsigned int p = 0; p < tpcGeo.Nplanes(); ++p) {
-        // FIXME (KJK): Shouldn't this be the location for each plane
-        // we're iterating through?  Right now it uses whatever value
-        // of plane_location_coord was set above.
-        fDriftClusterPos[driftcoordinate] = plane_location_coord;
-
-        // Drift nClus electron clusters to the induction plane
-        for (int k = 0; k < nClus; ++k) {
+        scratch.nEnDiff[xx] = 0.;
+    }
 
-          // Correct drift time for longitudinal diffusion and plane
-          double TDiff = TDrift + fLongDiff[k] * fRecipDriftVel[0];
+    // Smear drift times by longitudinal diffusion
+    if (LDiffSig > 0.0)
+      randGauss.fireArray(nClus, &scratch.longDiff[0], 0., LDiffSig);
+    else
+      scratch.longDiff.assign(nClus, 0.0);
 
-          // Take into account different Efields between planes
-          // Also take into account special case for ArgoNeuT (Nplanes = 2 and
-          // drift direction = x): plane 0 is the second wire plane
-          for (unsigned int ip = 0; ip < p; ++ip) {
-            TDiff +=
-              tpcGeo.PlanePitch(ip + 1, ip) *
-              fRecipDriftVel[(tpcGeo.Nplanes() == 2 && driftcoordinate == 0) ? ip + 2 : ip + 1];
-          }
+    if (TDiffSig > 0.0) {
+      // Smear the coordinates in plane perpendicular to drift direction by the transverse diffusion
+      randGauss.fireArray(nClus, &scratch.transDiff1[0], avegagetransversePos1, TDiffSig);
+      randGauss.fireArray(nClus, &scratch.transDiff2[0], avegagetransversePos2, TDiffSig);
+    }
+    else {
+      scratch.transDiff1.assign(nClus, avegagetransversePos1);
+      scratch.transDiff2.assign(nClus, avegagetransversePos2);
+    }
 
-          fDriftClusterPos[transversecoordinate1] = fTransDiff1[k];
-          fDriftClusterPos[transversecoordinate2] = fTransDiff2[k];
-
-          /// \todo think about effects of drift between planes
-
-          // grab the nearest channel to the fDriftClusterPos position
-          try {
-            raw::ChannelID_t channel = fGeometry->NearestChannel(
-              geo::vect::toPoint(fDriftClusterPos), geo::PlaneID{tpcid, p});
-
-            /// \todo check on what happens if we allow the tdc value to be
-            /// \todo beyond the end of the expected number of ticks
-            // Add potential decay/capture/etc delay effect, simTime.
-            auto const simTime = energyDeposit.Time();
-            unsigned int tdc = tpcClock.Ticks(clockData.G4ToElecTime(TDiff + simTime));
-
-            // Find whether we already have this channel in our map.
-            ChannelMap_t& channelDataMap = fChannelMaps[cryostat];
-            auto search = channelDataMap.find(channel);
-
-            // We will find (or create) the pointer to a
-            // sim::SimChannel.
-            size_t channelIndex = 0;
-
-            // Have we created the sim::SimChannel corresponding to
-            // channel ID?
-            if (search == channelDataMap.end()) {
-              // We haven't. Initialize the bookkeeping information
-              // for this channel.
-              ChannelBookKeeping bookKeeping;
-
-              // Add a new channel to the end of the list we'll
-              // write out after we've processed this event.
-              bookKeeping.channelIndex = channels->size();
-              channels->emplace_back(channel);
-              channelIndex = bookKeeping.channelIndex;
-
-              // Initialize a vector with the index of the step that
-              // created this channel.
-              bookKeeping.stepList.push_back(edIndex);
-
-              // Save the bookkeeping information for this channel.
-              channelDataMap[channel] = bookKeeping;
-            }
-            else {
-              // We've created this SimChannel for a previous energy
-              // deposit. Get its address.
-
-              auto& bookKeeping = search->second;
-              channelIndex = bookKeeping.channelIndex;
-
-              // Has this step contributed to this channel before?
-              auto& stepList = bookKeeping.stepList;
-              if (!std::binary_search(stepList.begin(), stepList.end(), edIndex)) {
-                // No, so add this step's index to the list.
-                stepList.push_back(edIndex);
-              }
-            }
-
-            sim::SimChannel* channelPtr = &(channels->at(channelIndex));
-
-            // Add the electron clusters and energy to the
-            // sim::SimChannel
-            channelPtr->AddIonizationElectrons(
-              energyDeposit.TrackID(), tdc, fnElDiff[k], data(xyz), fnEnDiff[k]);
-
-            if (fStoreDriftedElectronClusters)
-              SimDriftedElectronClusterCollection->emplace_back(
-                fnElDiff[k],
-                TDiff + simTime,                      // timing
-                geo::Point_t{mp.X(), mp.Y(), mp.Z()}, // mean position of the deposited energy
-                geo::Point_t{fDriftClusterPos[0],
-                             fDriftClusterPos[1],
-                             fDriftClusterPos[2]}, // final position of the drifted cluster
-                geo::Point_t{
-                  LDiffSig, TDiffSig, TDiffSig}, // Longitudinal (X) and transverse (Y,Z) diffusion
-                fnEnDiff[k],                     // deposited energy that originated this cluster
-                energyDeposit.TrackID());
-          }
-          catch (cet::exception& e) {
-            mf::LogDebug("SimDriftElectrons")
-              << "unable to drift electrons from point (" << xyz[0] << "," << xyz[1] << ","
-              << xyz[2] << ") with exception " << e;
-          } // end try to determine channel
-        }   // end loop over clusters
-      }     // end loop over planes
-    }       // for each sim::SimEnergyDeposit
-
-    // Write the sim::SimChannel collection.
-    event.put(std::move(channels));
-    if (fStoreDriftedElectronClusters) event.put(std::move(SimDriftedElectronClusterCollection));
+    // make a collection of electrons for each plane
+    auto const simTime = energyDeposit.Time();
+    for (unsigned int p = 0; p < drift.planes.size(); ++p) {
+      PlaneDrift_t const& planeDrift = drift.planes[p];
+      // FIXME (KJK): Shouldn't this be the location for each plane
+      // we're iterating through?  Right now it uses whatever value
+      // of plane_location_coord was set above.
+      scratch.driftClusterPos[driftcoordinate] = plane_location_coord;
+
+      // Drift nClus electron clusters to the induction plane
+      for (int k = 0; k < nClus; ++k) {
+
+        // Correct drift time for longitudinal diffusion and plane
+        double TDiff = TDrift + scratch.longDiff[k] * fRecipDriftVel[0];
+
+        // Take into account different Efields between planes
+        for (unsigned int ip = 1; ip <= p; ++ip)
+          TDiff += drift.planes[ip].interPlaneTime;
+
+        scratch.driftClusterPos[transversecoordinate1] = scratch.transDiff1[k];
+        scratch.driftClusterPos[transversecoordinate2] = scratch.transDiff2[k];
+
+        /// \todo think about effects of drift between planes
+
+        // grab the nearest channel to the drifted cluster position
+        raw::ChannelID_t const channel = planeDrift.nearestChannel(scratch.driftClusterPos);
+        if (channel == raw::InvalidChannelID) {
+          mf::LogDebug("SimDriftElectrons")
+            << "unable to drift electrons from point (" << xyz[0] << "," << xyz[1] << ","
+            << xyz[2] << "): cluster at (" << scratch.driftClusterPos[0] << ","
+            << scratch.driftClusterPos[1] << "," << scratch.driftClusterPos[2] << ") is off plane "
+            << geo::PlaneID{tpcid, p};
+          continue;
+        }
+
+        /// \todo check on what happens if we allow the tdc value to be
+        /// \todo beyond the end of the expected number of ticks
+        // Add potential decay/capture/etc delay effect, simTime.
+        unsigned int tdc = tpcClock.Ticks(clockData.G4ToElecTime(TDiff + simTime));
+
+        // Add the electron clusters and energy to the channel; they
+        // are stored into sim::SimChannel at the end of the event.
+        storeCluster(
+          channel, edIndex, energyDeposit.TrackID(), tdc, scratch.nElDiff[k], scratch.nEnDiff[k]);
+
+        if (driftedClusters)
+          driftedClusters->emplace_back(
+            scratch.nElDiff[k],
+            TDiff + simTime,                      // timing
+            geo::Point_t{mp.X(), mp.Y(), mp.Z()}, // mean position of the deposited energy
+            geo::Point_t{scratch.driftClusterPos[0],
+                         scratch.driftClusterPos[1],
+                         scratch.driftClusterPos[2]}, // final position of the drifted cluster
+            geo::Point_t{
+              LDiffSig, TDiffSig, TDiffSig}, // Longitudinal (X) and transverse (Y,Z) diffusion
+            scratch.nEnDiff[k],              // deposited energy that originated this cluster
+            energyDeposit.TrackID());
+      } // end loop over clusters
+    }   // end loop over planes
   }
 
 } // namespace detsim
@@ -24,6 +24,7 @@
 
 // larsoft includes
 #include "larcore/Geometry/Geometry.h"
+#include "larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h"
 #include "larcoreobj/SummaryData/RunData.h"
 #include "nusimdata/SimulationBase/MCParticle.h"
 #include "nusimdata/SimulationBase/MCTruth.h"
@@ -33,6 +34,11 @@
 #include "ifdh.h" //to handle flux files
 #include <sqlite3.h>
 
+#include <algorithm> // std::min()
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace evgen {
 
   /**
@@ -57,6 +63,11 @@ namespace evgen {
    * sources can be specified (`ShowerInputFiles` configuration parameter).
    * From each source, one database file is selected and copied locally via
    * IFDH.
+   * Alternatively, a source may be a shower file converted from a database by
+   * the `ConvertCORSIKAShowerDB` program (see `evgen::CORSIKAShowerFile`).
+   * Such files are memory-mapped from their path, with no local copy, and
+   * showers are sampled from them by index, which avoids sorting the whole
+   * database on each query.
    * From each source, showers are extracted proportionally to the relative flux
    * specified in the configuration (specified in `ShowerFluxConstants`,
    * see @ref CORSIKAGen_Normalization "normalization" below).
@@ -178,7 +189,9 @@ namespace evgen {
    * * `ShowerInputFiles` (list of paths; mandatory): a list of file paths to
    *     pregenerated CORSIKA shower files. Each entry can be a single file or
    *     use wildcards (`*`) to specify a set of files to choose among.
-   *     Paths and wildcards are processed by IFDH.
+   *     Paths and wildcards are processed by IFDH. Each file can be a SQLite
+   *     database or a shower file (`evgen::CORSIKAShowerFile`); the format is
+   *     detected from the file content.
    * * `ShowerFluxConstants` (list of real numbers; mandatory): for each entry
    *     @f$ A @f$ in `ShowerInputFiles`, specify the normalization factor
    *     @f$ K_{A} @f$ of their distribution [@f$ m^{-2}s^{-1} @f$]
@@ -289,7 +302,9 @@ namespace evgen {
       fBuffBox; ///< Buffer box extensions to cryostat in each direction (6 of them: x_lo,x_hi,y_lo,y_hi,z_lo,z_hi) [cm]
     double fShowerAreaExtension =
       0.; ///< Extend distribution of corsika particles in x,z by this much (e.g. 1000 will extend 10 m in -x, +x, -z, and +z) [cm]
-    sqlite3* fdb[5]; ///< Pointers to sqlite3 database object, max of 5
+    sqlite3* fdb[5] = {nullptr}; ///< Pointers to sqlite3 database object, max of 5
+    std::vector<std::unique_ptr<CORSIKAShowerFile>>
+      fShowerFiles; ///< Mapped shower file of each input (null for SQLite databases)
     double fRandomXZShift =
       0.; ///< Each shower will be shifted by a random amount in xz so that showers won't repeatedly sample the same space [cm]
     CLHEP::HepRandomEngine& fGenEngine;
@@ -457,7 +472,14 @@ namespace evgen {
     for (unsigned int i = 0; i < selectedflist.size(); i++) {
       mf::LogInfo("CorsikaGen") << "Fetching: " << selectedflist[i].first << " "
                                 << selectedflist[i].second << "\n";
-      if (fShowerCopyType == "IFDH") {
+      if (CORSIKAShowerFile::isShowerFile(selectedflist[i].first)) {
+        // shower files are mapped, and only the sampled showers are read
+        std::string fetchedfile(selectedflist[i].first);
+        MF_LOG_DEBUG("CorsikaGen") << "Fetched; local path: " << fetchedfile
+                                   << "; copy type: none (shower file)";
+        locallist.push_back(fetchedfile);
+      }
+      else if (fShowerCopyType == "IFDH") {
         std::string fetchedfile(fIFDH->fetchInput(selectedflist[i].first));
         MF_LOG_DEBUG("CorsikaGen") << "Fetched; local path: " << fetchedfile << "; copy type: IFDH";
         locallist.push_back(fetchedfile);
@@ -474,7 +496,13 @@ namespace evgen {
     }
 
     //open the files in fShowerInputFilesLocalPaths with sqlite3
+    fShowerFiles.resize(locallist.size());
     for (unsigned int i = 0; i < locallist.size(); i++) {
+      if (CORSIKAShowerFile::isShowerFile(locallist[i])) {
+        fShowerFiles[i] = std::make_unique<CORSIKAShowerFile>(locallist[i]);
+        mf::LogInfo("CORSIKAGen") << "Mapped shower file " << locallist[i] << "\n";
+        continue;
+      }
       //prepare and execute statement to attach db file
       int res = sqlite3_open(locallist[i].c_str(), &fdb[i]);
       if (res != SQLITE_OK)
@@ -509,6 +537,13 @@ namespace evgen {
     double t = 0.;
 
     for (int i = 0; i < fShowerInputs; i++) {
+      if (fShowerFiles[i]) {
+        t = fShowerFiles[i]->MinTime();
+        mf::LogInfo("CORSIKAGen") << "For showers input " << i << " found particles.min(t)=" << t
+                                  << "\n";
+        if (i == 0 || t < fToffset_corsika) fToffset_corsika = t;
+        continue;
+      }
       //build and do query to get run min(t) from each db
       if (sqlite3_prepare(fdb[i], kStatement.c_str(), -1, &statement, 0) == SQLITE_OK) {
         int res = 0;
@@ -584,7 +619,20 @@ namespace evgen {
     for (int i = 0; i < fShowerInputs; i++) {
       //build and do query to get run info from databases
       //  double thisrnd=flat();//need a new random number for each query
-      if (sqlite3_prepare(fdb[i], kStatement.c_str(), -1, &statement, 0) == SQLITE_OK) {
+      if (fShowerFiles[i]) {
+        upperLimitOfEnergyRange = fShowerFiles[i]->ERangeHigh();
+        lowerLimitOfEnergyRange = fShowerFiles[i]->ERangeLow();
+        energySlope = fShowerFiles[i]->ESlope();
+        fMaxShowers.push_back(fShowerFiles[i]->NShow());
+        oneMinusGamma = 1 + energySlope;
+        EiToOneMinusGamma = pow(lowerLimitOfEnergyRange, oneMinusGamma);
+        EfToOneMinusGamma = pow(upperLimitOfEnergyRange, oneMinusGamma);
+        mf::LogVerbatim("CORSIKAGen")
+          << "For showers input " << i << " found e_hi=" << upperLimitOfEnergyRange
+          << ", e_lo=" << lowerLimitOfEnergyRange << ", slope=" << energySlope
+          << ", k=" << fShowerFluxConstants[i] << "\n";
+      }
+      else if (sqlite3_prepare(fdb[i], kStatement.c_str(), -1, &statement, 0) == SQLITE_OK) {
         int res = 0;
         res = sqlite3_step(statement);
         if (res == SQLITE_ROW) {
@@ -670,15 +718,130 @@ namespace evgen {
       0; //keep track of last shower id so that t can be randomized on every new shower
     int nShowerCntr = 0; //keep track of how many showers are left to be added to mctruth
     int nShowerQry = 0;  //number of showers to query from db
-    int shower, pdg;
-    double px, py, pz, x, z, tParticleTime, etot,
-      showerTime = 0., showerTimex = 0., showerTimez = 0., showerXOffset = 0., showerZOffset = 0.,
-      t;
+    int shower;
+    double showerTime = 0., showerTimex = 0., showerTimez = 0., showerXOffset = 0.,
+           showerZOffset = 0.;
+
+    auto startShower = [&]() {
+      //each new shower gets its own random time and position offsets
+      showerTime = 1e9 * (flat() * fSampleTime);  //converting from s to ns
+      showerTimex = 1e9 * (flat() * fSampleTime); //converting from s to ns
+      showerTimez = 1e9 * (flat() * fSampleTime); //converting from s to ns
+      //and a random offset in both z and x controlled by the fRandomXZShift parameter
+      showerXOffset = flat() * fRandomXZShift - (fRandomXZShift / 2);
+      showerZOffset = flat() * fRandomXZShift - (fRandomXZShift / 2);
+    };
+
+    /*
+     * Adds a particle of the current shower to mctruth; arguments are the
+     * values of the particle as stored in the shower sample:
+     * particle ID (PDG), momentum x, y and z components [GeV/c],
+     * position x and z components [cm], time [ns] and energy [GeV]
+     */
+    auto addParticle = [&](int pdg,
+                           double dbPx,
+                           double dbPy,
+                           double dbPz,
+                           double dbX,
+                           double dbZ,
+                           double tParticleTime,
+                           double etot) {
+      //get mass for this particle
+      double m = 0.; // in GeV
+      TParticlePDG* pdgp = pdgt->GetParticle(pdg);
+      if (pdgp) m = pdgp->Mass();
+
+      //Note: position/momentum in db have north=-x and west=+z, rotate so that +z is north and +x is west
+      //get momentum components
+      double const px = dbPz; //uboone x=Particlez
+      double const py = dbPy;
+      double const pz = -dbPx; //uboone z=-Particlex
+
+      //get/calculate position components
+      int boxnoX = 0, boxnoZ = 0;
+      double const x =
+        wrapvarBoxNo(dbZ + showerXOffset, fShowerBounds[0], fShowerBounds[1], boxnoX);
+      double const z =
+        wrapvarBoxNo(-dbX + showerZOffset, fShowerBounds[4], fShowerBounds[5], boxnoZ);
+      //tParticleTime is the time offset, includes propagation time from top of atmosphere
+      //actual particle time is particle surface arrival time
+      //+ shower start time
+      //+ global offset (fcl parameter, in s)
+      //- propagation time through atmosphere
+      //+ boxNo{X,Z} time offset to make grid boxes have different shower times
+      double t = tParticleTime + showerTime + (1e9 * fToffset) - fToffset_corsika +
+                 showerTimex * boxnoX + showerTimez * boxnoZ;
+      //wrap surface arrival so that it's in the desired time window
+      t = wrapvar(t, (1e9 * fToffset), 1e9 * (fToffset + fSampleTime));
+
+      simb::MCParticle p(ntotalCtr, pdg, "primary", -200, m, 1);
+
+      //project back to wordvol/fProjectToHeight
+      /*
+       * This back propagation goes from a point on the upper surface of
+       * the cryostat back to the edge of the world, except that that
+       * world is cut short by `fProjectToHeight` (`y2`) ceiling.
+       * The projection will most often lie on that ceiling, but it may
+       * end up instead on one of the side edges of the world, or even
+       * outside it.
+       */
+      double xyzo[3];
+      double x0[3] = {x, fShowerBounds[3], z};
+      double dx[3] = {px, py, pz};
+      this->ProjectToBoxEdge(x0, dx, x1, x2, y1, y2, z1, z2, xyzo);
+
+      TLorentzVector pos(xyzo[0], xyzo[1], xyzo[2], t); // time needs to be in ns to match GENIE, etc
+      TLorentzVector mom(px, py, pz, etot);
+      p.AddTrajectoryPoint(pos, mom);
+      mctruth.Add(p);
+      ntotalCtr++;
+    };
+
     for (int i = 0; i < fShowerInputs; i++) {
       nShowerCntr = randpois.fire(fNShowersPerEvent[i]);
       mf::LogInfo("CORSIKAGEN") << " Shower input " << i << " with mean " << fNShowersPerEvent[i]
                                 << " generating " << nShowerCntr;
 
+      if (fShowerFiles[i]) {
+        // showers are drawn by index, with no repetition within each group of
+        // up to fMaxShowers[i] showers, the same as a database query does;
+        // a partial Fisher-Yates shuffle keeps track only of the swapped indices
+        CORSIKAShowerFile const& showerFile = *fShowerFiles[i];
+        std::size_t const nShowers = showerFile.NShowers();
+        std::unordered_map<std::size_t, std::size_t> swapped;
+        auto const atPosition = [&swapped](std::size_t pos) {
+          auto const it = swapped.find(pos);
+          return (it == swapped.end()) ? pos : it->second;
+        };
+        while ((nShowerCntr > 0) && (nShowers > 0)) {
+          nShowerQry = std::min(nShowerCntr, fMaxShowers[i]);
+          std::size_t const nPicks = std::min<std::size_t>(nShowerQry, nShowers);
+          swapped.clear();
+          for (std::size_t iPick = 0; iPick < nPicks; ++iPick) {
+            std::size_t const pos =
+              std::min(iPick + std::size_t(flat() * (nShowers - iPick)), nShowers - 1);
+            std::size_t const iShower = atPosition(pos);
+            swapped[pos] = atPosition(iPick);
+
+            auto const [first, last] = showerFile.showerParticles(iShower);
+            if (first == last) continue;
+            startShower();
+            for (std::size_t iPart = first; iPart != last; ++iPart) {
+              addParticle(showerFile.pdg(iPart),
+                          showerFile.value(CORSIKAShowerFile::cPx, iPart),
+                          showerFile.value(CORSIKAShowerFile::cPy, iPart),
+                          showerFile.value(CORSIKAShowerFile::cPz, iPart),
+                          showerFile.value(CORSIKAShowerFile::cX, iPart),
+                          showerFile.value(CORSIKAShowerFile::cZ, iPart),
+                          showerFile.value(CORSIKAShowerFile::cT, iPart),
+                          showerFile.value(CORSIKAShowerFile::cE, iPart));
+            }
+          } // for picks
+          nShowerCntr = nShowerCntr - nShowerQry;
+        } // while
+        continue;
+      } // if shower file
+
       while (nShowerCntr > 0) {
         //how many showers should we query?
         if (nShowerCntr > fMaxShowers[i]) {
@@ -710,72 +873,15 @@ namespace evgen {
                * [8] energy [GeV]
                */
               shower = sqlite3_column_int(statement, 0);
-              if (shower != lastShower) {
-                //each new shower gets its own random time and position offsets
-                showerTime = 1e9 * (flat() * fSampleTime);  //converting from s to ns
-                showerTimex = 1e9 * (flat() * fSampleTime); //converting from s to ns
-                showerTimez = 1e9 * (flat() * fSampleTime); //converting from s to ns
-                //and a random offset in both z and x controlled by the fRandomXZShift parameter
-                showerXOffset = flat() * fRandomXZShift - (fRandomXZShift / 2);
-                showerZOffset = flat() * fRandomXZShift - (fRandomXZShift / 2);
-              }
-              pdg = sqlite3_column_int(statement, 1);
-              //get mass for this particle
-              double m = 0.; // in GeV
-              TParticlePDG* pdgp = pdgt->GetParticle(pdg);
-              if (pdgp) m = pdgp->Mass();
-
-              //Note: position/momentum in db have north=-x and west=+z, rotate so that +z is north and +x is west
-              //get momentum components
-              px = sqlite3_column_double(statement, 4); //uboone x=Particlez
-              py = sqlite3_column_double(statement, 3);
-              pz = -sqlite3_column_double(statement, 2); //uboone z=-Particlex
-              etot = sqlite3_column_double(statement, 8);
-
-              //get/calculate position components
-              int boxnoX = 0, boxnoZ = 0;
-              x = wrapvarBoxNo(sqlite3_column_double(statement, 6) + showerXOffset,
-                               fShowerBounds[0],
-                               fShowerBounds[1],
-                               boxnoX);
-              z = wrapvarBoxNo(-sqlite3_column_double(statement, 5) + showerZOffset,
-                               fShowerBounds[4],
-                               fShowerBounds[5],
-                               boxnoZ);
-              tParticleTime = sqlite3_column_double(
-                statement, 7); //time offset, includes propagation time from top of atmosphere
-              //actual particle time is particle surface arrival time
-              //+ shower start time
-              //+ global offset (fcl parameter, in s)
-              //- propagation time through atmosphere
-              //+ boxNo{X,Z} time offset to make grid boxes have different shower times
-              t = tParticleTime + showerTime + (1e9 * fToffset) - fToffset_corsika +
-                  showerTimex * boxnoX + showerTimez * boxnoZ;
-              //wrap surface arrival so that it's in the desired time window
-              t = wrapvar(t, (1e9 * fToffset), 1e9 * (fToffset + fSampleTime));
-
-              simb::MCParticle p(ntotalCtr, pdg, "primary", -200, m, 1);
-
-              //project back to wordvol/fProjectToHeight
-              /*
-               * This back propagation goes from a point on the upper surface of
-               * the cryostat back to the edge of the world, except that that
-               * world is cut short by `fProjectToHeight` (`y2`) ceiling.
-               * The projection will most often lie on that ceiling, but it may
-               * end up instead on one of the side edges of the world, or even
-               * outside it.
-               */
-              double xyzo[3];
-              double x0[3] = {x, fShowerBounds[3], z};
-              double dx[3] = {px, py, pz};
-              this->ProjectToBoxEdge(x0, dx, x1, x2, y1, y2, z1, z2, xyzo);
-
-              TLorentzVector pos(
-                xyzo[0], xyzo[1], xyzo[2], t); // time needs to be in ns to match GENIE, etc
-              TLorentzVector mom(px, py, pz, etot);
-              p.AddTrajectoryPoint(pos, mom);
-              mctruth.Add(p);
-              ntotalCtr++;
+              if (shower != lastShower) startShower();
+              addParticle(sqlite3_column_int(statement, 1),
+                          sqlite3_column_double(statement, 2),
+                          sqlite3_column_double(statement, 3),
+                          sqlite3_column_double(statement, 4),
+                          sqlite3_column_double(statement, 5),
+                          sqlite3_column_double(statement, 6),
+                          sqlite3_column_double(statement, 7),
+                          sqlite3_column_double(statement, 8));
               lastShower = shower;
             }
             else if (res == SQLITE_DONE) {
@@ -0,0 +1,355 @@
+/**
+ * @file   larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.cxx
+ * @brief  Read-only CORSIKA shower sample backed by a memory-mapped file.
+ * @see    larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h
+ */
+
+#include "larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <sqlite3.h>
+
+// POSIX
+#include <fcntl.h>    // open()
+#include <sys/mman.h> // mmap(), munmap(), madvise()
+#include <sys/stat.h> // fstat()
+#include <unistd.h>   // close()
+
+#include <algorithm> // std::equal(), std::copy()
+#include <cerrno>
+#include <cstring> // std::strerror()
+#include <fstream>
+#include <memory>      // std::unique_ptr
+#include <type_traits> // std::decay_t
+#include <vector>
+
+namespace {
+
+  /// Blocks are aligned to this boundary in the file [bytes]
+  constexpr std::uint64_t BlockAlignment = 4096;
+
+  /// Number of particles buffered for each column before writing them out.
+  constexpr std::size_t WriteChunkSize = 65536;
+
+  std::uint64_t alignBlock(std::uint64_t offset)
+  {
+    return ((offset + BlockAlignment - 1) / BlockAlignment) * BlockAlignment;
+  }
+
+  /// Prepared SQLite statement, finalized on destruction.
+  class Statement {
+  public:
+    Statement(sqlite3* db, std::string const& query) : fDB(db), fQuery(query)
+    {
+      if (sqlite3_prepare_v2(fDB, fQuery.c_str(), -1, &fStatement, nullptr) != SQLITE_OK) {
+        throw cet::exception("CORSIKAShowerFile") << "Error preparing statement: (" << fQuery
+                                                  << "); ERROR:" << sqlite3_errmsg(fDB) << "\n";
+      }
+    }
+
+    ~Statement() { sqlite3_finalize(fStatement); }
+
+    Statement(Statement const&) = delete;
+    Statement& operator=(Statement const&) = delete;
+
+    /// Moves to the next row; returns `false` when there are no more.
+    bool step()
+    {
+      int const res = sqlite3_step(fStatement);
+      if (res == SQLITE_ROW) return true;
+      if (res == SQLITE_DONE) return false;
+      throw cet::exception("CORSIKAShowerFile")
+        << "Unexpected sqlite3_step return value: (" << res << ") for (" << fQuery
+        << "); ERROR:" << sqlite3_errmsg(fDB) << "\n";
+    }
+
+    sqlite3_stmt* get() const { return fStatement; }
+
+  private:
+    sqlite3* fDB;
+    std::string fQuery;
+    sqlite3_stmt* fStatement = nullptr;
+  }; // Statement
+
+  /// Runs a query expected to return a single row.
+  void querySingleRow(Statement& statement, std::string const& dbName)
+  {
+    if (!statement.step()) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Database '" << dbName << "' returned no data for a required query\n";
+    }
+  }
+
+} // local namespace
+
+namespace evgen {
+
+  constexpr char CORSIKAShowerFile::MagicString[8];
+
+  //------------------------------------------------------------
+  CORSIKAShowerFile::CORSIKAShowerFile(std::string const& fileName) : fFileName(fileName)
+  {
+    int const fd = open(fFileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Can't open shower file '" << fFileName << "': " << std::strerror(errno) << "\n";
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0) {
+      int const err = errno;
+      close(fd);
+      throw cet::exception("CORSIKAShowerFile")
+        << "Can't access shower file '" << fFileName << "': " << std::strerror(err) << "\n";
+    }
+    fMapSize = static_cast<std::size_t>(fileInfo.st_size);
+
+    if (fMapSize < sizeof(FileHeader_t)) {
+      close(fd);
+      throw cet::exception("CORSIKAShowerFile")
+        << "Shower file '" << fFileName << "' is too short (" << fMapSize << " bytes)\n";
+    }
+
+    // a shared read-only mapping lets all processes on the node share the pages
+    fMapAddress = mmap(nullptr, fMapSize, PROT_READ, MAP_SHARED, fd, 0);
+    int const mapErr = errno;
+    close(fd); // the mapping survives the file descriptor
+    if (fMapAddress == MAP_FAILED) {
+      fMapAddress = nullptr;
+      throw cet::exception("CORSIKAShowerFile")
+        << "Can't map shower file '" << fFileName << "': " << std::strerror(mapErr) << "\n";
+    }
+
+    // showers are picked at random
+    madvise(fMapAddress, fMapSize, MADV_RANDOM);
+
+    try {
+      fHeader = static_cast<FileHeader_t const*>(fMapAddress);
+      if (!std::equal(MagicString, MagicString + sizeof(MagicString), fHeader->magic)) {
+        throw cet::exception("CORSIKAShowerFile")
+          << "File '" << fFileName << "' is not a CORSIKA shower file\n";
+      }
+      if (fHeader->byteOrder != ByteOrderMark) {
+        throw cet::exception("CORSIKAShowerFile")
+          << "Shower file '" << fFileName << "' was written with a different byte order\n";
+      }
+      if (fHeader->version != FormatVersion) {
+        throw cet::exception("CORSIKAShowerFile")
+          << "Shower file '" << fFileName << "' has format version " << fHeader->version
+          << ", only version " << FormatVersion << " is supported\n";
+      }
+
+      std::uint64_t const nParticles = fHeader->nParticles;
+      if (fHeader->nShowers >= fMapSize) { // each shower takes at least its index entry
+        throw cet::exception("CORSIKAShowerFile")
+          << "Shower file '" << fFileName << "' is corrupted: " << fHeader->nShowers
+          << " showers in a " << fMapSize << " byte file\n";
+      }
+      fIndex = static_cast<std::uint64_t const*>(
+        blockAt(fHeader->indexOffset, fHeader->nShowers + 1, sizeof(std::uint64_t)));
+      fPDG = static_cast<std::int32_t const*>(
+        blockAt(fHeader->pdgOffset, nParticles, sizeof(std::int32_t)));
+      for (unsigned int column = 0; column < NColumns; ++column) {
+        fColumns[column] = static_cast<double const*>(
+          blockAt(fHeader->columnOffset[column], nParticles, sizeof(double)));
+      }
+      if (fIndex[fHeader->nShowers] != nParticles) {
+        throw cet::exception("CORSIKAShowerFile")
+          << "Shower file '" << fFileName << "' is corrupted: the shower index covers "
+          << fIndex[fHeader->nShowers] << " particles, " << nParticles << " are stored\n";
+      }
+      // every shower range must lie within the particle columns
+      for (std::uint64_t iShower = 0; iShower < fHeader->nShowers; ++iShower) {
+        if ((fIndex[iShower] <= fIndex[iShower + 1]) && (fIndex[iShower + 1] <= nParticles))
+          continue;
+        throw cet::exception("CORSIKAShowerFile")
+          << "Shower file '" << fFileName << "' is corrupted: shower " << iShower
+          << " spans particles " << fIndex[iShower] << " to " << fIndex[iShower + 1] << " of "
+          << nParticles << "\n";
+      }
+    }
+    catch (...) {
+      // the destructor is not called when the constructor throws
+      munmap(fMapAddress, fMapSize);
+      fMapAddress = nullptr;
+      throw;
+    }
+
+    mf::LogInfo("CORSIKAShowerFile")
+      << "Mapped shower file '" << fFileName << "': " << NShowers() << " showers, "
+      << NParticles() << " particles";
+  }
+
+  //------------------------------------------------------------
+  CORSIKAShowerFile::~CORSIKAShowerFile()
+  {
+    if (fMapAddress) munmap(fMapAddress, fMapSize);
+  }
+
+  //------------------------------------------------------------
+  bool CORSIKAShowerFile::isShowerFile(std::string const& fileName)
+  {
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[sizeof(MagicString)];
+    if (!in.read(magic, sizeof(magic))) return false;
+    return std::equal(MagicString, MagicString + sizeof(MagicString), magic);
+  }
+
+  //------------------------------------------------------------
+  void const* CORSIKAShowerFile::blockAt(std::uint64_t offset,
+                                         std::uint64_t nElements,
+                                         std::size_t elementSize) const
+  {
+    // written so that no product nor sum can overflow
+    if ((offset < sizeof(FileHeader_t)) || (offset % elementSize != 0) ||
+        (offset > fMapSize) || (nElements > (fMapSize - offset) / elementSize)) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Shower file '" << fFileName << "' is corrupted: block at offset " << offset << " ("
+        << nElements << " elements of " << elementSize << " bytes) does not fit a " << fMapSize
+        << " byte file\n";
+    }
+    return static_cast<char const*>(fMapAddress) + offset;
+  }
+
+  //------------------------------------------------------------
+  void CORSIKAShowerFile::ConvertFromSQLite(std::string const& dbName,
+                                            std::string const& fileName)
+  {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(dbName.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+      std::string const msg = db ? sqlite3_errmsg(db) : "out of memory";
+      sqlite3_close(db);
+      throw cet::exception("CORSIKAShowerFile")
+        << "Error opening db: (" << dbName << "): " << msg << "\n";
+    }
+    // the database is closed however we leave
+    std::unique_ptr<sqlite3, int (*)(sqlite3*)> dbCloser{db, sqlite3_close};
+
+    FileHeader_t header{};
+    std::copy(MagicString, MagicString + sizeof(MagicString), header.magic);
+    header.byteOrder = ByteOrderMark;
+    header.version = FormatVersion;
+
+    {
+      Statement input{db, "select erange_high,erange_low,eslope,nshow from input"};
+      querySingleRow(input, dbName);
+      header.erangeHigh = sqlite3_column_double(input.get(), 0);
+      header.erangeLow = sqlite3_column_double(input.get(), 1);
+      header.eslope = sqlite3_column_double(input.get(), 2);
+      header.nShow = sqlite3_column_int64(input.get(), 3);
+    }
+    {
+      Statement minTime{db, "select min(t) from particles"};
+      querySingleRow(minTime, dbName);
+      header.minTime = sqlite3_column_double(minTime.get(), 0);
+    }
+    {
+      Statement count{db, "select count(*) from showers"};
+      querySingleRow(count, dbName);
+      header.nShowers = sqlite3_column_int64(count.get(), 0);
+    }
+    {
+      Statement count{db,
+                      "select count(*) from particles where shower in (select id from showers)"};
+      querySingleRow(count, dbName);
+      header.nParticles = sqlite3_column_int64(count.get(), 0);
+    }
+
+    mf::LogInfo("CORSIKAShowerFile")
+      << "Converting " << header.nShowers << " showers (" << header.nParticles
+      << " particles) from '" << dbName << "' into '" << fileName << "'";
+
+    std::uint64_t offset = alignBlock(sizeof(FileHeader_t));
+    header.indexOffset = offset;
+    offset = alignBlock(offset + (header.nShowers + 1) * sizeof(std::uint64_t));
+    header.pdgOffset = offset;
+    offset = alignBlock(offset + header.nParticles * sizeof(std::int32_t));
+    for (unsigned int column = 0; column < NColumns; ++column) {
+      header.columnOffset[column] = offset;
+      offset = alignBlock(offset + header.nParticles * sizeof(double));
+    }
+
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Can't open '" << fileName << "' for writing the shower file\n";
+    }
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    // each column is buffered and written in chunks at its place in the file
+    std::vector<std::int32_t> pdgBuffer;
+    std::vector<double> columnBuffers[NColumns];
+    pdgBuffer.reserve(WriteChunkSize);
+    for (auto& buffer : columnBuffers)
+      buffer.reserve(WriteChunkSize);
+    std::uint64_t nWritten = 0;
+
+    auto writeAt = [&out](std::uint64_t pos, auto const& buffer) {
+      out.seekp(pos);
+      out.write(reinterpret_cast<char const*>(buffer.data()),
+                buffer.size() * sizeof(typename std::decay_t<decltype(buffer)>::value_type));
+    };
+    auto flush = [&]() {
+      writeAt(header.pdgOffset + nWritten * sizeof(std::int32_t), pdgBuffer);
+      for (unsigned int column = 0; column < NColumns; ++column)
+        writeAt(header.columnOffset[column] + nWritten * sizeof(double), columnBuffers[column]);
+      nWritten += pdgBuffer.size();
+      pdgBuffer.clear();
+      for (auto& buffer : columnBuffers)
+        buffer.clear();
+    };
+
+    // both queries are sorted by shower, so that they can be merged in a single pass;
+    // particles of showers not in the showers table are skipped, as CORSIKAGen would
+    std::vector<std::uint64_t> index;
+    index.reserve(header.nShowers + 1);
+    Statement showers{db, "select id from showers order by id"};
+    Statement particles{db,
+                        "select shower,pdg,px,py,pz,x,z,t,e from particles where shower in "
+                        "(select id from showers) order by shower"};
+    bool hasParticle = particles.step();
+    std::uint64_t nParticles = 0;
+    while (showers.step()) {
+      sqlite3_int64 const shower = sqlite3_column_int64(showers.get(), 0);
+      index.push_back(nParticles);
+      while (hasParticle && (sqlite3_column_int64(particles.get(), 0) == shower)) {
+        sqlite3_stmt* row = particles.get();
+        pdgBuffer.push_back(sqlite3_column_int(row, 1));
+        columnBuffers[cPx].push_back(sqlite3_column_double(row, 2));
+        columnBuffers[cPy].push_back(sqlite3_column_double(row, 3));
+        columnBuffers[cPz].push_back(sqlite3_column_double(row, 4));
+        columnBuffers[cX].push_back(sqlite3_column_double(row, 5));
+        columnBuffers[cZ].push_back(sqlite3_column_double(row, 6));
+        columnBuffers[cT].push_back(sqlite3_column_double(row, 7));
+        columnBuffers[cE].push_back(sqlite3_column_double(row, 8));
+        if (pdgBuffer.size() == WriteChunkSize) flush();
+        ++nParticles;
+        hasParticle = particles.step();
+      }
+    } // while showers
+    flush();
+    index.push_back(nParticles);
+
+    if ((index.size() != header.nShowers + 1) || (nParticles != header.nParticles)) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Database '" << dbName << "' changed while converting it: expected "
+        << header.nShowers << " showers and " << header.nParticles << " particles, read "
+        << (index.size() - 1) << " and " << nParticles << "\n";
+    }
+    writeAt(header.indexOffset, index);
+
+    // the file spans to the end of the last block
+    out.seekp(offset - 1);
+    out.put('\0');
+
+    if (!out) {
+      throw cet::exception("CORSIKAShowerFile")
+        << "Error while writing the shower file into '" << fileName << "'\n";
+    }
+  } // CORSIKAShowerFile::ConvertFromSQLite()
+
+  //----------------------------------------------------
+
+} // namespace evgen
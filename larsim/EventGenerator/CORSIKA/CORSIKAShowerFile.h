@@ -0,0 +1,161 @@
+/**
+ * @file   larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h
+ * @brief  Read-only CORSIKA shower sample backed by a memory-mapped file.
+ * @see    larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.cxx
+ */
+
+#ifndef LARSIM_EVENTGENERATOR_CORSIKA_CORSIKASHOWERFILE_H
+#define LARSIM_EVENTGENERATOR_CORSIKA_CORSIKASHOWERFILE_H
+
+#include <cstddef> // std::size_t
+#include <cstdint>
+#include <string>
+#include <utility> // std::pair
+
+namespace evgen {
+
+  /**
+   * @brief Pregenerated CORSIKA showers read from a flat columnar file.
+   *
+   * This is an alternative to the SQLite databases `CORSIKAGen` reads.
+   * In the database, a random sample of showers takes a sort of the whole
+   * shower table. In this format a shower is picked by its index, and its
+   * particles are read from a contiguous range.
+   *
+   * The file is made of a fixed-size header (`FileHeader_t`) followed by
+   * blocks, each starting on a page boundary:
+   * * the shower index: `NShowers() + 1` offsets (`std::uint64_t`); the
+   *   particles of shower `i` are the ones from `offsets[i]` to
+   *   `offsets[i + 1]` (excluded);
+   * * the particle ID column (`std::int32_t`);
+   * * one `double` column for each of the `Column_t` quantities.
+   *
+   * The columns hold the values as stored in the `particles` table of the
+   * database, with the same units and the same coordinate frame.
+   * The content of the database `input` table and the earliest particle time
+   * are kept in the header.
+   *
+   * The file is mapped read-only and shared. Opening it reads and checks the
+   * shower index; of the particle columns, only the pages of the sampled
+   * showers are read.
+   *
+   * A file in this format is written from a CORSIKA SQLite database by
+   * `ConvertFromSQLite()`; the `ConvertCORSIKAShowerDB` program is a command
+   * line interface to it.
+   */
+  class CORSIKAShowerFile {
+  public:
+    /// Quantities stored as `double` columns, in the order of the blocks.
+    enum Column_t : unsigned int {
+      cPx, ///< Momentum, _x_ component [GeV/c]
+      cPy, ///< Momentum, _y_ component [GeV/c]
+      cPz, ///< Momentum, _z_ component [GeV/c]
+      cX,  ///< Position, _x_ component [cm]
+      cZ,  ///< Position, _z_ component [cm]
+      cT,  ///< Time [ns]
+      cE,  ///< Energy [GeV]
+      NColumns
+    };
+
+    /// Header of the shower file (all fields in the byte order of the writer).
+    struct FileHeader_t {
+      char magic[8];              ///< File signature (`MagicString`).
+      std::uint32_t byteOrder;    ///< `ByteOrderMark` as written by the writer.
+      std::uint32_t version;      ///< Version of the format.
+      std::uint64_t nShowers;     ///< Number of showers.
+      std::uint64_t nParticles;   ///< Number of particles in all showers.
+      double erangeHigh;          ///< Upper limit of the primary energy range [GeV]
+      double erangeLow;           ///< Lower limit of the primary energy range [GeV]
+      double eslope;              ///< Slope of the primary energy spectrum.
+      std::uint64_t nShow;        ///< Number of showers the sample was generated with.
+      double minTime;             ///< Earliest time of all particles [ns]
+      std::uint64_t indexOffset;  ///< Offset of the shower index block [bytes]
+      std::uint64_t pdgOffset;    ///< Offset of the particle ID block [bytes]
+      std::uint64_t columnOffset[NColumns]; ///< Offset of each `double` column [bytes]
+    }; // FileHeader_t
+
+    static constexpr char MagicString[8] = {'L', 'A', 'R', 'C', 'R', 'S', 'K', 'A'};
+    static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+    static constexpr std::uint32_t FormatVersion = 1;
+
+    /// Maps the shower sample in the specified file; throws on any error.
+    explicit CORSIKAShowerFile(std::string const& fileName);
+
+    ~CORSIKAShowerFile();
+
+    // the mapping is owned and can't be duplicated
+    CORSIKAShowerFile(CORSIKAShowerFile const&) = delete;
+    CORSIKAShowerFile& operator=(CORSIKAShowerFile const&) = delete;
+
+    /// Returns whether the specified file starts with the signature of this format.
+    static bool isShowerFile(std::string const& fileName);
+
+    /// Number of showers in the sample.
+    std::size_t NShowers() const { return fHeader->nShowers; }
+
+    /// Number of particles in all the showers of the sample.
+    std::size_t NParticles() const { return fHeader->nParticles; }
+
+    /// Returns the range of particle indices (end excluded) of shower `iShower`.
+    std::pair<std::size_t, std::size_t> showerParticles(std::size_t iShower) const
+    {
+      return {fIndex[iShower], fIndex[iShower + 1]};
+    }
+
+    /// Returns the particle ID of the particle `iParticle`.
+    int pdg(std::size_t iParticle) const { return fPDG[iParticle]; }
+
+    /// Returns the value of `column` for particle `iParticle`.
+    double value(Column_t column, std::size_t iParticle) const
+    {
+      return fColumns[column][iParticle];
+    }
+
+    /// Upper limit of the primary energy range [GeV]
+    double ERangeHigh() const { return fHeader->erangeHigh; }
+
+    /// Lower limit of the primary energy range [GeV]
+    double ERangeLow() const { return fHeader->erangeLow; }
+
+    /// Slope of the primary energy spectrum.
+    double ESlope() const { return fHeader->eslope; }
+
+    /// Number of showers the sample was generated with.
+    std::size_t NShow() const { return fHeader->nShow; }
+
+    /// Earliest time of all particles [ns]
+    double MinTime() const { return fHeader->minTime; }
+
+    /**
+     * @brief Writes the content of a CORSIKA SQLite database into a shower file.
+     * @param dbName path of the SQLite database to be converted
+     * @param fileName path of the file to be (over)written
+     *
+     * Only the particles of showers in the `showers` table are stored, the
+     * same as `CORSIKAGen` can sample from the database.
+     * The database is read sequentially, and each column is written out in
+     * chunks, so the sample is never held in memory as a whole.
+     */
+    static void ConvertFromSQLite(std::string const& dbName, std::string const& fileName);
+
+  private:
+    std::string fFileName;
+    void* fMapAddress = nullptr; ///< Start of the mapped memory.
+    std::size_t fMapSize = 0U;   ///< Size of the mapped memory [bytes]
+
+    FileHeader_t const* fHeader = nullptr;       ///< Header of the file.
+    std::uint64_t const* fIndex = nullptr;       ///< Shower index block.
+    std::int32_t const* fPDG = nullptr;          ///< Particle ID block.
+    double const* fColumns[NColumns] = {nullptr}; ///< Start of each `double` block.
+
+    /// Returns a pointer to the block at `offset` after checking it is in the file
+    /// (the elements are aligned to their size).
+    void const* blockAt(std::uint64_t offset,
+                        std::uint64_t nElements,
+                        std::size_t elementSize) const;
+
+  }; // class CORSIKAShowerFile
+
+} // namespace evgen
+
+#endif // LARSIM_EVENTGENERATOR_CORSIKA_CORSIKASHOWERFILE_H
@@ -0,0 +1,72 @@
+/**
+ * @file   ConvertCORSIKAShowerDB.cc
+ * @brief  Converts a CORSIKA shower SQLite database into the mapped shower file format.
+ * @see    `evgen::CORSIKAShowerFile`
+ *
+ * Run with `--help` argument for usage instructions.
+ */
+
+// LArSoft libraries
+#include "larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h"
+
+// POSIX/UNIX
+#include <getopt.h> // getopt_long(), option
+
+// C/C++ standard libraries
+#include <cstdlib> // std::exit()
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+  void printHelp(const char* progName, int exitCode)
+  {
+    std::cout << "Converts a CORSIKA shower database from SQLite format to the flat binary format"
+                 " that can be memory-mapped by `evgen::CORSIKAShowerFile`."
+                 "\nThe converted file can be used in `CORSIKAGen` `ShowerInputFiles` in place of"
+                 " the database."
+                 "\n"
+                 "\nUsage:  "
+              << progName
+              << "  [options] [--] inputDB outputFile"
+                 "\n"
+                 "\nOptions:"
+                 "\n--help , -h"
+                 "\n    print these usage instructions and exit"
+              << std::endl;
+    std::exit(exitCode);
+  } // printHelp()
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  static const option longopts[] = {{"help", no_argument, nullptr, 'h'},
+                                    {nullptr, 0, nullptr, 0}};
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", longopts, nullptr)) != -1) {
+    switch (opt) {
+    case 'h': printHelp(argv[0], 0); break;
+    default: printHelp(argv[0], 1);
+    } // switch
+  }   // while
+
+  if (argc - optind != 2) printHelp(argv[0], 1);
+  std::string const sourcePath = argv[optind];
+  std::string const destPath = argv[optind + 1];
+
+  try {
+    evgen::CORSIKAShowerFile::ConvertFromSQLite(sourcePath, destPath);
+  }
+  catch (std::exception const& e) {
+    std::cerr << "Conversion of '" << sourcePath << "' failed:\n" << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Shower database '" << sourcePath << "' converted into '" << destPath << "'"
+            << std::endl;
+  return 0;
+} // main()
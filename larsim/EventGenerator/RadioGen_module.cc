@@ -30,13 +30,20 @@
 ////////////////////////////////////////////////////////////////////////
 
 // C++ includes.
+#include <algorithm> // std::fill(), std::count(), std::min(), std::max()
+#include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdio> // std::rename(), std::remove()
+#include <fstream>
+#include <iomanip> // std::setprecision()
 #include <iterator>
 #include <memory>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <sys/stat.h>
+#include <unistd.h> // getpid()
 #include <utility> // std::pair<>, std::tuple<>
 #include <vector>
 
@@ -185,6 +192,23 @@ namespace evgen {
    *     ticks after the trigger time equivalent to the full simulated TPC
    *     waveform (`detinfo::DetectorPropertiesData::NumberTimeSamples()`);
    *     this makes it a quite poor default, so you may want to avoid it.
+   * * `VoxelSize` (real, default: `0`): if positive, each volume is divided
+   *     at `beginJob()` into cubic-ish cells of about this side (in
+   *     centimeters), and the cells containing the configured material are
+   *     recorded; decays are then generated only in those cells, and the
+   *     material is checked only in the cells which also contain other
+   *     materials; a cell is considered to contain a material if any of its
+   *     probe points does, so the cells must be small enough for the probes
+   *     to sample the thinnest relevant volume; if not positive, decays are
+   *     generated in the whole volume and rejected when not in the material;
+   *     a volume may be divided in at most 10^8 cells;
+   * * `VoxelProbes` (integer, default: `3`): number of probe points per cell
+   *     side used to find the materials in a cell (`VoxelProbes` cubed
+   *     probes per cell);
+   * * `VoxelMapCache` (string, default: empty): if not empty, the cell map of
+   *     each volume is read from (or, if missing or built with different
+   *     settings, written into) a file with this path plus a `_<volume>.txt`
+   *     suffix.
    *
    */
   class RadioGen : public art::EDProducer {
@@ -194,6 +218,7 @@ namespace evgen {
   private:
     // This is called for each event.
     void produce(art::Event& evt);
+    void beginJob();
     void beginRun(art::Run& run);
 
     typedef int
@@ -208,6 +233,34 @@ namespace evgen {
     /// Checks that the node represents a box well aligned to world frame axes.
     void SampleOne(unsigned int i, simb::MCTruth& mct);
 
+    /// Cells of a volume which contain the material of its nuclide.
+    struct VoxelMap_t {
+      std::array<unsigned int, 3> nCells{{0U, 0U, 0U}}; ///< Number of cells on each axis.
+      std::vector<std::size_t> cells; ///< Index `x + nx * (y + ny * z)` of cells with material.
+      std::vector<bool> mixed;        ///< Whether each of `cells` also has other materials.
+
+      /// Returns the total number of cells in the volume.
+      std::size_t nTotalCells() const
+      {
+        return std::size_t(nCells[0]) * std::size_t(nCells[1]) * std::size_t(nCells[2]);
+      }
+    };
+
+    /// Fills the cell map of the volume `i` by probing the geometry.
+    void buildvoxelmap(std::size_t i, VoxelMap_t& map) const;
+
+    /// Reads the cell map of volume `i` from `filename`; returns `false` if not usable.
+    bool readvoxelmap(std::size_t i, std::string const& filename, VoxelMap_t& map) const;
+
+    /// Writes the cell map of volume `i` into `filename` (only warns on failure).
+    void writevoxelmap(std::size_t i, std::string const& filename, VoxelMap_t const& map) const;
+
+    /// Returns a string describing the settings the map of volume `i` is built with.
+    std::string voxelmapkey(std::size_t i) const;
+
+    /// Returns the number of cells on each axis of volume `i`.
+    std::array<unsigned int, 3> voxelgrid(std::size_t i) const;
+
     TLorentzVector dirCalc(double p, double m);
 
     void readfile(std::string nuclide, std::string const& filename);
@@ -218,8 +271,32 @@ namespace evgen {
     void Ar42Gamma4(std::vector<std::tuple<ti_PDGID, td_Mass, TLorentzVector>>& v_prods);
     void Ar42Gamma5(std::vector<std::tuple<ti_PDGID, td_Mass, TLorentzVector>>& v_prods);
 
+    /**
+     * @brief Cumulative distribution of a spectrum, precompiled for sampling.
+     *
+     * The sampling follows `TH1::GetRandom()`: the bin is found by binary
+     * search in the normalized partial sums of the bin contents, and the
+     * value is linearly interpolated within it.
+     */
+    class SpectrumSampler {
+    public:
+      /// Compiles the distribution from the content of `hist`.
+      explicit SpectrumSampler(TH1D const& hist);
+
+      /// Returns whether the spectrum has no content to sample from.
+      bool empty() const { return fLowEdges.empty(); }
+
+      /// Returns the value corresponding to the uniform number `r` in [0;1[.
+      double sample(double r) const;
+
+    private:
+      std::vector<double> fPartialSums; ///< Normalized cumulative content (first is `0`).
+      std::vector<double> fLowEdges;    ///< Lower edge of each bin.
+      std::vector<double> fBinWidths;   ///< Width of each bin.
+    };
+
     // recoded so as to use the LArSoft-managed random number generator
-    double samplefromth1d(TH1D& hist);
+    double samplefromspectrum(SpectrumSampler const& spectrum);
 
     /// Prints the settings for the specified nuclide and volume.
     template <typename Stream>
@@ -253,6 +330,10 @@ namespace evgen {
     std::vector<double> fY1; ///< Top corner y position (cm) in world coordinates
     std::vector<double> fZ1; ///< Top corner z position (cm) in world coordinates
     bool fIsFirstSignalSpecial;
+    double fVoxelSize;          ///< Size of the volume cells [cm] (not positive: no cells).
+    unsigned int fVoxelProbes;  ///< Number of probes per cell side.
+    std::string fVoxelMapCache; ///< Path prefix of the cell map cache files.
+    std::vector<VoxelMap_t> fVoxelMaps; ///< Cell map of each volume (if enabled).
     int trackidcounter; ///< Serial number for the MC track ID
 
     // leftovers from the phase space generator
@@ -260,13 +341,13 @@ namespace evgen {
     // TGenPhaseSpace rg;  // put this here so we don't constantly construct and destruct it
 
     std::vector<std::string> spectrumname;
-    std::vector<std::unique_ptr<TH1D>> alphaspectrum;
+    std::vector<std::unique_ptr<SpectrumSampler>> alphaspectrum;
     std::vector<double> alphaintegral;
-    std::vector<std::unique_ptr<TH1D>> betaspectrum;
+    std::vector<std::unique_ptr<SpectrumSampler>> betaspectrum;
     std::vector<double> betaintegral;
-    std::vector<std::unique_ptr<TH1D>> gammaspectrum;
+    std::vector<std::unique_ptr<SpectrumSampler>> gammaspectrum;
     std::vector<double> gammaintegral;
-    std::vector<std::unique_ptr<TH1D>> neutronspectrum;
+    std::vector<std::unique_ptr<SpectrumSampler>> neutronspectrum;
     std::vector<double> neutronintegral;
     CLHEP::HepRandomEngine& fEngine;
   };
@@ -276,6 +357,8 @@ namespace {
   constexpr double m_e = 0.000510998928;     // mass of electron in GeV
   constexpr double m_alpha = 3.727379240;    // mass of an alpha particle in GeV
   constexpr double m_neutron = 0.9395654133; // mass of a neutron in GeV
+
+  constexpr double MaxVoxelCells = 1e8; // largest number of cells in a volume map
 }
 
 namespace evgen {
@@ -290,6 +373,9 @@ namespace evgen {
     , fY1{pset.get<std::vector<double>>("Y1", {})}
     , fZ1{pset.get<std::vector<double>>("Z1", {})}
     , fIsFirstSignalSpecial{pset.get<bool>("IsFirstSignalSpecial", false)}
+    , fVoxelSize{pset.get<double>("VoxelSize", 0.0)}
+    , fVoxelProbes{pset.get<unsigned int>("VoxelProbes", 3U)}
+    , fVoxelMapCache{pset.get<std::string>("VoxelMapCache", "")}
     // create a default random engine; obtain the random seed from NuRandomService,
     // unless overridden in configuration with key "Seed"
     , fEngine(art::ServiceHandle<rndm::NuRandomService>()->registerAndSeedEngine(createEngine(0),
@@ -435,6 +521,35 @@ namespace evgen {
     }
   }
 
+  //____________________________________________________________________________
+  void RadioGen::beginJob()
+  {
+    if (fVoxelSize <= 0.0) return;
+    if (fVoxelProbes == 0) {
+      throw art::Exception(art::errors::Configuration)
+        << "RadioGen VoxelProbes must be positive when VoxelSize is set.\n";
+    }
+
+    fVoxelMaps.resize(fNuclide.size());
+    for (std::size_t i = 0; i < fNuclide.size(); ++i) {
+      VoxelMap_t& map = fVoxelMaps[i];
+      std::string const cacheName =
+        fVoxelMapCache.empty() ? std::string{} : fVoxelMapCache + "_" + std::to_string(i) + ".txt";
+      if (!cacheName.empty() && readvoxelmap(i, cacheName, map)) {
+        mf::LogInfo("RadioGen") << "Read the cell map of volume [#" << i << "] from '"
+                                << cacheName << "'";
+      }
+      else {
+        buildvoxelmap(i, map);
+        if (!cacheName.empty()) writevoxelmap(i, cacheName, map);
+      }
+      mf::LogInfo("RadioGen") << "Volume [#" << i << "]: " << map.cells.size() << " of "
+                              << map.nTotalCells() << " cells contain '" << fMaterial[i] << "', "
+                              << std::count(map.mixed.begin(), map.mixed.end(), true)
+                              << " of them also other materials";
+    } // for
+  }
+
   //____________________________________________________________________________
   void RadioGen::beginRun(art::Run& run)
   {
@@ -534,6 +649,11 @@ namespace evgen {
     double rate =
       fabs(fBq[i] * (fT1[i] - fT0[i]) * (fX1[i] - fX0[i]) * (fY1[i] - fY0[i]) * (fZ1[i] - fZ0[i])) /
       1.0E9;
+
+    // with a cell map, decays are generated only in the cells with the material
+    VoxelMap_t const* voxels = fVoxelMaps.empty() ? nullptr : &fVoxelMaps[i];
+    if (voxels) rate *= double(voxels->cells.size()) / voxels->nTotalCells();
+
     long ndecays = poisson.shoot(rate);
 
     std::regex const re_material{fMaterial[i]};
@@ -543,16 +663,38 @@ namespace evgen {
       // uniformly distributed in position and time
       //
       // JStock: Leaving this as a single position for the decay products. For now I will assume they all come from the same spot.
-      TLorentzVector pos(
-        fX0[i] + flat.fire() * (fX1[i] - fX0[i]),
-        fY0[i] + flat.fire() * (fY1[i] - fY0[i]),
-        fZ0[i] + flat.fire() * (fZ1[i] - fZ0[i]),
-        (idecay == 0 && fIsFirstSignalSpecial) ? 0 : (fT0[i] + flat.fire() * (fT1[i] - fT0[i])));
+      TLorentzVector pos;
+      bool checkMaterial = true;
+      if (voxels) {
+        // all cells have the same volume: pick one uniformly, then a point in it
+        std::size_t const nCells = voxels->cells.size();
+        std::size_t const iCell = std::min(std::size_t(flat.fire() * nCells), nCells - 1);
+        std::size_t const cell = voxels->cells[iCell];
+        std::size_t const ix = cell % voxels->nCells[0];
+        std::size_t const iy = (cell / voxels->nCells[0]) % voxels->nCells[1];
+        std::size_t const iz = cell / voxels->nCells[0] / voxels->nCells[1];
+        double const x = fX0[i] + (ix + flat.fire()) * (fX1[i] - fX0[i]) / voxels->nCells[0];
+        double const y = fY0[i] + (iy + flat.fire()) * (fY1[i] - fY0[i]) / voxels->nCells[1];
+        double const z = fZ0[i] + (iz + flat.fire()) * (fZ1[i] - fZ0[i]) / voxels->nCells[2];
+        double const t =
+          (idecay == 0 && fIsFirstSignalSpecial) ? 0 : (fT0[i] + flat.fire() * (fT1[i] - fT0[i]));
+        pos.SetXYZT(x, y, z, t);
+        checkMaterial = voxels->mixed[iCell];
+      }
+      else {
+        pos = TLorentzVector(
+          fX0[i] + flat.fire() * (fX1[i] - fX0[i]),
+          fY0[i] + flat.fire() * (fY1[i] - fY0[i]),
+          fZ0[i] + flat.fire() * (fZ1[i] - fZ0[i]),
+          (idecay == 0 && fIsFirstSignalSpecial) ? 0 : (fT0[i] + flat.fire() * (fT1[i] - fT0[i])));
+      }
 
       // discard decays that are not in the proper material
-      std::string volmaterial =
-        geomanager->FindNode(pos.X(), pos.Y(), pos.Z())->GetMedium()->GetMaterial()->GetName();
-      if (!std::regex_match(volmaterial, re_material)) continue;
+      if (checkMaterial) {
+        std::string volmaterial =
+          geomanager->FindNode(pos.X(), pos.Y(), pos.Z())->GetMedium()->GetMaterial()->GetName();
+        if (!std::regex_match(volmaterial, re_material)) continue;
+      }
 
       //Moved pdgid into the next statement, so that it is localized.
       // electron=11, photon=22, alpha = 1000020040, neutron = 2112
@@ -659,6 +801,135 @@ namespace evgen {
     }
   }
 
+  //____________________________________________________________________________
+  std::array<unsigned int, 3> RadioGen::voxelgrid(std::size_t i) const
+  {
+    // the corners may come in any order
+    std::array<double, 3> const n{{std::ceil(std::abs(fX1[i] - fX0[i]) / fVoxelSize),
+                                   std::ceil(std::abs(fY1[i] - fY0[i]) / fVoxelSize),
+                                   std::ceil(std::abs(fZ1[i] - fZ0[i]) / fVoxelSize)}};
+    double const nTotal = std::max(n[0], 1.0) * std::max(n[1], 1.0) * std::max(n[2], 1.0);
+    if (!(nTotal <= MaxVoxelCells)) { // also catches NaN
+      throw art::Exception(art::errors::Configuration)
+        << "RadioGen volume [#" << i << "] would be divided into " << nTotal
+        << " cells of size " << fVoxelSize << " cm (at most " << MaxVoxelCells
+        << " allowed): increase VoxelSize.\n";
+    }
+    auto const nCells = [](double n) { return std::max(1U, static_cast<unsigned int>(n)); };
+    return {{nCells(n[0]), nCells(n[1]), nCells(n[2])}};
+  }
+
+  //____________________________________________________________________________
+  std::string RadioGen::voxelmapkey(std::size_t i) const
+  {
+    auto const nCells = voxelgrid(i);
+    std::ostringstream key;
+    key << std::setprecision(17) << art::ServiceHandle<geo::Geometry const>()->DetectorName()
+        << " " << fMaterial[i] << " " << fX0[i] << " " << fY0[i] << " " << fZ0[i] << " "
+        << fX1[i] << " " << fY1[i] << " " << fZ1[i] << " " << nCells[0] << " " << nCells[1] << " "
+        << nCells[2] << " " << fVoxelProbes;
+    return key.str();
+  }
+
+  //____________________________________________________________________________
+  void RadioGen::buildvoxelmap(std::size_t i, VoxelMap_t& map) const
+  {
+    TGeoManager* geomanager = art::ServiceHandle<geo::Geometry const>()->ROOTGeoManager();
+    std::regex const re_material{fMaterial[i]};
+
+    map.nCells = voxelgrid(i);
+    map.cells.clear();
+    map.mixed.clear();
+
+    double const dx = (fX1[i] - fX0[i]) / map.nCells[0];
+    double const dy = (fY1[i] - fY0[i]) / map.nCells[1];
+    double const dz = (fZ1[i] - fZ0[i]) / map.nCells[2];
+    unsigned int const nProbes = fVoxelProbes * fVoxelProbes * fVoxelProbes;
+
+    std::size_t cell = 0;
+    for (unsigned int iz = 0; iz < map.nCells[2]; ++iz) {
+      for (unsigned int iy = 0; iy < map.nCells[1]; ++iy) {
+        for (unsigned int ix = 0; ix < map.nCells[0]; ++ix, ++cell) {
+          // probes are at the centres of a regular subdivision of the cell
+          unsigned int nMatches = 0;
+          for (unsigned int pz = 0; pz < fVoxelProbes; ++pz) {
+            double const z = fZ0[i] + (iz + (pz + 0.5) / fVoxelProbes) * dz;
+            for (unsigned int py = 0; py < fVoxelProbes; ++py) {
+              double const y = fY0[i] + (iy + (py + 0.5) / fVoxelProbes) * dy;
+              for (unsigned int px = 0; px < fVoxelProbes; ++px) {
+                double const x = fX0[i] + (ix + (px + 0.5) / fVoxelProbes) * dx;
+                std::string const volmaterial =
+                  geomanager->FindNode(x, y, z)->GetMedium()->GetMaterial()->GetName();
+                if (std::regex_match(volmaterial, re_material)) ++nMatches;
+              }
+            }
+          }
+          if (nMatches == 0) continue;
+          map.cells.push_back(cell);
+          map.mixed.push_back(nMatches < nProbes);
+        } // for x
+      }   // for y
+    }     // for z
+  }
+
+  //____________________________________________________________________________
+  bool RadioGen::readvoxelmap(std::size_t i, std::string const& filename, VoxelMap_t& map) const
+  {
+    std::ifstream file{filename};
+    if (!file) return false;
+
+    std::string key;
+    std::getline(file, key);
+    if (key != voxelmapkey(i)) {
+      mf::LogWarning("RadioGen") << "Cell map in '" << filename
+                                 << "' was built with different settings: rebuilding it.";
+      return false;
+    }
+
+    auto const corrupted = [&filename]() {
+      mf::LogWarning("RadioGen") << "Cell map in '" << filename << "' is corrupted: rebuilding it.";
+      return false;
+    };
+
+    std::size_t nCells = 0;
+    file >> nCells;
+    map.nCells = voxelgrid(i);
+    std::size_t const nTotalCells = map.nTotalCells();
+    if (!file || (nCells > nTotalCells)) return corrupted();
+    map.cells.resize(nCells);
+    map.mixed.resize(nCells);
+    for (std::size_t iCell = 0; iCell < nCells; ++iCell) {
+      bool mixed = false;
+      file >> map.cells[iCell] >> mixed;
+      map.mixed[iCell] = mixed;
+      // cells are written in increasing order, each within the grid
+      if (!file || (map.cells[iCell] >= nTotalCells) ||
+          ((iCell > 0) && (map.cells[iCell] <= map.cells[iCell - 1])))
+        return corrupted();
+    }
+    return true;
+  }
+
+  //____________________________________________________________________________
+  void RadioGen::writevoxelmap(std::size_t i,
+                               std::string const& filename,
+                               VoxelMap_t const& map) const
+  {
+    // written into a temporary file which then replaces the cache file,
+    // so that jobs sharing the cache never read a partially written map
+    std::string const tempName = filename + ".tmp" + std::to_string(::getpid());
+    std::ofstream file{tempName, std::ios::trunc};
+    file << voxelmapkey(i) << "\n" << map.cells.size() << "\n";
+    for (std::size_t iCell = 0; iCell < map.cells.size(); ++iCell)
+      file << map.cells[iCell] << " " << map.mixed[iCell] << "\n";
+    file.close();
+    if (!file || (std::rename(tempName.c_str(), filename.c_str()) != 0)) {
+      // the map is still usable, only not cached
+      std::remove(tempName.c_str());
+      mf::LogWarning("RadioGen") << "Failed to write the cell map into '" << filename << "'";
+    }
+  }
+
   //Calculate an arbitrary direction with a given magnitude p
   TLorentzVector RadioGen::dirCalc(double p, double m)
   {
@@ -730,7 +1001,7 @@ namespace evgen {
         alphahist->SetBinError(i + 1, 0);
       }
       alphaintegral.push_back(alphahist->Integral());
-      alphaspectrum.push_back(move(alphahist));
+      alphaspectrum.push_back(std::make_unique<SpectrumSampler>(*alphahist));
     }
     else {
       alphaintegral.push_back(0);
@@ -751,7 +1022,7 @@ namespace evgen {
         betahist->SetBinError(i + 1, 0);
       }
       betaintegral.push_back(betahist->Integral());
-      betaspectrum.push_back(move(betahist));
+      betaspectrum.push_back(std::make_unique<SpectrumSampler>(*betahist));
     }
     else {
       betaintegral.push_back(0);
@@ -771,7 +1042,7 @@ namespace evgen {
         gammahist->SetBinError(i + 1, 0);
       }
       gammaintegral.push_back(gammahist->Integral());
-      gammaspectrum.push_back(move(gammahist));
+      gammaspectrum.push_back(std::make_unique<SpectrumSampler>(*gammahist));
     }
     else {
       gammaintegral.push_back(0);
@@ -791,7 +1062,7 @@ namespace evgen {
         neutronhist->SetBinError(i + 1, 0);
       }
       neutronintegral.push_back(neutronhist->Integral());
-      neutronspectrum.push_back(move(neutronhist));
+      neutronspectrum.push_back(std::make_unique<SpectrumSampler>(*neutronhist));
     }
     else {
       neutronintegral.push_back(0);
@@ -840,23 +1111,23 @@ namespace evgen {
       if (rtype <= alphaintegral[inuc] && alphaspectrum[inuc] != nullptr) {
         itype = 1000020040; // alpha
         m = m_alpha;
-        t = samplefromth1d(*alphaspectrum[inuc]) / 1000000.0;
+        t = samplefromspectrum(*alphaspectrum[inuc]) / 1000000.0;
       }
       else if (rtype <= alphaintegral[inuc] + betaintegral[inuc] && betaspectrum[inuc] != nullptr) {
         itype = 11; // beta
         m = m_e;
-        t = samplefromth1d(*betaspectrum[inuc]) / 1000000.0;
+        t = samplefromspectrum(*betaspectrum[inuc]) / 1000000.0;
       }
       else if (rtype <= alphaintegral[inuc] + betaintegral[inuc] + gammaintegral[inuc] &&
                gammaspectrum[inuc] != nullptr) {
         itype = 22; // gamma
         m = 0;
-        t = samplefromth1d(*gammaspectrum[inuc]) / 1000000.0;
+        t = samplefromspectrum(*gammaspectrum[inuc]) / 1000000.0;
       }
       else if (neutronspectrum[inuc] != nullptr) {
         itype = 2112;
         m = m_neutron;
-        t = samplefromth1d(*neutronspectrum[inuc]) / 1000000.0;
+        t = samplefromspectrum(*neutronspectrum[inuc]) / 1000000.0;
       }
       if (itype >= 0) break;
     }
@@ -875,33 +1146,51 @@ namespace evgen {
   // this is just a copy of TH1::GetRandom that uses the art-managed CLHEP random number generator instead of gRandom
   // and a better handling of negative bin contents
 
-  double RadioGen::samplefromth1d(TH1D& hist)
+  double RadioGen::samplefromspectrum(SpectrumSampler const& spectrum)
   {
+    if (spectrum.empty()) return 0;
     CLHEP::RandFlat flat(fEngine);
+    return spectrum.sample(flat.fire());
+  }
 
-    int nbinsx = hist.GetNbinsX();
-    std::vector<double> partialsum;
-    partialsum.resize(nbinsx + 1);
-    partialsum[0] = 0;
+  //____________________________________________________________________________
+  RadioGen::SpectrumSampler::SpectrumSampler(TH1D const& hist)
+  {
+    int const nbinsx = hist.GetNbinsX();
+    fPartialSums.resize(nbinsx + 1);
+    fPartialSums[0] = 0;
 
     for (int i = 1; i <= nbinsx; i++) {
       double hc = hist.GetBinContent(i);
       if (hc < 0)
         throw cet::exception("RadioGen") << "Negative bin:  " << i << " " << hist.GetName() << "\n";
-      partialsum[i] = partialsum[i - 1] + hc;
+      fPartialSums[i] = fPartialSums[i - 1] + hc;
+    }
+    double integral = fPartialSums[nbinsx];
+    if (integral == 0) {
+      fPartialSums.clear();
+      return;
     }
-    double integral = partialsum[nbinsx];
-    if (integral == 0) return 0;
     // normalize to unit sum
     for (int i = 1; i <= nbinsx; i++)
-      partialsum[i] /= integral;
-
-    double r1 = flat.fire();
-    int ibin = TMath::BinarySearch(nbinsx, &(partialsum[0]), r1);
-    Double_t x = hist.GetBinLowEdge(ibin + 1);
-    if (r1 > partialsum[ibin]) {
-      x += hist.GetBinWidth(ibin + 1) * (r1 - partialsum[ibin]) /
-           (partialsum[ibin + 1] - partialsum[ibin]);
+      fPartialSums[i] /= integral;
+
+    fLowEdges.resize(nbinsx);
+    fBinWidths.resize(nbinsx);
+    for (int i = 0; i < nbinsx; i++) {
+      fLowEdges[i] = hist.GetBinLowEdge(i + 1);
+      fBinWidths[i] = hist.GetBinWidth(i + 1);
+    }
+  }
+
+  double RadioGen::SpectrumSampler::sample(double r) const
+  {
+    int const nbinsx = fLowEdges.size();
+    int ibin = TMath::BinarySearch(nbinsx, fPartialSums.data(), r);
+    double x = fLowEdges[ibin];
+    if (r > fPartialSums[ibin]) {
+      x += fBinWidths[ibin] * (r - fPartialSums[ibin]) /
+           (fPartialSums[ibin + 1] - fPartialSums[ibin]);
     }
     return x;
   }
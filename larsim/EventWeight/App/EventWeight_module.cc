@@ -13,7 +13,9 @@
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
 #include "canvas/Persistency/Common/PtrVector.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
@@ -22,6 +24,8 @@
 #include <memory>
 
 #include "larsim/EventWeight/Base/MCEventWeight.h"
+#include "larsim/EventWeight/Base/MCEventWeightArray.h"
+#include "larsim/EventWeight/Base/MCEventWeightSchema.h"
 #include "larsim/EventWeight/Base/WeightManager.h"
 #include "larsim/EventWeight/Base/Weight_t.h"
 
@@ -48,15 +52,33 @@ namespace evwgh {
     void produce(art::Event& e) override;
 
     //Optional functions.
+    void beginRun(art::Run& r) override;
     void endJob() override;
 
     WeightManager _wgt_manager;
     std::string fGenieModuleLabel;
+
+    bool fWriteWeightMaps = true;    ///< Whether to produce `MCEventWeight` maps.
+    bool fWriteWeightArrays = false; ///< Whether to produce `MCEventWeightArray` and schema.
+    MCEventWeightSchema fSchema;     ///< Layout of the weight arrays.
   };
 
   EventWeight::EventWeight(fhicl::ParameterSet const& p)
     : EDProducer{p}, fGenieModuleLabel{p.get<std::string>("genie_module_label", "generator")}
   {
+    // Format of the weight data products:
+    // "map" (one MCEventWeight per neutrino), "array" (one MCEventWeightArray
+    // per neutrino plus a MCEventWeightSchema in the run), or "both"
+    auto const output_format = p.get<std::string>("output_format", "map");
+    if (output_format == "array")
+      fWriteWeightMaps = false;
+    else if (output_format != "map" && output_format != "both") {
+      throw cet::exception("EventWeight")
+        << "Unsupported output_format '" << output_format
+        << "' (supported: \"map\", \"array\", \"both\")\n";
+    }
+    fWriteWeightArrays = (output_format != "map");
+
     // Configure the appropriate GENIE tune if needed (important for v3+ only)
     // NOTE: In all normal use cases, relying on the ${GENIE_XSEC_TUNE}
     // environment variable set by the genie_xsec package should be sufficient.
@@ -77,13 +99,32 @@ namespace evwgh {
       p, [this](std::string const& type, std::string const& instance) -> CLHEP::HepRandomEngine& {
         return createEngine(0, type, instance);
       });
-    if (n_func > 0) produces<std::vector<MCEventWeight>>();
+    if (n_func == 0) {
+      fWriteWeightMaps = false;
+      fWriteWeightArrays = false;
+    }
+    if (fWriteWeightMaps) produces<std::vector<MCEventWeight>>();
+    if (fWriteWeightArrays) {
+      // number of mantissa bits kept in the stored weights (23 is full single precision)
+      fSchema = _wgt_manager.Schema(p.get<int>("weight_mantissa_bits", 23));
+      produces<std::vector<MCEventWeightArray>>();
+      produces<MCEventWeightSchema, art::InRun>();
+    }
+  }
+
+  void EventWeight::beginRun(art::Run& r)
+  {
+    if (fWriteWeightArrays)
+      r.put(std::make_unique<MCEventWeightSchema>(fSchema), art::fullRun());
   }
 
   void EventWeight::produce(art::Event& e)
   {
+    if (!fWriteWeightMaps && !fWriteWeightArrays) return;
+
     // Implementation of required member function here.
     auto mcwghvec = std::make_unique<std::vector<MCEventWeight>>();
+    auto mcwgharrays = std::make_unique<std::vector<MCEventWeightArray>>();
 
     // Get the MC generator information out of the event
     // these are all handles to mc information.
@@ -93,13 +134,15 @@ namespace evwgh {
     auto const mcTruthHandle = e.getValidHandle<std::vector<simb::MCTruth>>(fGenieModuleLabel);
     art::fill_ptr_vector(mclist, mcTruthHandle);
 
-    // Loop over all neutrinos in this event
-    for (unsigned int inu = 0; inu < mclist.size(); ++inu) {
-      auto const mcwgh = _wgt_manager.Run(e, inu);
-      mcwghvec->push_back(mcwgh);
-    }
+    // Compute the weights of all neutrinos in this event
+    _wgt_manager.RunAll(e,
+                        mclist.size(),
+                        fWriteWeightMaps ? mcwghvec.get() : nullptr,
+                        fWriteWeightArrays ? mcwgharrays.get() : nullptr,
+                        &fSchema);
 
-    e.put(std::move(mcwghvec));
+    if (fWriteWeightMaps) e.put(std::move(mcwghvec));
+    if (fWriteWeightArrays) e.put(std::move(mcwgharrays));
   }
 
   void EventWeight::endJob()
@@ -1,6 +1,7 @@
 #ifndef _MCEVENTWEIGHT_H_
 #define _MCEVENTWEIGHT_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
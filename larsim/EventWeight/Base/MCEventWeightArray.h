@@ -0,0 +1,15 @@
+#ifndef _MCEVENTWEIGHTARRAY_H_
+#define _MCEVENTWEIGHTARRAY_H_
+
+#include <vector>
+
+namespace evwgh {
+
+  /// Weights of one neutrino in all the universes of all the functions,
+  /// in the layout described by the `MCEventWeightSchema` of the run.
+  struct MCEventWeightArray {
+    std::vector<float> fWeights;
+  };
+
+}
+#endif //_MCEVENTWEIGHTARRAY_H_
@@ -0,0 +1,48 @@
+#ifndef _MCEVENTWEIGHTSCHEMA_H_
+#define _MCEVENTWEIGHTSCHEMA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace evwgh {
+
+  /**
+   * @brief Layout of the weights in `MCEventWeightArray`, shared by a run.
+   *
+   * The weights of all the functions for a neutrino are stored in a single
+   * array: the ones of the function with index `i` (named `fFunctionNames[i]`,
+   * the same key as in `MCEventWeight`) are the universes from `fOffsets[i]`
+   * to `fOffsets[i + 1]` (excluded).
+   *
+   * Weights are stored in single precision, keeping only the `fMantissaBits`
+   * most significant bits of the mantissa (23 is full single precision).
+   */
+  struct MCEventWeightSchema {
+    std::vector<std::string> fFunctionNames; ///< Name of each weight function.
+    std::vector<std::size_t> fOffsets;       ///< First weight of each function, then their total.
+    int fMantissaBits = 23;                  ///< Mantissa bits kept in the stored weights.
+
+    /// Number of weight functions.
+    std::size_t NFunctions() const { return fFunctionNames.size(); }
+
+    /// Number of weights stored for each neutrino.
+    std::size_t NWeights() const { return fOffsets.empty() ? 0 : fOffsets.back(); }
+
+    /// Number of universes of the function with index `iFunc`.
+    std::size_t NUniverses(std::size_t iFunc) const
+    {
+      return fOffsets[iFunc + 1] - fOffsets[iFunc];
+    }
+
+    /// Returns the index of the function with the specified name, `NFunctions()` if not present.
+    std::size_t FunctionIndex(std::string const& name) const
+    {
+      return std::find(fFunctionNames.begin(), fFunctionNames.end(), name) -
+             fFunctionNames.begin();
+    }
+  };
+
+}
+#endif //_MCEVENTWEIGHTSCHEMA_H_
@@ -11,8 +11,10 @@ namespace CLHEP {
 }
 
 #include "TMatrixD.h"
+#include <cstddef>
 #include <map>
 #include <string>
+#include <vector>
 
 //weight calc base
 namespace evwgh {
@@ -22,6 +24,10 @@ namespace evwgh {
   public:
     virtual void Configure(fhicl::ParameterSet const& pset, CLHEP::HepRandomEngine&) = 0;
     virtual std::vector<std::vector<double>> GetWeight(art::Event& e) = 0;
+
+    /// Returns the number of weights computed for each neutrino, `0` if not known in advance.
+    virtual std::size_t NUniverses() const { return 0; }
+
     void SetName(std::string name) { fName = name; }
     std::string GetName() { return fName; }
 
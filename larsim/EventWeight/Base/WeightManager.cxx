@@ -1,5 +1,28 @@
 #include "WeightManager.h"
 
+#include <algorithm> // std::max(), std::min()
+#include <cstdint>
+#include <cstring> // std::memcpy()
+
+namespace {
+
+  /// Rounds `value` to the nearest float with only `bits` mantissa bits (ties to even).
+  float roundMantissa(float value, int bits)
+  {
+    if (bits >= 23) return value;
+    std::uint32_t u;
+    std::memcpy(&u, &value, sizeof(u));
+    if ((u & 0x7f800000u) == 0x7f800000u) return value; // infinity or NaN
+    unsigned int const drop = 23 - std::max(bits, 0);
+    std::uint32_t const lsb = (u >> drop) & 1u;
+    u += (std::uint32_t{1} << (drop - 1)) - 1u + lsb;
+    u &= ~((std::uint32_t{1} << drop) - 1u);
+    std::memcpy(&value, &u, sizeof(u));
+    return value;
+  }
+
+} // local namespace
+
 namespace evwgh {
 
   WeightManager::WeightManager(const std::string name) : _name(name) { _configured = false; }
@@ -32,12 +55,93 @@ namespace evwgh {
         std::pair<std::string, std::vector<double>> p(it->first + "_" + it->second->fWeightCalcType,
                                                       weights[inu]);
         mcwgh.fWeight.insert(p);
+        it->second->AddStatistics(weights[inu]);
       }
     }
 
     return mcwgh;
   }
 
+  MCEventWeightSchema WeightManager::Schema(int mantissaBits) const
+  {
+    if (!_configured)
+      throw cet::exception(__PRETTY_FUNCTION__) << "Have not configured yet!" << std::endl;
+
+    MCEventWeightSchema schema;
+    schema.fMantissaBits = std::min(mantissaBits, 23);
+    schema.fOffsets.push_back(0);
+    for (auto const& [name, winfo] : fWeightCalcMap) {
+      std::size_t const nUniverses = winfo->fWeightCalc->NUniverses();
+      if (nUniverses == 0) {
+        throw cet::exception(__PRETTY_FUNCTION__)
+          << "Function " << name << " (" << winfo->fWeightCalcType
+          << ") does not declare its number of universes, and can't be stored in arrays."
+          << std::endl;
+      }
+      schema.fFunctionNames.push_back(name + "_" + winfo->fWeightCalcType);
+      schema.fOffsets.push_back(schema.fOffsets.back() + nUniverses);
+    }
+    return schema;
+  }
+
+  void WeightManager::RunAll(art::Event& e,
+                             std::size_t nNeutrinos,
+                             std::vector<MCEventWeight>* weightMaps,
+                             std::vector<MCEventWeightArray>* weightArrays,
+                             MCEventWeightSchema const* schema)
+  {
+
+    if (!_configured)
+      throw cet::exception(__PRETTY_FUNCTION__) << "Have not configured yet!" << std::endl;
+    if (weightArrays && !schema)
+      throw cet::exception(__PRETTY_FUNCTION__) << "Weight arrays require a schema!" << std::endl;
+
+    if (weightMaps) weightMaps->assign(nNeutrinos, MCEventWeight{});
+    if (weightArrays) {
+      weightArrays->assign(nNeutrinos, MCEventWeightArray{});
+      for (auto& array : *weightArrays)
+        array.fWeights.assign(schema->NWeights(), 1.0f);
+    }
+
+    //
+    // Calculate the weights of all the neutrinos with one call per function
+    //
+    std::size_t iFunc = 0;
+    for (auto it = fWeightCalcMap.begin(); it != fWeightCalcMap.end(); ++it, ++iFunc) {
+
+      auto const& weights = it->second->GetWeight(e);
+      for (auto const& nuWeights : weights)
+        it->second->AddStatistics(nuWeights);
+
+      if (weightMaps) {
+        std::string const key = it->first + "_" + it->second->fWeightCalcType;
+        for (std::size_t inu = 0; inu < nNeutrinos; ++inu) {
+          if (weights.size() == 0)
+            (*weightMaps)[inu].fWeight.emplace("empty", std::vector<double>{});
+          else
+            (*weightMaps)[inu].fWeight.emplace(key, weights.at(inu));
+        }
+      }
+
+      if (weightArrays && !weights.empty()) {
+        std::size_t const offset = schema->fOffsets.at(iFunc);
+        std::size_t const nUniverses = schema->NUniverses(iFunc);
+        for (std::size_t inu = 0; inu < nNeutrinos; ++inu) {
+          auto const& nuWeights = weights.at(inu);
+          if (nuWeights.size() != nUniverses) {
+            throw cet::exception(__PRETTY_FUNCTION__)
+              << "Function " << it->first << " computed " << nuWeights.size()
+              << " weights for neutrino #" << inu << ", but declared " << nUniverses << "!"
+              << std::endl;
+          }
+          float* dest = (*weightArrays)[inu].fWeights.data() + offset;
+          for (double w : nuWeights)
+            *(dest++) = roundMantissa(static_cast<float>(w), schema->fMantissaBits);
+        }
+      }
+    }
+  }
+
   void WeightManager::PrintConfig() { return; }
 
 }
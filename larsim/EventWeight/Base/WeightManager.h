@@ -17,6 +17,8 @@
 #include "nurandom/RandomUtils/NuRandomService.h"
 
 #include "MCEventWeight.h"
+#include "MCEventWeightArray.h"
+#include "MCEventWeightSchema.h"
 #include "WeightCalc.h"
 #include "WeightCalcFactory.h"
 #include "Weight_t.h"
@@ -57,6 +59,30 @@ namespace evwgh {
      */
     MCEventWeight Run(art::Event& e, const int inu);
 
+    /**
+      * @brief Returns the layout of the weight arrays (previous call to Configure is needed)
+      * @param mantissaBits number of mantissa bits to keep in the stored weights (at most 23)
+       Functions are in the same order as in the MCEventWeight maps. \n
+       All calculators must declare their number of universes (WeightCalc::NUniverses()).
+     */
+    MCEventWeightSchema Schema(int mantissaBits = 23) const;
+
+    /**
+      * @brief Computes the weights of all the neutrinos in the event
+      * @param e the art event
+      * @param nNeutrinos the number of simulated neutrinos in the event
+      * @param weightMaps (output, if not null) one MCEventWeight per neutrino, as from Run()
+      * @param weightArrays (output, if not null) one MCEventWeightArray per neutrino
+      * @param schema the layout of weightArrays, from Schema()
+       Unlike calling Run() for each neutrino, each calculator is executed only once per event. \n
+       In weightArrays, a function which has no weights for a neutrino has all its weights set to 1.
+     */
+    void RunAll(art::Event& e,
+                std::size_t nNeutrinos,
+                std::vector<MCEventWeight>* weightMaps,
+                std::vector<MCEventWeightArray>* weightArrays = nullptr,
+                MCEventWeightSchema const* schema = nullptr);
+
     /**
       * @brief Returns the map between calculator name and Weight_t product
       */
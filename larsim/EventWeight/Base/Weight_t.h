@@ -3,7 +3,8 @@
 
 #include "WeightCalc.h"
 
-#include <numeric> // std::accumulate()
+#include <algorithm> // std::min_element(), std::max_element()
+#include <numeric>   // std::accumulate()
 
 namespace evwgh {
   struct Weight_t {
@@ -15,19 +16,19 @@ namespace evwgh {
       , fNcalls(0)
     {}
 
-    std::vector<std::vector<double>> GetWeight(art::Event& e)
+    std::vector<std::vector<double>> GetWeight(art::Event& e) { return fWeightCalc->GetWeight(e); }
+
+    /// Adds the weights of one neutrino to the statistics of this function.
+    void AddStatistics(std::vector<double> const& wgh)
     {
-      std::vector<std::vector<double>> wgh = fWeightCalc->GetWeight(e);
-      for (unsigned int inu = 0; inu < wgh.size(); inu++) {
-        double avgwgh = std::accumulate(wgh[inu].begin(), wgh[inu].end(), 0.0) / wgh[inu].size();
-        fAvgWeight = (fAvgWeight * fNcalls + avgwgh) / float(fNcalls + 1);
-        fMinWeight = std::min(fMinWeight, *std::min_element(wgh[inu].begin(), wgh[inu].end()));
-        fMaxWeight = std::max(fMaxWeight, *std::max_element(wgh[inu].begin(), wgh[inu].end()));
-        fNcalls++;
-      }
-
-      return wgh;
+      if (wgh.empty()) return;
+      double avgwgh = std::accumulate(wgh.begin(), wgh.end(), 0.0) / wgh.size();
+      fAvgWeight = (fAvgWeight * fNcalls + avgwgh) / float(fNcalls + 1);
+      fMinWeight = std::min(fMinWeight, *std::min_element(wgh.begin(), wgh.end()));
+      fMaxWeight = std::max(fMaxWeight, *std::max_element(wgh.begin(), wgh.end()));
+      fNcalls++;
     }
+
     std::string fName;
     WeightCalc* fWeightCalc;
     std::string fWeightCalcType;
@@ -3,3 +3,5 @@
 #include <string>
 
 #include "larsim/EventWeight/Base/MCEventWeight.h"
+#include "larsim/EventWeight/Base/MCEventWeightArray.h"
+#include "larsim/EventWeight/Base/MCEventWeightSchema.h"
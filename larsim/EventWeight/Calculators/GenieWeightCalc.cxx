@@ -213,6 +213,7 @@ namespace evwgh {
     GenieWeightCalc();
     void Configure(const fhicl::ParameterSet& pset, CLHEP::HepRandomEngine& engine) override;
     std::vector<std::vector<double>> GetWeight(art::Event& e) override;
+    std::size_t NUniverses() const override { return reweightVector.size(); }
 
   private:
     std::map<std::string, int> CheckForIncompatibleSystematics(
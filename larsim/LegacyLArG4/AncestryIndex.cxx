@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  AncestryIndex.cxx
+/// \brief Track ID -> parent ID index with cached ultimate ancestors.
+////////////////////////////////////////////////////////////////////////
+
+#include "larsim/LegacyLArG4/AncestryIndex.h"
+#include "lardataobj/Simulation/sim.h" // sim::NoParticleId
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+
+namespace larg4 {
+
+  //----------------------------------------------------------------------------
+  void AncestryIndex::setParent(int trackID, int parentID)
+  {
+    Node_t& entry = node(trackID);
+    if (entry.parent == parentID) return;
+
+    // a track added (or changed) after one of its descendants makes the
+    // ancestors cached so far unreliable; this is not expected to happen
+    bool const invalidates = (entry.parent != NoEntry) || entry.isParent;
+    entry.parent = parentID;
+    entry.ancestor = parentID;
+    if (parentID >= 0) node(parentID).isParent = true;
+    if (invalidates) resetAncestors();
+  }
+
+  //----------------------------------------------------------------------------
+  int AncestryIndex::ultimateAncestor(int trackID)
+  {
+    if (!hasEntry(trackID)) return sim::NoParticleId;
+
+    // walk up the cached ancestors until one is not in the index
+    fPath.clear();
+    int ancestor = trackID;
+    while (hasEntry(ancestor)) {
+      fPath.push_back(ancestor);
+      ancestor = fNodes[ancestor].ancestor;
+    }
+
+    // all the tracks on the way share the same ultimate ancestor
+    for (int const id : fPath)
+      fNodes[id].ancestor = ancestor;
+
+    return ancestor;
+  }
+
+  //----------------------------------------------------------------------------
+  void AncestryIndex::clear()
+  {
+    for (int const id : fUsed)
+      fNodes[id] = Node_t{};
+    fUsed.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  auto AncestryIndex::node(int trackID) -> Node_t&
+  {
+    if (trackID < 0) {
+      throw cet::exception("ParticleListAction")
+        << "Track ID " << trackID << " can't be stored in the parentage index.\n";
+    }
+    if (static_cast<std::size_t>(trackID) >= fNodes.size()) {
+      fNodes.resize(std::max(static_cast<std::size_t>(trackID) + 1, 2 * fNodes.size()));
+    }
+    Node_t& entry = fNodes[trackID];
+    if ((entry.parent == NoEntry) && !entry.isParent) fUsed.push_back(trackID);
+    return entry;
+  }
+
+  //----------------------------------------------------------------------------
+  void AncestryIndex::resetAncestors()
+  {
+    for (int const id : fUsed)
+      fNodes[id].ancestor = fNodes[id].parent;
+  }
+
+} // namespace larg4
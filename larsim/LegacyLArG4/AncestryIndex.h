@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  AncestryIndex.h
+/// \brief Track ID -> parent ID index with cached ultimate ancestors.
+///
+/// Used by `larg4::ParticleListAction` to resolve the parentage of tracks
+/// which are not stored in the particle list.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef LArG4_AncestryIndex_h
+#define LArG4_AncestryIndex_h
+
+#include <cstddef> // std::size_t
+#include <limits>
+#include <vector>
+
+namespace larg4 {
+
+  /**
+   * @brief Track ID -> parent ID index, with cached ultimate ancestors.
+   *
+   * The ultimate ancestor of a track is its first ancestor which is not in
+   * the index. Entries are stored in a vector indexed by track ID, and each
+   * keeps a pointer to an ancestor which is moved up the chain (path
+   * compression) as ancestors are resolved.
+   * Tracks are added after their parents, so a resolved ancestor stays
+   * valid; in the rare case a track is added after some of its descendants,
+   * the cached ancestors are reset to the parents.
+   */
+  class AncestryIndex {
+  public:
+    /// Sets `parentID` as the parent of `trackID`.
+    void setParent(int trackID, int parentID);
+
+    /// Returns the ultimate ancestor of `trackID`, `sim::NoParticleId` if
+    /// the track is not in the index.
+    int ultimateAncestor(int trackID);
+
+    /// Removes all entries (memory is kept for the next event).
+    void clear();
+
+  private:
+    static constexpr int NoEntry = std::numeric_limits<int>::min();
+
+    struct Node_t {
+      int parent = NoEntry;   ///< parent track ID, `NoEntry` if not in the index
+      int ancestor = NoEntry; ///< an ancestor along the chain (cached)
+      bool isParent = false;  ///< whether some entry has this track as parent
+    };
+
+    std::vector<Node_t> fNodes; ///< Indexed by track ID.
+    std::vector<int> fUsed;     ///< IDs of the nodes set in this event.
+    std::vector<int> fPath;     ///< Scratch buffer for the path compression.
+
+    bool hasEntry(int trackID) const
+    {
+      return (trackID >= 0) && (static_cast<std::size_t>(trackID) < fNodes.size()) &&
+             (fNodes[trackID].parent != NoEntry);
+    }
+
+    Node_t& node(int trackID);
+
+    /// Resets the cached ancestors to the parents.
+    void resetAncestors();
+  }; // AncestryIndex
+
+} // namespace larg4
+
+#endif // LArG4_AncestryIndex_h
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  ChargeDepositQueue.cxx
+/// \brief Queue of drifted charge waiting to be stored into SimChannels.
+////////////////////////////////////////////////////////////////////////
+
+#include "larsim/LegacyLArG4/ChargeDepositQueue.h"
+
+#include <algorithm> // std::sort()
+#include <tuple>     // std::tie()
+
+namespace {
+
+  bool byChannelTDCIndex(larg4::ChargeDepositQueue::ChargeDeposit_t const& a,
+                         larg4::ChargeDepositQueue::ChargeDeposit_t const& b)
+  {
+    return std::tie(a.channel, a.tdc, a.index) < std::tie(b.channel, b.tdc, b.index);
+  }
+
+} // local namespace
+
+namespace larg4 {
+
+  //--------------------------------------------------------------------------------------
+  void ChargeDepositQueue::addStep(int trackID,
+                                   int origTrackID,
+                                   double const* xyz,
+                                   std::vector<ChargeDeposit_t>& clusters)
+  {
+    if (clusters.empty()) return;
+
+    // merge the clusters landing on the same channel and TDC, adding them up
+    // in the original order
+    std::sort(clusters.begin(), clusters.end(), byChannelTDCIndex);
+
+    auto const stepIndex = static_cast<std::uint32_t>(fSteps.size());
+    fSteps.push_back({trackID, origTrackID, {xyz[0], xyz[1], xyz[2]}});
+
+    auto iCluster = clusters.cbegin();
+    auto const cend = clusters.cend();
+    while (iCluster != cend) {
+      ChargeDeposit_t merged{iCluster->channel, iCluster->tdc, stepIndex, 0., 0.};
+      for (; (iCluster != cend) && (iCluster->channel == merged.channel) &&
+             (iCluster->tdc == merged.tdc);
+           ++iCluster) {
+        merged.energy += iCluster->energy;
+        merged.electrons += iCluster->electrons;
+      }
+      fDeposits.push_back(merged);
+    } // while
+  }   // ChargeDepositQueue::addStep()
+
+  //--------------------------------------------------------------------------------------
+  void ChargeDepositQueue::moveInto(ChannelMap_t& channels)
+  {
+    if (fDeposits.empty()) {
+      fSteps.clear();
+      return;
+    }
+
+    // Within a step each (channel, TDC) pair appears only once, so sorting by
+    // step index too is equivalent to a stable sort: for each (channel, TDC)
+    // the charge is added in the same order as it would be step by step,
+    // and the resulting SimChannel content is the same.
+    std::sort(fDeposits.begin(), fDeposits.end(), byChannelTDCIndex);
+
+    auto iChannelData = channels.end();
+    for (ChargeDeposit_t const& deposit : fDeposits) {
+      // channels come in increasing order, so the previous one is a good hint
+      if ((iChannelData == channels.end()) || (iChannelData->first != deposit.channel)) {
+        iChannelData = channels.lower_bound(deposit.channel);
+        if ((iChannelData == channels.end()) || (iChannelData->first != deposit.channel)) {
+          iChannelData =
+            channels.emplace_hint(iChannelData, deposit.channel, sim::SimChannel(deposit.channel));
+        }
+      }
+
+      StepDeposit_t const& step = fSteps[deposit.index];
+      iChannelData->second.AddIonizationElectrons(step.trackID,
+                                                  deposit.tdc,
+                                                  deposit.electrons,
+                                                  step.xyz,
+                                                  deposit.energy,
+                                                  step.origTrackID);
+    } // for deposits
+
+    clear();
+  } // ChargeDepositQueue::moveInto()
+
+  //--------------------------------------------------------------------------------------
+  void ChargeDepositQueue::clear()
+  {
+    fSteps.clear();
+    fDeposits.clear();
+  }
+
+} // namespace larg4
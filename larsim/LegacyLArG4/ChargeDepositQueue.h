@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  ChargeDepositQueue.h
+/// \brief Queue of drifted charge waiting to be stored into SimChannels.
+///
+/// Used by `larg4::LArVoxelReadout` to store the charge of many steps at
+/// once into the `sim::SimChannel` of a TPC.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef LArG4_ChargeDepositQueue_h
+#define LArG4_ChargeDepositQueue_h
+
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+#include "lardataobj/Simulation/SimChannel.h"
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
+#include <map>
+#include <vector>
+
+namespace larg4 {
+
+  /**
+   * @brief Charge from steps, waiting to be added to `sim::SimChannel`.
+   *
+   * The charge of each step is merged by channel and TDC as it is queued.
+   * When moved into the channels, the queued charge is sorted by channel,
+   * TDC and step, so that each `sim::SimChannel` receives it in the same
+   * order as if each step were added to it directly, while the channels and
+   * their TDC entries are visited in order.
+   */
+  class ChargeDepositQueue {
+  public:
+    /// Type of map channel -> sim::SimChannel
+    using ChannelMap_t = std::map<unsigned int, sim::SimChannel>;
+
+    /// Charge of one electron cluster, or of one step, on one channel at one TDC.
+    struct ChargeDeposit_t {
+      raw::ChannelID_t channel;
+      unsigned int tdc;
+      std::uint32_t index; ///< cluster order within the step, or step index
+      double energy;
+      double electrons;
+    };
+
+    /**
+     * @brief Queues the charge of a step.
+     * @param trackID ID of the track of the step
+     * @param origTrackID original ID of the track of the step
+     * @param xyz middle point of the step [cm]
+     * @param clusters the charge of the step, `index` being the cluster order
+     *
+     * The `clusters` are sorted in place.
+     */
+    void addStep(int trackID,
+                 int origTrackID,
+                 double const* xyz,
+                 std::vector<ChargeDeposit_t>& clusters);
+
+    /// Returns the number of queued (step, channel, TDC) deposits.
+    std::size_t size() const { return fDeposits.size(); }
+
+    /// Returns whether there is no queued charge.
+    bool empty() const { return fDeposits.empty(); }
+
+    /// Adds all the queued charge into `channels`, and empties the queue.
+    void moveInto(ChannelMap_t& channels);
+
+    /// Drops the queued charge (memory is kept for the next event).
+    void clear();
+
+  private:
+    /// Information shared by all the charge deposited by a single step.
+    struct StepDeposit_t {
+      int trackID;
+      int origTrackID;
+      double xyz[3]; ///< step middle point [cm]
+    };
+
+    std::vector<StepDeposit_t> fSteps;      ///< Queued steps.
+    std::vector<ChargeDeposit_t> fDeposits; ///< Queued charge (`index` of the step).
+  }; // ChargeDepositQueue
+
+} // namespace larg4
+
+#endif // LArG4_ChargeDepositQueue_h
@@ -803,21 +803,13 @@ namespace larg4 {
           else {
             MF_LOG_DEBUG("Optical") << "Storing OpDet Hit Collection in Event";
 
-            std::map<int, std::map<int, int>> ThePhotons =
-              OpDetPhotonTable::Instance()->GetLitePhotons(Reflected);
-
-            if (size(ThePhotons) > 0) {
-              LitePhotonCol->reserve(ThePhotons.size());
-              for (auto const& [opChannel, detectedPhotons] : ThePhotons) {
-                sim::SimPhotonsLite ph;
-                ph.OpChannel = opChannel;
-                ph.DetectedPhotons = detectedPhotons;
-                if (Reflected)
-                  LitePhotonColRefl->push_back(std::move(ph));
-                else
-                  LitePhotonCol->push_back(std::move(ph));
-              }
-            }
+            std::vector<sim::SimPhotonsLite> ThePhotons =
+              OpDetPhotonTable::Instance()->YieldLitePhotons(Reflected);
+
+            if (Reflected)
+              *LitePhotonColRefl = std::move(ThePhotons);
+            else
+              *LitePhotonCol = std::move(ThePhotons);
           }
           if (Reflected)
             *cOpDetBacktrackerRecordColRefl =
@@ -7,8 +7,9 @@
 
 // C/C++ standard library
 #include <cassert>
-#include <cmath>  // std::ceil()
-#include <cstdio> // std::sscanf()
+#include <cmath>   // std::ceil()
+#include <cstdint> // std::uint32_t
+#include <cstdio>  // std::sscanf()
 #include <map>
 #include <string>
 #include <utility> // std::move()
@@ -133,6 +134,7 @@ namespace larg4 {
   // Called at the end of each event.
   void LArVoxelReadout::EndOfEvent(G4HCofThisEvent*)
   {
+    CompactAllDeposits();
     MF_LOG_DEBUG("LArVoxelReadout") << "Total number of steps was " << fNSteps << std::endl;
   }
 
@@ -143,13 +145,32 @@ namespace larg4 {
   void LArVoxelReadout::ClearSimChannels()
   {
     fChannelMaps.resize(fGeoHandle->Ncryostats());
-    size_t cryo = 0;
-    for (auto& cryoData : fChannelMaps) { // each, a vector of maps
-      cryoData.resize(fGeoHandle->NTPC(geo::CryostatID(cryo++)));
-      for (auto& channelsMap : cryoData)
+    fPendingDeposits.resize(fChannelMaps.size());
+    for (size_t cryo = 0; cryo < fChannelMaps.size(); ++cryo) { // each, a vector of maps
+      auto const nTPCs = fGeoHandle->NTPC(geo::CryostatID(cryo));
+      fChannelMaps[cryo].resize(nTPCs);
+      for (auto& channelsMap : fChannelMaps[cryo])
         channelsMap.clear(); // each, a map
-    }                        // for cryostats
-  }                          // LArVoxelReadout::ClearSimChannels()
+      // buffers keep their memory for the next event
+      fPendingDeposits[cryo].resize(nTPCs);
+      for (auto& pending : fPendingDeposits[cryo])
+        pending.clear();
+    } // for cryostats
+  }   // LArVoxelReadout::ClearSimChannels()
+
+  //--------------------------------------------------------------------------------------
+  void LArVoxelReadout::CompactAllDeposits() const
+  {
+    for (size_t cryo = 0; cryo < fPendingDeposits.size(); ++cryo)
+      for (size_t tpc = 0; tpc < fPendingDeposits[cryo].size(); ++tpc)
+        CompactDeposits(cryo, tpc);
+  }
+
+  //--------------------------------------------------------------------------------------
+  void LArVoxelReadout::CompactDeposits(unsigned short cryo, unsigned short tpc) const
+  {
+    fPendingDeposits.at(cryo).at(tpc).moveInto(fChannelMaps[cryo][tpc]);
+  }
 
   const LArVoxelReadout::ChannelMap_t& LArVoxelReadout::GetSimChannelMap() const
   {
@@ -166,12 +187,14 @@ namespace larg4 {
   const LArVoxelReadout::ChannelMap_t& LArVoxelReadout::GetSimChannelMap(unsigned short cryo,
                                                                          unsigned short tpc) const
   {
+    CompactDeposits(cryo, tpc);
     return fChannelMaps.at(cryo).at(tpc);
   }
 
   LArVoxelReadout::ChannelMap_t& LArVoxelReadout::GetSimChannelMap(unsigned short cryo,
                                                                    unsigned short tpc)
   {
+    CompactDeposits(cryo, tpc);
     return fChannelMaps.at(cryo).at(tpc);
   }
 
@@ -185,7 +208,7 @@ namespace larg4 {
                                                                unsigned short tpc) const
   {
     std::vector<sim::SimChannel> channels;
-    const ChannelMap_t& chmap = fChannelMaps.at(cryo).at(tpc);
+    const ChannelMap_t& chmap = GetSimChannelMap(cryo, tpc);
     channels.reserve(chmap.size());
     for (const auto& chpair : chmap)
       channels.push_back(chpair.second);
@@ -349,19 +372,9 @@ namespace larg4 {
     static double RecipDriftVel[3] = {
       1. / fDriftVelocity[0], 1. / fDriftVelocity[1], 1. / fDriftVelocity[2]};
 
-    struct Deposit_t {
-      double energy = 0.;
-      double electrons = 0.;
-
-      void add(double more_energy, double more_electrons)
-      {
-        energy += more_energy;
-        electrons += more_electrons;
-      }
-    }; // Deposit_t
-
-    // Map of electrons to store - catalogued by map[channel][tdc]
-    std::map<raw::ChannelID_t, std::map<unsigned int, Deposit_t>> DepositsToStore;
+    // Charge is collected cluster by cluster in fStepDeposits, then merged by
+    // (channel, TDC) and appended to the pending deposits of this TPC.
+    fStepDeposits.clear();
 
     geo::Point_t xyz1;
 
@@ -440,12 +453,18 @@ namespace larg4 {
         nClus = (int)std::ceil(nElectrons / electronclsize);
       }
 
-      // Compute arrays of values as quickly as possible.
-      std::vector<double> XDiff(nClus);
-      std::vector<double> YDiff(nClus);
-      std::vector<double> ZDiff(nClus);
-      std::vector<double> nElDiff(nClus, electronclsize);
-      std::vector<double> nEnDiff(nClus);
+      // Compute arrays of values as quickly as possible;
+      // the buffers are reused from step to step
+      std::vector<double>& XDiff = fXDiff;
+      std::vector<double>& YDiff = fYDiff;
+      std::vector<double>& ZDiff = fZDiff;
+      std::vector<double>& nElDiff = fNElDiff;
+      std::vector<double>& nEnDiff = fNEnDiff;
+      XDiff.resize(nClus);
+      YDiff.resize(nClus);
+      ZDiff.resize(nClus);
+      nElDiff.assign(nClus, electronclsize);
+      nEnDiff.resize(nClus);
 
       // fix the number of electrons in the last cluster, that has smaller size
       nElDiff.back() = nElectrons - (nClus - 1) * electronclsize;
@@ -462,14 +481,14 @@ namespace larg4 {
 
       // Smear drift times by x position and drift time
       if (LDiffSig > 0.0)
-        PropRand.fireArray(nClus, &XDiff[0], 0., LDiffSig);
+        PropRand.fireArray(nClus, XDiff.data(), 0., LDiffSig);
       else
         XDiff.assign(nClus, 0.0);
 
       if (TDiffSig > 0.0) {
         // Smear the Y,Z position by the transverse diffusion
-        PropRand.fireArray(nClus, &YDiff[0], averageYtransversePos, TDiffSig);
-        PropRand.fireArray(nClus, &ZDiff[0], averageZtransversePos, TDiffSig);
+        PropRand.fireArray(nClus, YDiff.data(), averageYtransversePos, TDiffSig);
+        PropRand.fireArray(nClus, ZDiff.data(), averageZtransversePos, TDiffSig);
       }
       else {
         YDiff.assign(nClus, averageYtransversePos);
@@ -520,8 +539,13 @@ namespace larg4 {
             // Add potential decay/capture/etc delay effect, simTime.
             unsigned int tdc = tpcClock.Ticks(clockData.G4ToElecTime(TDiff + simTime));
 
-            // Add electrons produced by each cluster to the map
-            DepositsToStore[channel][tdc].add(nEnDiff[k], nElDiff[k]);
+            // Add electrons produced by each cluster to the list;
+            // the index keeps track of the order of the clusters
+            fStepDeposits.push_back({channel,
+                                     tdc,
+                                     static_cast<std::uint32_t>(fStepDeposits.size()),
+                                     nEnDiff[k],
+                                     nElDiff[k]});
           }
           catch (cet::exception& e) {
             MF_LOG_DEBUG("LArVoxelReadout")
@@ -531,36 +555,16 @@ namespace larg4 {
         } // end loop over clusters
       }   // end loop over planes
 
-      // Now store them in SimChannels
-      ChannelMap_t& ChannelDataMap = fChannelMaps[cryostat][tpc];
-
-      // browse deposited data on each channel: (channel; deposit data in time)
-      for (auto const& deposit_per_channel : DepositsToStore) {
-
-        raw::ChannelID_t channel = deposit_per_channel.first;
-
-        // find whether we already have this channel
-        auto iChannelData = ChannelDataMap.find(channel);
-
-        // channelData is the SimChannel these deposits are going to be added to
-        // If there is such a channel already, use it (first beanch).
-        // If it's a new channel, the inner assignment creates a new SimChannel
-        // in the map, and we save its reference in channelData
-        sim::SimChannel& channelData = (iChannelData == ChannelDataMap.end()) ?
-                                         (ChannelDataMap[channel] = sim::SimChannel(channel)) :
-                                         iChannelData->second;
+      if (fStepDeposits.empty()) return;
 
-        // go through all deposits, one for each TDC: (TDC, deposit data)
-        for (auto const& deposit_per_tdc : deposit_per_channel.second) {
-          channelData.AddIonizationElectrons(trackID,
-                                             deposit_per_tdc.first,
-                                             deposit_per_tdc.second.electrons,
-                                             xyz,
-                                             deposit_per_tdc.second.energy,
-                                             origTrackID);
+      // Now merge the clusters landing on the same channel and TDC, and queue
+      // them for the SimChannels
+      ChargeDepositQueue& pending = fPendingDeposits[cryostat][tpc];
+      pending.addStep(trackID, origTrackID, xyz, fStepDeposits);
 
-        } // for deposit on TDCs
-      }   // for deposit on channels
+      // the pending charge is bounded: it is moved into the channel map when
+      // the buffer is full; earlier steps are still added first
+      if (pending.size() >= MaxPendingDeposits) CompactDeposits(cryostat, tpc);
 
     } // end try intended to catch points where TPC can't be found
     catch (cet::exception& e) {
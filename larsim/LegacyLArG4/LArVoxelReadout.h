@@ -53,6 +53,7 @@
 #define LArG4_LArVoxelReadout_h
 
 #include <algorithm> // std::max()
+#include <cstddef>   // std::size_t
 #include <stddef.h>
 #include <vector>
 
@@ -61,8 +62,10 @@
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "larcore/Geometry/Geometry.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
 #include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
 #include "lardataobj/Simulation/SimChannel.h"
+#include "larsim/LegacyLArG4/ChargeDepositQueue.h"
 #include "larsim/Simulation/LArG4Parameters.h"
 namespace detinfo {
   class DetectorClocksData;
@@ -169,7 +172,7 @@ namespace larg4 {
   class LArVoxelReadout : public G4VSensitiveDetector {
   public:
     /// Type of map channel -> sim::SimChannel
-    typedef std::map<unsigned int, sim::SimChannel> ChannelMap_t;
+    typedef ChargeDepositQueue::ChannelMap_t ChannelMap_t;
 
     /// Collection of what it takes to set a `LArVoxelReadout` up.
     struct Setup_t {
@@ -318,6 +321,18 @@ namespace larg4 {
                                   unsigned short int tpc,
                                   int origTrackID);
 
+    using ChargeDeposit_t = ChargeDepositQueue::ChargeDeposit_t;
+
+    /// Pending deposits of a TPC which trigger the compaction into its channel map
+    /// (about 512 kB each).
+    static constexpr std::size_t MaxPendingDeposits = 16384;
+
+    /// Moves the pending charge of the specified TPC into its channel map.
+    void CompactDeposits(unsigned short cryo, unsigned short tpc) const;
+
+    /// Moves the pending charge of all TPCs into their channel maps.
+    void CompactAllDeposits() const;
+
     bool Has(std::vector<unsigned short int> v, unsigned short int tpc) const
     {
       for (auto c : v)
@@ -339,7 +354,20 @@ namespace larg4 {
     /// Charge deposited within this many [cm] from the plane is lead onto it.
     double fOffPlaneMargin = 0.0;
 
-    std::vector<std::vector<ChannelMap_t>> fChannelMaps; ///< Maps of cryostat, tpc to channel data
+    // the pending charge is moved into the channel maps also on const access
+    /// Maps of cryostat, tpc to channel data
+    mutable std::vector<std::vector<ChannelMap_t>> fChannelMaps;
+    /// Charge of cryostat, tpc waiting to be moved into `fChannelMaps`.
+    mutable std::vector<std::vector<ChargeDepositQueue>> fPendingDeposits;
+
+    // scratch buffers of `DriftIonizationElectrons()`, reused step after step
+    std::vector<ChargeDeposit_t> fStepDeposits;
+    std::vector<double> fXDiff;
+    std::vector<double> fYDiff;
+    std::vector<double> fZDiff;
+    std::vector<double> fNElDiff;
+    std::vector<double> fNEnDiff;
+
     art::ServiceHandle<geo::Geometry const> fGeoHandle;  ///< Handle to the Geometry service
     art::ServiceHandle<sim::LArG4Parameters const>
       fLgpHandle;        ///< Handle to the LArG4 parameters service
@@ -53,10 +53,7 @@ namespace larg4 {
   //--------------------------------------------------
   void OpDetPhotonTable::AddLitePhoton(int opchannel, int time, int nphotons, bool Reflected)
   {
-    if (!Reflected)
-      fLitePhotons[opchannel][time] += nphotons;
-    else
-      fReflectedLitePhotons[opchannel][time] += nphotons;
+    LitePhotonsFor(opchannel, Reflected).add(opchannel, time, nphotons);
   }
 
   //--------------------------------------------------
@@ -64,13 +61,59 @@ namespace larg4 {
                                    bool Reflected)
   {
     for (auto it = StepPhotonTable->begin(); it != StepPhotonTable->end(); it++) {
-      for (auto in_it = it->second.begin(); in_it != it->second.end(); in_it++) {
-        if (!Reflected)
-          fLitePhotons[it->first][in_it->first] += in_it->second;
-        else
-          fReflectedLitePhotons[it->first][in_it->first] += in_it->second;
-      }
+      sim::LitePhotonAccumulator& photons = LitePhotonsFor(it->first, Reflected);
+      for (auto in_it = it->second.begin(); in_it != it->second.end(); in_it++)
+        photons.add(it->first, in_it->first, in_it->second);
+    }
+  }
+
+  //--------------------------------------------------
+  sim::LitePhotonAccumulator& OpDetPhotonTable::LitePhotonsFor(int opchannel, bool Reflected)
+  {
+    if (opchannel < 0) {
+      std::cerr << "<<" << __PRETTY_FUNCTION__ << ">>"
+                << "Invalid channel: " << opchannel << std::endl;
+      throw std::exception();
+    }
+    sim::LitePhotonAccumulator& photons = LitePhotons(Reflected);
+    if (static_cast<std::size_t>(opchannel) >= photons.nChannels()) photons.resize(opchannel + 1);
+    return photons;
+  }
+
+  //--------------------------------------------------
+  std::map<int, std::map<int, int>> OpDetPhotonTable::GetLitePhotons(bool Reflected)
+  {
+    std::map<int, std::map<int, int>> photons;
+    sim::LitePhotonAccumulator const& litePhotons = LitePhotons(Reflected);
+    for (std::size_t opchannel = 0; opchannel < litePhotons.nChannels(); ++opchannel) {
+      if (litePhotons.empty(opchannel)) continue;
+      photons.emplace_hint(photons.end(), opchannel, litePhotons.toMap(opchannel));
     }
+    return photons;
+  }
+
+  //--------------------------------------------------
+  std::map<int, int> OpDetPhotonTable::GetLitePhotonsForOpChannel(int opchannel, bool Reflected)
+  {
+    sim::LitePhotonAccumulator const& litePhotons = LitePhotons(Reflected);
+    if ((opchannel < 0) || (static_cast<std::size_t>(opchannel) >= litePhotons.nChannels()))
+      return {};
+    return litePhotons.toMap(opchannel);
+  }
+
+  //--------------------------------------------------
+  std::vector<sim::SimPhotonsLite> OpDetPhotonTable::YieldLitePhotons(bool Reflected)
+  {
+    std::vector<sim::SimPhotonsLite> photons;
+    sim::LitePhotonAccumulator& litePhotons = LitePhotons(Reflected);
+    for (std::size_t opchannel = 0; opchannel < litePhotons.nChannels(); ++opchannel) {
+      if (litePhotons.empty(opchannel)) continue;
+      sim::SimPhotonsLite& ph = photons.emplace_back();
+      ph.OpChannel = opchannel;
+      ph.DetectedPhotons = litePhotons.toMap(opchannel);
+    }
+    litePhotons.clear();
+    return photons;
   }
 
   //--------------------------------------------------- cOpDetBacktrackerRecord population
@@ -88,17 +131,24 @@ namespace larg4 {
   //--------------------------------------------------- cOpDetBacktrackerRecord population
   void OpDetPhotonTable::AddOpDetBacktrackerRecord(
     std::vector<sim::OpDetBacktrackerRecord>& RecordsCol,
-    std::map<int, int>& ChannelMap,
+    std::vector<int>& ChannelMap,
     sim::OpDetBacktrackerRecord soc)
   {
     int iChan = soc.OpDetNum();
-    std::map<int, int>::iterator channelPosition = ChannelMap.find(iChan);
-    if (channelPosition == ChannelMap.end()) {
-      ChannelMap[iChan] = RecordsCol.size();
+    if (iChan < 0) {
+      std::cerr << "<<" << __PRETTY_FUNCTION__ << ">>"
+                << "Invalid channel: " << iChan << std::endl;
+      throw std::exception();
+    }
+    if (static_cast<std::size_t>(iChan) >= ChannelMap.size())
+      ChannelMap.resize(iChan + 1, NoRecord);
+    int& channelPosition = ChannelMap[iChan];
+    if (channelPosition == NoRecord) {
+      channelPosition = RecordsCol.size();
       RecordsCol.emplace_back(std::move(soc));
     }
     else {
-      unsigned int idtest = channelPosition->second;
+      unsigned int idtest = channelPosition;
       auto const& timePDclockSDPsMap = soc.timePDclockSDPsMap();
       for (auto const& timePDclockSDP : timePDclockSDPsMap) {
         for (auto const& sdp : timePDclockSDP.second) {
@@ -124,7 +174,7 @@ namespace larg4 {
     //    std::cout << "DEBUG: std::swap(result, cOpDetBacktrackerRecordsCol);" << std::endl;
     //    std::cout << "DEBUG: result.size()       = " << result.size() << std::endl;
     //    std::cout << "DEBUG: cOpDetBTRCol.size() = " << cOpDetBacktrackerRecordsCol.size() << std::endl;
-    cOpChannelToSOCMap.clear();
+    cOpChannelToSOCMap.assign(cOpChannelToSOCMap.size(), NoRecord);
     return result;
   } // OpDetPhotonTable::YieldOpDetBacktrackerRecords()
 
@@ -139,7 +189,7 @@ namespace larg4 {
     std::swap(result, cReflectedOpDetBacktrackerRecordsCol);
     //    std::cout << "DEBUG: result.size()           = " << result.size() << std::endl;
     //    std::cout << "DEBUG: cReflOpDetBTRCol.size() = " << cReflectedOpDetBacktrackerRecordsCol.size() << std::endl;
-    cReflectedOpChannelToSOCMap.clear();
+    cReflectedOpChannelToSOCMap.assign(cReflectedOpChannelToSOCMap.size(), NoRecord);
     return result;
   } // OpDetPhotonTable::YieldOpDetBacktrackerRecords()
 
@@ -159,11 +209,10 @@ namespace larg4 {
       //fDetectedPhotons.at(i).reserve(10000); // Just a guess on minimum # photons
     }
 
-    for (auto it = fLitePhotons.begin(); it != fLitePhotons.end(); ++it)
-      (it->second).clear();
-    for (auto it = fReflectedLitePhotons.begin(); it != fReflectedLitePhotons.end(); ++it)
-      (it->second).clear();
+    // lite photon accumulators keep their memory for the next event
+    if (fLitePhotons.nChannels() < nch) fLitePhotons.resize(nch);
     fLitePhotons.clear();
+    if (fReflectedLitePhotons.nChannels() < nch) fReflectedLitePhotons.resize(nch);
     fReflectedLitePhotons.clear();
   }
 
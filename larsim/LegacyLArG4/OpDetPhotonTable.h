@@ -31,9 +31,15 @@
 //
 //
 //Changes have been made to this object to include the OpDetBacktrackerRecords for use in the photonbacktracker
+//
+// Lite photons and backtracker records are stored densely by optical
+// channel. The lite photons are counted in a sim::LitePhotonAccumulator;
+// the std::map form expected by sim::SimPhotonsLite is only built when the
+// photons are requested.
 #ifndef OPDETPHOTONTABLE_h
 #define OPDETPHOTONTABLE_h 1
 
+#include <cstddef> // std::size_t
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -42,6 +48,7 @@
 #include "lardataobj/Simulation/OpDetBacktrackerRecord.h"
 #include "lardataobj/Simulation/SimEnergyDeposit.h"
 #include "lardataobj/Simulation/SimPhotons.h"
+#include "larsim/Simulation/LitePhotonAccumulator.h"
 
 namespace larg4 {
   class OpDetPhotonTable {
@@ -65,19 +72,16 @@ namespace larg4 {
     sim::SimPhotons& GetPhotonsForOpChannel(size_t opchannel);
     sim::SimPhotons& GetReflectedPhotonsForOpChannel(size_t opchannel);
 
-    std::map<int, std::map<int, int>> GetLitePhotons(bool Reflected = false)
-    {
-      return (Reflected ? fReflectedLitePhotons : fLitePhotons);
-    }
+    std::map<int, std::map<int, int>> GetLitePhotons(bool Reflected = false);
     std::map<int, std::map<int, int>> GetReflectedLitePhotons() { return GetLitePhotons(true); }
-    std::map<int, int>& GetLitePhotonsForOpChannel(int opchannel)
-    {
-      return fLitePhotons[opchannel];
-    }
-    std::map<int, int>& GetReflectedLitePhotonsForOpChannel(int opchannel)
+    /// Returns a copy of the lite photons (time -> count) on `opchannel`.
+    std::map<int, int> GetLitePhotonsForOpChannel(int opchannel, bool Reflected = false);
+    std::map<int, int> GetReflectedLitePhotonsForOpChannel(int opchannel)
     {
-      return fReflectedLitePhotons[opchannel];
+      return GetLitePhotonsForOpChannel(opchannel, true);
     }
+    /// Returns the lite photons of all channels with any, and removes them.
+    std::vector<sim::SimPhotonsLite> YieldLitePhotons(bool Reflected = false);
     void ClearTable(size_t nch = 0);
 
     void AddOpDetBacktrackerRecord(sim::OpDetBacktrackerRecord soc, bool Reflected = false);
@@ -113,18 +117,28 @@ namespace larg4 {
     OpDetPhotonTable();
 
   private:
+    /// No record stored yet in `AddOpDetBacktrackerRecord()` channel index.
+    static constexpr int NoRecord = -1;
+
+    sim::LitePhotonAccumulator& LitePhotons(bool Reflected)
+    {
+      return (Reflected ? fReflectedLitePhotons : fLitePhotons);
+    }
+    /// Returns the lite photon accumulator, making sure it includes `opchannel`.
+    sim::LitePhotonAccumulator& LitePhotonsFor(int opchannel, bool Reflected);
+
     void AddOpDetBacktrackerRecord(std::vector<sim::OpDetBacktrackerRecord>& RecordsCol,
-                                   std::map<int, int>& ChannelMap,
+                                   std::vector<int>& ChannelMap,
                                    sim::OpDetBacktrackerRecord soc);
 
-    std::map<int, std::map<int, int>> fLitePhotons;
-    std::map<int, std::map<int, int>> fReflectedLitePhotons;
+    sim::LitePhotonAccumulator fLitePhotons;
+    sim::LitePhotonAccumulator fReflectedLitePhotons;
     std::vector<sim::OpDetBacktrackerRecord>
       cOpDetBacktrackerRecordsCol; //analogous to scCol for electrons
     std::vector<sim::OpDetBacktrackerRecord>
       cReflectedOpDetBacktrackerRecordsCol;         //analogous to scCol for electrons
-    std::map<int, int> cOpChannelToSOCMap;          //Where each OpChan is.
-    std::map<int, int> cReflectedOpChannelToSOCMap; //Where each OpChan is.
+    std::vector<int> cOpChannelToSOCMap;          //Where each OpChan is (NoRecord if not yet).
+    std::vector<int> cReflectedOpChannelToSOCMap; //Where each OpChan is (NoRecord if not yet).
     std::vector<sim::SimPhotons> fDetectedPhotons;
     std::vector<sim::SimPhotons> fReflectedDetectedPhotons;
 
@@ -544,7 +544,6 @@ namespace larg4 {
     const G4DynamicParticle* aParticle = aTrack->GetDynamicParticle();
     const G4Material* aMaterial = aTrack->GetMaterial();
 
-    G4int materialIndex = aMaterial->GetIndex();
     G4int tracknumber = aStep.GetTrack()->GetTrackID();
 
     G4ThreeVector x0 = pPreStepPoint->GetPosition();
@@ -552,15 +551,16 @@ namespace larg4 {
     //G4double      t0 = pPreStepPoint->GetGlobalTime() - fGlobalTimeOffset;
     G4double t0 = pPreStepPoint->GetGlobalTime();
 
-    G4MaterialPropertiesTable* aMaterialPropertiesTable = aMaterial->GetMaterialPropertiesTable();
+    // material constants are looked up once, in BuildThePhysicsTable()
+    MaterialScintConstants_t const& scintConsts = scintConstants(*aMaterial);
 
-    G4MaterialPropertyVector* Fast_Intensity =
-      aMaterialPropertiesTable->GetProperty("FASTCOMPONENT");
-    G4MaterialPropertyVector* Slow_Intensity =
-      aMaterialPropertiesTable->GetProperty("SLOWCOMPONENT");
+    bool const Fast_Intensity = scintConsts.hasFastComponent;
+    bool const Slow_Intensity = scintConsts.hasSlowComponent;
 
     if (!Fast_Intensity && !Slow_Intensity) return 1;
 
+    G4MaterialPropertiesTable const& aMaterialPropertiesTable = *scintConsts.table;
+
     if (!bPropagate) return 0;
 
     // Get the visibility vector for this point
@@ -576,50 +576,19 @@ namespace larg4 {
       // The scintillation response is a function of the energy
       // deposited by particle types.
 
-      // Get the definition of the current particle
-      G4ParticleDefinition* pDef = aParticle->GetDefinition();
+      // Get the species of the current particle; particles not
+      // enumerated there, and electrons and gammas (must also account for
+      // shell-binding energy attributed to gamma from standard
+      // PhotoElectricEffect), use the electron yield ratio
+      ScintSpecies_t const species = scintSpecies(aParticle->GetDefinition());
+      YieldRatio = scintConsts.speciesYieldRatio[species].get(aMaterialPropertiesTable);
 
-      // Obtain the G4MaterialPropertyVectory containing the
-      // scintillation light yield as a function of the deposited
-      // energy for the current particle type
-
-      // Protons
-      if (pDef == G4Proton::ProtonDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("PROTONYIELDRATIO");
-      }
-      // Muons
-      else if (pDef == G4MuonPlus::MuonPlusDefinition() ||
-               pDef == G4MuonMinus::MuonMinusDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("MUONYIELDRATIO");
-      }
-      // Pions
-      else if (pDef == G4PionPlus::PionPlusDefinition() ||
-               pDef == G4PionMinus::PionMinusDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("PIONYIELDRATIO");
-      }
-      // Kaons
-      else if (pDef == G4KaonPlus::KaonPlusDefinition() ||
-               pDef == G4KaonMinus::KaonMinusDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("KAONYIELDRATIO");
-      }
-      // Alphas
-      else if (pDef == G4Alpha::AlphaDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("ALPHAYIELDRATIO");
-      }
-      // Electrons (must also account for shell-binding energy
-      // attributed to gamma from standard PhotoElectricEffect)
-      else if (pDef == G4Electron::ElectronDefinition() || pDef == G4Gamma::GammaDefinition()) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("ELECTRONYIELDRATIO");
-      }
-      // Default for particles not enumerated/listed above
-      else {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("ELECTRONYIELDRATIO");
-      }
       // If the user has not specified yields for (p,d,t,a,carbon)
       // then these unspecified particles will default to the
       // electron's scintillation yield
       if (YieldRatio == 0) {
-        YieldRatio = aMaterialPropertiesTable->GetConstProperty("ELECTRONYIELDRATIO");
+        YieldRatio =
+          scintConsts.speciesYieldRatio[kElectronSpecies].get(aMaterialPropertiesTable);
       }
     }
 
@@ -634,7 +603,7 @@ namespace larg4 {
       ReflVisibilities = fPVS->GetAllVisibilities(ScintPoint, true);
       if (fPVS->StoreReflT0()) ReflT0s = fPVS->GetReflT0s(ScintPoint);
     }
-    if (fPVS->IncludeParPropTime()) { ParPropTimeTF1 = fPVS->GetTimingTF1(ScintPoint); }
+    if (fPVS->IncludeParPropTime()) { ParPropTimeSamplers = fPVS->GetTimingSamplers(ScintPoint); }
 
     /*
     // For Kazu to debug # photons generated using csv file, by default should be commented out
@@ -669,51 +638,42 @@ namespace larg4 {
       if (scnt == 1) {
         if (nscnt == 1) {
           if (Fast_Intensity) {
-            ScintillationTime = aMaterialPropertiesTable->GetConstProperty("FASTTIMECONSTANT");
+            ScintillationTime = scintConsts.fastTimeConstant.get(aMaterialPropertiesTable);
             if (fFiniteRiseTime) {
-              ScintillationRiseTime =
-                aMaterialPropertiesTable->GetConstProperty("FASTSCINTILLATIONRISETIME");
+              ScintillationRiseTime = scintConsts.fastRiseTime.get(aMaterialPropertiesTable);
             }
-            ScintillationIntegral =
-              (G4PhysicsOrderedFreeVector*)((*theFastIntegralTable)(materialIndex));
+            ScintillationIntegral = scintConsts.fastIntegral;
           }
           if (Slow_Intensity) {
-            ScintillationTime = aMaterialPropertiesTable->GetConstProperty("SLOWTIMECONSTANT");
+            ScintillationTime = scintConsts.slowTimeConstant.get(aMaterialPropertiesTable);
             if (fFiniteRiseTime) {
-              ScintillationRiseTime =
-                aMaterialPropertiesTable->GetConstProperty("SLOWSCINTILLATIONRISETIME");
+              ScintillationRiseTime = scintConsts.slowRiseTime.get(aMaterialPropertiesTable);
             }
-            ScintillationIntegral =
-              (G4PhysicsOrderedFreeVector*)((*theSlowIntegralTable)(materialIndex));
+            ScintillationIntegral = scintConsts.slowIntegral;
           }
         } //endif nscnt=1
         else {
-          if (YieldRatio == 0)
-            YieldRatio = aMaterialPropertiesTable->GetConstProperty("YIELDRATIO");
+          if (YieldRatio == 0) YieldRatio = scintConsts.yieldRatio.get(aMaterialPropertiesTable);
 
           if (ExcitationRatio == 1.0) { Num = std::min(YieldRatio, 1.0) * MeanNumberOfPhotons; }
           else {
             Num = std::min(ExcitationRatio, 1.0) * MeanNumberOfPhotons;
           }
-          ScintillationTime = aMaterialPropertiesTable->GetConstProperty("FASTTIMECONSTANT");
+          ScintillationTime = scintConsts.fastTimeConstant.get(aMaterialPropertiesTable);
           if (fFiniteRiseTime) {
-            ScintillationRiseTime =
-              aMaterialPropertiesTable->GetConstProperty("FASTSCINTILLATIONRISETIME");
+            ScintillationRiseTime = scintConsts.fastRiseTime.get(aMaterialPropertiesTable);
           }
-          ScintillationIntegral =
-            (G4PhysicsOrderedFreeVector*)((*theFastIntegralTable)(materialIndex));
+          ScintillationIntegral = scintConsts.fastIntegral;
         } //endif nscnt!=1
       }   //end scnt=1
 
       else {
         Num = MeanNumberOfPhotons - Num;
-        ScintillationTime = aMaterialPropertiesTable->GetConstProperty("SLOWTIMECONSTANT");
+        ScintillationTime = scintConsts.slowTimeConstant.get(aMaterialPropertiesTable);
         if (fFiniteRiseTime) {
-          ScintillationRiseTime =
-            aMaterialPropertiesTable->GetConstProperty("SLOWSCINTILLATIONRISETIME");
+          ScintillationRiseTime = scintConsts.slowRiseTime.get(aMaterialPropertiesTable);
         }
-        ScintillationIntegral =
-          (G4PhysicsOrderedFreeVector*)((*theSlowIntegralTable)(materialIndex));
+        ScintillationIntegral = scintConsts.slowIntegral;
       }
 
       if (!ScintillationIntegral) continue;
@@ -959,6 +919,107 @@ namespace larg4 {
       theFastIntegralTable->insertAt(i, aPhysicsOrderedFreeVector);
       theSlowIntegralTable->insertAt(i, bPhysicsOrderedFreeVector);
     }
+
+    BuildScintConstants();
+  }
+
+  //----------------------------------------------------------------------------
+  G4double OpFastScintillation::ConstProperty_t::get(G4MaterialPropertiesTable const& table) const
+  {
+    return exists ? value : table.GetConstProperty(key);
+  }
+
+  //----------------------------------------------------------------------------
+  void OpFastScintillation::BuildScintConstants()
+  {
+    // The step path used to query the material properties by name at each
+    // step; here all of them are read once per material.
+    const G4MaterialTable* theMaterialTable = G4Material::GetMaterialTable();
+    G4int const numOfMaterials = G4Material::GetNumberOfMaterials();
+
+    auto const readConst = [](G4MaterialPropertiesTable const* table, char const* key) {
+      ConstProperty_t prop;
+      prop.key = key;
+      if (table && table->ConstPropertyExists(key)) {
+        prop.value = table->GetConstProperty(key);
+        prop.exists = true;
+      }
+      return prop;
+    };
+
+    fMaterialScintConstants.assign(numOfMaterials, {});
+    for (G4int i = 0; i < numOfMaterials; ++i) {
+      G4Material const* aMaterial = (*theMaterialTable)[i];
+      G4MaterialPropertiesTable* table = aMaterial->GetMaterialPropertiesTable();
+
+      MaterialScintConstants_t& consts = fMaterialScintConstants[i];
+      consts.material = aMaterial;
+      consts.table = table;
+      consts.fastIntegral = static_cast<G4PhysicsOrderedFreeVector*>((*theFastIntegralTable)(i));
+      consts.slowIntegral = static_cast<G4PhysicsOrderedFreeVector*>((*theSlowIntegralTable)(i));
+      if (!table) continue;
+
+      consts.hasFastComponent = (table->GetProperty("FASTCOMPONENT") != nullptr);
+      consts.hasSlowComponent = (table->GetProperty("SLOWCOMPONENT") != nullptr);
+      consts.fastTimeConstant = readConst(table, "FASTTIMECONSTANT");
+      consts.fastRiseTime = readConst(table, "FASTSCINTILLATIONRISETIME");
+      consts.slowTimeConstant = readConst(table, "SLOWTIMECONSTANT");
+      consts.slowRiseTime = readConst(table, "SLOWSCINTILLATIONRISETIME");
+      consts.yieldRatio = readConst(table, "YIELDRATIO");
+      consts.speciesYieldRatio[kElectronSpecies] = readConst(table, "ELECTRONYIELDRATIO");
+      consts.speciesYieldRatio[kProtonSpecies] = readConst(table, "PROTONYIELDRATIO");
+      consts.speciesYieldRatio[kMuonSpecies] = readConst(table, "MUONYIELDRATIO");
+      consts.speciesYieldRatio[kPionSpecies] = readConst(table, "PIONYIELDRATIO");
+      consts.speciesYieldRatio[kKaonSpecies] = readConst(table, "KAONYIELDRATIO");
+      consts.speciesYieldRatio[kAlphaSpecies] = readConst(table, "ALPHAYIELDRATIO");
+    } // for materials
+    fLastScintConstants = nullptr;
+
+    // particle definitions are numbered by Geant4 in order of creation;
+    // the ones created later than this point are not in the list and are
+    // treated as the default (electron) species
+    std::pair<G4ParticleDefinition const*, ScintSpecies_t> const speciesDefs[] = {
+      {G4Proton::ProtonDefinition(), kProtonSpecies},
+      {G4MuonPlus::MuonPlusDefinition(), kMuonSpecies},
+      {G4MuonMinus::MuonMinusDefinition(), kMuonSpecies},
+      {G4PionPlus::PionPlusDefinition(), kPionSpecies},
+      {G4PionMinus::PionMinusDefinition(), kPionSpecies},
+      {G4KaonPlus::KaonPlusDefinition(), kKaonSpecies},
+      {G4KaonMinus::KaonMinusDefinition(), kKaonSpecies},
+      {G4Alpha::AlphaDefinition(), kAlphaSpecies},
+    };
+    fScintSpecies.clear();
+    for (auto const& [pDef, species] : speciesDefs) {
+      auto const id = static_cast<std::size_t>(pDef->GetInstanceID());
+      if (id >= fScintSpecies.size()) fScintSpecies.resize(id + 1, kElectronSpecies);
+      fScintSpecies[id] = species;
+    }
+  } // OpFastScintillation::BuildScintConstants()
+
+  //----------------------------------------------------------------------------
+  OpFastScintillation::MaterialScintConstants_t const& OpFastScintillation::scintConstants(
+    G4Material const& material)
+  {
+    // fast path: most steps happen in the same material (liquid argon)
+    if (fLastScintConstants && (fLastScintConstants->material == &material))
+      return *fLastScintConstants;
+
+    std::size_t const index = material.GetIndex();
+    if (index >= fMaterialScintConstants.size()) {
+      throw cet::exception("OpFastScintillation")
+        << "Material '" << material.GetName() << "' (#" << index
+        << ") was created after the scintillation tables were built.\n";
+    }
+    fLastScintConstants = &fMaterialScintConstants[index];
+    return *fLastScintConstants;
+  } // OpFastScintillation::scintConstants()
+
+  //----------------------------------------------------------------------------
+  OpFastScintillation::ScintSpecies_t OpFastScintillation::scintSpecies(
+    G4ParticleDefinition const* pDef) const
+  {
+    auto const id = static_cast<std::size_t>(pDef->GetInstanceID());
+    return (id < fScintSpecies.size()) ? fScintSpecies[id] : kElectronSpecies;
   }
 
   // Called by the user to set the scintillation yield as a function
@@ -1017,9 +1078,8 @@ namespace larg4 {
         << "Cannot have both propagation time models simultaneously.";
     }
     else if (fPVS->IncludeParPropTime() &&
-             !(ParPropTimeTF1 && (ParPropTimeTF1[OpChannel].GetNdim() == 1))) {
-      //Warning: TF1::GetNdim()==1 will tell us if the TF1 is really defined or it is the default one.
-      //This will fix a segfault when using timing and interpolation.
+             !(ParPropTimeSamplers && ParPropTimeSamplers[OpChannel].isValid())) {
+      // the sampler is invalid if the library has no distribution for this channel
       G4cout << "WARNING: Requested parameterized timing, but no function found. Not applying "
                 "propagation time."
              << G4endl;
@@ -1028,8 +1088,9 @@ namespace larg4 {
       if (Reflected)
         throw cet::exception("OpFastScintillation")
           << "No parameterized propagation time for reflected light";
+      phot::PhotonLibraryTimingSampler const sampler = ParPropTimeSamplers[OpChannel];
       for (size_t i = 0; i < arrival_time_dist.size(); ++i) {
-        arrival_time_dist[i] = ParPropTimeTF1[OpChannel].GetRandom();
+        arrival_time_dist[i] = sampler.sample(G4UniformRand());
       }
     }
     else if (fPVS->IncludePropTime()) {
@@ -100,9 +100,13 @@
 #include "TF1.h"
 #include "TVector3.h"
 
+#include <array>
 #include <memory> // std::unique_ptr
+#include <vector>
 
 class G4EmSaturation;
+class G4Material;
+class G4MaterialPropertiesTable;
 class G4Step;
 class G4Track;
 class G4VParticleChange;
@@ -270,6 +274,63 @@ namespace larg4 {
     std::unique_ptr<G4PhysicsTable> theSlowIntegralTable;
     std::unique_ptr<G4PhysicsTable> theFastIntegralTable;
 
+    /// Particle species with a dedicated scintillation yield ratio.
+    enum ScintSpecies_t : unsigned char {
+      kElectronSpecies, ///< electrons, gammas and any species not listed below
+      kProtonSpecies,
+      kMuonSpecies,
+      kPionSpecies,
+      kKaonSpecies,
+      kAlphaSpecies,
+      NScintSpecies
+    };
+
+    /// A material constant property, cached from its properties table.
+    struct ConstProperty_t {
+      char const* key = nullptr; ///< name of the property
+      G4double value = 0.;       ///< value, if the property exists
+      bool exists = false;       ///< whether the material defines the property
+
+      /// Returns the cached value (querying `table` if not defined, to have
+      /// Geant4 report the missing property as it would have done).
+      G4double get(G4MaterialPropertiesTable const& table) const;
+    };
+
+    /// Scintillation constants of a material, built with the integral tables.
+    struct MaterialScintConstants_t {
+      G4Material const* material = nullptr;
+      G4MaterialPropertiesTable const* table = nullptr; ///< null if no optical properties
+      bool hasFastComponent = false;
+      bool hasSlowComponent = false;
+      ConstProperty_t fastTimeConstant;
+      ConstProperty_t fastRiseTime;
+      ConstProperty_t slowTimeConstant;
+      ConstProperty_t slowRiseTime;
+      ConstProperty_t yieldRatio;
+      /// Yield ratio per species (`ELECTRONYIELDRATIO` for electrons).
+      std::array<ConstProperty_t, NScintSpecies> speciesYieldRatio;
+      G4PhysicsOrderedFreeVector* fastIntegral = nullptr;
+      G4PhysicsOrderedFreeVector* slowIntegral = nullptr;
+    };
+
+    /// Constants of all materials, by material index.
+    std::vector<MaterialScintConstants_t> fMaterialScintConstants;
+
+    /// Species of each particle definition, by definition instance ID.
+    std::vector<ScintSpecies_t> fScintSpecies;
+
+    /// Constants of the last material seen (steps are mostly in one material).
+    MaterialScintConstants_t const* fLastScintConstants = nullptr;
+
+    /// Fills `fMaterialScintConstants` and `fScintSpecies`.
+    void BuildScintConstants();
+
+    /// Returns the cached constants of `material`.
+    MaterialScintConstants_t const& scintConstants(G4Material const& material);
+
+    /// Returns the scintillation species of the particle `pDef`.
+    ScintSpecies_t scintSpecies(G4ParticleDefinition const* pDef) const;
+
     G4bool fTrackSecondariesFirst;
     G4bool fFiniteRiseTime;
 
@@ -324,7 +385,7 @@ namespace larg4 {
 
     G4EmSaturation* emSaturation;
     // functions and parameters for the propagation time parametrization
-    phot::MappedFunctions_t ParPropTimeTF1;
+    phot::MappedTimingSamplers_t ParPropTimeSamplers;
     phot::MappedT0s_t ReflT0s;
 
     /*TF1 const* functions_vuv[8];
@@ -87,23 +87,12 @@ namespace larg4 {
   // trackid
   // assume that the current track id has already been added to
   // the fParentIDMap
-  int ParticleListAction::GetParentage(int trackid, bool useOrigTrackIDMap) const
+  int ParticleListAction::GetParentage(int trackid, bool useOrigTrackIDMap)
   {
-    int parentid = sim::NoParticleId;
-    const std::map<int, int>* parentIDMap =
-      useOrigTrackIDMap ? &fParentIDMap_OrigTrackID : &fParentIDMap;
-
-    // search the fParentIDMap recursively until we have the parent id
-    // of the first EM particle that led to this one
-    std::map<int, int>::const_iterator itr = parentIDMap->find(trackid);
-    while (itr != parentIDMap->end()) {
-      MF_LOG_DEBUG("ParticleListAction") << "parentage for " << trackid << " " << (*itr).second;
-
-      // set the parentid to the current parent ID, when the loop ends
-      // this id will be the first EM particle
-      parentid = (*itr).second;
-      itr = parentIDMap->find(parentid);
-    }
+    AncestryIndex& parentIDMap = useOrigTrackIDMap ? fParentIDMap_OrigTrackID : fParentIDMap;
+
+    // the id of the first EM particle that led to this one
+    int const parentid = parentIDMap.ultimateAncestor(trackid);
     MF_LOG_DEBUG("ParticleListAction") << "final parent ID " << parentid;
 
     return parentid;
@@ -183,7 +172,7 @@ namespace larg4 {
 
         // figure out the ultimate parentage of this particle
         // first add this track id and its parent to the fParentIDMap
-        fParentIDMap[trackID] = parentID;
+        fParentIDMap.setParent(trackID, parentID);
 
         fCurrentTrackID = -1 * this->GetParentage(
                                  trackID); // the real trackID remains stored in fCurrentOrigTrackID
@@ -207,8 +196,8 @@ namespace larg4 {
 
         // do add the particle to the parent id map though
         // and set the current track id to be it's ultimate parent
-        fParentIDMap[trackID] = parentID;
-        fParentIDMap_OrigTrackID[trackID] = parentID;
+        fParentIDMap.setParent(trackID, parentID);
+        fParentIDMap_OrigTrackID.setParent(trackID, parentID);
 
         fCurrentTrackID = -1 * this->GetParentage(trackID);
         fCurrentOrigTrackID = -1 * this->GetParentage(trackID, true);
@@ -224,8 +213,8 @@ namespace larg4 {
           !(fdroppedParticleList && fdroppedParticleList->KnownParticle(parentID))) {
         // do add the particle to the parent id map
         // just in case it makes a daughter that we have to track as well
-        fParentIDMap[trackID] = parentID;
-        fParentIDMap_OrigTrackID[trackID] = parentID;
+        fParentIDMap.setParent(trackID, parentID);
+        fParentIDMap_OrigTrackID.setParent(trackID, parentID);
         int pid = this->GetParentage(parentID);
 
         // if we still can't find the parent in the particle navigator,
@@ -21,6 +21,7 @@
 
 #include "cetlib/exempt_ptr.h"
 #include "larcorealg/CoreUtils/ParticleFilters.h" // util::PositionInVolumeFilter
+#include "larsim/LegacyLArG4/AncestryIndex.h"
 #include "nug4/G4Base/UserAction.h"
 #include "nusimdata/SimulationBase/simb.h" // simb::GeneratedParticleIndex_t
 
@@ -132,9 +133,9 @@ namespace larg4 {
     static bool isDropped(simb::MCParticle const* p);
 
   private:
-    // this method will loop over the fParentIDMap to get the
+    // this method will look up fParentIDMap to get the
     // parentage of the provided trackid
-    int GetParentage(int trackid, bool useOrigTrackIDMap = false) const;
+    int GetParentage(int trackid, bool useOrigTrackIDMap = false);
 
     G4double fenergyCut;             ///< The minimum energy for a particle to
                                      ///< be included in the list.
@@ -146,8 +147,8 @@ namespace larg4 {
       fdroppedParticleList;          ///< The accumulated particle information for
                                      ///< all dropped particles in the event.
     G4bool fstoreTrajectories;       ///< Whether to store particle trajectories with each particle.
-    std::map<int, int> fParentIDMap; ///< key is current track ID, value is parent ID
-    std::map<int, int>
+    AncestryIndex fParentIDMap; ///< key is current track ID, value is parent ID
+    AncestryIndex
       fParentIDMap_OrigTrackID; ///< key is current track ID, value is parent ID -- for real G4 track ID tracking only
     static int fCurrentTrackID; ///< track ID of the current particle, set to eve ID
                                 ///< for EM shower particles
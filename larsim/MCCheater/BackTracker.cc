@@ -19,6 +19,13 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "lardataalg/DetectorInfo/DetectorClocks.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+#include <algorithm> // std::stable_sort(), std::equal_range(), std::partition_point()
+#include <cstdlib>   // abs()
+#include <iterator>  // std::distance()
+
 namespace cheat {
 
   //-----------------------------------------------------------------------
@@ -54,29 +61,109 @@ namespace cheat {
   void BackTracker::ClearEvent()
   {
     fSimChannels.clear();
+    ResetIndices();
     //    fAllHitList.clear();
   }
 
+  //-----------------------------------------------------------------------
+  void BackTracker::ResetIndices() const
+  {
+    fTrackIDEIndex.clear();
+    fTrackIDEIndexReady = false;
+    fTDCIndex.clear();
+    fTDCIndexOffsets.clear();
+    fTDCIndexReady = false;
+  }
+
+  //-----------------------------------------------------------------------
+  void BackTracker::PrepTDCIndex() const
+  {
+    if (fTDCIndexReady) return;
+
+    // TDCIDEMap() is in fact not a map, and it is not guaranteed to be sorted
+    auto const byTDC = [](const TDCIDE_t* a, const TDCIDE_t* b) { return a->first < b->first; };
+    fTDCIndex.clear();
+    fTDCIndexOffsets.assign(1U, 0U);
+    fTDCIndexOffsets.reserve(fSimChannels.size() + 1);
+    for (const art::Ptr<sim::SimChannel>& sc : fSimChannels) {
+      auto const first = fTDCIndex.size();
+      for (const TDCIDE_t& item : sc->TDCIDEMap())
+        fTDCIndex.push_back(&item);
+      auto const begin = fTDCIndex.begin() + first;
+      if (!std::is_sorted(begin, fTDCIndex.end(), byTDC))
+        std::stable_sort(begin, fTDCIndex.end(), byTDC);
+      fTDCIndexOffsets.push_back(fTDCIndex.size());
+    }
+    fTDCIndexReady = true;
+  }
+
+  //-----------------------------------------------------------------------
+  std::size_t BackTracker::FindSimChannelIndex(raw::ChannelID_t channel) const
+  {
+    auto ilb = std::lower_bound(fSimChannels.begin(),
+                                fSimChannels.end(),
+                                channel,
+                                [](art::Ptr<sim::SimChannel> const& a, raw::ChannelID_t channel) {
+                                  return (a->Channel() < channel);
+                                });
+    return ((ilb != fSimChannels.end()) && ((*ilb)->Channel() == channel)) ?
+             std::distance(fSimChannels.begin(), ilb) :
+             fSimChannels.size();
+  }
+
+  //-----------------------------------------------------------------------
+  auto BackTracker::TDCRange(std::size_t iChannel, int start_tdc, int end_tdc) const
+    -> std::pair<std::vector<const TDCIDE_t*>::const_iterator,
+                 std::vector<const TDCIDE_t*>::const_iterator>
+  {
+    auto const begin = fTDCIndex.cbegin() + fTDCIndexOffsets[iChannel];
+    auto const end = fTDCIndex.cbegin() + fTDCIndexOffsets[iChannel + 1];
+    auto const first =
+      std::partition_point(begin, end, [start_tdc](const TDCIDE_t* p) { return p->first < start_tdc; });
+    auto const last =
+      std::partition_point(first, end, [end_tdc](const TDCIDE_t* p) { return p->first <= end_tdc; });
+    return {first, last};
+  }
+
+  //-----------------------------------------------------------------------
+  auto BackTracker::TrackIdToIndexEntries(int id) const
+    -> std::pair<std::vector<TrackIDEIndexEntry_t>::const_iterator,
+                 std::vector<TrackIDEIndexEntry_t>::const_iterator>
+  {
+    if (!fTrackIDEIndexReady) {
+      // one pass over all the IDEs of the event; the stable sort keeps the
+      // IDEs of each track in the order of the SimChannels, as a scan would
+      fTrackIDEIndex.clear();
+      for (const art::Ptr<sim::SimChannel>& sc : fSimChannels) {
+        raw::ChannelID_t const channel = sc->Channel();
+        for (const auto& item : sc->TDCIDEMap()) {
+          for (const sim::IDE& ide : item.second)
+            fTrackIDEIndex.push_back({abs(ide.trackID), channel, &ide});
+        }
+      }
+      std::stable_sort(fTrackIDEIndex.begin(),
+                       fTrackIDEIndex.end(),
+                       [](TrackIDEIndexEntry_t const& a, TrackIDEIndexEntry_t const& b) {
+                         return a.trackID < b.trackID;
+                       });
+      fTrackIDEIndexReady = true;
+    }
+
+    struct CompareTrackID {
+      bool operator()(TrackIDEIndexEntry_t const& entry, int id) const { return entry.trackID < id; }
+      bool operator()(int id, TrackIDEIndexEntry_t const& entry) const { return id < entry.trackID; }
+    };
+    return std::equal_range(fTrackIDEIndex.cbegin(), fTrackIDEIndex.cend(), id, CompareTrackID{});
+  }
+
   //-----------------------------------------------------------------------
   std::vector<const sim::IDE*> BackTracker::TrackIdToSimIDEs_Ps(int const& id) const
   {
+    auto const [begin, end] = TrackIdToIndexEntries(id);
     std::vector<const sim::IDE*> ideps;
-    for (size_t sc = 0; sc < fSimChannels.size(); ++sc) {
-      const auto& tdcidemap = fSimChannels[sc]->TDCIDEMap(); // This returns a reference.
-      // loop over the IDEMAP
-      for (auto mapitr = tdcidemap.begin(); mapitr != tdcidemap.end(); mapitr++) {
-        // loop over the vector of IDE objects.
-        const std::vector<sim::IDE>& idevec =
-          (*mapitr).second; // note, mapitr.second returns the actual data from
-                            // the map, not a copy
-        for (size_t iv = 0; iv < idevec.size(); ++iv) {
-          // const sim::IDE* const idep = &idevec[iv];
-          // if( abs(idevec[iv].trackID) == id) continue;
-          // ideps.push_back(idep);
-          if (abs(idevec[iv].trackID) == id) ideps.push_back(&(idevec[iv]));
-        } // end for index in idevec
-      }   // end loop over map from sim::SimChannel
-    }     // end loop over sim::SimChannels
+    ideps.reserve(std::distance(begin, end));
+    for (auto it = begin; it != end; ++it)
+      ideps.push_back(it->ide);
     return ideps;
   }
 
@@ -84,20 +171,18 @@ namespace cheat {
   std::vector<const sim::IDE*> BackTracker::TrackIdToSimIDEs_Ps(int const& id,
                                                                 const geo::View_t view) const
   {
+    auto const [begin, end] = TrackIdToIndexEntries(id);
     std::vector<const sim::IDE*> ide_Ps;
-    for (const art::Ptr<sim::SimChannel> sc : fSimChannels) {
-      if (fGeom->View(sc->Channel()) != view) continue;
-
-      // loop over the IDEMAP
-      for (const auto& item : sc->TDCIDEMap()) {
-
-        // loop over the vector of IDE objects.
-        for (const sim::IDE& ide : item.second) {
-          if (abs(ide.trackID) == id) ide_Ps.push_back(&ide);
-        }
-      } // end loop over map from sim::SimChannel
-    }   // end loop over sim::SimChannels
-
+    // entries of the same channel are contiguous: ask the view once per channel
+    raw::ChannelID_t channel = raw::InvalidChannelID;
+    bool inView = false;
+    for (auto it = begin; it != end; ++it) {
+      if (it->channel != channel) {
+        channel = it->channel;
+        inView = (fGeom->View(channel) == view);
+      }
+      if (inView) ide_Ps.push_back(it->ide);
+    }
     return ide_Ps;
   }
 
@@ -130,11 +215,19 @@ namespace cheat {
     const double hit_start_time,
     const double hit_end_time) const
   {
-    art::Ptr<sim::SimChannel> schannel = this->FindSimChannelPtr(channel);
-    if (!schannel) return {};
+    PrepTDCIndex();
+    return ChannelToTrackIDEsImpl(clockData, channel, hit_start_time, hit_end_time);
+  }
 
-    std::vector<sim::TrackIDE> trackIDEs;
-    double totalE = 0.;
+  //-----------------------------------------------------------------------
+  std::vector<sim::TrackIDE> BackTracker::ChannelToTrackIDEsImpl(
+    detinfo::DetectorClocksData const& clockData,
+    raw::ChannelID_t channel,
+    const double hit_start_time,
+    const double hit_end_time) const
+  {
+    std::size_t const iChannel = FindSimChannelIndex(channel);
+    if (iChannel == fSimChannels.size()) return {};
 
     // loop over the electrons in the channel and grab those that are in time
     // with the identified hit start and stop times
@@ -142,31 +235,63 @@ namespace cheat {
     int end_tdc = clockData.TPCTick2TDC(hit_end_time);
     if (start_tdc < 0) start_tdc = 0;
     if (end_tdc < 0) end_tdc = 0;
-    std::vector<sim::IDE> simides = schannel->TrackIDsAndEnergies(start_tdc, end_tdc);
-
-    // first get the total energy represented by all track ids for
-    // this channel and range of tdc values
-    for (size_t e = 0; e < simides.size(); ++e)
-      totalE += simides[e].energy;
-
-    // protect against a divide by zero below
-    if (totalE < 1.e-5) totalE = 1.;
-
-    // loop over the entries in the map and fill the input vectors
-
-    for (size_t e = 0; e < simides.size(); ++e) {
-
-      if (simides[e].trackID == sim::NoParticleId) continue;
+    // sim::SimChannel::TrackIDsAndEnergies() has nothing for a reversed window
+    if (start_tdc > end_tdc) return {};
+
+    // Sum energy and electrons by track ID as sim::SimChannel::TrackIDsAndEnergies()
+    // does, in the same order, but without building IDEs: collect all the
+    // contributions, then sort them by track ID keeping their original order.
+    struct Contribution_t {
+      int trackID;
+      unsigned int order;
+      double energy;
+      double numElectrons;
+    };
+    thread_local std::vector<Contribution_t> contributions;
+    contributions.clear();
+    auto const [first, last] = TDCRange(iChannel, start_tdc, end_tdc);
+    for (auto it = first; it != last; ++it) {
+      for (const sim::IDE& ide : (*it)->second) {
+        contributions.push_back({ide.trackID,
+                                 static_cast<unsigned int>(contributions.size()),
+                                 ide.energy,
+                                 ide.numElectrons});
+      }
+    }
+    std::sort(contributions.begin(),
+              contributions.end(),
+              [](Contribution_t const& a, Contribution_t const& b) {
+                return (a.trackID < b.trackID) || ((a.trackID == b.trackID) && (a.order < b.order));
+              });
 
+    std::vector<sim::TrackIDE> trackIDEs;
+    double totalE = 0.;
+    auto iContrib = contributions.cbegin();
+    auto const cend = contributions.cend();
+    while (iContrib != cend) {
       sim::TrackIDE info;
-      info.trackID = simides[e].trackID;
-      info.energyFrac = simides[e].energy / totalE;
-      info.energy = simides[e].energy;
-      info.numElectrons = simides[e].numElectrons;
+      info.trackID = iContrib->trackID;
+      info.energy = iContrib->energy;
+      info.numElectrons = iContrib->numElectrons;
+      while ((++iContrib != cend) && (iContrib->trackID == info.trackID)) {
+        info.energy += iContrib->energy;
+        info.numElectrons += iContrib->numElectrons;
+      }
 
+      // first get the total energy represented by all track ids for
+      // this channel and range of tdc values
+      totalE += info.energy;
+
+      if (info.trackID == sim::NoParticleId) continue;
       trackIDEs.push_back(info);
     }
 
+    // protect against a divide by zero below
+    if (totalE < 1.e-5) totalE = 1.;
+
+    for (sim::TrackIDE& info : trackIDEs)
+      info.energyFrac = info.energy / totalE;
+
     return trackIDEs;
   }
 
@@ -180,6 +305,40 @@ namespace cheat {
     return this->ChannelToTrackIDEs(clockData, hit.Channel(), start, end);
   }
 
+  //-----------------------------------------------------------------------
+  std::vector<std::vector<sim::TrackIDE>> BackTracker::HitsToTrackIDEs(
+    detinfo::DetectorClocksData const& clockData,
+    std::vector<art::Ptr<recob::Hit>> const& hits) const
+  {
+    // the index is shared by all the threads, and must be ready beforehand
+    PrepTDCIndex();
+
+    // dereferencing an art::Ptr may resolve it, which is not thread-safe:
+    // the hits are read here, and only their time windows are shared
+    struct HitWindow_t {
+      raw::ChannelID_t channel;
+      double start;
+      double end;
+    };
+    std::vector<HitWindow_t> windows;
+    windows.reserve(hits.size());
+    for (art::Ptr<recob::Hit> const& hit : hits) {
+      windows.push_back(
+        {hit->Channel(), hit->PeakTimeMinusRMS(fHitTimeRMS), hit->PeakTimePlusRMS(fHitTimeRMS)});
+    }
+
+    std::vector<std::vector<sim::TrackIDE>> trackIDEs(hits.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, windows.size()),
+                      [&](tbb::blocked_range<std::size_t> const& range) {
+                        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                          HitWindow_t const& window = windows[i];
+                          trackIDEs[i] = this->ChannelToTrackIDEsImpl(
+                            clockData, window.channel, window.start, window.end);
+                        }
+                      });
+    return trackIDEs;
+  }
+
   //-----------------------------------------------------------------------
   std::vector<int> BackTracker::HitToTrackIds(detinfo::DetectorClocksData const& clockData,
                                               recob::Hit const& hit) const
@@ -327,42 +486,16 @@ namespace cheat {
 
     if (start_tdc > end_tdc) { throw; }
 
-    const std::vector<std::pair<unsigned short, std::vector<sim::IDE>>>& tdcIDEMap =
-      (this->FindSimChannel(hit.Channel()))
-        ->TDCIDEMap(); // This in fact does not return a std::map. It returns a
-                       // vector... with no guarantee that it is sorted...
-    std::vector<const std::pair<unsigned short, std::vector<sim::IDE>>*> tdcIDEMap_SortedPointers;
-    for (auto& pair : tdcIDEMap) {
-      tdcIDEMap_SortedPointers.push_back(&pair);
-    }
-
-    // This is a bunch of extra steps, due to needing a vector we can sort, and
-    // needing those items in the sorted vector to be the items from the sim
-    // channels (so a pointer to the IDEs inside the sim channels can be made).
-    // The work around is to make a vector of pointers to IDEs inside the
-    // TDCIDEMap (which is a constant reference to the fTDCIDEs in the
-    // SimChannel.)
-    auto pairSort = [](auto& a, auto& b) { return a->first < b->first; };
-    if (!std::is_sorted(
-          tdcIDEMap_SortedPointers.begin(), tdcIDEMap_SortedPointers.end(), pairSort)) {
-      std::sort(tdcIDEMap_SortedPointers.begin(), tdcIDEMap_SortedPointers.end(), pairSort);
+    std::size_t const iChannel = FindSimChannelIndex(hit.Channel());
+    if (iChannel == fSimChannels.size()) {
+      throw cet::exception("BackTracker") << "No sim::SimChannel corresponding "
+                                          << "to channel: " << hit.Channel() << "\n";
     }
 
-    std::vector<sim::IDE> dummyVec; // I need something to stick in a pair to compare pair<tdcVal,
-                                    // IDE>. This is an otherwise useless "hack".
-    std::pair<double, std::vector<sim::IDE>> start_tdcPair =
-      std::make_pair(start_tdc, dummyVec); // This pair is a "hack" to make my comparison work
-                                           // for lower and upper bound.
-    std::pair<double, std::vector<sim::IDE>> end_tdcPair = std::make_pair(end_tdc, dummyVec);
-    auto start_tdcPair_P = &start_tdcPair;
-    auto end_tdcPair_P = &end_tdcPair;
-    auto mapFirst = std::lower_bound(
-      tdcIDEMap_SortedPointers.begin(), tdcIDEMap_SortedPointers.end(), start_tdcPair_P, pairSort);
-
-    // iterator to just after the last interesting IDE
-    auto mapLast = std::upper_bound(
-      tdcIDEMap_SortedPointers.begin(), tdcIDEMap_SortedPointers.end(), end_tdcPair_P, pairSort);
-    for (auto& mapitr = mapFirst; mapitr != mapLast; ++mapitr) {
+    // the TDC entries of the channel were sorted once for the event
+    PrepTDCIndex();
+    auto const [mapFirst, mapLast] = TDCRange(iChannel, start_tdc, end_tdc);
+    for (auto mapitr = mapFirst; mapitr != mapLast; ++mapitr) {
       for (auto& ide : (*mapitr)->second) {
         retVec.push_back(&ide);
       } // Add all interesting IDEs to the retVec
@@ -11,6 +11,8 @@
 #ifndef CHEAT_BACKTRACKER_H
 #define CHEAT_BACKTRACKER_H
 
+#include <cstddef> // std::size_t
+#include <utility>
 #include <vector>
 
 #include "fhiclcpp/types/Atom.h"
@@ -153,6 +155,19 @@ namespace cheat {
       return this->HitToTrackIDEs(clockData, *hit);
     }
 
+    /**
+     * @brief Returns the track IDEs of each of the `hits`.
+     * @param clockData detector clocks information
+     * @param hits the hits to be backtracked
+     * @return a list of track IDEs for each hit, in the same order as `hits`
+     *
+     * The result is the same as calling `HitToTrackIDEs()` on each hit, but
+     * the hits are processed in parallel.
+     */
+    std::vector<std::vector<sim::TrackIDE>> HitsToTrackIDEs(
+      detinfo::DetectorClocksData const& clockData,
+      std::vector<art::Ptr<recob::Hit>> const& hits) const;
+
     std::vector<int> HitToTrackIds(detinfo::DetectorClocksData const& clockData,
                                    recob::Hit const& hit) const;
     //   std::vector< const int> HitToTrackId(art::Ptr<recob::Hit> const& hit) {
@@ -248,6 +263,56 @@ namespace cheat {
 
     mutable std::vector<art::Ptr<sim::SimChannel>> fSimChannels;
 
+    /// Entry of the track ID -> IDE index.
+    struct TrackIDEIndexEntry_t {
+      int trackID;              ///< Absolute value of the track ID of the IDE.
+      raw::ChannelID_t channel; ///< Channel of the IDE.
+      const sim::IDE* ide;
+    };
+
+    /// All IDEs of `fSimChannels`, by track ID and then in channel/TDC order;
+    /// built on the first track ID query of each event.
+    mutable std::vector<TrackIDEIndexEntry_t> fTrackIDEIndex;
+    mutable bool fTrackIDEIndexReady = false;
+
+    /// Type of the TDC entries in `sim::SimChannel::TDCIDEMap()`.
+    using TDCIDE_t = std::pair<unsigned short, std::vector<sim::IDE>>;
+
+    /// TDC entries of all `fSimChannels`, sorted by TDC within each channel;
+    /// those of `fSimChannels[i]` are between `fTDCIndexOffsets[i]` and
+    /// `fTDCIndexOffsets[i + 1]`. Built on the first hit query of each event.
+    mutable std::vector<const TDCIDE_t*> fTDCIndex;
+    mutable std::vector<std::size_t> fTDCIndexOffsets;
+    mutable bool fTDCIndexReady = false;
+
+    /// Drops the indices built on the current `fSimChannels`.
+    void ResetIndices() const;
+
+    /// Builds `fTDCIndex` if not done yet (not thread-safe).
+    void PrepTDCIndex() const;
+
+    /// Returns the position of the `channel` in `fSimChannels`, or their
+    /// number if not present.
+    std::size_t FindSimChannelIndex(raw::ChannelID_t channel) const;
+
+    /// Returns the TDC entries of `fSimChannels[iChannel]` within
+    /// `start_tdc` and `end_tdc` (included); requires `PrepTDCIndex()`.
+    std::pair<std::vector<const TDCIDE_t*>::const_iterator,
+              std::vector<const TDCIDE_t*>::const_iterator>
+    TDCRange(std::size_t iChannel, int start_tdc, int end_tdc) const;
+
+    /// `ChannelToTrackIDEs()` implementation; requires `PrepTDCIndex()`.
+    std::vector<sim::TrackIDE> ChannelToTrackIDEsImpl(
+      detinfo::DetectorClocksData const& clockData,
+      raw::ChannelID_t channel,
+      const double hit_start_time,
+      const double hit_end_time) const;
+
+    /// Returns the entries of `fTrackIDEIndex` for track ID `id`.
+    std::pair<std::vector<TrackIDEIndexEntry_t>::const_iterator,
+              std::vector<TrackIDEIndexEntry_t>::const_iterator>
+    TrackIdToIndexEntries(int id) const;
+
   }; // end class BackTracker
 
 } // end namespace cheat
@@ -21,7 +21,7 @@ namespace cheat {
       throw cet::exception("BackTracker") << "BackTracker cannot function. "
                                           << "Is this file real data?";
     }
-    fSimChannels.clear();
+    this->ClearEvent();
     this->PrepSimChannels(evt);
     //this->PrepAllHitList ( evt ); //This line temporarily commented out until I figure out how I want PrepAllHitList to work.
   }
@@ -42,6 +42,7 @@ namespace cheat {
     };
     if (!std::is_sorted(fSimChannels.begin(), fSimChannels.end(), comparesclambda))
       std::sort(fSimChannels.begin(), fSimChannels.end(), comparesclambda);
+    this->ResetIndices();
   }
 
   //--------------------------------------------------------------------
@@ -176,6 +176,16 @@ namespace cheat {
     return BackTracker::HitToTrackIDEs(clockData, hit);
   }
 
+  //---------------------------------------------------------------------
+  std::vector<std::vector<sim::TrackIDE>> BackTrackerService::HitsToTrackIDEs(
+    detinfo::DetectorClocksData const& clockData,
+    std::vector<art::Ptr<recob::Hit>> const& hits) const
+  {
+    // Removed until Lazy Rebuild works
+    // if(!this->priv_SimChannelsReady()){this->priv_PrepSimChannels();}
+    return BackTracker::HitsToTrackIDEs(clockData, hits);
+  }
+
   //---------------------------------------------------------------------
   std::vector<int> BackTrackerService::HitToTrackIds(detinfo::DetectorClocksData const& clockData,
                                                      recob::Hit const& hit) const
@@ -76,6 +76,9 @@ namespace cheat {
                                               recob::Hit const& hit) const;
     std::vector<sim::TrackIDE> HitToTrackIDEs(detinfo::DetectorClocksData const& clockData,
                                               art::Ptr<recob::Hit> const& hit) const;
+    std::vector<std::vector<sim::TrackIDE>> HitsToTrackIDEs(
+      detinfo::DetectorClocksData const& clockData,
+      std::vector<art::Ptr<recob::Hit>> const& hits) const;
 
     std::vector<int> HitToTrackIds(detinfo::DetectorClocksData const& clockData,
                                    recob::Hit const& hit) const;
@@ -0,0 +1,156 @@
+/**
+ * @file   ConvertPhotonLibraryToMapped.cc
+ * @brief  Converts a ROOT tree photon library into the memory-mappable format.
+ * @see    `phot::PhotonLibraryMapped`
+ *
+ * Run with `--help` argument for usage instructions.
+ *
+ * The voxelization is read from the metadata of the source library; libraries
+ * without metadata need the voxelization to be specified with `--grid`.
+ */
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/PhotonLibrary.h"
+#include "larsim/PhotonPropagation/PhotonLibraryMapped.h"
+#include "larsim/Simulation/PhotonVoxels.h"
+
+// ROOT
+#include "RooInt.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TKey.h"
+
+// POSIX/UNIX
+#include <getopt.h> // getopt_long(), option
+
+// C/C++ standard libraries
+#include <cstdlib> // std::exit()
+#include <exception>
+#include <iostream>
+#include <memory> // std::unique_ptr
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace {
+
+  void printHelp(const char* progName, int exitCode)
+  {
+    std::cout
+      << "Converts a photon library from ROOT tree format to the flat binary format"
+         " that can be memory-mapped by `phot::PhotonLibraryMapped`."
+         "\n"
+         "\nUsage:  "
+      << progName
+      << "  [options] [--] inputROOTfile outputFile"
+         "\n"
+         "\nOptions:"
+         "\n--reflected , -r"
+         "\n    also convert the reflected light visibility"
+         "\n--reflT0 , -t"
+         "\n    also convert the reflected light arrival time"
+         "\n--grid=\"XMIN XMAX NX YMIN YMAX NY ZMIN ZMAX NZ\" , -g ..."
+         "\n    voxelization of the library (required if the source has no metadata;"
+         "\n    ignored otherwise)"
+         "\n--help , -h"
+         "\n    print these usage instructions and exit"
+      << std::endl;
+    std::exit(exitCode);
+  } // printHelp()
+
+  /// Parses the voxel definition from a string of 9 space-separated values.
+  std::optional<sim::PhotonVoxelDef> parseGrid(std::string const& spec)
+  {
+    std::istringstream sstr(spec);
+    double xMin, xMax, yMin, yMax, zMin, zMax;
+    int xN, yN, zN;
+    if (!(sstr >> xMin >> xMax >> xN >> yMin >> yMax >> yN >> zMin >> zMax >> zN))
+      return std::nullopt;
+    return sim::PhotonVoxelDef(xMin, xMax, xN, yMin, yMax, yN, zMin, zMax, zN);
+  } // parseGrid()
+
+  /// Returns the number of voxels from the library metadata, if present.
+  std::optional<std::size_t> readNVoxels(std::string const& fileName)
+  {
+    std::unique_ptr<TFile> file{TFile::Open(fileName.c_str())};
+    if (!file || file->IsZombie()) return std::nullopt;
+
+    TDirectory* dir = file.get();
+    if (!dir->Get("PhotonLibraryData")) {
+      TKey* key = file->FindKeyAny("PhotonLibraryData");
+      if (!key) return std::nullopt;
+      dir = key->GetMotherDir();
+    }
+
+    std::size_t nVoxels = 1U;
+    for (char const* key : {"NDivX", "NDivY", "NDivZ"}) {
+      RooInt const* value = dir->Get<RooInt>(key);
+      if (!value) return std::nullopt;
+      nVoxels *= static_cast<Int_t>(*value);
+    }
+    return nVoxels;
+  } // readNVoxels()
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  static const option longopts[] = {{"reflected", no_argument, nullptr, 'r'},
+                                    {"reflT0", no_argument, nullptr, 't'},
+                                    {"grid", required_argument, nullptr, 'g'},
+                                    {"help", no_argument, nullptr, 'h'},
+                                    {nullptr, 0, nullptr, 0}};
+
+  bool storeReflected = false;
+  bool storeReflT0 = false;
+  std::optional<sim::PhotonVoxelDef> grid;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "rtg:h", longopts, nullptr)) != -1) {
+    switch (opt) {
+    case 'r': storeReflected = true; break;
+    case 't': storeReflT0 = true; break;
+    case 'g':
+      grid = parseGrid(optarg);
+      if (!grid) {
+        std::cerr << "Invalid grid specification: '" << optarg << "'" << std::endl;
+        return 1;
+      }
+      break;
+    case 'h': printHelp(argv[0], 0); break;
+    default: printHelp(argv[0], 1);
+    } // switch
+  }   // while
+
+  if (argc - optind != 2) printHelp(argv[0], 1);
+  std::string const sourcePath = argv[optind];
+  std::string const destPath = argv[optind + 1];
+
+  try {
+    std::optional<std::size_t> nVoxels = readNVoxels(sourcePath);
+    if (!nVoxels) {
+      if (!grid) {
+        std::cerr << "Library '" << sourcePath
+                  << "' has no voxel metadata: please specify it with `--grid`." << std::endl;
+        return 1;
+      }
+      nVoxels = grid->GetNVoxels();
+    }
+
+    phot::PhotonLibrary lib;
+    lib.LoadLibraryFromFile(sourcePath, *nVoxels, storeReflected, storeReflT0);
+    if (!lib.hasVoxelDef()) lib.SetVoxelDef(*grid);
+
+    phot::PhotonLibraryMapped::StoreLibraryToFile(
+      lib, lib.GetVoxelDef(), destPath, storeReflected, storeReflT0);
+  }
+  catch (std::exception const& e) {
+    std::cerr << "Conversion of '" << sourcePath << "' failed:\n" << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Photon library '" << sourcePath << "' converted into '" << destPath << "'"
+            << std::endl;
+  return 0;
+} // main()
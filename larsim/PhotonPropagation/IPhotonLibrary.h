@@ -23,10 +23,6 @@ namespace phot {
     /// (which is not part of this interface yet).
     using Params_t = std::vector<float> const*;
 
-    /// Type for parametrization function
-    /// (which is not part of this interface yet).
-    using Functions_t = TF1*;
-
     virtual ~IPhotonLibrary() = default;
 
     virtual float GetCount(size_t Voxel, size_t OpChannel) const = 0;
@@ -43,6 +43,7 @@
 #include "larsim/PhotonPropagation/PropagationTimeModel.h"
 #include "larsim/PhotonPropagation/ScintTimeTools/ScintTime.h"
 #include "larsim/PhotonPropagation/SemiAnalyticalModel.h"
+#include "larsim/Simulation/LitePhotonAccumulator.h"
 
 #include "nurandom/RandomUtils/NuRandomService.h"
 
@@ -65,14 +66,42 @@
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 // Random numbers
+#include "CLHEP/Random/MixMaxRng.h"
 #include "CLHEP/Random/RandPoissonQ.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
 #include <cmath>
 #include <ctime>
+#include <limits>
 #include <map>
 #include <memory>
 #include <vector>
 
+namespace {
+
+  /// Returns the backtracking record of `n` photons of a step detected at the same time.
+  /// The photons are accumulated one at a time, exactly as adding them one by one to a
+  /// `sim::OpDetBacktrackerRecord` would do.
+  sim::SDP stepSDP(int trackID, std::ptrdiff_t n, double const* pos, double edeposit)
+  {
+    sim::SDP sdp(trackID, 1., edeposit, pos[0], pos[1], pos[2]);
+    for (std::ptrdiff_t i = 1; i < n; ++i) {
+      double const weight = sdp.numPhotons + 1.;
+      sdp.x = (sdp.x * sdp.numPhotons + pos[0]) / weight;
+      sdp.y = (sdp.y * sdp.numPhotons + pos[1]) / weight;
+      sdp.z = (sdp.z * sdp.numPhotons + pos[2]) / weight;
+      sdp.numPhotons = weight;
+      sdp.energy = sdp.energy + edeposit;
+    }
+    return sdp;
+  }
+
+} // local namespace
+
 namespace phot {
   class PDFastSimPAR : public art::EDProducer {
   public:
@@ -125,6 +154,12 @@ namespace phot {
       DP VUVHits{Name("VUVHits"), Comment("Configuration for UV visibility parameterization")};
       ODP VISHits{Name("VISHits"),
                   Comment("Configuration for visibile visibility parameterization")};
+      fhicl::Atom<unsigned int> NThreads{
+        Name("NThreads"),
+        Comment("Threads simulating the deposits in parallel, each deposit with its own random "
+                "stream (results do not depend on the number of threads); 0 (default) "
+                "simulates the deposits in order from the module random engines"),
+        0U};
     };
     using Parameters = art::EDProducer::Table<Config>;
 
@@ -132,13 +167,118 @@ namespace phot {
     void produce(art::Event&) override;
 
   private:
-    void detectedNumPhotons(std::vector<int>& DetectedNumPhotons,
+    /// Number of energy deposits whose detected photons are sampled in one pass.
+    static constexpr size_t DepositBatchSize = 256;
+
+    /// Photons detected by a channel from one energy deposit at the same time.
+    struct PhotonGroup_t {
+      size_t deposit; ///< Index of the deposit in the input collection.
+      unsigned int channel;
+      bool reflected;
+      int time;  ///< Detection time [ns]
+      int count; ///< Number of photons.
+    };
+
+    /// Photon counters, for the log.
+    struct PhotonCounts_t {
+      int fast = 0;
+      int slow = 0;
+      PhotonCounts_t& operator+=(PhotonCounts_t const& other)
+      {
+        fast += other.fast;
+        slow += other.slow;
+        return *this;
+      }
+    };
+
+    /// Working buffers, reused across deposits and events.
+    struct Scratch_t {
+      std::vector<size_t> deposits;    ///< Selected deposits of the batch.
+      std::vector<geo::Point_t> points; ///< Their scintillation points.
+      /// Detected photons, one row of `fNOpChannels` per selected deposit.
+      std::vector<int> detectedFast, detectedSlow;
+      std::vector<int> reflDetectedFast, reflDetectedSlow;
+      std::vector<int> anodeDetected; ///< One deposit.
+      std::vector<double> visibilities;
+      std::vector<double> transportTime;
+      std::vector<double> scintTimes; ///< Emission times of one channel.
+      std::vector<int> photonTimes;
+      std::vector<PhotonGroup_t> groups;
+
+      void resize(size_t nDeposits, size_t nChannels, bool reflected);
+    };
+
+    /// Random engine and tools drawing from it, for one thread of the parallel mode.
+    struct Worker_t {
+      CLHEP::MixMaxRng engine;
+      long seeds[4]; ///< Seeds of the current deposit (the engine keeps a pointer).
+      CLHEP::RandPoissonQ randPoissPhot{engine};
+      std::unique_ptr<ScintTime> scintTime;
+      std::unique_ptr<PropagationTimeModel> propTimeModel;
+      Scratch_t scratch;
+    };
+
+    /// Output collections.
+    struct Output_t {
+      std::vector<sim::SimPhotonsLite> dirLite, refLite;
+      sim::LitePhotonAccumulator dirLiteCounts, refLiteCounts; ///< Their counts.
+      std::vector<sim::OpDetBacktrackerRecord> dirBTR, refBTR;
+      std::vector<int> dirBTRIndex, refBTRIndex; ///< Where each OpChan is.
+      std::vector<sim::SimPhotons> dirPhotons, refPhotons;
+    };
+
+    /// Simulates the deposits in order, drawing from the module random engines.
+    void simulateSequential(std::vector<sim::SimEnergyDeposit> const& edeps,
+                            Output_t& out,
+                            PhotonCounts_t& emitted,
+                            PhotonCounts_t& detected);
+
+    /// Simulates the deposits in parallel, each one with its own random stream.
+    void simulateParallel(art::EventID const& eventID,
+                          std::vector<sim::SimEnergyDeposit> const& edeps,
+                          Output_t& out,
+                          PhotonCounts_t& emitted,
+                          PhotonCounts_t& detected);
+
+    /// Returns whether the deposit is simulated, and its scintillation point.
+    bool selectDeposit(sim::SimEnergyDeposit const& edep,
+                       PhotonCounts_t& emitted,
+                       geo::Point_t& ScintPoint) const;
+
+    /// Samples the photons detected by each channel into row `row` of the scratch.
+    void sampleDetectedPhotons(CLHEP::RandPoissonQ& randPoissPhot,
+                               Scratch_t& scratch,
+                               size_t row,
+                               sim::SimEnergyDeposit const& edep,
+                               geo::Point_t const& ScintPoint) const;
+
+    /// Samples the arrival time of the photons in row `row` of the scratch.
+    void samplePhotonTimes(ScintTime& scintTime,
+                           PropagationTimeModel* propTimeModel,
+                           Scratch_t& scratch,
+                           size_t row,
+                           size_t iDep,
+                           sim::SimEnergyDeposit const& edep,
+                           geo::Point_t const& ScintPoint,
+                           PhotonCounts_t& detected) const;
+
+    /// Adds the photon groups to the output, in order.
+    void storePhotons(std::vector<PhotonGroup_t> const& groups,
+                      std::vector<sim::SimEnergyDeposit> const& edeps,
+                      Output_t& out) const;
+
+    void detectedNumPhotons(CLHEP::RandPoissonQ& randPoissPhot,
+                            int* DetectedNumPhotons,
                             const std::vector<double>& OpDetVisibilities,
                             const int NumPhotons) const;
 
+    /// Adds `count` photons detected by `channel` at `time` from `edep` to its record.
     void AddOpDetBTR(std::vector<sim::OpDetBacktrackerRecord>& opbtr,
                      std::vector<int>& ChannelMap,
-                     const sim::OpDetBacktrackerRecord& btr) const;
+                     size_t channel,
+                     sim::SimEnergyDeposit const& edep,
+                     int time,
+                     int count) const;
 
     bool isOpDetInSameTPC(geo::Point_t const& ScintPoint, geo::Point_t const& OpDetPoint) const;
     std::vector<geo::Point_t> opDetCenters() const;
@@ -176,6 +316,13 @@ namespace phot {
     const bool fOnlyActiveVolume;
     const bool fOnlyOneCryostat;
     const bool fUseXeAbsorption;
+    const unsigned int fNThreads;
+
+    Scratch_t fScratch;
+
+    // parallel mode
+    std::unique_ptr<tbb::task_arena> fArena;
+    std::vector<std::unique_ptr<Worker_t>> fWorkers; ///< One per arena slot.
   };
 
   //......................................................................
@@ -213,6 +360,7 @@ namespace phot {
     , fOnlyActiveVolume(config().OnlyActiveVolume())
     , fOnlyOneCryostat(config().OnlyOneCryostat())
     , fUseXeAbsorption(config().UseXeAbsorption())
+    , fNThreads(config().NThreads())
   {
     mf::LogInfo("PDFastSimPAR") << "Initializing PDFastSimPAR." << std::endl;
 
@@ -298,6 +446,26 @@ namespace phot {
         produces<std::vector<sim::SimPhotons>>("Reflected");
       }
     }
+
+    fScratch.resize(DepositBatchSize, fNOpChannels, fDoReflectedLight);
+
+    // parallel mode: each slot of the arena has its own engine and tools
+    if (fNThreads > 0) {
+      mf::LogInfo("PDFastSimPAR") << "Simulating deposits on " << fNThreads << " threads";
+      fArena = std::make_unique<tbb::task_arena>(fNThreads);
+      for (unsigned int i = 0; i < fNThreads; ++i) {
+        auto worker = std::make_unique<Worker_t>();
+        worker->scintTime =
+          art::make_tool<phot::ScintTime>(config().ScintTimeTool.get<fhicl::ParameterSet>());
+        worker->scintTime->initRand(worker->engine);
+        if (fIncludePropTime)
+          worker->propTimeModel = std::make_unique<PropagationTimeModel>(
+            VUVTimingParams, VISTimingParams, worker->engine, fDoReflectedLight, fGeoPropTimeOnly);
+        worker->scratch.resize(1U, fNOpChannels, fDoReflectedLight);
+        fWorkers.push_back(std::move(worker));
+      }
+    }
+
     mf::LogInfo("PDFastSimPAR") << "PDFastSimPAR Initialization finish.\n"
                                 << "Simulate using semi-analytic model for number of hits."
                                 << std::endl;
@@ -309,35 +477,25 @@ namespace phot {
     mf::LogTrace("PDFastSimPAR") << "PDFastSimPAR Module Producer"
                                  << "EventID: " << event.event();
 
-    std::vector<int> PDChannelToSOCMapDirect(fNOpChannels, -1);  // Where each OpChan is.
-    std::vector<int> PDChannelToSOCMapReflect(fNOpChannels, -1); // Where each OpChan is.
-
-    // SimPhotonsLite
-    auto phlit = std::make_unique<std::vector<sim::SimPhotonsLite>>();
-    auto opbtr = std::make_unique<std::vector<sim::OpDetBacktrackerRecord>>();
-    auto phlit_ref = std::make_unique<std::vector<sim::SimPhotonsLite>>();
-    auto opbtr_ref = std::make_unique<std::vector<sim::OpDetBacktrackerRecord>>();
-    auto& dir_phlitcol(*phlit);
-    auto& ref_phlitcol(*phlit_ref);
-    // SimPhotons
-    auto phot = std::make_unique<std::vector<sim::SimPhotons>>();
-    auto phot_ref = std::make_unique<std::vector<sim::SimPhotons>>();
-    auto& dir_photcol(*phot);
-    auto& ref_photcol(*phot_ref);
+    Output_t out;
+    out.dirBTRIndex.assign(fNOpChannels, -1);
+    out.refBTRIndex.assign(fNOpChannels, -1);
     if (fUseLitePhotons) {
-      dir_phlitcol.resize(fNOpChannels);
-      ref_phlitcol.resize(fNOpChannels);
+      out.dirLite.resize(fNOpChannels);
+      out.refLite.resize(fNOpChannels);
+      out.dirLiteCounts.resize(fNOpChannels);
+      out.refLiteCounts.resize(fNOpChannels);
       for (unsigned int i = 0; i < fNOpChannels; i++) {
-        dir_phlitcol[i].OpChannel = i;
-        ref_phlitcol[i].OpChannel = i;
+        out.dirLite[i].OpChannel = i;
+        out.refLite[i].OpChannel = i;
       }
     }
     else { // SimPhotons
-      dir_photcol.resize(fNOpChannels);
-      ref_photcol.resize(fNOpChannels);
+      out.dirPhotons.resize(fNOpChannels);
+      out.refPhotons.resize(fNOpChannels);
       for (unsigned int i = 0; i < fNOpChannels; i++) {
-        dir_photcol[i].fOpChannel = i;
-        ref_photcol[i].fOpChannel = i;
+        out.dirPhotons[i].fOpChannel = i;
+        out.refPhotons[i].fOpChannel = i;
       }
     }
 
@@ -347,230 +505,390 @@ namespace phot {
       return;
     }
 
-    auto const& edeps = edepHandle;
+    auto const& edeps = *edepHandle;
+
+    PhotonCounts_t emitted;
+    PhotonCounts_t detected;
+    if (fArena)
+      simulateParallel(event.id(), edeps, out, emitted, detected);
+    else
+      simulateSequential(edeps, out, emitted, detected);
+
+    mf::LogTrace("PDFastSimPAR") << "Total points: " << edeps.size()
+                                 << ", total fast photons: " << emitted.fast
+                                 << ", total slow photons: " << emitted.slow
+                                 << "\ndetected fast photons: " << detected.fast
+                                 << ", detected slow photons: " << detected.slow;
+
+    if (fUseLitePhotons) {
+      out.dirLiteCounts.fill(out.dirLite);
+      out.refLiteCounts.fill(out.refLite);
+      event.put(std::make_unique<std::vector<sim::SimPhotonsLite>>(std::move(out.dirLite)));
+      event.put(std::make_unique<std::vector<sim::OpDetBacktrackerRecord>>(std::move(out.dirBTR)));
+      if (fDoReflectedLight) {
+        event.put(std::make_unique<std::vector<sim::SimPhotonsLite>>(std::move(out.refLite)),
+                  "Reflected");
+        event.put(
+          std::make_unique<std::vector<sim::OpDetBacktrackerRecord>>(std::move(out.refBTR)),
+          "Reflected");
+      }
+    }
+    else {
+      event.put(std::make_unique<std::vector<sim::SimPhotons>>(std::move(out.dirPhotons)));
+      if (fDoReflectedLight) {
+        event.put(std::make_unique<std::vector<sim::SimPhotons>>(std::move(out.refPhotons)),
+                  "Reflected");
+      }
+    }
+
+    return;
+  }
+
+  //......................................................................
+  // The deposits are processed in batches: first the numbers of detected photons of all
+  // the deposits in the batch are sampled, then their arrival times. The two passes draw
+  // from separate random engines, each one in the same sequence as a deposit-by-deposit
+  // processing would, so the result does not depend on the batch size.
+  void PDFastSimPAR::simulateSequential(std::vector<sim::SimEnergyDeposit> const& edeps,
+                                        Output_t& out,
+                                        PhotonCounts_t& emitted,
+                                        PhotonCounts_t& detected)
+  {
+    Scratch_t& scratch = fScratch;
+    for (size_t batchStart = 0; batchStart < edeps.size(); batchStart += DepositBatchSize) {
+      size_t const batchEnd = std::min(batchStart + DepositBatchSize, edeps.size());
+
+      // first pass: selection of the deposits and number of detected photons
+      scratch.deposits.clear();
+      scratch.points.clear();
+      for (size_t iDep = batchStart; iDep < batchEnd; ++iDep) {
+        geo::Point_t ScintPoint;
+        if (!selectDeposit(edeps[iDep], emitted, ScintPoint)) continue;
+        sampleDetectedPhotons(
+          *fRandPoissPhot, scratch, scratch.deposits.size(), edeps[iDep], ScintPoint);
+        scratch.deposits.push_back(iDep);
+        scratch.points.push_back(ScintPoint);
+      }
+
+      // second pass: arrival times of the detected photons
+      scratch.groups.clear();
+      for (size_t row = 0; row < scratch.deposits.size(); ++row) {
+        size_t const iDep = scratch.deposits[row];
+        samplePhotonTimes(*fScintTime,
+                          fPropTimeModel.get(),
+                          scratch,
+                          row,
+                          iDep,
+                          edeps[iDep],
+                          scratch.points[row],
+                          detected);
+      }
+      storePhotons(scratch.groups, edeps, out);
+    } // for batches
+  }
+
+  //......................................................................
+  // The deposits are split in batches simulated by the threads of the arena. The random
+  // engine of the thread is reseeded for each deposit from its index and the event ID,
+  // and the photons of each batch are stored in order after the batches are completed,
+  // so that the result does not depend on the number of threads.
+  void PDFastSimPAR::simulateParallel(art::EventID const& eventID,
+                                      std::vector<sim::SimEnergyDeposit> const& edeps,
+                                      Output_t& out,
+                                      PhotonCounts_t& emitted,
+                                      PhotonCounts_t& detected)
+  {
+    long const baseSeed = fPhotonEngine.getSeed();
+    long const eventSeed = (long(eventID.subRun()) * 0x9E3779B1L) ^ long(eventID.event());
+
+    struct BatchResult_t {
+      std::vector<PhotonGroup_t> groups;
+      PhotonCounts_t emitted;
+      PhotonCounts_t detected;
+    };
+
+    // batches are simulated in rounds, to bound the memory held by their results
+    size_t const nBatches = (edeps.size() + DepositBatchSize - 1) / DepositBatchSize;
+    size_t const roundSize = 4 * fWorkers.size();
+    std::vector<BatchResult_t> results(std::min(roundSize, nBatches));
+
+    auto simulateBatch = [&](size_t iBatch, BatchResult_t& result) {
+      Worker_t& worker = *fWorkers[tbb::this_task_arena::current_thread_index()];
+      result.groups.clear();
+      result.emitted = PhotonCounts_t{};
+      result.detected = PhotonCounts_t{};
+      worker.scratch.groups.clear();
+      size_t const batchEnd = std::min((iBatch + 1) * DepositBatchSize, edeps.size());
+      for (size_t iDep = iBatch * DepositBatchSize; iDep < batchEnd; ++iDep) {
+        geo::Point_t ScintPoint;
+        if (!selectDeposit(edeps[iDep], result.emitted, ScintPoint)) continue;
+
+        worker.seeds[0] = baseSeed;
+        worker.seeds[1] = eventID.run();
+        worker.seeds[2] = eventSeed;
+        worker.seeds[3] = iDep;
+        worker.engine.setSeeds(worker.seeds, 4);
+
+        sampleDetectedPhotons(worker.randPoissPhot, worker.scratch, 0, edeps[iDep], ScintPoint);
+        samplePhotonTimes(*worker.scintTime,
+                          worker.propTimeModel.get(),
+                          worker.scratch,
+                          0,
+                          iDep,
+                          edeps[iDep],
+                          ScintPoint,
+                          result.detected);
+      }
+      std::swap(result.groups, worker.scratch.groups);
+    };
 
-    int num_points = 0;
-    int num_fastph = 0;
-    int num_slowph = 0;
-    int num_fastdp = 0;
-    int num_slowdp = 0;
+    for (size_t roundStart = 0; roundStart < nBatches; roundStart += roundSize) {
+      size_t const roundEnd = std::min(roundStart + roundSize, nBatches);
+      fArena->execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(roundStart, roundEnd),
+                          [&](tbb::blocked_range<size_t> const& range) {
+                            for (size_t iBatch = range.begin(); iBatch < range.end(); ++iBatch)
+                              simulateBatch(iBatch, results[iBatch - roundStart]);
+                          });
+      });
+      for (size_t iBatch = roundStart; iBatch < roundEnd; ++iBatch) {
+        BatchResult_t const& result = results[iBatch - roundStart];
+        storePhotons(result.groups, edeps, out);
+        emitted += result.emitted;
+        detected += result.detected;
+      }
+    } // for rounds
+  }
 
-    for (auto const& edepi : *edeps) {
-      num_points++;
+  //......................................................................
+  bool PDFastSimPAR::selectDeposit(sim::SimEnergyDeposit const& edep,
+                                   PhotonCounts_t& emitted,
+                                   geo::Point_t& ScintPoint) const
+  {
+    int nphot_fast = edep.NumFPhotons();
+    int nphot_slow = edep.NumSPhotons();
 
-      int nphot_fast = edepi.NumFPhotons();
-      int nphot_slow = edepi.NumSPhotons();
+    emitted.fast += nphot_fast;
+    emitted.slow += nphot_slow;
 
-      num_fastph += nphot_fast;
-      num_slowph += nphot_slow;
+    if (!((nphot_fast > 0 && fDoFastComponent) || (nphot_slow > 0 && fDoSlowComponent)))
+      return false;
 
-      if (!((nphot_fast > 0 && fDoFastComponent) || (nphot_slow > 0 && fDoSlowComponent))) continue;
+    ScintPoint = {edep.MidPointX(), edep.MidPointY(), edep.MidPointZ()};
 
-      int trackID = edepi.TrackID();
-      int nphot = edepi.NumPhotons();
-      double edeposit = edepi.Energy() / nphot;
-      double pos[3] = {edepi.MidPointX(), edepi.MidPointY(), edepi.MidPointZ()};
-      geo::Point_t const ScintPoint = {pos[0], pos[1], pos[2]};
+    return !fOnlyActiveVolume || fISTPC.isScintInActiveVolume(ScintPoint);
+  }
 
-      if (fOnlyActiveVolume && !fISTPC.isScintInActiveVolume(ScintPoint)) continue;
+  //......................................................................
+  void PDFastSimPAR::sampleDetectedPhotons(CLHEP::RandPoissonQ& randPoissPhot,
+                                           Scratch_t& scratch,
+                                           size_t row,
+                                           sim::SimEnergyDeposit const& edep,
+                                           geo::Point_t const& ScintPoint) const
+  {
+    int const nphot_fast = edep.NumFPhotons();
+    int const nphot_slow = edep.NumSPhotons();
+    size_t const offset = row * fNOpChannels;
 
-      // direct light
-      std::vector<int> DetectedNumFast(fNOpChannels);
-      std::vector<int> DetectedNumSlow(fNOpChannels);
+    // direct light
+    int* DetectedNumFast = scratch.detectedFast.data() + offset;
+    int* DetectedNumSlow = scratch.detectedSlow.data() + offset;
 
-      std::vector<double> OpDetVisibilities;
-      fVisibilityModel->detectedDirectVisibilities(OpDetVisibilities, ScintPoint);
-      detectedNumPhotons(DetectedNumFast, OpDetVisibilities, nphot_fast);
-      detectedNumPhotons(DetectedNumSlow, OpDetVisibilities, nphot_slow);
+    std::vector<double>& OpDetVisibilities = scratch.visibilities;
+    fVisibilityModel->detectedDirectVisibilities(OpDetVisibilities, ScintPoint);
+    detectedNumPhotons(randPoissPhot, DetectedNumFast, OpDetVisibilities, nphot_fast);
+    detectedNumPhotons(randPoissPhot, DetectedNumSlow, OpDetVisibilities, nphot_slow);
 
-      if (fIncludeAnodeReflections) {
-        std::vector<int> AnodeDetectedNumFast(fNOpChannels);
-        std::vector<int> AnodeDetectedNumSlow(fNOpChannels);
+    if (fIncludeAnodeReflections) {
+      int* AnodeDetectedNum = scratch.anodeDetected.data();
 
-        std::vector<double> OpDetVisibilitiesAnode;
-        fVisibilityModel->detectedReflectedVisibilities(OpDetVisibilitiesAnode, ScintPoint, true);
-        detectedNumPhotons(AnodeDetectedNumFast, OpDetVisibilitiesAnode, nphot_fast);
-        detectedNumPhotons(AnodeDetectedNumSlow, OpDetVisibilitiesAnode, nphot_slow);
+      fVisibilityModel->detectedReflectedVisibilities(OpDetVisibilities, ScintPoint, true);
 
-        // add to existing count
-        for (size_t i = 0; i < AnodeDetectedNumFast.size(); ++i) {
-          DetectedNumFast[i] += AnodeDetectedNumFast[i];
-        }
-        for (size_t i = 0; i < AnodeDetectedNumSlow.size(); ++i) {
-          DetectedNumSlow[i] += AnodeDetectedNumSlow[i];
-        }
+      // add to existing count
+      detectedNumPhotons(randPoissPhot, AnodeDetectedNum, OpDetVisibilities, nphot_fast);
+      for (size_t i = 0; i < fNOpChannels; ++i) {
+        DetectedNumFast[i] += AnodeDetectedNum[i];
       }
-
-      // reflected light, if enabled
-      std::vector<int> ReflDetectedNumFast(fNOpChannels);
-      std::vector<int> ReflDetectedNumSlow(fNOpChannels);
-      if (fDoReflectedLight) {
-        std::vector<double> OpDetVisibilitiesRefl;
-        fVisibilityModel->detectedReflectedVisibilities(OpDetVisibilitiesRefl, ScintPoint, false);
-        detectedNumPhotons(ReflDetectedNumFast, OpDetVisibilitiesRefl, nphot_fast);
-        detectedNumPhotons(ReflDetectedNumSlow, OpDetVisibilitiesRefl, nphot_slow);
+      detectedNumPhotons(randPoissPhot, AnodeDetectedNum, OpDetVisibilities, nphot_slow);
+      for (size_t i = 0; i < fNOpChannels; ++i) {
+        DetectedNumSlow[i] += AnodeDetectedNum[i];
       }
+    }
 
-      // loop through direct photons then reflected photons cases
-      size_t DoReflected = (fDoReflectedLight) ? 1 : 0;
-      for (size_t Reflected = 0; Reflected <= DoReflected; ++Reflected) {
-        for (size_t channel = 0; channel < fNOpChannels; channel++) {
+    // reflected light, if enabled
+    if (fDoReflectedLight) {
+      fVisibilityModel->detectedReflectedVisibilities(OpDetVisibilities, ScintPoint, false);
+      detectedNumPhotons(
+        randPoissPhot, scratch.reflDetectedFast.data() + offset, OpDetVisibilities, nphot_fast);
+      detectedNumPhotons(
+        randPoissPhot, scratch.reflDetectedSlow.data() + offset, OpDetVisibilities, nphot_slow);
+    }
+  }
 
-          if (fOpaqueCathode && !isOpDetInSameTPC(ScintPoint, fOpDetCenter[channel])) continue;
+  //......................................................................
+  void PDFastSimPAR::samplePhotonTimes(ScintTime& scintTime,
+                                       PropagationTimeModel* propTimeModel,
+                                       Scratch_t& scratch,
+                                       size_t row,
+                                       size_t iDep,
+                                       sim::SimEnergyDeposit const& edep,
+                                       geo::Point_t const& ScintPoint,
+                                       PhotonCounts_t& detected) const
+  {
+    size_t const offset = row * fNOpChannels;
+    std::vector<double>& transport_time = scratch.transportTime;
+    std::vector<double>& scint_times = scratch.scintTimes;
+    std::vector<int>& times = scratch.photonTimes;
+
+    // loop through direct photons then reflected photons cases
+    size_t DoReflected = (fDoReflectedLight) ? 1 : 0;
+    for (size_t Reflected = 0; Reflected <= DoReflected; ++Reflected) {
+      int const* DetectedNumFast =
+        (Reflected ? scratch.reflDetectedFast : scratch.detectedFast).data() + offset;
+      int const* DetectedNumSlow =
+        (Reflected ? scratch.reflDetectedSlow : scratch.detectedSlow).data() + offset;
+
+      for (size_t channel = 0; channel < fNOpChannels; channel++) {
+
+        if (fOpaqueCathode && !isOpDetInSameTPC(ScintPoint, fOpDetCenter[channel])) continue;
+
+        int ndetected_fast = DetectedNumFast[channel];
+        int ndetected_slow = DetectedNumSlow[channel];
+        if (!((ndetected_fast > 0 && fDoFastComponent) ||
+              (ndetected_slow > 0 && fDoSlowComponent)))
+          continue;
+
+        // calculate propagation time, does not matter whether fast or slow photon
+        if (fIncludePropTime) {
+          transport_time.resize(ndetected_fast + ndetected_slow);
+          propTimeModel->propagationTime(transport_time, ScintPoint, channel, Reflected);
+        }
 
-          int ndetected_fast = DetectedNumFast[channel];
-          int ndetected_slow = DetectedNumSlow[channel];
-          if (Reflected) {
-            ndetected_fast = ReflDetectedNumFast[channel];
-            ndetected_slow = ReflDetectedNumSlow[channel];
+        times.clear();
+        if (ndetected_fast > 0 && fDoFastComponent) {
+          int n = ndetected_fast;
+          detected.fast += n;
+          scint_times.resize(n);
+          scintTime.fastScintTimes(scint_times);
+          for (int i = 0; i < n; ++i) {
+            // calculates the time at which the photon was produced
+            double dtime = edep.StartT() + scint_times[i];
+            if (fIncludePropTime) dtime += transport_time[i];
+            times.push_back(static_cast<int>(std::round(dtime)));
           }
-          if (!((ndetected_fast > 0 && fDoFastComponent) ||
-                (ndetected_slow > 0 && fDoSlowComponent)))
-            continue;
-
-          // calculate propagation time, does not matter whether fast or slow photon
-          std::vector<double> transport_time;
-          if (fIncludePropTime) {
-            transport_time.resize(ndetected_fast + ndetected_slow);
-            fPropTimeModel->propagationTime(transport_time, ScintPoint, channel, Reflected);
+        }
+        if (ndetected_slow > 0 && fDoSlowComponent) {
+          int n = ndetected_slow;
+          detected.slow += n;
+          scint_times.resize(n);
+          scintTime.slowScintTimes(scint_times);
+          for (int i = 0; i < n; ++i) {
+            double dtime = edep.StartT() + scint_times[i];
+            if (fIncludePropTime) dtime += transport_time[ndetected_fast + i];
+            times.push_back(static_cast<int>(std::round(dtime)));
           }
+        }
 
-          // SimPhotonsLite case
-          if (fUseLitePhotons) {
-            sim::OpDetBacktrackerRecord tmpbtr(channel);
-            if (ndetected_fast > 0 && fDoFastComponent) {
-              int n = ndetected_fast;
-              num_fastdp += n;
-              for (int i = 0; i < n; ++i) {
-                // calculates the time at which the photon was produced
-                double dtime = edepi.StartT() + fScintTime->fastScintTime();
-                if (fIncludePropTime) dtime += transport_time[i];
-                int time = static_cast<int>(std::round(dtime));
-                if (Reflected)
-                  ++ref_phlitcol[channel].DetectedPhotons[time];
-                else
-                  ++dir_phlitcol[channel].DetectedPhotons[time];
-                tmpbtr.AddScintillationPhotons(trackID, time, 1, pos, edeposit);
-              }
-            }
-            if (ndetected_slow > 0 && fDoSlowComponent) {
-              int n = ndetected_slow;
-              num_slowdp += n;
-              for (int i = 0; i < n; ++i) {
-                double dtime = edepi.StartT() + fScintTime->slowScintTime();
-                if (fIncludePropTime) dtime += transport_time[ndetected_fast + i];
-                int time = static_cast<int>(std::round(dtime));
-                if (Reflected)
-                  ++ref_phlitcol[channel].DetectedPhotons[time];
-                else
-                  ++dir_phlitcol[channel].DetectedPhotons[time];
-                tmpbtr.AddScintillationPhotons(trackID, time, 1, pos, edeposit);
-              }
-            }
-            if (Reflected)
-              AddOpDetBTR(*opbtr_ref, PDChannelToSOCMapReflect, tmpbtr);
-            else
-              AddOpDetBTR(*opbtr, PDChannelToSOCMapDirect, tmpbtr);
-          }
-          // SimPhotons case
-          else {
-            sim::OnePhoton photon;
-            photon.SetInSD = false;
-            photon.InitialPosition = edepi.End();
-            photon.MotherTrackID = edepi.TrackID();
-            if (Reflected)
-              photon.Energy = 2.9 * CLHEP::eV; // 430 nm
-            else
-              photon.Energy = 9.7 * CLHEP::eV; // 128 nm
-            // TODO: un-hardcode and add another energy for Xe scintillation
-            if (ndetected_fast > 0 && fDoFastComponent) {
-              int n = ndetected_fast;
-              num_fastdp += n;
-              for (int i = 0; i < n; ++i) {
-                // calculates the time at which the photon was produced
-                double dtime = edepi.StartT() + fScintTime->fastScintTime();
-                if (fIncludePropTime) dtime += transport_time[i];
-                int time = static_cast<int>(std::round(dtime));
-                photon.Time = time;
-                if (Reflected)
-                  ref_photcol[channel].insert(ref_photcol[channel].end(), 1, photon);
-                else
-                  dir_photcol[channel].insert(dir_photcol[channel].end(), 1, photon);
-              }
-            }
-            if (ndetected_slow > 0 && fDoSlowComponent) {
-              int n = ndetected_slow;
-              num_slowdp += n;
-              for (int i = 0; i < n; ++i) {
-                double dtime = edepi.StartT() + fScintTime->slowScintTime();
-                if (fIncludePropTime) dtime += transport_time[ndetected_fast + i];
-                int time = static_cast<int>(std::round(dtime));
-                photon.Time = time;
-                if (Reflected)
-                  ref_photcol[channel].insert(ref_photcol[channel].end(), 1, photon);
-                else
-                  dir_photcol[channel].insert(dir_photcol[channel].end(), 1, photon);
-              }
-            }
-          }
+        // photons at the same time are grouped; backtracking records are filled in time
+        // order, while SimPhotons keep the order of generation
+        if (fUseLitePhotons) std::sort(times.begin(), times.end());
+        for (auto it = times.cbegin(); it != times.cend();) {
+          auto const next = std::find_if(it, times.cend(), [t = *it](int time) { return time != t; });
+          scratch.groups.push_back({iDep,
+                                    static_cast<unsigned int>(channel),
+                                    Reflected != 0,
+                                    *it,
+                                    static_cast<int>(next - it)});
+          it = next;
         }
       }
     }
+  }
 
-    mf::LogTrace("PDFastSimPAR") << "Total points: " << num_points
-                                 << ", total fast photons: " << num_fastph
-                                 << ", total slow photons: " << num_slowph
-                                 << "\ndetected fast photons: " << num_fastdp
-                                 << ", detected slow photons: " << num_slowdp;
-
-    if (fUseLitePhotons) {
-      event.put(move(phlit));
-      event.put(move(opbtr));
-      if (fDoReflectedLight) {
-        event.put(move(phlit_ref), "Reflected");
-        event.put(move(opbtr_ref), "Reflected");
+  //......................................................................
+  void PDFastSimPAR::storePhotons(std::vector<PhotonGroup_t> const& groups,
+                                  std::vector<sim::SimEnergyDeposit> const& edeps,
+                                  Output_t& out) const
+  {
+    for (PhotonGroup_t const& group : groups) {
+      sim::SimEnergyDeposit const& edep = edeps[group.deposit];
+
+      // SimPhotonsLite case
+      if (fUseLitePhotons) {
+        (group.reflected ? out.refLiteCounts : out.dirLiteCounts)
+          .add(group.channel, group.time, group.count);
+        if (group.reflected)
+          AddOpDetBTR(out.refBTR, out.refBTRIndex, group.channel, edep, group.time, group.count);
+        else
+          AddOpDetBTR(out.dirBTR, out.dirBTRIndex, group.channel, edep, group.time, group.count);
+      }
+      // SimPhotons case
+      else {
+        sim::OnePhoton photon;
+        photon.SetInSD = false;
+        photon.InitialPosition = edep.End();
+        photon.MotherTrackID = edep.TrackID();
+        if (group.reflected)
+          photon.Energy = 2.9 * CLHEP::eV; // 430 nm
+        else
+          photon.Energy = 9.7 * CLHEP::eV; // 128 nm
+        // TODO: un-hardcode and add another energy for Xe scintillation
+        photon.Time = group.time;
+        auto& photcol = (group.reflected ? out.refPhotons : out.dirPhotons)[group.channel];
+        photcol.insert(photcol.end(), group.count, photon);
       }
     }
-    else {
-      event.put(move(phot));
-      if (fDoReflectedLight) { event.put(move(phot_ref), "Reflected"); }
-    }
-
-    return;
   }
 
   //......................................................................
+  // photons are added to the record with the same values as if the photons of the deposit
+  // were first collected in a record of their own, and that record then merged
   void PDFastSimPAR::AddOpDetBTR(std::vector<sim::OpDetBacktrackerRecord>& opbtr,
                                  std::vector<int>& ChannelMap,
-                                 const sim::OpDetBacktrackerRecord& btr) const
+                                 size_t channel,
+                                 sim::SimEnergyDeposit const& edep,
+                                 int time,
+                                 int count) const
   {
-    int iChan = btr.OpDetNum();
-    if (ChannelMap[iChan] < 0) {
-      ChannelMap[iChan] = opbtr.size();
-      opbtr.emplace_back(std::move(btr));
-    }
-    else {
-      size_t idtest = ChannelMap[iChan];
-      auto const& timePDclockSDPsMap = btr.timePDclockSDPsMap();
-      for (auto const& timePDclockSDP : timePDclockSDPsMap) {
-        for (auto const& sdp : timePDclockSDP.second) {
-          double xyz[3] = {sdp.x, sdp.y, sdp.z};
-          opbtr.at(idtest).AddScintillationPhotons(
-            sdp.trackID, timePDclockSDP.first, sdp.numPhotons, xyz, sdp.energy);
-        }
-      }
+    if (ChannelMap[channel] < 0) {
+      ChannelMap[channel] = opbtr.size();
+      opbtr.emplace_back(channel);
     }
+    double const edeposit = edep.Energy() / edep.NumPhotons();
+    // photons carrying no energy are not recorded
+    if (edeposit <= std::numeric_limits<double>::epsilon()) return;
+
+    double const pos[3] = {edep.MidPointX(), edep.MidPointY(), edep.MidPointZ()};
+    sim::SDP const sdp = stepSDP(edep.TrackID(), count, pos, edeposit);
+    double const xyz[3] = {sdp.x, sdp.y, sdp.z};
+    opbtr[ChannelMap[channel]].AddScintillationPhotons(
+      edep.TrackID(), time, sdp.numPhotons, xyz, sdp.energy);
   }
 
   //......................................................................
   // calculates number of photons detected given visibility and emitted number of photons
-  void PDFastSimPAR::detectedNumPhotons(std::vector<int>& DetectedNumPhotons,
+  void PDFastSimPAR::detectedNumPhotons(CLHEP::RandPoissonQ& randPoissPhot,
+                                        int* DetectedNumPhotons,
                                         const std::vector<double>& OpDetVisibilities,
                                         const int NumPhotons) const
   {
     for (size_t i = 0; i < OpDetVisibilities.size(); ++i) {
-      DetectedNumPhotons[i] = fRandPoissPhot->fire(OpDetVisibilities[i] * NumPhotons);
+      DetectedNumPhotons[i] = randPoissPhot.fire(OpDetVisibilities[i] * NumPhotons);
+    }
+  }
+
+  //......................................................................
+  void PDFastSimPAR::Scratch_t::resize(size_t nDeposits, size_t nChannels, bool reflected)
+  {
+    deposits.reserve(nDeposits);
+    points.reserve(nDeposits);
+    detectedFast.resize(nDeposits * nChannels);
+    detectedSlow.resize(nDeposits * nChannels);
+    if (reflected) {
+      reflDetectedFast.resize(nDeposits * nChannels);
+      reflDetectedSlow.resize(nDeposits * nChannels);
     }
+    anodeDetected.resize(nChannels);
   }
 
   //......................................................................
@@ -34,6 +34,7 @@
 #include "larsim/PhotonPropagation/PropagationTimeModel.h"
 #include "larsim/PhotonPropagation/ScintTimeTools/ScintTime.h"
 #include "larsim/Simulation/LArG4Parameters.h"
+#include "larsim/Simulation/LitePhotonAccumulator.h"
 
 #include "nurandom/RandomUtils/NuRandomService.h"
 
@@ -167,6 +168,9 @@ namespace phot {
     auto opbtr_ref = std::make_unique<std::vector<sim::OpDetBacktrackerRecord>>();
     auto& dir_phlitcol(*phlit);
     auto& ref_phlitcol(*phlit_ref);
+    sim::LitePhotonAccumulator dir_litePhotons{fNOpChannels};
+    sim::LitePhotonAccumulator ref_litePhotons{fNOpChannels};
+    std::vector<double> scintTimes; // buffer for the batch emission time sampling
     // SimPhotons
     auto phot = std::make_unique<std::vector<sim::SimPhotons>>();
     auto phot_ref = std::make_unique<std::vector<sim::SimPhotons>>();
@@ -257,28 +261,26 @@ namespace phot {
           if (fUseLitePhotons) {
             sim::OpDetBacktrackerRecord tmpbtr(channel);
             if (ndetected_fast > 0 && fDoFastComponent) {
+              scintTimes.resize(ndetected_fast);
+              fScintTime->fastScintTimes(scintTimes);
               for (int i = 0; i < ndetected_fast; ++i) {
                 // calculate the time at which each photon is seen
-                double dtime = edepi.StartT() + fScintTime->fastScintTime();
+                double dtime = edepi.StartT() + scintTimes[i];
                 if (fIncludePropTime) dtime += transport_time[i];
                 int time = static_cast<int>(std::round(dtime));
-                if (Reflected)
-                  ++ref_phlitcol[channel].DetectedPhotons[time];
-                else
-                  ++dir_phlitcol[channel].DetectedPhotons[time];
+                (Reflected ? ref_litePhotons : dir_litePhotons).add(channel, time);
                 tmpbtr.AddScintillationPhotons(trackID, time, 1, pos, edeposit);
               }
             }
             if ((ndetected_slow > 0) && fDoSlowComponent) {
+              scintTimes.resize(ndetected_slow);
+              fScintTime->slowScintTimes(scintTimes);
               for (int i = 0; i < ndetected_slow; ++i) {
                 // calculate the time at which each photon is seen
-                double dtime = edepi.StartT() + fScintTime->slowScintTime();
+                double dtime = edepi.StartT() + scintTimes[i];
                 if (fIncludePropTime) dtime += transport_time[ndetected_fast + i];
                 int time = static_cast<int>(std::round(dtime));
-                if (Reflected)
-                  ++ref_phlitcol[channel].DetectedPhotons[time];
-                else
-                  ++dir_phlitcol[channel].DetectedPhotons[time];
+                (Reflected ? ref_litePhotons : dir_litePhotons).add(channel, time);
                 tmpbtr.AddScintillationPhotons(trackID, time, 1, pos, edeposit);
               }
             }
@@ -300,9 +302,11 @@ namespace phot {
               photon.Energy = 9.7 * CLHEP::eV; // 128 nm
             // TODO: un-hardcode and add another energy for Xe scintillation
             if (ndetected_fast > 0 && fDoFastComponent) {
+              scintTimes.resize(ndetected_fast);
+              fScintTime->fastScintTimes(scintTimes);
               for (int i = 0; i < ndetected_fast; ++i) {
                 // calculates the time at which the photon was produced
-                double dtime = edepi.StartT() + fScintTime->fastScintTime();
+                double dtime = edepi.StartT() + scintTimes[i];
                 if (fIncludePropTime) dtime += transport_time[i];
                 int time = static_cast<int>(std::round(dtime));
                 photon.Time = time;
@@ -313,8 +317,10 @@ namespace phot {
               }
             }
             if (ndetected_slow > 0 && fDoSlowComponent) {
+              scintTimes.resize(ndetected_slow);
+              fScintTime->slowScintTimes(scintTimes);
               for (int i = 0; i < ndetected_slow; ++i) {
-                double dtime = edepi.StartT() + fScintTime->slowScintTime();
+                double dtime = edepi.StartT() + scintTimes[i];
                 if (fIncludePropTime) dtime += transport_time[ndetected_fast + i];
                 int time = static_cast<int>(std::round(dtime));
                 photon.Time = time;
@@ -330,6 +336,8 @@ namespace phot {
     }
 
     if (fUseLitePhotons) {
+      dir_litePhotons.fill(dir_phlitcol);
+      ref_litePhotons.fill(ref_phlitcol);
       event.put(move(phlit));
       event.put(move(opbtr));
       if (fStoreReflected) {
@@ -9,7 +9,6 @@
 #include "RooInt.h"
 #include "RtypesCore.h"
 #include "TBranch.h"
-#include "TF1.h"
 #include "TFile.h"
 #include "TKey.h"
 #include "TNamed.h"
@@ -139,7 +138,7 @@ namespace phot {
     fReflLookupTable.clear();
     fReflTLookupTable.clear();
     fTimingParLookupTable.clear();
-    fTimingParTF1LookupTable.clear();
+    fTiming.reset();
 
     fNVoxels = NVoxels;
     fNOpChannels = NOpChannels;
@@ -150,10 +149,7 @@ namespace phot {
     fHasReflectedT0 = storeReflT0;
     if (storeReflT0) fReflTLookupTable.resize(LibrarySize());
     fHasTiming = storeTiming;
-    if (storeTiming != 0) {
-      fTimingParLookupTable.resize(LibrarySize());
-      fTimingParTF1LookupTable.resize(LibrarySize());
-    }
+    if (storeTiming != 0) fTimingParLookupTable.resize(LibrarySize());
   }
 
   //------------------------------------------------------------
@@ -169,7 +165,7 @@ namespace phot {
     fReflLookupTable.clear();
     fReflTLookupTable.clear();
     fTimingParLookupTable.clear();
-    fTimingParTF1LookupTable.clear();
+    fTiming.reset();
 
     mf::LogInfo("PhotonLibrary") << "Reading photon library from input file: "
                                  << LibraryFile.c_str() << std::endl;
@@ -233,13 +229,15 @@ namespace phot {
       fTimingParNParameters = fHasTiming;
       // should be pSrcDir->Get()? kept as is for backward compatibility
       TNamed* n = (TNamed*)f->Get("fTimingParFormula");
-      if (!n)
-        mf::LogError("PhotonLibrary")
-          << "Error reading the photon propagation formula. Please check the photon library."
-          << std::endl;
+      if (!n) {
+        throw cet::exception("PhotonLibrary")
+          << "Error reading the photon propagation formula. Please check the photon library: "
+          << LibraryFile << "\n";
+      }
       fTimingParFormula = n->GetTitle();
-      fTimingParTF1LookupTable.resize(LibrarySize());
-      fTimingParTF1LookupTable.data_init(LibrarySize());
+      // only the parameters are stored; the formula is compiled once
+      fTiming = std::make_unique<PhotonLibraryTiming>(
+        fTimingParFormula, fTimingParNParameters, fNVoxels, fNOpChannels, fTimingMaxRange);
       mf::LogInfo("PhotonLibrary")
         << "Time parametrization is activated. Using the formula: " << fTimingParFormula << " with "
         << fTimingParNParameters << " parameters." << std::endl;
@@ -264,21 +262,7 @@ namespace phot {
 
       if (fHasReflected) uncheckedAccessRefl(Voxel, OpChannel) = ReflVisibility;
       if (fHasReflectedT0) uncheckedAccessReflT(Voxel, OpChannel) = ReflTfirst;
-      if (fHasTiming != 0) {
-        // TODO: use TF1::Copy
-        TF1 timingfunction(Form("timing_%i_%i", Voxel, OpChannel),
-                           fTimingParFormula.c_str(),
-                           timing_par[0],
-                           fTimingMaxRange);
-        timingfunction.SetParameter(
-          0,
-          0.0); //first parameter is now in the range. Let's do this to keep compatible with old libraries.
-        for (size_t k = 1; k < fTimingParNParameters; k++) {
-          timingfunction.SetParameter(k, timing_par[k]);
-        }
-
-        uncheckedAccessTimingTF1(Voxel, OpChannel) = timingfunction;
-      }
+      if (fHasTiming != 0) fTiming->SetParameters(Voxel, OpChannel, timing_par.data());
     } // for entries
 
     LoadMetadata(*pSrcDir);
@@ -358,16 +342,6 @@ namespace phot {
   }
   //----------------------------------------------------
 
-  void PhotonLibrary::SetTimingTF1(size_t Voxel, size_t OpChannel, TF1 func)
-  {
-    if ((Voxel >= fNVoxels) || (OpChannel >= fNOpChannels))
-      mf::LogError("PhotonLibrary") << "Error - attempting to set a propagation function in voxel "
-                                    << Voxel << " which is out of range";
-    else
-      uncheckedAccessTimingTF1(Voxel, OpChannel) = func;
-  }
-  //----------------------------------------------------
-
   void PhotonLibrary::SetReflCount(size_t Voxel, size_t OpChannel, float Count)
   {
     if ((Voxel >= fNVoxels) || (OpChannel >= fNOpChannels))
@@ -409,30 +383,9 @@ namespace phot {
 
   //----------------------------------------------------
 
-  TF1* PhotonLibrary::GetTimingTF1s(size_t Voxel) const
+  PhotonLibraryTimingSampler const* PhotonLibrary::GetTimingSamplers(size_t Voxel) const
   {
-    if (Voxel >= fNVoxels) return nullptr;
-    /*
-     * Sorry, Universe, but we can't undergo ROOT's bad design hell.
-     * TF1::GetRandom() is non-const member, because it uses some internal
-     * integral information which can be produced on the spot instead than
-     * always be present. That's called caching, it's Good, but it must not
-     * interfere with constantness of the interface (in fact, this is one of
-     * the few acceptable uses of `mutable` members).
-     * Because of this, this method can't return a constant `TF1`, therefore
-     * it can't be constant, therefore the underlying access returning a
-     * constant object is not acceptable.
-     * So I do the Bad thing.
-     * Plus I opened JIRA ROOT-9549
-     * (https://sft.its.cern.ch/jira/browse/ROOT-9549).
-     * After that is solved, this method should become:
-     *
-     * TF1 const* PhotonLibrary::GetTimingTF1s(size_t Voxel) const
-     *
-     * and the users should update their code accordingly.
-     */
-    else
-      return const_cast<TF1*>(fTimingParTF1LookupTable.data_address(uncheckedIndex(Voxel, 0)));
+    return fTiming ? fTiming->GetSamplers(Voxel) : nullptr;
   }
 
   //----------------------------------------------------
@@ -5,15 +5,16 @@
 #define PHOTONLIBRARY_H
 
 #include "larsim/PhotonPropagation/IPhotonLibrary.h"
+#include "larsim/PhotonPropagation/PhotonLibraryTiming.h"
 
 #include "larsim/Simulation/PhotonVoxels.h"
 
-#include "TF1.h"
 class TTree;
 
 #include "lardataobj/Utilities/LazyVector.h"
 
 #include <limits> // std::numeric_limits
+#include <memory> // std::unique_ptr
 #include <optional>
 
 namespace art {
@@ -35,9 +36,6 @@ namespace phot {
     float GetTimingPar(size_t Voxel, size_t OpChannel, size_t parnum) const;
     void SetTimingPar(size_t Voxel, size_t OpChannel, float Count, size_t parnum);
 
-    //    TF1& GetTimingTF1(size_t Voxel, size_t OpChannel) const;
-    void SetTimingTF1(size_t Voxel, size_t OpChannel, TF1 func);
-
     virtual float GetReflCount(size_t Voxel, size_t OpChannel) const override;
     void SetReflCount(size_t Voxel, size_t OpChannel, float Count);
 
@@ -47,7 +45,13 @@ namespace phot {
     /// Returns a pointer to NOpChannels() visibility values, one per channel
     virtual float const* GetCounts(size_t Voxel) const override;
     const std::vector<float>* GetTimingPars(size_t Voxel) const;
-    TF1* GetTimingTF1s(size_t Voxel) const;
+
+    /// Returns the propagation time distributions (`nullptr` if none loaded).
+    PhotonLibraryTiming const* GetTiming() const { return fTiming.get(); }
+
+    /// Returns NOpChannels() propagation time samplers for the voxel
+    /// (`nullptr` if the voxel is invalid or no timing is loaded).
+    PhotonLibraryTimingSampler const* GetTimingSamplers(size_t Voxel) const;
 
     virtual float const* GetReflCounts(size_t Voxel) const override;
     virtual float const* GetReflT0s(size_t Voxel) const override;
@@ -118,7 +122,8 @@ namespace phot {
     util::LazyVector<float> fReflLookupTable;
     util::LazyVector<float> fReflTLookupTable;
     util::LazyVector<std::vector<float>> fTimingParLookupTable;
-    util::LazyVector<TF1> fTimingParTF1LookupTable;
+    /// Propagation time distributions read from the library file.
+    std::unique_ptr<PhotonLibraryTiming> fTiming;
     std::string fTimingParFormula;
     size_t fTimingParNParameters;
 
@@ -187,19 +192,6 @@ namespace phot {
       return fTimingParLookupTable[uncheckedIndex(Voxel, OpChannel)][parnum];
     }
 
-    /// Unchecked access to a parameter of the time distribution
-    TF1& uncheckedAccessTimingTF1(size_t Voxel, size_t OpChannel)
-    {
-      return fTimingParTF1LookupTable[uncheckedIndex(Voxel, OpChannel)];
-    }
-
-    /// Unchecked access to a parameter of the time distribution
-    const TF1& uncheckedAccessTimingTF1(size_t Voxel, size_t OpChannel) const
-    {
-      // note that this will produce a segmentation fault if the formula is not there
-      return *(fTimingParTF1LookupTable.data_address(uncheckedIndex(Voxel, OpChannel)));
-    }
-
     /// Reads the metadata from specified ROOT directory and sets it as current.
     void LoadMetadata(TDirectory& srcDir);
 
@@ -0,0 +1,435 @@
+#include "larsim/PhotonPropagation/PhotonLibraryCompressed.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "TFile.h"
+#include "TKey.h"
+#include "TTree.h"
+
+#include <algorithm> // std::fill_n(), std::lower_bound(), std::find(), std::clamp()
+#include <cmath>
+#include <limits>
+#include <memory> // std::unique_ptr
+
+namespace {
+
+  /// Relative error allowance for the rounding of the decoded values to `float`.
+  constexpr double FloatRoundingMargin = 2.0 * std::numeric_limits<float>::epsilon();
+
+} // local namespace
+
+namespace phot {
+
+  //------------------------------------------------------------
+  auto PhotonLibraryCompressed::parseEncoding(std::string const& name) -> Encoding_t
+  {
+    if (name == "Log8") return Encoding_t::Log8;
+    if (name == "Log16") return Encoding_t::Log16;
+    if (name == "Auto") return Encoding_t::Auto;
+    throw cet::exception("PhotonLibraryCompressed")
+      << "Unknown visibility encoding '" << name << "' (supported: 'Log8', 'Log16', 'Auto')\n";
+  }
+
+  //------------------------------------------------------------
+  PhotonLibraryCompressed::PhotonLibraryCompressed(IPhotonLibrary const& source,
+                                                   Config_t const& config)
+    : fConfig(config)
+    , fNVoxels(source.NVoxels())
+    , fNOpChannels(source.NOpChannels())
+    , fHasReflected(source.hasReflected())
+    , fHasReflectedT0(source.hasReflectedT0())
+  {
+    encode([this, &source](EntryCallback_t const& process) {
+      Entry_t entry{};
+      for (std::size_t v = 0; v < fNVoxels; ++v) {
+        float const* counts = source.GetCounts(v);
+        float const* reflCounts = fHasReflected ? source.GetReflCounts(v) : nullptr;
+        float const* reflT0s = fHasReflectedT0 ? source.GetReflT0s(v) : nullptr;
+        if (!counts && !reflCounts && !reflT0s) continue;
+        entry.voxel = v;
+        for (std::size_t ch = 0; ch < fNOpChannels; ++ch) {
+          entry.channel = ch;
+          entry.visibility = counts ? counts[ch] : 0.0f;
+          entry.reflVisibility = reflCounts ? reflCounts[ch] : 0.0f;
+          entry.reflT0 = reflT0s ? reflT0s[ch] : 0.0f;
+          process(entry);
+        }
+      }
+    });
+  }
+
+  //------------------------------------------------------------
+  PhotonLibraryCompressed::PhotonLibraryCompressed(std::string const& libraryFile,
+                                                   std::size_t NVoxels,
+                                                   bool getReflected,
+                                                   bool getReflT0,
+                                                   Config_t const& config)
+    : fConfig(config), fNVoxels(NVoxels), fHasReflected(getReflected), fHasReflectedT0(getReflT0)
+  {
+    mf::LogInfo("PhotonLibraryCompressed")
+      << "Reading and compressing photon library from input file: " << libraryFile;
+
+    std::unique_ptr<TFile> file{TFile::Open(libraryFile.c_str(), "READ")};
+    if (!file || file->IsZombie()) {
+      throw cet::exception("PhotonLibraryCompressed")
+        << "Can't open photon library file '" << libraryFile << "'\n";
+    }
+    TTree* tree = dynamic_cast<TTree*>(file->Get("PhotonLibraryData"));
+    if (!tree) { // library not in the top directory
+      TKey* key = file->FindKeyAny("PhotonLibraryData");
+      if (key) tree = dynamic_cast<TTree*>(key->ReadObj());
+    }
+    if (!tree) {
+      throw cet::exception("PhotonLibraryCompressed")
+        << "PhotonLibraryData not found in file '" << libraryFile << "'\n";
+    }
+
+    Int_t voxel;
+    Int_t channel;
+    Float_t visibility;
+    Float_t reflVisibility = 0.0f;
+    Float_t reflT0 = 0.0f;
+    tree->SetBranchAddress("Voxel", &voxel);
+    tree->SetBranchAddress("OpChannel", &channel);
+    tree->SetBranchAddress("Visibility", &visibility);
+    if (fHasReflected) tree->SetBranchAddress("ReflVisibility", &reflVisibility);
+    if (fHasReflectedT0) tree->SetBranchAddress("ReflTfirst", &reflT0);
+
+    Long64_t const nEntries = tree->GetEntries();
+    encode([&](EntryCallback_t const& process) {
+      Entry_t entry{};
+      for (Long64_t i = 0; i < nEntries; ++i) {
+        tree->GetEntry(i);
+        if ((voxel < 0) || (channel < 0)) {
+          throw cet::exception("PhotonLibraryCompressed")
+            << "Photon library '" << libraryFile << "' has an entry with voxel " << voxel
+            << " and channel " << channel << "\n";
+        }
+        entry.voxel = voxel;
+        entry.channel = channel;
+        entry.visibility = visibility;
+        entry.reflVisibility = reflVisibility;
+        entry.reflT0 = reflT0;
+        process(entry);
+      }
+    });
+  }
+
+  //------------------------------------------------------------
+  void PhotonLibraryCompressed::encode(EntrySource_t const& source)
+  {
+    if (!(fConfig.maxRelError > FloatRoundingMargin)) {
+      throw cet::exception("PhotonLibraryCompressed")
+        << "Maximum relative error must be larger than " << FloatRoundingMargin << " ("
+        << fConfig.maxRelError << " specified)\n";
+    }
+
+    // first pass: number of channels and range of the non-zero visibilities
+    float directMin = std::numeric_limits<float>::max(), directMax = 0.0f;
+    float reflMin = std::numeric_limits<float>::max(), reflMax = 0.0f;
+    auto updateRange = [](float value, float& vmin, float& vmax) {
+      if (!(value > 0.0f)) return;
+      if (value < vmin) vmin = value;
+      if (value > vmax) vmax = value;
+    };
+    std::size_t nChannels = 0U;
+    source([&](Entry_t const& entry) {
+      if (entry.voxel >= fNVoxels) {
+        throw cet::exception("PhotonLibraryCompressed")
+          << "Library entry for voxel " << entry.voxel << ", but the library has only "
+          << fNVoxels << " voxels\n";
+      }
+      if (entry.channel >= nChannels) nChannels = entry.channel + 1;
+      updateRange(entry.visibility, directMin, directMax);
+      if (fHasReflected) updateRange(entry.reflVisibility, reflMin, reflMax);
+    });
+
+    if (fNOpChannels == 0U)
+      fNOpChannels = nChannels;
+    else if (nChannels > fNOpChannels) {
+      throw cet::exception("PhotonLibraryCompressed")
+        << "Library entry for channel " << (nChannels - 1) << ", but the library has only "
+        << fNOpChannels << " channels\n";
+    }
+    if (fConfig.sparse && (fNOpChannels > std::numeric_limits<std::uint16_t>::max() + 1U)) {
+      throw cet::exception("PhotonLibraryCompressed")
+        << "Sparse encoding supports up to " << (std::numeric_limits<std::uint16_t>::max() + 1U)
+        << " channels, library has " << fNOpChannels << "\n";
+    }
+
+    if (fConfig.encoding == Encoding_t::Auto) {
+      double maxError = expectedRelError(256U, directMin, directMax);
+      if (fHasReflected) maxError = std::max(maxError, expectedRelError(256U, reflMin, reflMax));
+      fConfig.encoding = (maxError <= fConfig.maxRelError) ? Encoding_t::Log8 : Encoding_t::Log16;
+    }
+
+    setupTable(fDirect, directMin, directMax);
+    if (fHasReflected) setupTable(fRefl, reflMin, reflMax);
+    if (fHasReflectedT0) fReflT0.assign(fNVoxels * fNOpChannels, 0.0f);
+
+    // second pass: encoding into dense tables
+    bool const use8 = (fConfig.encoding == Encoding_t::Log8);
+    auto setCode = [use8](EncodedTable_t& table, std::size_t index, std::uint16_t code) {
+      if (use8)
+        table.codes8[index] = code;
+      else
+        table.codes16[index] = code;
+    };
+    source([&](Entry_t const& entry) {
+      std::size_t const index = entry.voxel * fNOpChannels + entry.channel;
+      setCode(fDirect, index, encodeValue(fDirect, entry.visibility));
+      if (fHasReflected) setCode(fRefl, index, encodeValue(fRefl, entry.reflVisibility));
+      if (fHasReflectedT0) fReflT0[index] = entry.reflT0;
+    });
+
+    auto finishTable = [this](EncodedTable_t& table) {
+      if (fConfig.sparse) makeSparse(table);
+      CompressionReport_t& report = table.report;
+      report.nStored = table.codes8.size() + table.codes16.size();
+      report.memoryBytes = table.codes8.size() * sizeof(std::uint8_t) +
+                           table.codes16.size() * sizeof(std::uint16_t) +
+                           table.channels.size() * sizeof(std::uint16_t) +
+                           table.voxelStart.size() * sizeof(std::size_t) +
+                           table.decode.size() * sizeof(float);
+    };
+    finishTable(fDirect);
+    if (fHasReflected) finishTable(fRefl);
+
+    printReports();
+
+    auto checkError = [this](const char* name, CompressionReport_t const& report) {
+      if (report.maxRelError <= fConfig.maxRelError) return;
+      throw cet::exception("PhotonLibraryCompressed")
+        << "The " << name << " visibilities span too wide a range for "
+        << ((fConfig.encoding == Encoding_t::Log8) ? 8 : 16)
+        << "-bit codes: maximum relative error " << report.maxRelError << " exceeds the allowed "
+        << fConfig.maxRelError << " (use a wider encoding, or a looser bound)\n";
+    };
+    checkError("direct", fDirect.report);
+    if (fHasReflected) checkError("reflected", fRefl.report);
+
+  } // PhotonLibraryCompressed::encode()
+
+  //------------------------------------------------------------
+  double PhotonLibraryCompressed::expectedRelError(std::size_t nCodes, float vmin, float vmax)
+  {
+    if (!(vmax > vmin)) return FloatRoundingMargin; // at most one non-zero value
+    double const step = (std::log(vmax) - std::log(vmin)) / (nCodes - 2);
+    return std::expm1(step / 2.0) + FloatRoundingMargin;
+  } // PhotonLibraryCompressed::expectedRelError()
+
+  //------------------------------------------------------------
+  void PhotonLibraryCompressed::setupTable(EncodedTable_t& table, float vmin, float vmax) const
+  {
+    std::size_t const N = nCodes();
+    bool const hasValues = (vmax > 0.0f);
+
+    // the codes span the whole range of the non-zero values, so none is lost;
+    // rounding to the nearest code in log space keeps the relative error
+    // within exp(step/2) - 1
+    table.logMax = hasValues ? std::log(vmax) : 0.0;
+    table.step = (hasValues && (vmax > vmin)) ? (table.logMax - std::log(vmin)) / (N - 2) : 0.0;
+
+    table.decode.resize(N);
+    table.decode[0] = 0.0f;
+    for (std::size_t c = 1; c < N; ++c)
+      table.decode[c] = hasValues ? float(std::exp(table.logMax - (N - 1 - c) * table.step)) : 0.0f;
+
+    table.report = CompressionReport_t{};
+    table.report.minStored = table.decode[1];
+
+    if (fConfig.encoding == Encoding_t::Log8)
+      table.codes8.assign(fNVoxels * fNOpChannels, 0U);
+    else
+      table.codes16.assign(fNVoxels * fNOpChannels, 0U);
+  } // PhotonLibraryCompressed::setupTable()
+
+  //------------------------------------------------------------
+  std::uint16_t PhotonLibraryCompressed::encodeValue(EncodedTable_t& table, float value) const
+  {
+    if (!(value > 0.0f)) return 0;
+    std::size_t const N = nCodes();
+    double const k =
+      (table.step > 0.0) ? std::round((table.logMax - std::log(value)) / table.step) : 0.0;
+    std::uint16_t const code = std::uint16_t(N - 1 - std::size_t(std::clamp(k, 0.0, N - 2.0)));
+
+    CompressionReport_t& report = table.report;
+    double const relError = std::abs(table.decode[code] - value) / value;
+    if (relError > report.maxRelError) report.maxRelError = relError;
+    ++report.nNonZero;
+    return code;
+  } // PhotonLibraryCompressed::encodeValue()
+
+  //------------------------------------------------------------
+  void PhotonLibraryCompressed::makeSparse(EncodedTable_t& table) const
+  {
+    // the codes are compacted in place, since no stored entry is moved forward
+    bool const use8 = (fConfig.encoding == Encoding_t::Log8);
+    std::size_t nStored = 0U;
+    table.voxelStart.reserve(fNVoxels + 1);
+    table.voxelStart.assign(1U, 0U);
+    for (std::size_t v = 0; v < fNVoxels; ++v) {
+      for (std::size_t ch = 0; ch < fNOpChannels; ++ch) {
+        std::size_t const index = v * fNOpChannels + ch;
+        std::uint16_t const code = codeAt(table, index);
+        if (code == 0) continue;
+        table.channels.push_back(ch);
+        if (use8)
+          table.codes8[nStored] = table.codes8[index];
+        else
+          table.codes16[nStored] = table.codes16[index];
+        ++nStored;
+      } // for channels
+      table.voxelStart.push_back(nStored);
+    } // for voxels
+
+    if (use8)
+      table.codes8.resize(nStored);
+    else
+      table.codes16.resize(nStored);
+    table.codes8.shrink_to_fit();
+    table.codes16.shrink_to_fit();
+    table.channels.shrink_to_fit();
+  } // PhotonLibraryCompressed::makeSparse()
+
+  //------------------------------------------------------------
+  void PhotonLibraryCompressed::printReports() const
+  {
+    mf::LogInfo log("PhotonLibraryCompressed");
+    log << "Compressed photon library: " << fNVoxels << " voxels, " << fNOpChannels
+        << " channels, " << ((fConfig.encoding == Encoding_t::Log8) ? 8 : 16) << "-bit codes"
+        << (fConfig.sparse ? " (sparse)" : "");
+    auto printReport = [&log, this](const char* name, CompressionReport_t const& report) {
+      log << "\n  " << name << ": " << report.nStored << " codes in " << report.memoryBytes
+          << " bytes (float: " << (fNVoxels * fNOpChannels * sizeof(float)) << "); "
+          << report.nNonZero << " non-zero values, max relative error: " << report.maxRelError
+          << "; smallest stored value: " << report.minStored;
+    };
+    printReport("direct", fDirect.report);
+    if (fHasReflected) printReport("reflected", fRefl.report);
+  } // PhotonLibraryCompressed::printReports()
+
+  //------------------------------------------------------------
+  void PhotonLibraryCompressed::decodeVoxel(EncodedTable_t const& table,
+                                            size_t Voxel,
+                                            float* buffer) const
+  {
+    float const* decode = table.decode.data();
+    if (fConfig.sparse) {
+      std::fill_n(buffer, fNOpChannels, 0.0f);
+      std::size_t const end = table.voxelStart[Voxel + 1];
+      for (std::size_t i = table.voxelStart[Voxel]; i < end; ++i)
+        buffer[table.channels[i]] = decode[codeAt(table, i)];
+    }
+    else if (fConfig.encoding == Encoding_t::Log8) {
+      std::uint8_t const* codes = table.codes8.data() + Voxel * fNOpChannels;
+      for (std::size_t ch = 0; ch < fNOpChannels; ++ch)
+        buffer[ch] = decode[codes[ch]];
+    }
+    else {
+      std::uint16_t const* codes = table.codes16.data() + Voxel * fNOpChannels;
+      for (std::size_t ch = 0; ch < fNOpChannels; ++ch)
+        buffer[ch] = decode[codes[ch]];
+    }
+  } // PhotonLibraryCompressed::decodeVoxel()
+
+  //------------------------------------------------------------
+  float PhotonLibraryCompressed::decodeOne(EncodedTable_t const& table,
+                                           size_t Voxel,
+                                           size_t OpChannel) const
+  {
+    if (!fConfig.sparse) return table.decode[codeAt(table, Voxel * fNOpChannels + OpChannel)];
+
+    auto const begin = table.channels.begin() + table.voxelStart[Voxel];
+    auto const end = table.channels.begin() + table.voxelStart[Voxel + 1];
+    auto const it = std::lower_bound(begin, end, OpChannel);
+    if ((it == end) || (*it != OpChannel)) return 0.0f;
+    return table.decode[codeAt(table, it - table.channels.begin())];
+  } // PhotonLibraryCompressed::decodeOne()
+
+  //------------------------------------------------------------
+  float const* PhotonLibraryCompressed::cachedRow(
+    EncodedTable_t const& table,
+    tbb::enumerable_thread_specific<DecodedRows_t>& rows,
+    size_t Voxel) const
+  {
+    DecodedRows_t& cache = rows.local();
+    if (cache.voxels.empty()) {
+      cache.voxels.assign(DecodedRowsPerThread, fNVoxels); // no valid voxel yet
+      cache.values.resize(DecodedRowsPerThread * fNOpChannels);
+    }
+
+    auto const found = std::find(cache.voxels.begin(), cache.voxels.end(), Voxel);
+    if (found != cache.voxels.end())
+      return cache.values.data() + (found - cache.voxels.begin()) * fNOpChannels;
+
+    std::size_t const slot = cache.next;
+    cache.next = (slot + 1) % DecodedRowsPerThread;
+    cache.voxels[slot] = Voxel;
+    float* const row = cache.values.data() + slot * fNOpChannels;
+    decodeVoxel(table, Voxel, row);
+    return row;
+  } // PhotonLibraryCompressed::cachedRow()
+
+  //----------------------------------------------------
+  float PhotonLibraryCompressed::GetCount(size_t Voxel, size_t OpChannel) const
+  {
+    if ((Voxel >= fNVoxels) || (OpChannel >= fNOpChannels)) return 0;
+    return decodeOne(fDirect, Voxel, OpChannel);
+  }
+
+  //----------------------------------------------------
+  float PhotonLibraryCompressed::GetReflCount(size_t Voxel, size_t OpChannel) const
+  {
+    if (!fHasReflected || (Voxel >= fNVoxels) || (OpChannel >= fNOpChannels)) return 0;
+    return decodeOne(fRefl, Voxel, OpChannel);
+  }
+
+  //----------------------------------------------------
+  float PhotonLibraryCompressed::GetReflT0(size_t Voxel, size_t OpChannel) const
+  {
+    if (!fHasReflectedT0 || (Voxel >= fNVoxels) || (OpChannel >= fNOpChannels)) return 0;
+    return fReflT0[Voxel * fNOpChannels + OpChannel];
+  }
+
+  //----------------------------------------------------
+  bool PhotonLibraryCompressed::DecodeCounts(size_t Voxel, float* buffer) const
+  {
+    if (Voxel >= fNVoxels) return false;
+    decodeVoxel(fDirect, Voxel, buffer);
+    return true;
+  }
+
+  //----------------------------------------------------
+  bool PhotonLibraryCompressed::DecodeReflCounts(size_t Voxel, float* buffer) const
+  {
+    if (!fHasReflected || (Voxel >= fNVoxels)) return false;
+    decodeVoxel(fRefl, Voxel, buffer);
+    return true;
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryCompressed::GetCounts(size_t Voxel) const -> Counts_t
+  {
+    if (Voxel >= fNVoxels) return nullptr;
+    return cachedRow(fDirect, fDirectRows, Voxel);
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryCompressed::GetReflCounts(size_t Voxel) const -> Counts_t
+  {
+    if (!fHasReflected || (Voxel >= fNVoxels)) return nullptr;
+    return cachedRow(fRefl, fReflRows, Voxel);
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryCompressed::GetReflT0s(size_t Voxel) const -> T0s_t
+  {
+    if (!fHasReflectedT0 || (Voxel >= fNVoxels)) return nullptr;
+    return fReflT0.data() + Voxel * fNOpChannels;
+  }
+
+  //----------------------------------------------------
+
+} // namespace phot
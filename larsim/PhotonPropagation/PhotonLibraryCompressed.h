@@ -0,0 +1,223 @@
+////# PhotonLibraryCompressed.h header file
+////#
+////# Photon library with visibilities stored as quantized logarithmic codes.
+#ifndef PHOTONLIBRARYCOMPRESSED_H
+#define PHOTONLIBRARYCOMPRESSED_H
+
+#include "larsim/PhotonPropagation/IPhotonLibrary.h"
+
+#include "tbb/enumerable_thread_specific.h"
+
+#include <cstddef> // std::size_t
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace phot {
+
+  /**
+   * @brief Photon library storing visibilities as log-quantized integer codes.
+   *
+   * The library is encoded from a stream of (voxel, channel) entries, read
+   * either from another (floating point) library or directly from a ROOT
+   * photon library file; in the latter case the full precision library is
+   * never held in memory.
+   *
+   * Each visibility `v` is stored as an 8- or 16-bit code `c`: code `0` means
+   * zero visibility, and code `c > 0` stands for
+   * `vmax * exp(-(N - 1 - c) * step)`, `N` being the number of available codes.
+   * The codes span the whole range between the smallest (`vmin`) and the
+   * largest (`vmax`) non-zero visibility of the source, i.e.
+   * `step = log(vmax / vmin) / (N - 2)`, so that no value is flushed to zero.
+   * The maximum relative error is then about `step / 2`; it is measured on
+   * every non-zero value while encoding (`GetCompressionReport()`), and if it
+   * exceeds the configured bound the construction fails.
+   * With the `Auto` encoding (the default) the 8-bit codes are used when the
+   * range of the source allows them to meet the bound, the 16-bit ones
+   * otherwise; `GetEncoding()` tells which one was chosen.
+   *
+   * In the sparse mode, for each voxel only the channels with non-zero code
+   * are stored, together with their channel number.
+   *
+   * Decoding is a table lookup. `DecodeCounts()` writes `NOpChannels()` values
+   * into a buffer owned by the caller. `GetCounts()` and `GetReflCounts()`
+   * decode into a small cache private to the calling thread and to this
+   * library: a returned pointer stays valid until `DecodedRowsPerThread`
+   * other voxels have been decoded by the same thread from the same table.
+   *
+   * Reflected light timing, if present, is stored uncompressed.
+   */
+  class PhotonLibraryCompressed : public IPhotonLibrary {
+  public:
+    /// Available code widths (`Auto`: the narrowest meeting the error bound).
+    enum class Encoding_t { Log8, Log16, Auto };
+
+    /// Compression settings.
+    struct Config_t {
+      Encoding_t encoding = Encoding_t::Auto; ///< Width of the codes.
+      double maxRelError = 1e-3; ///< Maximum relative error on a stored visibility.
+      bool sparse = false;       ///< Store only channels with non-zero visibility.
+    };
+
+    /// Accuracy and size of an encoded table.
+    struct CompressionReport_t {
+      double maxRelError = 0.0;     ///< Largest relative error among non-zero values.
+      float minStored = 0.0f;       ///< Smallest non-zero value that can be stored.
+      std::size_t nNonZero = 0U;    ///< Number of non-zero values in the source.
+      std::size_t nStored = 0U;     ///< Number of stored codes.
+      std::size_t memoryBytes = 0U; ///< Memory used by the encoded table.
+    };
+
+    /// Parses the encoding name (`"Log8"`, `"Log16"` or `"Auto"`); throws if unknown.
+    static Encoding_t parseEncoding(std::string const& name);
+
+    /// Number of decoded voxels kept by `GetCounts()` for each thread and table.
+    static constexpr std::size_t DecodedRowsPerThread = 16U;
+
+    /// Encodes the content of `source` with the specified settings.
+    PhotonLibraryCompressed(IPhotonLibrary const& source, Config_t const& config);
+
+    /**
+     * @brief Encodes the photon library in a ROOT file, reading it twice.
+     * @param libraryFile path of the ROOT file with the `PhotonLibraryData` tree
+     * @param NVoxels number of voxels of the library
+     * @param getReflected whether to read the reflected light visibility
+     * @param getReflT0 whether to read the reflected light arrival time
+     * @param config compression settings
+     *
+     * The tree entries are streamed: the first pass finds the number of
+     * channels and the range of the visibilities, the second one encodes them.
+     */
+    PhotonLibraryCompressed(std::string const& libraryFile,
+                            std::size_t NVoxels,
+                            bool getReflected,
+                            bool getReflT0,
+                            Config_t const& config);
+
+    virtual float GetCount(size_t Voxel, size_t OpChannel) const override;
+    virtual float GetReflCount(size_t Voxel, size_t OpChannel) const override;
+    virtual float GetReflT0(size_t Voxel, size_t OpChannel) const override;
+
+    /// Returns a pointer to NOpChannels() visibility values, one per channel
+    /// (see the class documentation for how long it stays valid).
+    virtual Counts_t GetCounts(size_t Voxel) const override;
+    virtual Counts_t GetReflCounts(size_t Voxel) const override;
+    virtual T0s_t GetReflT0s(size_t Voxel) const override;
+
+    /// Decodes the visibilities of `Voxel` into `buffer` (`NOpChannels()` long).
+    /// @return whether the voxel is valid (if not, `buffer` is not touched)
+    bool DecodeCounts(size_t Voxel, float* buffer) const;
+    bool DecodeReflCounts(size_t Voxel, float* buffer) const;
+
+    virtual bool hasReflected() const override { return fHasReflected; }
+    virtual bool hasReflectedT0() const override { return fHasReflectedT0; }
+
+    virtual int NOpChannels() const override { return fNOpChannels; }
+    virtual int NVoxels() const override { return fNVoxels; }
+
+    virtual bool isVoxelValid(size_t Voxel) const override { return Voxel < fNVoxels; }
+
+    /// Returns the encoding in use (never `Encoding_t::Auto`).
+    Encoding_t GetEncoding() const { return fConfig.encoding; }
+
+    /// Returns the accuracy report of the direct (or reflected) light table.
+    CompressionReport_t const& GetCompressionReport(bool reflected = false) const
+    {
+      return reflected ? fRefl.report : fDirect.report;
+    }
+
+  private:
+    /// A library entry, as read from the source.
+    struct Entry_t {
+      std::size_t voxel;
+      std::size_t channel;
+      float visibility;
+      float reflVisibility;
+      float reflT0;
+    };
+
+    /// Processes one entry of the source.
+    using EntryCallback_t = std::function<void(Entry_t const&)>;
+
+    /// Calls its argument on each entry of the source (called twice).
+    using EntrySource_t = std::function<void(EntryCallback_t const&)>;
+
+    /// A full table (all voxels and channels) of encoded visibilities.
+    struct EncodedTable_t {
+      std::vector<float> decode; ///< Value for each code.
+      std::vector<std::uint8_t> codes8;
+      std::vector<std::uint16_t> codes16;
+      /// Sparse mode: index of first stored entry of each voxel (`NVoxels()+1`).
+      std::vector<std::size_t> voxelStart;
+      /// Sparse mode: channel of each stored entry.
+      std::vector<std::uint16_t> channels;
+      double logMax = 0.0; ///< Logarithm of the largest value.
+      double step = 0.0;   ///< Logarithmic step between codes.
+      CompressionReport_t report;
+    };
+
+    /// Voxels recently decoded by one thread from one table.
+    struct DecodedRows_t {
+      std::vector<std::size_t> voxels; ///< Voxel in each slot.
+      std::vector<float> values;       ///< `NOpChannels()` values per slot.
+      std::size_t next = 0U;           ///< Slot to be overwritten next.
+    };
+
+    Config_t fConfig;
+
+    std::size_t fNVoxels = 0U;
+    std::size_t fNOpChannels = 0U;
+    bool fHasReflected = false;
+    bool fHasReflectedT0 = false;
+
+    EncodedTable_t fDirect;
+    EncodedTable_t fRefl;
+    std::vector<float> fReflT0; ///< Uncompressed reflected light timing.
+
+    mutable tbb::enumerable_thread_specific<DecodedRows_t> fDirectRows;
+    mutable tbb::enumerable_thread_specific<DecodedRows_t> fReflRows;
+
+    /// Encodes all the tables from the entries of `source`.
+    void encode(EntrySource_t const& source);
+
+    /// Returns the maximum relative error of `nCodes` codes spanning `vmin` to `vmax`.
+    static double expectedRelError(std::size_t nCodes, float vmin, float vmax);
+
+    /// Prepares `table` to encode non-zero values between `vmin` and `vmax`.
+    void setupTable(EncodedTable_t& table, float vmin, float vmax) const;
+
+    /// Returns the code of `value` in `table`, recording its error.
+    std::uint16_t encodeValue(EncodedTable_t& table, float value) const;
+
+    /// Converts the dense codes of `table` into the sparse form.
+    void makeSparse(EncodedTable_t& table) const;
+
+    /// Returns a pointer to the decoded `Voxel` from the cache `rows`.
+    float const* cachedRow(EncodedTable_t const& table,
+                           tbb::enumerable_thread_specific<DecodedRows_t>& rows,
+                           size_t Voxel) const;
+
+    /// Logs the compression reports.
+    void printReports() const;
+
+    /// Writes the decoded visibilities of `Voxel` from `table` into `buffer`.
+    void decodeVoxel(EncodedTable_t const& table, size_t Voxel, float* buffer) const;
+
+    /// Returns the decoded visibility of a single channel from `table`.
+    float decodeOne(EncodedTable_t const& table, size_t Voxel, size_t OpChannel) const;
+
+    /// Returns the code stored at position `index` of the table.
+    std::uint16_t codeAt(EncodedTable_t const& table, std::size_t index) const
+    {
+      return (fConfig.encoding == Encoding_t::Log8) ? table.codes8[index] : table.codes16[index];
+    }
+
+    /// Returns the number of codes of the configured encoding.
+    std::size_t nCodes() const { return (fConfig.encoding == Encoding_t::Log8) ? 256U : 65536U; }
+
+  }; // class PhotonLibraryCompressed
+
+} // namespace phot
+
+#endif // PHOTONLIBRARYCOMPRESSED_H
@@ -0,0 +1,292 @@
+#include "larsim/PhotonPropagation/PhotonLibraryMapped.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// POSIX
+#include <fcntl.h>    // open()
+#include <sys/mman.h> // mmap(), munmap(), madvise()
+#include <sys/stat.h> // fstat()
+#include <unistd.h>   // close()
+
+#include <algorithm> // std::equal(), std::copy(), std::max()
+#include <cerrno>
+#include <cstring> // std::strerror()
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+  /// Blocks are aligned to this boundary in the file [bytes]
+  constexpr std::uint64_t BlockAlignment = 4096;
+
+  std::uint64_t alignBlock(std::uint64_t offset)
+  {
+    return ((offset + BlockAlignment - 1) / BlockAlignment) * BlockAlignment;
+  }
+
+} // local namespace
+
+namespace phot {
+
+  constexpr char PhotonLibraryMapped::MagicString[8];
+
+  //------------------------------------------------------------
+  PhotonLibraryMapped::PhotonLibraryMapped(std::string const& fileName) : fFileName(fileName)
+  {
+    mf::LogInfo("PhotonLibraryMapped") << "Mapping photon library from file: " << fFileName;
+
+    int const fd = open(fFileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "Can't open photon library '" << fFileName << "': " << std::strerror(errno) << "\n";
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0) {
+      int const err = errno;
+      close(fd);
+      throw cet::exception("PhotonLibraryMapped")
+        << "Can't access photon library '" << fFileName << "': " << std::strerror(err) << "\n";
+    }
+    fMapSize = static_cast<std::size_t>(fileInfo.st_size);
+
+    if (fMapSize < sizeof(FileHeader_t)) {
+      close(fd);
+      throw cet::exception("PhotonLibraryMapped")
+        << "Photon library '" << fFileName << "' is too short (" << fMapSize << " bytes)\n";
+    }
+
+    // a shared read-only mapping lets all processes on the node share the pages
+    fMapAddress = mmap(nullptr, fMapSize, PROT_READ, MAP_SHARED, fd, 0);
+    int const mapErr = errno;
+    close(fd); // the mapping survives the file descriptor
+    if (fMapAddress == MAP_FAILED) {
+      fMapAddress = nullptr;
+      throw cet::exception("PhotonLibraryMapped")
+        << "Can't map photon library '" << fFileName << "': " << std::strerror(mapErr) << "\n";
+    }
+
+    // voxels are accessed following the scintillation points, not in sequence
+    madvise(fMapAddress, fMapSize, MADV_RANDOM);
+
+    // the destructor is not called if the constructor throws: release the mapping
+    try {
+      FileHeader_t const& header = *static_cast<FileHeader_t const*>(fMapAddress);
+      if (!std::equal(MagicString, MagicString + sizeof(MagicString), header.magic)) {
+        throw cet::exception("PhotonLibraryMapped")
+          << "File '" << fFileName << "' is not a mapped photon library\n";
+      }
+      if (header.byteOrder != ByteOrderMark) {
+        throw cet::exception("PhotonLibraryMapped")
+          << "Photon library '" << fFileName << "' was written with a different byte order\n";
+      }
+      if (header.version != FormatVersion) {
+        throw cet::exception("PhotonLibraryMapped")
+          << "Photon library '" << fFileName << "' has format version " << header.version
+          << ", only version " << FormatVersion << " is supported\n";
+      }
+
+      // the file must hold all the blocks the header declares
+      if ((header.nOpChannels != 0) &&
+          (header.nVoxels > std::numeric_limits<std::uint64_t>::max() / sizeof(float) /
+                              header.nOpChannels)) {
+        throw cet::exception("PhotonLibraryMapped")
+          << "Photon library '" << fFileName << "' is corrupted: " << header.nVoxels
+          << " voxels and " << header.nOpChannels << " channels overflow the block size\n";
+      }
+      std::uint64_t const blockSize = header.nVoxels * header.nOpChannels * sizeof(float);
+      std::uint64_t lastOffset = header.directOffset;
+      if (header.flags & hasReflectedBlock) lastOffset = std::max(lastOffset, header.reflOffset);
+      if (header.flags & hasReflectedT0Block)
+        lastOffset = std::max(lastOffset, header.reflT0Offset);
+      if ((lastOffset > fMapSize) || (blockSize > fMapSize - lastOffset)) {
+        throw cet::exception("PhotonLibraryMapped")
+          << "Photon library '" << fFileName << "' is truncated: the header declares "
+          << blockSize << " byte blocks up to offset " << lastOffset << ", but the file has only "
+          << fMapSize << " bytes\n";
+      }
+
+      fNVoxels = header.nVoxels;
+      fNOpChannels = header.nOpChannels;
+      fVoxelDef = sim::PhotonVoxelDef(header.lower[0],
+                                      header.upper[0],
+                                      header.steps[0],
+                                      header.lower[1],
+                                      header.upper[1],
+                                      header.steps[1],
+                                      header.lower[2],
+                                      header.upper[2],
+                                      header.steps[2]);
+
+      fDirect = blockAt(header.directOffset);
+      if (header.flags & hasReflectedBlock) fRefl = blockAt(header.reflOffset);
+      if (header.flags & hasReflectedT0Block) fReflT0 = blockAt(header.reflT0Offset);
+    }
+    catch (...) {
+      munmap(fMapAddress, fMapSize);
+      fMapAddress = nullptr;
+      throw;
+    }
+
+    mf::LogInfo("PhotonLibraryMapped")
+      << "Photon lookup table size : " << fNVoxels << " voxels,  " << fNOpChannels
+      << " channels; " << fVoxelDef;
+  }
+
+  //------------------------------------------------------------
+  PhotonLibraryMapped::~PhotonLibraryMapped()
+  {
+    if (fMapAddress) munmap(fMapAddress, fMapSize);
+  }
+
+  //------------------------------------------------------------
+  float const* PhotonLibraryMapped::blockAt(std::uint64_t offset) const
+  {
+    std::uint64_t const blockSize = fNVoxels * fNOpChannels * sizeof(float);
+    if ((offset < sizeof(FileHeader_t)) || (offset % alignof(float) != 0) ||
+        (offset + blockSize > fMapSize)) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "Photon library '" << fFileName << "' is corrupted: block at offset " << offset
+        << " (" << blockSize << " bytes) does not fit a " << fMapSize << " byte file\n";
+    }
+    return reinterpret_cast<float const*>(static_cast<char const*>(fMapAddress) + offset);
+  }
+
+  //----------------------------------------------------
+  float PhotonLibraryMapped::GetCount(size_t Voxel, size_t OpChannel) const
+  {
+    return isInRange(Voxel, OpChannel) ? fDirect[uncheckedIndex(Voxel, OpChannel)] : 0;
+  }
+
+  //----------------------------------------------------
+  float PhotonLibraryMapped::GetReflCount(size_t Voxel, size_t OpChannel) const
+  {
+    return (fRefl && isInRange(Voxel, OpChannel)) ? fRefl[uncheckedIndex(Voxel, OpChannel)] : 0;
+  }
+
+  //----------------------------------------------------
+  float PhotonLibraryMapped::GetReflT0(size_t Voxel, size_t OpChannel) const
+  {
+    return (fReflT0 && isInRange(Voxel, OpChannel)) ? fReflT0[uncheckedIndex(Voxel, OpChannel)] :
+                                                      0;
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryMapped::GetCounts(size_t Voxel) const -> Counts_t
+  {
+    return (Voxel < fNVoxels) ? fDirect + uncheckedIndex(Voxel, 0) : nullptr;
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryMapped::GetReflCounts(size_t Voxel) const -> Counts_t
+  {
+    return (fRefl && (Voxel < fNVoxels)) ? fRefl + uncheckedIndex(Voxel, 0) : nullptr;
+  }
+
+  //----------------------------------------------------
+  auto PhotonLibraryMapped::GetReflT0s(size_t Voxel) const -> T0s_t
+  {
+    return (fReflT0 && (Voxel < fNVoxels)) ? fReflT0 + uncheckedIndex(Voxel, 0) : nullptr;
+  }
+
+  //------------------------------------------------------------
+  void PhotonLibraryMapped::StoreLibraryToFile(IPhotonLibrary const& lib,
+                                               sim::PhotonVoxelDef const& voxelDef,
+                                               std::string const& fileName,
+                                               bool storeReflected /* = false */,
+                                               bool storeReflT0 /* = false */)
+  {
+    if (storeReflected && !lib.hasReflected()) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "StoreLibraryToFile() requested to store reflected light, "
+           "which is not in the source library.\n";
+    }
+    if (storeReflT0 && !lib.hasReflectedT0()) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "StoreLibraryToFile() requested to store reflected light timing, "
+           "which is not in the source library.\n";
+    }
+
+    std::size_t const nVoxels = lib.NVoxels();
+    std::size_t const nChannels = lib.NOpChannels();
+    if (nVoxels != voxelDef.GetNVoxels()) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "StoreLibraryToFile(): library has " << nVoxels << " voxels, voxel definition "
+        << voxelDef.GetNVoxels() << "\n";
+    }
+
+    mf::LogInfo("PhotonLibraryMapped")
+      << "Writing photon library (" << nVoxels << " voxels, " << nChannels
+      << " channels) to file: " << fileName;
+
+    FileHeader_t header{};
+    std::copy(MagicString, MagicString + sizeof(MagicString), header.magic);
+    header.byteOrder = ByteOrderMark;
+    header.version = FormatVersion;
+    header.nVoxels = nVoxels;
+    header.nOpChannels = nChannels;
+
+    geo::Point_t const& lower = voxelDef.GetRegionLowerCorner();
+    geo::Point_t const& upper = voxelDef.GetRegionUpperCorner();
+    auto const steps = voxelDef.GetSteps();
+    header.lower[0] = lower.X();
+    header.lower[1] = lower.Y();
+    header.lower[2] = lower.Z();
+    header.upper[0] = upper.X();
+    header.upper[1] = upper.Y();
+    header.upper[2] = upper.Z();
+    for (std::size_t i = 0; i < 3; ++i)
+      header.steps[i] = steps[i];
+
+    std::uint64_t const blockSize = nVoxels * nChannels * sizeof(float);
+    std::uint64_t offset = alignBlock(sizeof(FileHeader_t));
+    header.directOffset = offset;
+    offset = alignBlock(offset + blockSize);
+    if (storeReflected) {
+      header.flags |= hasReflectedBlock;
+      header.reflOffset = offset;
+      offset = alignBlock(offset + blockSize);
+    }
+    if (storeReflT0) {
+      header.flags |= hasReflectedT0Block;
+      header.reflT0Offset = offset;
+    }
+
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "Can't open '" << fileName << "' for writing the photon library\n";
+    }
+
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    std::vector<float> const zeroes(nChannels, 0.0f);
+    auto writeBlock = [&](std::uint64_t blockOffset, auto getRow) {
+      // pad up to the start of the block
+      std::uint64_t const pos = out.tellp();
+      std::vector<char> const padding(blockOffset - pos, 0);
+      out.write(padding.data(), padding.size());
+      for (std::size_t voxel = 0; voxel < nVoxels; ++voxel) {
+        float const* row = getRow(voxel);
+        if (!row) row = zeroes.data();
+        out.write(reinterpret_cast<char const*>(row), nChannels * sizeof(float));
+      }
+    };
+
+    writeBlock(header.directOffset, [&lib](std::size_t v) { return lib.GetCounts(v); });
+    if (storeReflected)
+      writeBlock(header.reflOffset, [&lib](std::size_t v) { return lib.GetReflCounts(v); });
+    if (storeReflT0)
+      writeBlock(header.reflT0Offset, [&lib](std::size_t v) { return lib.GetReflT0s(v); });
+
+    if (!out) {
+      throw cet::exception("PhotonLibraryMapped")
+        << "Error while writing the photon library into '" << fileName << "'\n";
+    }
+  } // PhotonLibraryMapped::StoreLibraryToFile()
+
+  //----------------------------------------------------
+
+} // namespace phot
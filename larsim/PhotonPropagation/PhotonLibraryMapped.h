@@ -0,0 +1,143 @@
+////# PhotonLibraryMapped.h header file
+////#
+////# Read-only photon library backed by a memory-mapped flat binary file.
+#ifndef PHOTONLIBRARYMAPPED_H
+#define PHOTONLIBRARYMAPPED_H
+
+#include "larsim/PhotonPropagation/IPhotonLibrary.h"
+
+#include "larsim/Simulation/PhotonVoxels.h"
+
+#include <cstddef> // std::size_t
+#include <cstdint>
+#include <string>
+
+namespace phot {
+
+  /**
+   * @brief Photon library reading a flat binary file via `mmap()`.
+   *
+   * The library file is made of a fixed-size header (`FileHeader_t`) followed
+   * by up to three blocks of `float`: direct visibility, reflected visibility
+   * and reflected light arrival time. Each block is voxel-major, i.e. for each
+   * voxel all `NOpChannels()` channel values are stored in sequence, which is
+   * the same layout as `PhotonLibrary` keeps in memory. Each block starts on a
+   * page boundary.
+   *
+   * The file is mapped read-only and shared, so that `GetCounts()` returns a
+   * pointer straight into the mapped pages, startup time does not depend on
+   * the library size, and all the processes on the same node reading the same
+   * file share the page cache.
+   *
+   * A file in this format can be written from any other library via
+   * `StoreLibraryToFile()`; the `ConvertPhotonLibraryToMapped` program converts
+   * a ROOT tree library into this format.
+   *
+   * Propagation time parametrization is not supported.
+   */
+  class PhotonLibraryMapped : public IPhotonLibrary {
+  public:
+    /// Header of the library file (all fields in the byte order of the writer).
+    struct FileHeader_t {
+      char magic[8];             ///< File signature (`MagicString`).
+      std::uint32_t byteOrder;   ///< `ByteOrderMark` as written by the writer.
+      std::uint32_t version;     ///< Version of the format.
+      std::uint64_t nVoxels;     ///< Number of voxels.
+      std::uint64_t nOpChannels; ///< Number of channels per voxel.
+      double lower[3];           ///< Lower corner of the voxelized volume [cm]
+      double upper[3];           ///< Upper corner of the voxelized volume [cm]
+      std::uint32_t steps[3];    ///< Number of voxels on each direction.
+      std::uint32_t flags;       ///< Which blocks are present (`BlockFlags_t`).
+      std::uint64_t directOffset; ///< Offset of direct visibility block [bytes]
+      std::uint64_t reflOffset;   ///< Offset of reflected visibility block (or 0).
+      std::uint64_t reflT0Offset; ///< Offset of reflected time block (or 0).
+    }; // FileHeader_t
+
+    /// Bits of `FileHeader_t::flags`.
+    enum BlockFlags_t : std::uint32_t {
+      hasReflectedBlock = 0x1,  ///< Reflected visibility block is present.
+      hasReflectedT0Block = 0x2 ///< Reflected light timing block is present.
+    };
+
+    static constexpr char MagicString[8] = {'L', 'A', 'R', 'P', 'H', 'L', 'I', 'B'};
+    static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+    static constexpr std::uint32_t FormatVersion = 1;
+
+    /// Maps the library in the specified file; throws on any error.
+    explicit PhotonLibraryMapped(std::string const& fileName);
+
+    virtual ~PhotonLibraryMapped();
+
+    // the mapping is owned and can't be duplicated
+    PhotonLibraryMapped(PhotonLibraryMapped const&) = delete;
+    PhotonLibraryMapped& operator=(PhotonLibraryMapped const&) = delete;
+
+    virtual float GetCount(size_t Voxel, size_t OpChannel) const override;
+    virtual float GetReflCount(size_t Voxel, size_t OpChannel) const override;
+    virtual float GetReflT0(size_t Voxel, size_t OpChannel) const override;
+
+    /// Returns a pointer to NOpChannels() visibility values, one per channel
+    virtual Counts_t GetCounts(size_t Voxel) const override;
+    virtual Counts_t GetReflCounts(size_t Voxel) const override;
+    virtual T0s_t GetReflT0s(size_t Voxel) const override;
+
+    virtual bool hasReflected() const override { return fRefl != nullptr; }
+    virtual bool hasReflectedT0() const override { return fReflT0 != nullptr; }
+
+    virtual int NOpChannels() const override { return fNOpChannels; }
+    virtual int NVoxels() const override { return fNVoxels; }
+
+    virtual bool isVoxelValid(size_t Voxel) const override { return Voxel < fNVoxels; }
+
+    /// Returns the voxel definition stored in the library file.
+    sim::PhotonVoxelDef const& GetVoxelDef() const { return fVoxelDef; }
+
+    /**
+     * @brief Writes the content of a library into a file in the mapped format.
+     * @param lib the library to be written
+     * @param voxelDef the voxelization the library refers to
+     * @param fileName path of the file to be (over)written
+     * @param storeReflected whether to write reflected visibility as well
+     * @param storeReflT0 whether to write reflected light timing as well
+     *
+     * Visibilities are read via `lib.GetCounts()` one voxel at a time, so no
+     * additional copy of the library is held in memory.
+     */
+    static void StoreLibraryToFile(IPhotonLibrary const& lib,
+                                   sim::PhotonVoxelDef const& voxelDef,
+                                   std::string const& fileName,
+                                   bool storeReflected = false,
+                                   bool storeReflT0 = false);
+
+  private:
+    std::string fFileName;
+    void* fMapAddress = nullptr; ///< Start of the mapped memory.
+    std::size_t fMapSize = 0U;   ///< Size of the mapped memory [bytes]
+
+    std::size_t fNVoxels = 0U;
+    std::size_t fNOpChannels = 0U;
+    sim::PhotonVoxelDef fVoxelDef;
+
+    float const* fDirect = nullptr; ///< Start of the direct visibility block.
+    float const* fRefl = nullptr;   ///< Start of the reflected visibility block.
+    float const* fReflT0 = nullptr; ///< Start of the reflected timing block.
+
+    /// Returns a pointer to the block at `offset` after checking it is in the file.
+    float const* blockAt(std::uint64_t offset) const;
+
+    /// Returns the index of visibility of specified voxel and cell
+    size_t uncheckedIndex(size_t Voxel, size_t OpChannel) const
+    {
+      return Voxel * fNOpChannels + OpChannel;
+    }
+
+    bool isInRange(size_t Voxel, size_t OpChannel) const
+    {
+      return (Voxel < fNVoxels) && (OpChannel < fNOpChannels);
+    }
+
+  }; // class PhotonLibraryMapped
+
+} // namespace phot
+
+#endif // PHOTONLIBRARYMAPPED_H
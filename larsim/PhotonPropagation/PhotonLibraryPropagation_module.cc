@@ -11,6 +11,7 @@
 #include "larsim/IonizationScintillation/ISCalcSeparate.h"
 #include "larsim/PhotonPropagation/PhotonVisibilityService.h"
 #include "larsim/Simulation/LArG4Parameters.h"
+#include "larsim/Simulation/LitePhotonAccumulator.h"
 
 #include "nurandom/RandomUtils/NuRandomService.h"
 
@@ -28,36 +29,53 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
 
 using namespace std;
 
 namespace {
 
-  double single_exp(double t, double tau2) { return exp((-1.0 * t) / tau2) / tau2; }
-
-  double bi_exp(double t, double tau1, double tau2)
-  {
-    return (((exp((-1.0 * t) / tau2) * (1.0 - exp((-1.0 * t) / tau1))) / tau2) / tau2) *
-           (tau1 + tau2);
-  }
-
   // Returns the time within the time distribution of the scintillation process, when the photon was created.
   // Scintillation light has an exponential decay which here is given by the decay time, tau2,
   // and an exponential increase, which here is given by the rise time, tau1.
   // randflatscinttime is passed to use the saved seed from the RandomNumberSaver in order to be able to reproduce the same results.
+  // The distribution with rise time is the convolution of two exponential distributions
+  // with decay times tau2 and tau1*tau2/(tau1+tau2), and it is sampled exactly as the sum of two
+  // exponentially distributed times.
   double GetScintTime(double tau1, double tau2, CLHEP::RandFlat& randflatscinttime)
   {
     // tau1: rise time (originally defaulted to -1) and tau2: decay time
     //ran1, ran2 = random numbers for the algorithm
     if ((tau1 == 0.0) || (tau1 == -1.0)) { return -tau2 * log(randflatscinttime()); }
-    while (1) {
-      auto ran1 = randflatscinttime();
-      auto ran2 = randflatscinttime();
-      auto d = (tau1 + tau2) / tau2;
-      auto t = -tau2 * log(1 - ran1);
-      auto g = d * single_exp(t, tau2);
-      if (ran2 <= bi_exp(t, tau1, tau2) / g) { return t; }
+    auto const tauRise = tau1 * tau2 / (tau1 + tau2);
+    auto const ran1 = randflatscinttime();
+    auto const ran2 = randflatscinttime();
+    return -tau2 * log(ran1) - tauRise * log(ran2);
+  }
+
+  // Fills all the elements of times with scintillation times as GetScintTime() would,
+  // extracting all the needed random numbers at once.
+  void GetScintTimes(double tau1,
+                     double tau2,
+                     CLHEP::RandFlat& randflatscinttime,
+                     std::vector<double>& times,
+                     std::vector<double>& uniforms)
+  {
+    auto const n = times.size();
+    if (n == 0) return;
+    double* t = times.data();
+    if ((tau1 == 0.0) || (tau1 == -1.0)) {
+      randflatscinttime.fireArray(static_cast<int>(n), t);
+      for (std::size_t i = 0; i < n; ++i)
+        t[i] = -tau2 * log(t[i]);
+      return;
     }
+    uniforms.resize(2 * n);
+    double const* u = uniforms.data();
+    randflatscinttime.fireArray(static_cast<int>(2 * n), uniforms.data());
+    auto const tauRise = tau1 * tau2 / (tau1 + tau2);
+    for (std::size_t i = 0; i < n; ++i)
+      t[i] = -tau2 * log(u[2 * i]) - tauRise * log(u[2 * i + 1]);
   }
 
   double GetScintYield(sim::SimEnergyDeposit const& edep, detinfo::LArProperties const& larp)
@@ -201,6 +219,8 @@ namespace phot {
       photonLiteCollection[i].OpChannel = i;
       photonCollection[i].SetChannel(i);
     }
+    sim::LitePhotonAccumulator litePhotons{nOpChannels};
+    std::vector<double> scintTimes, scintUniforms; // buffers for the batch time sampling
     vector<vector<sim::SimEnergyDeposit> const*> edep_vecs;
     for (auto label : fEDepTags) {
       auto const& edep_handle = e.getValidHandle<vector<sim::SimEnergyDeposit>>(label);
@@ -234,23 +254,31 @@ namespace phot {
             if (nphot_fast > 0) {
               //throwing a random number from a poisson distribution with a mean of the amount of photons visible at this channel
               auto n = static_cast<int>(randpoisphot.fire(nphot_fast * visibleFraction));
-              for (long i = 0; i < n; ++i) {
-                //calculates the time at which the photon was produced
-                auto time = static_cast<int>(edep.T0() + GetScintTime(fRiseTimeFast,
-                                                                      larp->ScintFastTimeConst(),
-                                                                      randflatscinttime));
-                ++photonLiteCollection[channel].DetectedPhotons[time];
+              //calculates the times at which the photons were produced
+              scintTimes.resize(n);
+              GetScintTimes(fRiseTimeFast,
+                            larp->ScintFastTimeConst(),
+                            randflatscinttime,
+                            scintTimes,
+                            scintUniforms);
+              for (double const scintTime : scintTimes) {
+                auto time = static_cast<int>(edep.T0() + scintTime);
+                litePhotons.add(channel, time);
               }
             }
             if ((nphot_slow > 0) && fDoSlowComponent) {
               //throwing a random number from a poisson distribution with a mean of the amount of photons visible at this channel
               auto n = randpoisphot.fire(nphot_slow * visibleFraction);
-              for (long i = 0; i < n; ++i) {
-                //calculates the time at which the photon was produced
-                auto time = static_cast<int>(edep.T0() + GetScintTime(fRiseTimeSlow,
-                                                                      larp->ScintSlowTimeConst(),
-                                                                      randflatscinttime));
-                ++photonLiteCollection[channel].DetectedPhotons[time];
+              //calculates the times at which the photons were produced
+              scintTimes.resize(n);
+              GetScintTimes(fRiseTimeSlow,
+                            larp->ScintSlowTimeConst(),
+                            randflatscinttime,
+                            scintTimes,
+                            scintUniforms);
+              for (double const scintTime : scintTimes) {
+                auto time = static_cast<int>(edep.T0() + scintTime);
+                litePhotons.add(channel, time);
               }
             }
           }
@@ -288,6 +316,7 @@ namespace phot {
       }
     }
     if (lgp->UseLitePhotons()) {
+      litePhotons.fill(photonLiteCollection);
       // put the photon collection of LitePhotons into the art event
       e.put(move(photLiteCol));
     }
@@ -0,0 +1,173 @@
+#include "larsim/PhotonPropagation/PhotonLibraryTiming.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm> // std::find()
+#include <cmath>     // std::isnan()
+#include <limits>
+#include <memory> // std::make_unique()
+
+namespace phot {
+
+  //------------------------------------------------------------
+  PhotonLibraryTiming::PhotonLibraryTiming(std::string const& formula,
+                                           std::size_t nParameters,
+                                           std::size_t nVoxels,
+                                           std::size_t nOpChannels,
+                                           double maxTime,
+                                           std::size_t nBins /* = DefaultNBins */)
+    : fFormulaText(formula)
+    , fFormula("PhotonLibraryTiming", formula.c_str(), false)
+    , fNParameters(nParameters)
+    , fNVoxels(nVoxels)
+    , fNOpChannels(nOpChannels)
+    , fMaxTime(maxTime)
+    , fNBins(nBins)
+    , fNGuide(std::max(nBins / 4, std::size_t(1)))
+    , fParameters(nVoxels * nOpChannels * nParameters, std::numeric_limits<float>::quiet_NaN())
+  {
+    if (!fFormula.IsValid()) {
+      throw cet::exception("PhotonLibraryTiming")
+        << "Invalid propagation time formula: '" << fFormulaText << "'\n";
+    }
+    if (fNParameters == 0) {
+      throw cet::exception("PhotonLibraryTiming")
+        << "Propagation time parametrization requires at least one parameter (the time "
+           "lower bound)\n";
+    }
+    if ((fNBins == 0) || (fNBins > std::numeric_limits<std::uint32_t>::max())) {
+      throw cet::exception("PhotonLibraryTiming")
+        << "Invalid number of bins for propagation time sampling: " << fNBins << "\n";
+    }
+  }
+
+  //------------------------------------------------------------
+  void PhotonLibraryTiming::SetParameters(std::size_t Voxel,
+                                          std::size_t OpChannel,
+                                          float const* pars)
+  {
+    std::copy(pars, pars + fNParameters, fParameters.begin() + entryIndex(Voxel, OpChannel));
+  }
+
+  //------------------------------------------------------------
+  float const* PhotonLibraryTiming::GetParameters(std::size_t Voxel, std::size_t OpChannel) const
+  {
+    if ((Voxel >= fNVoxels) || (OpChannel >= fNOpChannels)) return nullptr;
+    float const* pars = fParameters.data() + entryIndex(Voxel, OpChannel);
+    return std::isnan(pars[0]) ? nullptr : pars;
+  }
+
+  //------------------------------------------------------------
+  double PhotonLibraryTiming::Eval(std::size_t Voxel, std::size_t OpChannel, double t) const
+  {
+    float const* storedPars = GetParameters(Voxel, OpChannel);
+    if (!storedPars || (t < storedPars[0]) || (t > fMaxTime)) return 0.0;
+
+    std::vector<double> pars(storedPars, storedPars + fNParameters);
+    pars[0] = 0.0; // the first parameter is the range lower bound
+    return threadCache().formula->EvalPar(&t, pars.data());
+  }
+
+  //------------------------------------------------------------
+  PhotonLibraryTimingSampler const* PhotonLibraryTiming::GetSamplers(std::size_t Voxel) const
+  {
+    if (Voxel >= fNVoxels) return nullptr;
+
+    SamplerCache_t& cache = threadCache();
+    auto const found = std::find(cache.voxels.begin(), cache.voxels.end(), Voxel);
+    if (found != cache.voxels.end())
+      return cache.samplers[found - cache.voxels.begin()].samplers.data();
+
+    // the oldest slot is reused, and so is the memory of its tables
+    std::size_t const slot = cache.next;
+    cache.next = (slot + 1) % CachedVoxelsPerThread;
+    cache.voxels[slot] = Voxel;
+    fillVoxelSamplers(Voxel, cache.samplers[slot], *cache.formula);
+    return cache.samplers[slot].samplers.data();
+  }
+
+  //------------------------------------------------------------
+  auto PhotonLibraryTiming::threadCache() const -> SamplerCache_t&
+  {
+    SamplerCache_t& cache = fSamplerCache.local();
+    if (!cache.formula) {
+      cache.formula = std::make_unique<TFormula>(fFormula);
+      cache.voxels.assign(CachedVoxelsPerThread, fNVoxels); // no valid voxel yet
+      cache.samplers.resize(CachedVoxelsPerThread);
+    }
+    return cache;
+  }
+
+  //------------------------------------------------------------
+  void PhotonLibraryTiming::fillVoxelSamplers(std::size_t Voxel,
+                                              VoxelSamplers_t& voxelSamplers,
+                                              TFormula const& formula) const
+  {
+    voxelSamplers.cumulative.resize(fNOpChannels * (fNBins + 1));
+    voxelSamplers.guide.resize(fNOpChannels * fNGuide);
+    voxelSamplers.samplers.assign(fNOpChannels, PhotonLibraryTimingSampler{});
+
+    std::vector<double> pars(fNParameters);
+    std::vector<double> integral;
+    for (std::size_t ch = 0; ch < fNOpChannels; ++ch) {
+      float* cumulative = voxelSamplers.cumulative.data() + ch * (fNBins + 1);
+      std::uint32_t* guide = voxelSamplers.guide.data() + ch * fNGuide;
+      if (!fillTables(formula, Voxel, ch, pars, integral, cumulative, guide)) continue;
+
+      double const tMin = fParameters[entryIndex(Voxel, ch)];
+      voxelSamplers.samplers[ch] = PhotonLibraryTimingSampler{
+        cumulative, guide, fNBins, fNGuide, tMin, (fMaxTime - tMin) / fNBins};
+    }
+  }
+
+  //------------------------------------------------------------
+  bool PhotonLibraryTiming::fillTables(TFormula const& formula,
+                                       std::size_t Voxel,
+                                       std::size_t OpChannel,
+                                       std::vector<double>& pars,
+                                       std::vector<double>& integral,
+                                       float* cumulative,
+                                       std::uint32_t* guide) const
+  {
+    float const* storedPars = GetParameters(Voxel, OpChannel);
+    if (!storedPars) return false;
+
+    double const tMin = storedPars[0];
+    if (!(fMaxTime > tMin)) return false;
+
+    std::copy(storedPars, storedPars + fNParameters, pars.begin());
+    pars[0] = 0.0; // the first parameter is the range lower bound
+
+    // trapezoidal integration on the bin edges
+    double const dt = (fMaxTime - tMin) / fNBins;
+    integral.resize(fNBins + 1);
+    integral[0] = 0.0;
+    double t = tMin;
+    double prev = std::max(formula.EvalPar(&t, pars.data()), 0.0);
+    for (std::size_t i = 1; i <= fNBins; ++i) {
+      t = tMin + i * dt;
+      double const value = std::max(formula.EvalPar(&t, pars.data()), 0.0);
+      integral[i] = integral[i - 1] + 0.5 * (prev + value) * dt;
+      prev = value;
+    }
+    double const total = integral[fNBins];
+    if (!(total > 0.0) || !std::isfinite(total)) return false;
+
+    for (std::size_t i = 0; i < fNBins; ++i)
+      cumulative[i] = integral[i] / total;
+    cumulative[fNBins] = 1.0f;
+
+    // guide[k]: first bin whose upper edge reaches probability k / fNGuide
+    std::uint32_t j = 0;
+    for (std::size_t k = 0; k < fNGuide; ++k) {
+      float const target = float(k) / fNGuide;
+      while ((j < fNBins - 1) && (cumulative[j + 1] < target))
+        ++j;
+      guide[k] = j;
+    }
+    return true;
+  } // PhotonLibraryTiming::fillTables()
+
+  //------------------------------------------------------------
+
+} // namespace phot
@@ -0,0 +1,198 @@
+////# PhotonLibraryTiming.h header file
+////#
+////# Parametrized propagation time distributions of a photon library.
+#ifndef PHOTONLIBRARYTIMING_H
+#define PHOTONLIBRARYTIMING_H
+
+#include "TFormula.h"
+
+#include "tbb/enumerable_thread_specific.h"
+
+#include <algorithm> // std::min()
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint32_t
+#include <memory>    // std::unique_ptr
+#include <string>
+#include <vector>
+
+namespace phot {
+
+  /**
+   * @brief Draws photon arrival times from a tabulated cumulative distribution.
+   *
+   * The sampler refers to the cumulative distribution tabulated on a uniform
+   * time grid of `nBins` bins, normalized to `1`, and to a guide table with the
+   * first bin reaching each of `nGuide` equally spaced probability values.
+   * A time is sampled at probability `u` by inverting the cumulative with
+   * linear interpolation inside the bin; the guide table makes the search
+   * constant time on average.
+   * The sampler does not own the tables and it has no state, so it can be
+   * used concurrently.
+   */
+  class PhotonLibraryTimingSampler {
+  public:
+    /// Default constructor: an invalid sampler.
+    PhotonLibraryTimingSampler() = default;
+
+    PhotonLibraryTimingSampler(float const* cumulative,
+                               std::uint32_t const* guide,
+                               std::size_t nBins,
+                               std::size_t nGuide,
+                               double tMin,
+                               double binWidth)
+      : fCumulative(cumulative)
+      , fGuide(guide)
+      , fNBins(nBins)
+      , fNGuide(nGuide)
+      , fTMin(tMin)
+      , fBinWidth(binWidth)
+    {}
+
+    /// Returns whether there is a distribution to sample from.
+    bool isValid() const { return fCumulative != nullptr; }
+
+    /// Returns the arrival time with cumulative probability `u` (in `[0;1]`).
+    double sample(double u) const
+    {
+      std::size_t j = fGuide[std::min(static_cast<std::size_t>(u * fNGuide), fNGuide - 1)];
+      while ((j < fNBins - 1) && (fCumulative[j + 1] < u))
+        ++j;
+      double const width = fCumulative[j + 1] - fCumulative[j];
+      double const f = (width > 0.0) ? std::min((u - fCumulative[j]) / width, 1.0) : 0.0;
+      return fTMin + (j + f) * fBinWidth;
+    }
+
+  private:
+    float const* fCumulative = nullptr;    ///< Cumulative, `fNBins + 1` values.
+    std::uint32_t const* fGuide = nullptr; ///< Guide table, `fNGuide` bin indices.
+    std::size_t fNBins = 0U;
+    std::size_t fNGuide = 0U;
+    double fTMin = 0.0;     ///< Lower bound of the time range.
+    double fBinWidth = 0.0; ///< Width of the bins of the cumulative.
+  }; // class PhotonLibraryTimingSampler
+
+  /**
+   * @brief Propagation time distributions of a photon library.
+   *
+   * For each voxel and channel, only the parameters of the distribution are
+   * stored. The distribution function is a single formula, compiled once and
+   * evaluated with the parameters of each entry; each thread evaluates its own
+   * copy of it, since `TFormula` evaluation is not guaranteed to be safe to be
+   * called concurrently.
+   *
+   * Consistently with the ROOT tree library format, the first parameter of
+   * each entry is the lower bound of the time range (the formula is evaluated
+   * with that parameter set to `0`), while the upper bound is common to all
+   * entries.
+   *
+   * Samplers (`PhotonLibraryTimingSampler`) for all the channels of a voxel are
+   * tabulated from the distributions on request. Each thread keeps the samplers
+   * of the last `CachedVoxelsPerThread` voxels it requested, so that the memory
+   * does not grow with the number of voxels visited: the samplers returned by
+   * `GetSamplers()` stay valid until the same thread has requested
+   * `CachedVoxelsPerThread` other voxels. All the methods are safe to be called
+   * concurrently, except for `SetParameters()`, which is meant to be used only
+   * while loading.
+   */
+  class PhotonLibraryTiming {
+  public:
+    /// Default number of bins of the tabulated distributions.
+    static constexpr std::size_t DefaultNBins = 400U;
+
+    /// Number of voxels whose samplers each thread keeps.
+    static constexpr std::size_t CachedVoxelsPerThread = 16U;
+
+    /**
+     * @brief Constructor: prepares storage for the parameters.
+     * @param formula distribution function (ROOT `TFormula` syntax, in `x`)
+     * @param nParameters number of parameters of each distribution
+     * @param nVoxels number of voxels in the library
+     * @param nOpChannels number of channels in the library
+     * @param maxTime upper bound of the time range [ns]
+     * @param nBins number of bins of the tabulated distributions
+     */
+    PhotonLibraryTiming(std::string const& formula,
+                        std::size_t nParameters,
+                        std::size_t nVoxels,
+                        std::size_t nOpChannels,
+                        double maxTime,
+                        std::size_t nBins = DefaultNBins);
+
+    PhotonLibraryTiming(PhotonLibraryTiming const&) = delete;
+    PhotonLibraryTiming& operator=(PhotonLibraryTiming const&) = delete;
+
+    /// Sets the `NParameters()` parameters of the distribution of an entry.
+    void SetParameters(std::size_t Voxel, std::size_t OpChannel, float const* pars);
+
+    /// Returns the parameters of an entry, `nullptr` if not available.
+    float const* GetParameters(std::size_t Voxel, std::size_t OpChannel) const;
+
+    /// Returns the value of the (unnormalized) distribution of an entry at `t`.
+    double Eval(std::size_t Voxel, std::size_t OpChannel, double t) const;
+
+    /// Returns `NOpChannels()` samplers for `Voxel` (`nullptr` if invalid voxel);
+    /// see the class documentation for how long they stay valid.
+    PhotonLibraryTimingSampler const* GetSamplers(std::size_t Voxel) const;
+
+    std::string const& Formula() const { return fFormulaText; }
+    std::size_t NParameters() const { return fNParameters; }
+
+  private:
+    /// Samplers of all the channels of a voxel, and their tables.
+    struct VoxelSamplers_t {
+      std::vector<float> cumulative;
+      std::vector<std::uint32_t> guide;
+      std::vector<PhotonLibraryTimingSampler> samplers;
+    };
+
+    /// Samplers of the voxels recently requested by one thread.
+    struct SamplerCache_t {
+      std::unique_ptr<TFormula> formula;    ///< This thread's copy of the function.
+      std::vector<std::size_t> voxels;      ///< Voxel in each slot.
+      std::vector<VoxelSamplers_t> samplers; ///< Samplers in each slot.
+      std::size_t next = 0U;                ///< Slot to be overwritten next.
+    };
+
+    std::string fFormulaText;
+    TFormula fFormula; ///< Compiled distribution function (only copied).
+    std::size_t fNParameters;
+    std::size_t fNVoxels;
+    std::size_t fNOpChannels;
+    double fMaxTime;
+    std::size_t fNBins;
+    std::size_t fNGuide; ///< Size of the guide tables.
+
+    /// Parameters, voxel- then channel-major; NaN where not available.
+    std::vector<float> fParameters;
+
+    /// Samplers recently created by each thread.
+    mutable tbb::enumerable_thread_specific<SamplerCache_t> fSamplerCache;
+
+    /// Returns the cache of the calling thread, with its copy of the function.
+    SamplerCache_t& threadCache() const;
+
+    /// Fills `voxelSamplers` with the samplers for all the channels of `Voxel`.
+    void fillVoxelSamplers(std::size_t Voxel,
+                           VoxelSamplers_t& voxelSamplers,
+                           TFormula const& formula) const;
+
+    /// Fills the normalized cumulative and the guide table of an entry.
+    /// @return whether the distribution has a positive integral
+    bool fillTables(TFormula const& formula,
+                    std::size_t Voxel,
+                    std::size_t OpChannel,
+                    std::vector<double>& pars,
+                    std::vector<double>& integral,
+                    float* cumulative,
+                    std::uint32_t* guide) const;
+
+    std::size_t entryIndex(std::size_t Voxel, std::size_t OpChannel) const
+    {
+      return (Voxel * fNOpChannels + OpChannel) * fNParameters;
+    }
+
+  }; // class PhotonLibraryTiming
+
+} // namespace phot
+
+#endif // PHOTONLIBRARYTIMING_H
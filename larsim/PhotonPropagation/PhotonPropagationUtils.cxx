@@ -6,24 +6,6 @@
 
 namespace phot {
 
-  //......................................................................
-  double fast_acos(double x)
-  {
-    double negate = double(x < 0.);
-    x = std::abs(x);
-    x -= double(x > 1.) * (x - 1.); // <- equivalent to min(1.,x), but faster
-    double ret = -0.0187293;
-    ret = ret * x;
-    ret = ret + 0.0742610;
-    ret = ret * x;
-    ret = ret - 0.2121144;
-    ret = ret * x;
-    ret = ret + 1.5707288;
-    ret = ret * std::sqrt(1. - x);
-    ret = ret - 2. * negate * ret;
-    return negate * 3.14159265358979 + ret;
-  }
-
   //......................................................................
   // Returns interpolated value at x from parallel arrays ( xData, yData )
   // Assumes that xData has at least two elements, is sorted and is strictly
@@ -28,7 +28,9 @@
 #include "larcore/Geometry/Geometry.h"
 #include "larcorealg/Geometry/OpDetGeo.h"
 #include "larsim/PhotonPropagation/PhotonLibrary.h"
+#include "larsim/PhotonPropagation/PhotonLibraryCompressed.h"
 #include "larsim/PhotonPropagation/PhotonLibraryHybrid.h"
+#include "larsim/PhotonPropagation/PhotonLibraryMapped.h"
 #include "larsim/Simulation/PhotonVoxels.h"
 
 // framework libraries
@@ -44,6 +46,7 @@
 #include "TF1.h"
 
 // C/C++ standard libraries
+#include <algorithm> // std::min()
 
 namespace phot {
 
@@ -85,6 +88,8 @@ namespace phot {
     , fDoNotLoadLibrary(false)
     , fParameterization(false)
     , fHybrid(false)
+    , fMapped(false)
+    , fCompressLibrary(false)
     , fStoreReflected(false)
     , fStoreReflT0(false)
     , fIncludePropTime(false)
@@ -169,6 +174,37 @@ namespace phot {
           if (fHybrid) {
             fTheLibrary = new PhotonLibraryHybrid(LibraryFileWithPath, GetVoxelDef());
           }
+          else if (fMapped) {
+            PhotonLibraryMapped* lib = new PhotonLibraryMapped(LibraryFileWithPath);
+            fTheLibrary = lib;
+
+            if (lib->NVoxels() != (int)GetVoxelDef().GetNVoxels()) {
+              throw art::Exception(art::errors::Configuration)
+                << "Photon library '" << LibraryFileWithPath << "' has " << lib->NVoxels()
+                << " voxels, while PhotonVisibilityService is configured for "
+                << GetVoxelDef().GetNVoxels() << ".\n";
+            }
+            if ((fStoreReflected && !lib->hasReflected()) ||
+                (fStoreReflT0 && !lib->hasReflectedT0())) {
+              throw art::Exception(art::errors::Configuration)
+                << "Photon library '" << LibraryFileWithPath
+                << "' does not include the requested reflected light information.\n";
+            }
+            if (GetVoxelDef() != lib->GetVoxelDef()) {
+              mf::LogWarning("PhotonVisbilityService")
+                << "Photon library reports the geometry:\n"
+                << lib->GetVoxelDef() << "while PhotonVisbilityService is configured with:\n"
+                << GetVoxelDef();
+            }
+          }
+          else if (fCompressLibrary) {
+            // encoded while reading, without loading the full precision library
+            fTheLibrary = new PhotonLibraryCompressed(LibraryFileWithPath,
+                                                      GetVoxelDef().GetNVoxels(),
+                                                      fStoreReflected,
+                                                      fStoreReflT0,
+                                                      fCompressionConfig);
+          }
           else {
             PhotonLibrary* lib = new PhotonLibrary;
             fTheLibrary = lib;
@@ -198,6 +234,12 @@ namespace phot {
                 << GetVoxelDef();
             } // if metadata
           }
+
+          if (fMapped && fCompressLibrary) {
+            // the mapped library is only needed for the encoding
+            std::unique_ptr<IPhotonLibrary> source{fTheLibrary};
+            fTheLibrary = new PhotonLibraryCompressed(*source, fCompressionConfig);
+          }
         }
       }
       else {
@@ -260,6 +302,7 @@ namespace phot {
     fLibraryBuildJob = p.get<bool>("LibraryBuildJob", false);
     fParameterization = p.get<bool>("DUNE10ktParameterization", false);
     fHybrid = p.get<bool>("HybridLibrary", false);
+    fMapped = p.get<bool>("MappedLibrary", false);
     fLibraryFile = p.get<std::string>("LibraryFile", "");
     fDoNotLoadLibrary = p.get<bool>("DoNotLoadLibrary");
     fStoreReflected = p.get<bool>("StoreReflected", false);
@@ -282,6 +325,19 @@ namespace phot {
 
     if (!fParPropTime) { fParPropTime_npar = 0; }
 
+    fCompressLibrary = p.get<bool>("CompressLibrary", false);
+    if (fCompressLibrary) {
+      if (fLibraryBuildJob || fHybrid || fParPropTime) {
+        throw art::Exception(art::errors::Configuration)
+          << "PhotonVisibilityService: `CompressLibrary` is not supported for library building, "
+             "hybrid libraries or libraries with parametrized propagation time.\n";
+      }
+      fCompressionConfig.encoding = PhotonLibraryCompressed::parseEncoding(
+        p.get<std::string>("CompressionEncoding", "Auto"));
+      fCompressionConfig.maxRelError = p.get<double>("CompressionMaxRelError", 1e-3);
+      fCompressionConfig.sparse = p.get<bool>("CompressionSparse", false);
+    }
+
     if (!fUseNhitsModel) {
 
       if (fUseCryoBoundary) {
@@ -396,6 +452,18 @@ namespace phot {
 
   auto PhotonVisibilityService::doGetAllVisibilities(geo::Point_t const& p,
                                                      bool wantReflected) const -> MappedCounts_t
+  {
+    // callers often hold the direct and the reflected visibilities together
+    thread_local std::vector<float> directBuffer;
+    thread_local std::vector<float> reflBuffer;
+    return doGetAllVisibilities(p, wantReflected ? reflBuffer : directBuffer, wantReflected);
+  }
+
+  //------------------------------------------------------
+
+  auto PhotonVisibilityService::doGetAllVisibilities(geo::Point_t const& p,
+                                                     std::vector<float>& buffer,
+                                                     bool wantReflected) const -> MappedCounts_t
   {
     phot::IPhotonLibrary::Counts_t data{};
 
@@ -403,13 +471,8 @@ namespace phot {
     // (it is directly the values of the library unless interpolation is
     //  requested)
     if (fInterpolate) {
-      // this is a punch into multithreading face:
-      static std::vector<float> ret;
-      ret.resize(fMapping->libraryMappingSize(p));
-      for (std::size_t libIndex = 0; libIndex < ret.size(); ++libIndex) {
-        ret[libIndex] = doGetVisibilityOfOpLib(p, LibraryIndex_t(libIndex), wantReflected);
-      }
-      data = &ret.front();
+      doInterpolateVisibilities(p, buffer, wantReflected);
+      data = buffer.data();
     }
     else {
       auto const VoxID = VoxelAt(p);
@@ -420,6 +483,36 @@ namespace phot {
 
   //------------------------------------------------------
 
+  void PhotonVisibilityService::doInterpolateVisibilities(geo::Point_t const& p,
+                                                          std::vector<float>& buffer,
+                                                          bool wantReflected) const
+  {
+    buffer.assign(fMapping->libraryMappingSize(p), 0.0f);
+
+    // In case we're outside the bounding box we'll get a empty optional list.
+    auto const neis = GetVoxelDef().GetNeighboringVoxelIDs(LibLocation(p));
+    if (!neis) return;
+
+    if (fTheLibrary == 0) LoadLibrary();
+    std::size_t const nChannels =
+      std::min(buffer.size(), static_cast<std::size_t>(fTheLibrary->NOpChannels()));
+
+    // Sum up all the weighted neighbours to get interpolation behaviour;
+    // the neighbours are found once, and each contributes a whole library row
+    // (the sum is in the same order as in `doGetVisibilityOfOpLib()`)
+    float* const vis = buffer.data();
+    for (const sim::PhotonVoxelDef::NeiInfo& n : neis.value()) {
+      if (n.id < 0) continue;
+      phot::IPhotonLibrary::Counts_t const counts = GetLibraryEntries(n.id, wantReflected);
+      if (!counts) continue;
+      double const weight = n.weight;
+      for (std::size_t i = 0; i < nChannels; ++i)
+        vis[i] += weight * counts[i];
+    }
+  }
+
+  //------------------------------------------------------
+
   // Get distance to optical detector OpDet
   double PhotonVisibilityService::DistanceToOpDetImpl(geo::Point_t const& p, unsigned int OpDet)
   {
@@ -608,11 +701,12 @@ namespace phot {
     return fMapping->applyOpDetMapping(p, params);
   }
 
-  auto PhotonVisibilityService::doGetTimingTF1(geo::Point_t const& p) const -> MappedFunctions_t
+  auto PhotonVisibilityService::doGetTimingSamplers(geo::Point_t const& p) const
+    -> MappedTimingSamplers_t
   {
     int const VoxID = VoxelAt(p);
-    phot::IPhotonLibrary::Functions_t const& functions = GetLibraryTimingTF1Entries(VoxID);
-    return fMapping->applyOpDetMapping(p, functions);
+    phot::PhotonLibraryTimingSampler const* samplers = GetLibraryTimingSamplers(VoxID);
+    return fMapping->applyOpDetMapping(p, samplers);
   }
 
   //------------------------------------------------------
@@ -628,13 +722,13 @@ namespace phot {
 
   //------------------------------------------------------
 
-  phot::IPhotonLibrary::Functions_t PhotonVisibilityService::GetLibraryTimingTF1Entries(
+  phot::PhotonLibraryTimingSampler const* PhotonVisibilityService::GetLibraryTimingSamplers(
     int VoxID) const
   {
-    PhotonLibrary* lib = dynamic_cast<PhotonLibrary*>(fTheLibrary);
     if (fTheLibrary == 0) LoadLibrary();
+    PhotonLibrary const* lib = dynamic_cast<PhotonLibrary const*>(fTheLibrary);
 
-    return lib->GetTimingTF1s(VoxID);
+    return lib ? lib->GetTimingSamplers(VoxID) : nullptr;
   }
 
   //------------------------------------------------------
@@ -655,19 +749,6 @@ namespace phot {
 
   //------------------------------------------------------
 
-  void PhotonVisibilityService::SetLibraryTimingTF1Entry(int VoxID, int OpChannel, TF1 const& func)
-  {
-    PhotonLibrary* lib = dynamic_cast<PhotonLibrary*>(fTheLibrary);
-    if (fTheLibrary == 0) LoadLibrary();
-
-    lib->SetTimingTF1(VoxID, OpChannel, func);
-
-    MF_LOG_DEBUG("PhotonVisibilityService")
-      << " PVS logging " << VoxID << " " << OpChannel << std::endl;
-  }
-
-  //------------------------------------------------------
-
   float PhotonVisibilityService::GetLibraryTimingParEntry(int VoxID,
                                                           OpDetID_t libOpChannel,
                                                           size_t npar) const
@@ -14,6 +14,7 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h" // geo::Point_t
 #include "larsim/PhotonPropagation/IPhotonLibrary.h"
 #include "larsim/PhotonPropagation/LibraryMappingTools/IPhotonMappingTransformations.h"
+#include "larsim/PhotonPropagation/PhotonLibraryCompressed.h"
 #include "larsim/PhotonPropagation/PhotonVisibilityTypes.h"
 #include "larsim/Simulation/PhotonVoxels.h"
 
@@ -70,12 +71,25 @@ namespace phot {
       return doGetVisibility(geo::vect::toPoint(p), OpChannel, wantReflected);
     }
 
+    /// Returns the visibilities of all the optical detectors from `p`.
+    /// With interpolation, the values are stored in a thread-local buffer
+    /// (one for direct and one for reflected light) reused by the next call.
     template <typename Point>
     MappedCounts_t GetAllVisibilities(Point const& p, bool wantReflected = false) const
     {
       return doGetAllVisibilities(geo::vect::toPoint(p), wantReflected);
     }
 
+    /// Same as `GetAllVisibilities(p, wantReflected)`, but interpolated values
+    /// are stored in `buffer`, and are valid as long as `buffer` is unchanged.
+    template <typename Point>
+    MappedCounts_t GetAllVisibilities(Point const& p,
+                                      std::vector<float>& buffer,
+                                      bool wantReflected = false) const
+    {
+      return doGetAllVisibilities(geo::vect::toPoint(p), buffer, wantReflected);
+    }
+
     void LoadLibrary() const;
     void StoreLibrary();
 
@@ -105,13 +119,13 @@ namespace phot {
     phot::IPhotonLibrary::Params_t GetLibraryTimingParEntries(int VoxID) const;
     float GetLibraryTimingParEntry(int VoxID, OpDetID_t libOpChannel, size_t npar) const;
 
+    /// Returns samplers of the parametrized propagation time for each channel.
     template <typename Point>
-    MappedFunctions_t GetTimingTF1(Point const& p) const
+    MappedTimingSamplers_t GetTimingSamplers(Point const& p) const
     {
-      return doGetTimingTF1(geo::vect::toPoint(p));
+      return doGetTimingSamplers(geo::vect::toPoint(p));
     }
-    void SetLibraryTimingTF1Entry(int VoxID, int OpChannel, TF1 const& func);
-    phot::IPhotonLibrary::Functions_t GetLibraryTimingTF1Entries(int VoxID) const;
+    phot::PhotonLibraryTimingSampler const* GetLibraryTimingSamplers(int VoxID) const;
 
     void SetDirectLightPropFunctions(TF1 const* functions[8],
                                      double& d_break,
@@ -185,6 +199,9 @@ namespace phot {
     bool fDoNotLoadLibrary;
     bool fParameterization;
     bool fHybrid;
+    bool fMapped; ///< Library file is in the memory-mapped format.
+    bool fCompressLibrary; ///< Library is encoded into quantized visibilities.
+    PhotonLibraryCompressed::Config_t fCompressionConfig;
     bool fStoreReflected;
     bool fStoreReflT0;
     bool fIncludePropTime;
@@ -292,11 +309,21 @@ namespace phot {
 
     MappedCounts_t doGetAllVisibilities(geo::Point_t const& p, bool wantReflected = false) const;
 
+    MappedCounts_t doGetAllVisibilities(geo::Point_t const& p,
+                                        std::vector<float>& buffer,
+                                        bool wantReflected = false) const;
+
+    /// Fills `buffer` with the visibilities from `p` interpolated among the
+    /// neighbouring voxels, for all the library indices.
+    void doInterpolateVisibilities(geo::Point_t const& p,
+                                   std::vector<float>& buffer,
+                                   bool wantReflected) const;
+
     MappedT0s_t doGetReflT0s(geo::Point_t const& p) const;
 
     MappedParams_t doGetTimingPar(geo::Point_t const& p) const;
 
-    MappedFunctions_t doGetTimingTF1(geo::Point_t const& p) const;
+    MappedTimingSamplers_t doGetTimingSamplers(geo::Point_t const& p) const;
 
     /// @}
     // --- END Implementation functions ----------------------------------------
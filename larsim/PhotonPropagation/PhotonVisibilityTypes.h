@@ -18,6 +18,7 @@
 // LArSoft libraries
 #include "larsim/PhotonPropagation/IPhotonLibrary.h"
 #include "larsim/PhotonPropagation/LibraryMappingTools/IPhotonMappingTransformations.h"
+#include "larsim/PhotonPropagation/PhotonLibraryTiming.h"
 
 namespace phot {
 
@@ -61,16 +62,16 @@ namespace phot {
     phot::IPhotonMappingTransformations::MappedOpDetData_t<phot::IPhotonLibrary::Params_t>;
 
   /**
-   * @brief Type of mapped parametrization functions.
+   * @brief Type of mapped samplers of parametrized propagation time.
    *
    * No data storage is provided.
    *
    * This is the type returned by `phot::PhotonVisibilityService` when asked
-   * about any parameter directlyt described by functions (glorious ROOT `TF1`),
-   * from a point to _all_ the optical detectors.
+   * about the propagation time distributions from a point to _all_ the optical
+   * detectors. It used to be a collection of ROOT `TF1`.
    */
-  using MappedFunctions_t =
-    phot::IPhotonMappingTransformations::MappedOpDetData_t<phot::IPhotonLibrary::Functions_t>;
+  using MappedTimingSamplers_t = phot::IPhotonMappingTransformations::MappedOpDetData_t<
+    phot::PhotonLibraryTimingSampler const*>;
 
 } // namespace phot
 
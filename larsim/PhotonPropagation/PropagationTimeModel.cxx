@@ -340,7 +340,9 @@ namespace phot {
     // cut-off and tau
     // cut-off
     // interpolate in d_c for each r bin
-    std::vector<double> interp_vals(fcut_off_pars[theta_bin].size(), 0.0);
+    // (scratch buffers reused across calls)
+    thread_local std::vector<double> interp_vals;
+    interp_vals.resize(fcut_off_pars[theta_bin].size());
     for (size_t i = 0; i < fcut_off_pars[theta_bin].size(); i++) {
       interp_vals[i] =
         interpolate(fdistances_refl, fcut_off_pars[theta_bin][i], distance_cathode_plane, true);
@@ -350,7 +352,8 @@ namespace phot {
 
     // tau
     // interpolate in x for each r bin
-    std::vector<double> interp_vals_tau(ftau_pars[theta_bin].size(), 0.0);
+    thread_local std::vector<double> interp_vals_tau;
+    interp_vals_tau.resize(ftau_pars[theta_bin].size());
     for (size_t i = 0; i < ftau_pars[theta_bin].size(); i++) {
       interp_vals_tau[i] =
         interpolate(fdistances_refl, ftau_pars[theta_bin][i], distance_cathode_plane, true);
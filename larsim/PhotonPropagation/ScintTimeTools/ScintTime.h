@@ -8,6 +8,8 @@
 #ifndef ScintTime_H
 #define ScintTime_H
 
+#include <vector>
+
 namespace CLHEP {
   class HepRandomEngine;
 }
@@ -23,6 +25,20 @@ namespace phot {
     virtual double fastScintTime() = 0;
     virtual double slowScintTime() = 0;
 
+    /// Fills all the elements of `times` with emission times of fast scintillation photons.
+    virtual void fastScintTimes(std::vector<double>& times)
+    {
+      for (double& t : times)
+        t = fastScintTime();
+    }
+
+    /// Fills all the elements of `times` with emission times of slow scintillation photons.
+    virtual void slowScintTimes(std::vector<double>& times)
+    {
+      for (double& t : times)
+        t = slowScintTime();
+    }
+
   protected:
     // FIXME: This should be private, with a protected setter.
     //        2022-04-10 CHG
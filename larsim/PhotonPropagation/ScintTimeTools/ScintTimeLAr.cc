@@ -10,6 +10,9 @@
 
 #include "fhiclcpp/ParameterSet.h"
 
+#include <cmath>
+#include <iostream>
+
 namespace phot {
   //......................................................................
   ScintTimeLAr::ScintTimeLAr(fhicl::ParameterSet const& pset)
@@ -18,8 +21,8 @@ namespace phot {
     , SDTime{pset.get<double>("SlowDecayTime", 0.)}
     , FRTime{pset.get<double>("FastRisingTime", 0.)}
     , FDTime{pset.get<double>("FastDecayTime", 0.)}
-    , fNoFastRisingTime((FRTime >= 1.e-8) && (FRTime != -1.))
-    , fNoSlowRisingTime((SRTime >= 1.e-8) && (SRTime != -1.))
+    , fNoFastRisingTime((FRTime < 1.e-8) || (FRTime == -1.))
+    , fNoSlowRisingTime((SRTime < 1.e-8) || (SRTime == -1.))
   {
     if (LogLevel >= 1) {
       std::cout << "ScintTimeLAr Tool configure:" << std::endl;
@@ -34,32 +37,46 @@ namespace phot {
   }
 
   //......................................................................
-  double ScintTimeLAr::single_exp(double t, double tau2) const
+  // The distribution with rising time,
+  //   (tau1 + tau2) / tau2^2 * exp(-t/tau2) * (1 - exp(-t/tau1)),
+  // is the convolution of two exponential distributions with decay times
+  // tau2 and tau1*tau2/(tau1+tau2): the time is sampled exactly as the sum
+  // of two exponential times.
+  double ScintTimeLAr::with_rising_time(double tau1, double tau2, CLHEP::RandFlat& flat) const
   {
-    return std::exp((-1.0 * t) / tau2) / tau2;
+    double const tauRise = tau1 * tau2 / (tau1 + tau2);
+    double const ran1 = flat.fire();
+    double const ran2 = flat.fire();
+    return -tau2 * std::log(ran1) - tauRise * std::log(ran2);
   }
 
   //......................................................................
-  double ScintTimeLAr::bi_exp(double t, double tau1, double tau2) const
+  // Same sampling as the single time methods, with all the random numbers
+  // extracted at once; the uniform numbers are transformed in place.
+  void ScintTimeLAr::fill_scint_times(std::vector<double>& times,
+                                      double tau1,
+                                      double tau2,
+                                      bool noRisingTime)
   {
-    return (((std::exp((-1.0 * t) / tau2) * (1.0 - std::exp((-1.0 * t) / tau1))) / tau2) / tau2) *
-           (tau1 + tau2);
-  }
+    std::size_t const n = times.size();
+    if (n == 0) return;
+    double* t = times.data();
 
-  //......................................................................
-  double ScintTimeLAr::with_rising_time(double tau1, double tau2)
-  {
-    // TODO: This method is very inefficient.
-    // If we care about simulating the rising time, it would be better
-    // to simulate random numbers according a general distribution
-    double d = (tau1 + tau2) / tau2;
-    while (1) {
-      double ran1 = fUniformGen->fire();
-      double ran2 = fUniformGen->fire();
-      double t = -tau2 * std::log(1 - ran1);
-      double g = d * single_exp(t, tau2);
-      if (ran2 <= bi_exp(t, tau1, tau2) / g) { return t; }
+    if (noRisingTime) {
+      fUniformGen->fireArray(static_cast<int>(n), t);
+      for (std::size_t i = 0; i < n; ++i)
+        t[i] = -tau2 * std::log(t[i]);
+      return;
     }
+
+    // two uniform numbers per photon, in the same order as with_rising_time()
+    thread_local std::vector<double> uniforms;
+    uniforms.resize(2 * n);
+    double const* u = uniforms.data();
+    fUniformGen->fireArray(static_cast<int>(2 * n), uniforms.data());
+    double const tauRise = tau1 * tau2 / (tau1 + tau2);
+    for (std::size_t i = 0; i < n; ++i)
+      t[i] = -tau2 * std::log(u[2 * i]) - tauRise * std::log(u[2 * i + 1]);
   }
 
   //......................................................................
@@ -89,30 +106,29 @@ namespace phot {
       return;
     }
 
-    //ran1, ran2 = random numbers for the algorithm
-    while (1) {
-      auto ran1 = randflatscinttime();
-      auto ran2 = randflatscinttime();
-      auto d = (tau1 + tau2) / tau2;
-      auto t = -tau2 * std::log(1 - ran1);
-      auto g = d * single_exp(t, tau2);
-      if (ran2 <= bi_exp(t, tau1, tau2) / g) {
-        timing = t;
-        return;
-      }
-    }
+    timing = with_rising_time(tau1, tau2, randflatscinttime);
   }
 
-  inline double ScintTimeLAr::fastScintTime()
+  double ScintTimeLAr::fastScintTime()
   {
     if (fNoFastRisingTime) { return -FDTime * std::log(fUniformGen->fire()); }
-    return with_rising_time(FRTime, FDTime);
+    return with_rising_time(FRTime, FDTime, *fUniformGen);
   }
 
-  inline double ScintTimeLAr::slowScintTime()
+  double ScintTimeLAr::slowScintTime()
   {
     if (fNoSlowRisingTime) { return -SDTime * std::log(fUniformGen->fire()); }
-    return with_rising_time(SRTime, SDTime);
+    return with_rising_time(SRTime, SDTime, *fUniformGen);
+  }
+
+  void ScintTimeLAr::fastScintTimes(std::vector<double>& times)
+  {
+    fill_scint_times(times, FRTime, FDTime, fNoFastRisingTime);
+  }
+
+  void ScintTimeLAr::slowScintTimes(std::vector<double>& times)
+  {
+    fill_scint_times(times, SRTime, SDTime, fNoSlowRisingTime);
   }
 
 }
@@ -15,6 +15,7 @@
 #include "larsim/PhotonPropagation/ScintTimeTools/ScintTime.h"
 
 #include <memory>
+#include <vector>
 
 namespace fhicl {
   class ParameterSet;
@@ -24,10 +25,12 @@ namespace phot {
   class ScintTimeLAr : public ScintTime {
   public:
     explicit ScintTimeLAr(fhicl::ParameterSet const& pset);
-    void initRand(CLHEP::HepRandomEngine& engine);
-    void GenScintTime(bool is_fast, CLHEP::HepRandomEngine& engine);
-    double fastScintTime();
-    double slowScintTime();
+    void initRand(CLHEP::HepRandomEngine& engine) override;
+    void GenScintTime(bool is_fast, CLHEP::HepRandomEngine& engine) override;
+    double fastScintTime() override;
+    double slowScintTime() override;
+    void fastScintTimes(std::vector<double>& times) override;
+    void slowScintTimes(std::vector<double>& times) override;
 
   private:
     int LogLevel;
@@ -40,9 +43,8 @@ namespace phot {
     const bool fNoFastRisingTime, fNoSlowRisingTime;
 
     // general functions
-    double single_exp(double t, double tau2) const;
-    double bi_exp(double t, double tau1, double tau2) const;
-    double with_rising_time(double tau1, double tau2);
+    double with_rising_time(double tau1, double tau2, CLHEP::RandFlat& flat) const;
+    void fill_scint_times(std::vector<double>& times, double tau1, double tau2, bool noRisingTime);
   };
 }
 #endif
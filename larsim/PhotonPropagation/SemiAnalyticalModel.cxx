@@ -16,7 +16,12 @@
 
 #include "TMath.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "boost/math/special_functions/ellint_1.hpp"
@@ -86,6 +91,13 @@ namespace phot {
       fborder_corr_dome = VUVHitsParams.get<std::vector<std::vector<double>>>("GH_border_dome");
     }
 
+    // group the detectors by shape and orientation, with their corrections
+    fOpDetGroups = opDetGroups();
+
+    // tabulated solid angle of disk PMTs
+    if (VUVHitsParams.get<bool>("UseDiskSolidAngleTable", false))
+      fDiskSolidAngleTable = diskSolidAngleTable(VUVHitsParams);
+
     // Load corrections for VIS semi-analytic hits
     if (fDoReflectedLight) {
       mf::LogInfo("SemiAnalyticalModel") << "Using VIS (reflected) visibility parameterization";
@@ -175,144 +187,133 @@ namespace phot {
   void SemiAnalyticalModel::detectedDirectVisibilities(std::vector<double>& DetectedVisibilities,
                                                        geo::Point_t const& ScintPoint) const
   {
+    thread_local VUVWorkspace_t ws;
     DetectedVisibilities.resize(fNOpDets);
-    for (size_t const OpDet : util::counter(fNOpDets)) {
-      if (!isOpDetInSameTPC(ScintPoint, fOpDetector[OpDet].center)) {
-        DetectedVisibilities[OpDet] = 0.;
-        continue;
-      }
-
-      DetectedVisibilities[OpDet] = VUVVisibility(ScintPoint, fOpDetector[OpDet]);
-      ;
-    }
+    for (OpDetGroup_t const& group : fOpDetGroups)
+      directVisibilities(DetectedVisibilities.data(), ScintPoint, group, ws);
   }
 
-  double SemiAnalyticalModel::VUVVisibility(geo::Point_t const& ScintPoint,
-                                            OpticalDetector const& opDet) const
+  // The calculation runs in stages over all the detectors of the group: the
+  // geometry (branch-free, vectorizable), the solid angle, then the corrections.
+  void SemiAnalyticalModel::directVisibilities(double* DetectedVisibilities,
+                                               geo::Point_t const& ScintPoint,
+                                               OpDetGroup_t const& group,
+                                               VUVWorkspace_t& ws) const
   {
-    // distance and angle between ScintPoint and OpDet center
-    geo::Vector_t const relative = ScintPoint - opDet.center;
-    const double distance = relative.R();
-    double cosine;
-    if (opDet.orientation == 1)
-      cosine = std::abs(relative.Y()) / distance;
-    else
-      cosine = std::abs(relative.X()) / distance;
-    const double theta = fast_acos(cosine) * 180. / CLHEP::pi;
+    const size_t n = group.opDet.size();
+    ws.resize(n);
+    const bool lateral = (group.orientation == 1);
+    const double px = ScintPoint.X();
+    const double py = ScintPoint.Y();
+    const double pz = ScintPoint.Z();
+    const bool twoTPCs = (fNTPC == 2);
 
-    double solid_angle = 0.;
+    // distance and angle between ScintPoint and OpDet center
+    double const* gx = group.x.data();
+    double const* gy = group.y.data();
+    double const* gz = group.z.data();
+    double* dx = ws.dx.data();
+    double* dy = ws.dy.data();
+    double* dz = ws.dz.data();
+    double* distance = ws.distance.data();
+    double* cosine = ws.cosine.data();
+    double* theta = ws.theta.data();
+    char* sameTPC = ws.sameTPC.data();
+    for (size_t i = 0; i < n; ++i) {
+      dx[i] = px - gx[i];
+      dy[i] = py - gy[i];
+      dz[i] = pz - gz[i];
+      distance[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+      cosine[i] = std::abs(lateral ? dy[i] : dx[i]) / distance[i];
+      theta[i] = fast_acos(cosine[i]) * 180. / CLHEP::pi;
+      // same as isOpDetInSameTPC()
+      sameTPC[i] = !(((px < 0.) != (gx[i] < 0.)) && std::abs(gx[i]) > 10. && twoTPCs);
+    }
+
+    double* solid_angle = ws.solidAngle.data();
     // ARAPUCAS/Bars (rectangle)
-    if (opDet.type == 0) {
-      // get scintillation point coordinates relative to arapuca window centre
-      geo::Vector_t const abs_relative{
-        std::abs(relative.X()), std::abs(relative.Y()), std::abs(relative.Z())};
-      solid_angle = Rectangle_SolidAngle(Dims{opDet.h, opDet.w}, abs_relative, opDet.orientation);
+    if (group.type == 0) {
+      for (size_t i = 0; i < n; ++i) {
+        if (!sameTPC[i]) continue;
+        // get scintillation point coordinates relative to arapuca window centre
+        geo::Vector_t const abs_relative{std::abs(dx[i]), std::abs(dy[i]), std::abs(dz[i])};
+        solid_angle[i] =
+          Rectangle_SolidAngle(Dims{group.h[i], group.w[i]}, abs_relative, group.orientation);
+      }
     }
     // PMTs (dome)
-    else if (opDet.type == 1) {
-      solid_angle = Omega_Dome_Model(distance, theta);
+    else if (group.type == 1) {
+      for (size_t i = 0; i < n; ++i) {
+        if (!sameTPC[i]) continue;
+        solid_angle[i] = Omega_Dome_Model(distance[i], theta[i]);
+      }
     }
     // PMTs (disk)
-    else if (opDet.type == 2) {
-      const double zy_offset = std::sqrt(relative.Y() * relative.Y() + relative.Z() * relative.Z());
-      const double x_distance = std::abs(relative.X());
-      solid_angle = Disk_SolidAngle(zy_offset, x_distance, fradius);
-    }
     else {
-      throw cet::exception("SemiAnalyticalModel")
-        << "Error: Invalid optical detector shape requested - configuration "
-           "error in semi-analytical model, only rectangular, dome or disk "
-           "optical detectors are supported."
-        << "\n";
+      for (size_t i = 0; i < n; ++i) {
+        if (!sameTPC[i]) continue;
+        const double zy_offset = std::sqrt(dy[i] * dy[i] + dz[i] * dz[i]);
+        const double x_distance = std::abs(dx[i]);
+        solid_angle[i] = DiskSolidAngle(zy_offset, x_distance);
+      }
     }
 
-    // calculate visibility by geometric acceptance
-    // accounting for solid angle and LAr absorbtion length
-    double visibility_geo =
-      std::exp(-1. * distance / fvuv_absorption_length) * (solid_angle / (4 * CLHEP::pi));
-
-    // apply Gaisser-Hillas correction for Rayleigh scattering distance
-    // and angular dependence offset angle bin
-    const size_t j = (theta / fdelta_angulo_vuv);
-
     // determine GH parameters, accounting for border effects
     // radial distance from centre of detector (Y-Z standard / X-Z laterals)
     double r = 0;
-    if (opDet.orientation == 1)
-      r = std::hypot(ScintPoint.X() - fcathode_centre[0], ScintPoint.Z() - fcathode_centre[2]);
+    if (lateral)
+      r = std::hypot(px - fcathode_centre[0], pz - fcathode_centre[2]);
     else
-      r = std::hypot(ScintPoint.Y() - fcathode_centre[1], ScintPoint.Z() - fcathode_centre[2]);
+      r = std::hypot(py - fcathode_centre[1], pz - fcathode_centre[2]);
 
-    double pars_ini[4] = {0, 0, 0, 0};
-    double s1 = 0;
-    double s2 = 0;
-    double s3 = 0;
-    // flat PDs
-    if ((opDet.type == 0 || opDet.type == 2) && (fIsFlatPDCorr || fIsFlatPDCorrLat)) {
-      if (opDet.orientation == 1 && fIsFlatPDCorrLat) { // laterals
-        pars_ini[0] = fGHvuvpars_flat_lateral[0][j];
-        pars_ini[1] = fGHvuvpars_flat_lateral[1][j];
-        pars_ini[2] = fGHvuvpars_flat_lateral[2][j];
-        pars_ini[3] = fGHvuvpars_flat_lateral[3][j];
-        s1 =
-          interpolate(fborder_corr_angulo_flat_lateral, fborder_corr_flat_lateral[0], theta, true);
-        s2 =
-          interpolate(fborder_corr_angulo_flat_lateral, fborder_corr_flat_lateral[1], theta, true);
-        s3 =
-          interpolate(fborder_corr_angulo_flat_lateral, fborder_corr_flat_lateral[2], theta, true);
-      }
-      else if (opDet.orientation == 0 && fIsFlatPDCorr) { // cathode/anode
-        pars_ini[0] = fGHvuvpars_flat[0][j];
-        pars_ini[1] = fGHvuvpars_flat[1][j];
-        pars_ini[2] = fGHvuvpars_flat[2][j];
-        pars_ini[3] = fGHvuvpars_flat[3][j];
-        s1 = interpolate(fborder_corr_angulo_flat, fborder_corr_flat[0], theta, true);
-        s2 = interpolate(fborder_corr_angulo_flat, fborder_corr_flat[1], theta, true);
-        s3 = interpolate(fborder_corr_angulo_flat, fborder_corr_flat[2], theta, true);
+    VUVCorrection_t const& corr = group.correction;
+    const size_t nAngles = corr.borderAngles.size();
+    for (size_t i = 0; i < n; ++i) {
+      if (!sameTPC[i]) {
+        DetectedVisibilities[group.opDet[i]] = 0.;
+        continue;
       }
+
+      // calculate visibility by geometric acceptance
+      // accounting for solid angle and LAr absorbtion length
+      double visibility_geo =
+        std::exp(-1. * distance[i] / fvuv_absorption_length) * (solid_angle[i] / (4 * CLHEP::pi));
+
+      // apply Gaisser-Hillas correction for Rayleigh scattering distance
+      // and angular dependence offset angle bin
+      const size_t j = (theta[i] / fdelta_angulo_vuv);
+
+      // border correction slopes, interpolated in angle as interpolate() does
+      size_t k = 0;
+      if (theta[i] >= corr.borderAngles[nAngles - 2])
+        k = nAngles - 2;
       else {
-        throw cet::exception("SemiAnalyticalModel")
-          << "Error: flat optical detectors are found, but parameters are "
-             "missing - configuration error in semi-analytical model."
-          << "\n";
+        while (theta[i] > corr.borderAngles[k + 1])
+          ++k;
       }
-    }
-    // dome PDs
-    else if (opDet.type == 1 && fIsDomePDCorr) {
-      pars_ini[0] = fGHvuvpars_dome[0][j];
-      pars_ini[1] = fGHvuvpars_dome[1][j];
-      pars_ini[2] = fGHvuvpars_dome[2][j];
-      pars_ini[3] = fGHvuvpars_dome[3][j];
-      s1 = interpolate(fborder_corr_angulo_dome, fborder_corr_dome[0], theta, true);
-      s2 = interpolate(fborder_corr_angulo_dome, fborder_corr_dome[1], theta, true);
-      s3 = interpolate(fborder_corr_angulo_dome, fborder_corr_dome[2], theta, true);
-    }
-    else {
-      throw cet::exception("SemiAnalyticalModel")
-        << "Error: Invalid optical detector shape requested or corrections are "
-           "missing - configuration error in semi-analytical model."
-        << "\n";
-    }
+      const double xL = corr.borderAngles[k];
+      const double xR = corr.borderAngles[k + 1];
+      double const* sL = corr.borderSlopes.data() + 3 * k;
+      double const* sR = sL + 3;
+
+      // add border correction to parameters
+      double const* pars = corr.pars.data() + 4 * j;
+      double pars_ini[4];
+      for (size_t p = 0; p < 3; ++p) {
+        const double s = sL[p] + (sR[p] - sL[p]) / (xR - xL) * (theta[i] - xL);
+        pars_ini[p] = pars[p] + s * r;
+      }
+      pars_ini[3] = pars[3];
 
-    // add border correction to parameters
-    pars_ini[0] = pars_ini[0] + s1 * r;
-    pars_ini[1] = pars_ini[1] + s2 * r;
-    pars_ini[2] = pars_ini[2] + s3 * r;
-    pars_ini[3] = pars_ini[3];
+      // calculate correction
+      double GH_correction = Gaisser_Hillas(distance[i], pars_ini);
 
-    // calculate correction
-    double GH_correction = Gaisser_Hillas(distance, pars_ini);
+      // apply field cage transparency factor
+      if (fApplyFieldCageTransparency) GH_correction = GH_correction * group.transparency;
 
-    // apply field cage transparency factor
-    if (fApplyFieldCageTransparency) {
-      if (opDet.orientation == 1)
-        GH_correction = GH_correction * fFieldCageTransparencyLateral;
-      else if (opDet.orientation == 0)
-        GH_correction = GH_correction * fFieldCageTransparencyCathode;
+      // determine corrected visibility of photo-detector
+      DetectedVisibilities[group.opDet[i]] = GH_correction * visibility_geo / cosine[i];
     }
-
-    // determine corrected visibility of photo-detector
-    return GH_correction * visibility_geo / cosine;
   }
 
   //......................................................................
@@ -457,7 +458,7 @@ namespace phot {
       const double zy_offset = std::sqrt(emission_relative.Y() * emission_relative.Y() +
                                          emission_relative.Z() * emission_relative.Z());
       const double x_distance = std::abs(emission_relative.X());
-      solid_angle_detector = Disk_SolidAngle(zy_offset, x_distance, fradius);
+      solid_angle_detector = DiskSolidAngle(zy_offset, x_distance);
     }
     else {
       throw cet::exception("SemiAnalyticalModel")
@@ -540,7 +541,7 @@ namespace phot {
 
   //......................................................................
   // solid angle of circular aperture
-  double SemiAnalyticalModel::Disk_SolidAngle(const double d, const double h, const double b) const
+  double SemiAnalyticalModel::Disk_SolidAngle(const double d, const double h, const double b)
   {
     if (b <= 0. || d < 0. || h <= 0.) return 0.;
     const double leg2 = (b + d) * (b + d);
@@ -778,4 +779,178 @@ namespace phot {
     return opticalDetector;
   }
 
+  SemiAnalyticalModel::VUVCorrection_t SemiAnalyticalModel::makeVUVCorrection(
+    std::vector<std::vector<double>> const& GHpars,
+    std::vector<double> const& borderAngles,
+    std::vector<std::vector<double>> const& borderCorr) const
+  {
+    if (GHpars.size() < 4 || borderCorr.size() < 3 || borderAngles.size() < 2) {
+      throw cet::exception("SemiAnalyticalModel")
+        << "Error: Gaisser-Hillas correction requires 4 parameter sets and 3 "
+           "border corrections on at least 2 angles - configuration error in "
+           "semi-analytical model."
+        << "\n";
+    }
+    for (size_t k = 0; k < 3; ++k) {
+      if (borderCorr[k].size() != borderAngles.size()) {
+        throw cet::exception("SemiAnalyticalModel")
+          << "Error: border correction " << k << " has " << borderCorr[k].size()
+          << " values for " << borderAngles.size() << " angles.\n";
+      }
+    }
+    const size_t nBins = GHpars[0].size();
+    VUVCorrection_t corr;
+    corr.pars.resize(4 * nBins);
+    for (size_t k = 0; k < 4; ++k) {
+      if (GHpars[k].size() != nBins) {
+        throw cet::exception("SemiAnalyticalModel")
+          << "Error: Gaisser-Hillas parameter set " << k << " has " << GHpars[k].size()
+          << " angle bins instead of " << nBins << ".\n";
+      }
+      for (size_t j = 0; j < nBins; ++j)
+        corr.pars[4 * j + k] = GHpars[k][j];
+    }
+    corr.borderAngles = borderAngles;
+    corr.borderSlopes.resize(3 * borderAngles.size());
+    for (size_t i = 0; i < borderAngles.size(); ++i)
+      for (size_t k = 0; k < 3; ++k)
+        corr.borderSlopes[3 * i + k] = borderCorr[k][i];
+    return corr;
+  }
+
+  std::vector<SemiAnalyticalModel::OpDetGroup_t> SemiAnalyticalModel::opDetGroups() const
+  {
+    std::vector<OpDetGroup_t> groups;
+    for (size_t const OpDet : util::counter(fNOpDets)) {
+      OpticalDetector const& opDet = fOpDetector[OpDet];
+      auto group = std::find_if(groups.begin(), groups.end(), [&opDet](OpDetGroup_t const& g) {
+        return (g.type == opDet.type) && (g.orientation == opDet.orientation);
+      });
+      if (group == groups.end()) {
+        VUVCorrection_t correction;
+        // flat PDs
+        if ((opDet.type == 0 || opDet.type == 2) && (fIsFlatPDCorr || fIsFlatPDCorrLat)) {
+          if (opDet.orientation == 1 && fIsFlatPDCorrLat) // laterals
+            correction = makeVUVCorrection(fGHvuvpars_flat_lateral,
+                                           fborder_corr_angulo_flat_lateral,
+                                           fborder_corr_flat_lateral);
+          else if (opDet.orientation == 0 && fIsFlatPDCorr) // cathode/anode
+            correction =
+              makeVUVCorrection(fGHvuvpars_flat, fborder_corr_angulo_flat, fborder_corr_flat);
+          else {
+            throw cet::exception("SemiAnalyticalModel")
+              << "Error: flat optical detectors are found, but parameters are "
+                 "missing - configuration error in semi-analytical model."
+              << "\n";
+          }
+        }
+        // dome PDs
+        else if (opDet.type == 1 && fIsDomePDCorr) {
+          correction =
+            makeVUVCorrection(fGHvuvpars_dome, fborder_corr_angulo_dome, fborder_corr_dome);
+        }
+        else {
+          throw cet::exception("SemiAnalyticalModel")
+            << "Error: Invalid optical detector shape requested or corrections are "
+               "missing - configuration error in semi-analytical model."
+            << "\n";
+        }
+        // field cage transparency factor, only for laterals and cathode/anode
+        double transparency = 1.;
+        if (opDet.orientation == 1)
+          transparency = fFieldCageTransparencyLateral;
+        else if (opDet.orientation == 0)
+          transparency = fFieldCageTransparencyCathode;
+        groups.push_back(
+          OpDetGroup_t{opDet.type, opDet.orientation, std::move(correction), transparency});
+        group = std::prev(groups.end());
+      }
+      group->opDet.push_back(OpDet);
+      group->x.push_back(opDet.center.X());
+      group->y.push_back(opDet.center.Y());
+      group->z.push_back(opDet.center.Z());
+      group->h.push_back(opDet.h);
+      group->w.push_back(opDet.w);
+    }
+    return groups;
+  }
+
+  std::unique_ptr<SolidAngleTable> SemiAnalyticalModel::diskSolidAngleTable(
+    const fhicl::ParameterSet& VUVHitsParams) const
+  {
+    bool const hasDisks =
+      std::any_of(fOpDetector.begin(), fOpDetector.end(), [](OpticalDetector const& opDet) {
+        return opDet.type == 2;
+      });
+    if (!hasDisks) return nullptr;
+
+    // the table covers the active volumes as seen from each disk: distance
+    // along the disk axis (x) and offset from it
+    double maxDistance = 0.0;
+    double maxOffset = 0.0;
+    for (OpticalDetector const& opDet : fOpDetector) {
+      if (opDet.type != 2) continue;
+      geo::Point_t const& c = opDet.center;
+      for (geo::BoxBoundedGeo const& volume : fActiveVolumes) {
+        double const dx = std::max(std::abs(volume.MinX() - c.X()), std::abs(volume.MaxX() - c.X()));
+        double const dy = std::max(std::abs(volume.MinY() - c.Y()), std::abs(volume.MaxY() - c.Y()));
+        double const dz = std::max(std::abs(volume.MinZ() - c.Z()), std::abs(volume.MaxZ() - c.Z()));
+        maxDistance = std::max(maxDistance, dx);
+        maxOffset = std::max(maxOffset, std::hypot(dy, dz));
+      }
+    }
+
+    SolidAngleTable::Config_t config;
+    config.maxOffset = maxOffset;
+    config.maxDistance = maxDistance;
+    config.minDistance = VUVHitsParams.get<double>("SolidAngleTableMinDistance", 5. * fradius);
+    config.step = VUVHitsParams.get<double>("SolidAngleTableStep", 1.0);
+    double const maxRelError = VUVHitsParams.get<double>("SolidAngleTableMaxRelError", 1e-3);
+    std::string const cacheFile = VUVHitsParams.get<std::string>("SolidAngleTableCacheFile", "");
+    auto const maxPoints = VUVHitsParams.get<std::size_t>("SolidAngleTableMaxPoints", 10000000);
+
+    if (!(config.maxDistance > config.minDistance)) {
+      mf::LogInfo("SemiAnalyticalModel")
+        << "Disk PMT solid angle not tabulated: all the active volume is closer than "
+        << config.minDistance << " cm to the disks.";
+      return nullptr;
+    }
+    double const points = (std::ceil(config.maxOffset / config.step) + 1.) *
+                          (std::ceil((config.maxDistance - config.minDistance) / config.step) + 1.);
+    if (points > maxPoints) {
+      throw cet::exception("SemiAnalyticalModel")
+        << "Error: tabulating the disk solid angle up to " << config.maxDistance
+        << " cm in distance and " << config.maxOffset << " cm in offset with steps of "
+        << config.step << " cm needs " << points << " points, more than the allowed "
+        << maxPoints << "; use a larger SolidAngleTableStep.\n";
+    }
+
+    double const radius = fradius;
+    auto table = std::make_unique<SolidAngleTable>(
+      [radius](double d, double h) { return Disk_SolidAngle(d, h, radius); },
+      config,
+      radius,
+      cacheFile);
+
+    double const relError = table->MaxRelativeError();
+    mf::LogInfo("SemiAnalyticalModel")
+      << "Disk PMT solid angle tabulated with " << table->NBins() << " points "
+      << (table->FromCache() ? "(from cache) " : "") << "beyond " << config.minDistance
+      << " cm, with maximum relative error " << relError;
+    if (relError > maxRelError) {
+      throw cet::exception("SemiAnalyticalModel")
+        << "Error: tabulated disk solid angle has relative error " << relError
+        << ", more than the allowed " << maxRelError
+        << "; use a smaller SolidAngleTableStep or a larger SolidAngleTableMinDistance.\n";
+    }
+    return table;
+  }
+
+  void SemiAnalyticalModel::VUVWorkspace_t::resize(size_t n)
+  {
+    for (auto* v : {&dx, &dy, &dz, &distance, &cosine, &theta, &solidAngle})
+      v->resize(n);
+    sameTPC.resize(n);
+  }
+
 } // namespace phot
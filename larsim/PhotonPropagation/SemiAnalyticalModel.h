@@ -14,6 +14,7 @@
 // LArSoft Libraries
 #include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
 #include "larsim/IonizationScintillation/ISTPC.h"
+#include "larsim/PhotonPropagation/SolidAngleTable.h"
 
 // fhicl
 #include "fhiclcpp/ParameterSet.h"
@@ -23,6 +24,7 @@
 #include "boost/math/policies/policy.hpp"
 
 #include <map>
+#include <memory>
 #include <vector>
 
 // Define a new policy *not* internally promoting RealType to double:
@@ -66,8 +68,37 @@ namespace phot {
       int orientation;
     };
 
-    // direct light photo-detector visibility calculation
-    double VUVVisibility(geo::Point_t const& ScintPoint, OpticalDetector const& opDet) const;
+    // Gaisser-Hillas corrections of direct light for one class of detectors,
+    // with the parameters of each angle bin contiguous
+    struct VUVCorrection_t {
+      std::vector<double> pars;         // [angle bin][4]
+      std::vector<double> borderAngles; // angles of border correction table
+      std::vector<double> borderSlopes; // [angle][3]
+    };
+
+    // optical detectors of the same shape and orientation, in SoA layout
+    struct OpDetGroup_t {
+      int type;
+      int orientation;
+      VUVCorrection_t correction;
+      double transparency; // field cage transparency factor
+      std::vector<size_t> opDet;
+      std::vector<double> x, y, z; // center
+      std::vector<double> h, w;
+    };
+
+    // per-detector intermediate results of the direct light calculation
+    struct VUVWorkspace_t {
+      std::vector<double> dx, dy, dz, distance, cosine, theta, solidAngle;
+      std::vector<char> sameTPC;
+      void resize(size_t n);
+    };
+
+    // direct light visibility of the detectors of a group
+    void directVisibilities(double* DetectedVisibilities,
+                            geo::Point_t const& ScintPoint,
+                            OpDetGroup_t const& group,
+                            VUVWorkspace_t& ws) const;
 
     // reflected light photo-detector visibility calculation
     double VISVisibility(geo::Point_t const& ScintPoint,
@@ -86,13 +117,23 @@ namespace phot {
                                 geo::Vector_t const& v,
                                 const int OpDetOrientation) const;
     // circular aperture
-    double Disk_SolidAngle(const double d, const double h, const double b) const;
+    static double Disk_SolidAngle(const double d, const double h, const double b);
+    // circular aperture of PMT radius, from the table if available
+    double DiskSolidAngle(const double d, const double h) const
+    {
+      return fDiskSolidAngleTable ? (*fDiskSolidAngleTable)(d, h) : Disk_SolidAngle(d, h, fradius);
+    }
     // dome aperture calculation
     double Omega_Dome_Model(const double distance, const double theta) const;
 
     // TODO: replace with geometry service
     bool isOpDetInSameTPC(geo::Point_t const& ScintPoint, geo::Point_t const& OpDetPoint) const;
     std::vector<OpticalDetector> opticalDetectors() const;
+    VUVCorrection_t makeVUVCorrection(std::vector<std::vector<double>> const& GHpars,
+                                      std::vector<double> const& borderAngles,
+                                      std::vector<std::vector<double>> const& borderCorr) const;
+    std::vector<OpDetGroup_t> opDetGroups() const;
+    std::unique_ptr<SolidAngleTable> diskSolidAngleTable(const fhicl::ParameterSet& VUVHits) const;
 
     // geometry properties
     geo::GeometryCore const& fGeom;
@@ -108,6 +149,8 @@ namespace phot {
     double fradius;
     Dims fcathode_plane;
     Dims fanode_plane;
+    // tabulated solid angle of disk PMTs (if requested)
+    std::unique_ptr<SolidAngleTable> fDiskSolidAngleTable;
 
     // For VUV semi-analytic hits
     double fdelta_angulo_vuv;
@@ -131,6 +174,8 @@ namespace phot {
     bool fApplyFieldCageTransparency;
     double fFieldCageTransparencyLateral;
     double fFieldCageTransparencyCathode;
+    // detectors grouped by shape and orientation, with their corrections
+    std::vector<OpDetGroup_t> fOpDetGroups;
 
     // For VIS semi-analytic hits
     const bool fDoReflectedLight;
@@ -0,0 +1,161 @@
+#include "larsim/PhotonPropagation/SolidAngleTable.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <algorithm> // std::max()
+#include <cmath>
+#include <cstdint>
+#include <cstdio>  // std::rename(), std::remove()
+#include <cstring> // std::memcmp()
+#include <fstream>
+
+#include <unistd.h> // getpid()
+
+namespace {
+
+  /// Header of the cache file.
+  struct CacheHeader_t {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nOffset;
+    std::uint64_t nDistance;
+    double maxOffset;
+    double minDistance;
+    double maxDistance;
+    double step;
+    double key;
+  };
+
+  constexpr char CacheMagic[8] = {'L', 'A', 'R', 'S', 'A', 'T', 'B', 'L'};
+  constexpr std::uint32_t CacheVersion = 1;
+
+} // local namespace
+
+namespace phot {
+
+  //------------------------------------------------------------
+  SolidAngleTable::SolidAngleTable(Function_t exact,
+                                   Config_t const& config,
+                                   double key,
+                                   std::string const& cacheFile /* = "" */)
+    : fExact(std::move(exact)), fConfig(config), fKey(key)
+  {
+    if (!(fConfig.step > 0.0) || !(fConfig.minDistance > 0.0) ||
+        !(fConfig.maxDistance > fConfig.minDistance) || !(fConfig.maxOffset > 0.0)) {
+      throw cet::exception("SolidAngleTable")
+        << "Invalid solid angle table: offset up to " << fConfig.maxOffset << " cm, distance "
+        << fConfig.minDistance << " -- " << fConfig.maxDistance << " cm, step " << fConfig.step
+        << " cm\n";
+    }
+
+    // the grid covers the requested range, with at least two points per axis
+    fNOffset = std::max(std::size_t(std::ceil(fConfig.maxOffset / fConfig.step)) + 1, std::size_t(2));
+    fNDistance = std::max(
+      std::size_t(std::ceil((fConfig.maxDistance - fConfig.minDistance) / fConfig.step)) + 1,
+      std::size_t(2));
+
+    if (!cacheFile.empty()) fFromCache = loadTable(cacheFile);
+    if (!fFromCache) {
+      fillTable();
+      if (!cacheFile.empty()) storeTable(cacheFile);
+    }
+  }
+
+  //------------------------------------------------------------
+  double SolidAngleTable::MaxRelativeError() const
+  {
+    double maxError = 0.0;
+    for (std::size_t i = 0; i + 1 < fNOffset; ++i) {
+      double const offset = (i + 0.5) * fConfig.step;
+      if (offset > fConfig.maxOffset) break;
+      for (std::size_t j = 0; j + 1 < fNDistance; ++j) {
+        double const distance = fConfig.minDistance + (j + 0.5) * fConfig.step;
+        if (distance > fConfig.maxDistance) break;
+        double const exact = fExact(offset, distance);
+        if (!(exact > 0.0)) continue;
+        double const error = std::abs((*this)(offset, distance) - exact) / exact;
+        if (error > maxError) maxError = error;
+      }
+    }
+    return maxError;
+  }
+
+  //------------------------------------------------------------
+  void SolidAngleTable::fillTable()
+  {
+    fTable.resize(fNOffset * fNDistance);
+    for (std::size_t i = 0; i < fNOffset; ++i) {
+      double const offset = i * fConfig.step;
+      for (std::size_t j = 0; j < fNDistance; ++j) {
+        double const distance = fConfig.minDistance + j * fConfig.step;
+        fTable[i * fNDistance + j] =
+          fExact(offset, distance) * (offset * offset + distance * distance);
+      }
+    }
+  }
+
+  //------------------------------------------------------------
+  bool SolidAngleTable::loadTable(std::string const& fileName)
+  {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader_t header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if ((std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0) ||
+        (header.version != CacheVersion) || (header.nOffset != fNOffset) ||
+        (header.nDistance != fNDistance) || (header.maxOffset != fConfig.maxOffset) ||
+        (header.minDistance != fConfig.minDistance) ||
+        (header.maxDistance != fConfig.maxDistance) || (header.step != fConfig.step) ||
+        (header.key != fKey)) {
+      mf::LogInfo("SolidAngleTable")
+        << "Solid angle table in '" << fileName << "' does not match the configuration.";
+      return false;
+    }
+
+    fTable.resize(fNOffset * fNDistance);
+    if (!file.read(reinterpret_cast<char*>(fTable.data()), fTable.size() * sizeof(double))) {
+      mf::LogWarning("SolidAngleTable") << "Solid angle table in '" << fileName << "' is truncated.";
+      fTable.clear();
+      return false;
+    }
+    mf::LogInfo("SolidAngleTable") << "Solid angle table read from '" << fileName << "'.";
+    return true;
+  }
+
+  //------------------------------------------------------------
+  void SolidAngleTable::storeTable(std::string const& fileName) const
+  {
+    CacheHeader_t header{};
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.nOffset = fNOffset;
+    header.nDistance = fNDistance;
+    header.maxOffset = fConfig.maxOffset;
+    header.minDistance = fConfig.minDistance;
+    header.maxDistance = fConfig.maxDistance;
+    header.step = fConfig.step;
+    header.key = fKey;
+
+    // written into a temporary file which then replaces the cache file, so
+    // that jobs sharing the cache never read a partially written table
+    std::string const tempName = fileName + ".tmp" + std::to_string(::getpid());
+    std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const*>(fTable.data()), fTable.size() * sizeof(double));
+    file.close();
+    if (!file || (std::rename(tempName.c_str(), fileName.c_str()) != 0)) {
+      std::remove(tempName.c_str());
+      // the table is still usable, only not cached
+      mf::LogWarning("SolidAngleTable")
+        << "Failed to write the solid angle table into '" << fileName << "'.";
+      return;
+    }
+    mf::LogInfo("SolidAngleTable") << "Solid angle table written into '" << fileName << "'.";
+  }
+
+  //------------------------------------------------------------
+
+} // namespace phot
@@ -0,0 +1,104 @@
+////# SolidAngleTable.h header file
+////#
+////# Tabulated solid angle of an optical detector.
+#ifndef SOLIDANGLETABLE_H
+#define SOLIDANGLETABLE_H
+
+#include <algorithm> // std::min()
+#include <cstddef>   // std::size_t
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace phot {
+
+  /**
+   * @brief Solid angle of a detector tabulated in offset and distance.
+   *
+   * The solid angle subtended by a detector with an axial symmetry depends on
+   * the distance of the point from the detector plane and on its offset from
+   * the detector axis. This class tabulates the exact solid angle function on
+   * a uniform grid in (offset, distance) and evaluates it by bilinear
+   * interpolation.
+   *
+   * The table stores the solid angle times the square of the distance from the
+   * detector center, which is smooth also far from the detector.
+   * Points closer than the minimum distance, or outside the table, are
+   * evaluated with the exact function.
+   *
+   * The accuracy of the table is checked against the exact function in the
+   * center of each cell, where the interpolation is least accurate.
+   */
+  class SolidAngleTable {
+  public:
+    /// Exact solid angle, as function of offset and distance.
+    using Function_t = std::function<double(double offset, double distance)>;
+
+    /// Extent and granularity of the table.
+    struct Config_t {
+      double maxOffset = 0.0;   ///< Largest offset in the table [cm]
+      double minDistance = 0.0; ///< Smallest distance in the table [cm]
+      double maxDistance = 0.0; ///< Largest distance in the table [cm]
+      double step = 1.0;        ///< Spacing of the grid [cm]
+    };
+
+    /**
+     * @brief Creates the table, loading it from `cacheFile` if possible.
+     * @param exact exact solid angle function
+     * @param config extent and granularity of the table
+     * @param key value identifying the function (e.g. detector size)
+     * @param cacheFile file to read the table from, or to store it into
+     *
+     * If `cacheFile` is not empty, the table is read from it if it matches
+     * `config` and `key`, otherwise it is computed and written into it.
+     */
+    SolidAngleTable(Function_t exact,
+                    Config_t const& config,
+                    double key,
+                    std::string const& cacheFile = "");
+
+    /// Returns the solid angle at the specified offset and distance.
+    double operator()(double offset, double distance) const
+    {
+      if ((distance < fConfig.minDistance) || (distance > fConfig.maxDistance) ||
+          (offset > fConfig.maxOffset))
+        return fExact(offset, distance);
+
+      double const u = offset / fConfig.step;
+      double const v = (distance - fConfig.minDistance) / fConfig.step;
+      std::size_t const i = std::min(static_cast<std::size_t>(u), fNOffset - 2);
+      std::size_t const j = std::min(static_cast<std::size_t>(v), fNDistance - 2);
+      double const fu = u - i;
+      double const fv = v - j;
+      double const* row = fTable.data() + i * fNDistance + j;
+      double const value = (1.0 - fu) * ((1.0 - fv) * row[0] + fv * row[1]) +
+                           fu * ((1.0 - fv) * row[fNDistance] + fv * row[fNDistance + 1]);
+      return value / (offset * offset + distance * distance);
+    }
+
+    /// Returns the largest relative error of the table, at the cell centers.
+    double MaxRelativeError() const;
+
+    /// Returns whether the table was loaded from the cache file.
+    bool FromCache() const { return fFromCache; }
+
+    std::size_t NBins() const { return fTable.size(); }
+
+  private:
+    Function_t fExact;
+    Config_t fConfig;
+    double fKey;
+    std::size_t fNOffset = 0U;   ///< Number of grid points in offset.
+    std::size_t fNDistance = 0U; ///< Number of grid points in distance.
+    std::vector<double> fTable;  ///< Solid angle x squared distance, offset-major.
+    bool fFromCache = false;
+
+    void fillTable();
+    bool loadTable(std::string const& fileName);
+    void storeTable(std::string const& fileName) const;
+
+  }; // class SolidAngleTable
+
+} // namespace phot
+
+#endif // SOLIDANGLETABLE_H
@@ -0,0 +1,80 @@
+/**
+ * @file  larsim/Simulation/LitePhotonAccumulator.cxx
+ * @brief Accumulator of detected photon counts for `sim::SimPhotonsLite`.
+ * @see   larsim/Simulation/LitePhotonAccumulator.h
+ */
+
+#include "larsim/Simulation/LitePhotonAccumulator.h"
+
+// C/C++ standard libraries
+#include <algorithm>
+
+namespace sim {
+
+  //----------------------------------------------------------------------------
+  std::size_t LitePhotonAccumulator::pageOffset(Channel_t& ch, int page)
+  {
+    auto const it =
+      std::lower_bound(ch.pages.begin(), ch.pages.end(), page, [](auto const& entry, int p) {
+        return entry.first < p;
+      });
+    if ((it != ch.pages.end()) && (it->first == page)) return it->second;
+
+    std::size_t const offset = fBins.size();
+    fBins.resize(offset + PageTicks, 0);
+    ch.pages.emplace(it, page, offset);
+    return offset;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename F>
+  void LitePhotonAccumulator::forEachCount(Channel_t const& ch, F&& f) const
+  {
+    for (auto const& [page, offset] : ch.pages) {
+      int const* bins = fBins.data() + offset;
+      int const pageStart = page * PageTicks;
+      for (int i = 0; i < PageTicks; ++i) {
+        if (bins[i] != 0) f(pageStart + i, bins[i]);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  std::map<int, int> LitePhotonAccumulator::toMap(std::size_t channel) const
+  {
+    std::map<int, int> photons;
+    forEachCount(fChannels[channel], [&photons](int time, int count) {
+      photons.emplace_hint(photons.end(), time, count);
+    });
+    return photons;
+  }
+
+  //----------------------------------------------------------------------------
+  void LitePhotonAccumulator::fill(std::vector<sim::SimPhotonsLite>& photons) const
+  {
+    for (std::size_t channel = 0; channel < fChannels.size(); ++channel) {
+      std::map<int, int>& detected = photons[channel].DetectedPhotons;
+      if (detected.empty()) {
+        // times come in order: each goes at the end of the map
+        forEachCount(fChannels[channel], [&detected](int time, int count) {
+          detected.emplace_hint(detected.end(), time, count);
+        });
+      }
+      else {
+        forEachCount(fChannels[channel],
+                     [&detected](int time, int count) { detected[time] += count; });
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void LitePhotonAccumulator::clear()
+  {
+    fBins.clear();
+    for (Channel_t& ch : fChannels) {
+      ch.pages.clear();
+      ch.lastPage = NoPage;
+    }
+  }
+
+} // namespace sim
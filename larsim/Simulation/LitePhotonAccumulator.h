@@ -0,0 +1,115 @@
+/**
+ * @file  larsim/Simulation/LitePhotonAccumulator.h
+ * @brief Accumulator of detected photon counts for `sim::SimPhotonsLite`.
+ * @see   larsim/Simulation/LitePhotonAccumulator.cxx
+ */
+
+#ifndef LARSIM_SIMULATION_LITEPHOTONACCUMULATOR_H
+#define LARSIM_SIMULATION_LITEPHOTONACCUMULATOR_H
+
+// LArSoft libraries
+#include "lardataobj/Simulation/SimPhotons.h"
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace sim {
+
+  /**
+   * @brief Counts of detected photons by optical channel and time tick.
+   *
+   * This is meant to replace `++photons[channel].DetectedPhotons[time]` in the
+   * inner loops of the photon simulation: each of those is a lookup in a
+   * `std::map`, and often a node allocation.
+   * Here the counts of each channel are stored in dense pages of `PageTicks`
+   * consecutive ticks; a page is allocated when the first photon falls in it,
+   * and the pages of a channel are found in a small sorted table. Since the
+   * page of the last photon of each channel is remembered, adding photons
+   * close in time (like the ones from the same energy deposition) is just an
+   * increment of a counter. The times of the photons are not limited to any
+   * window: pages are allocated only where photons are.
+   *
+   * The counts are converted into `sim::SimPhotonsLite` maps once all the
+   * photons have been added, with `toMap()` or `fill()`. Times with no photon
+   * are not present in the maps; these are the same maps that the
+   * `DetectedPhotons[time] += count` pattern produces with positive counts.
+   *
+   * This object is not thread-safe.
+   */
+  class LitePhotonAccumulator {
+  public:
+    /// Base 2 logarithm of the number of ticks in a page.
+    static constexpr unsigned int PageBits = 8;
+
+    /// Number of ticks in a page.
+    static constexpr int PageTicks = 1 << PageBits;
+
+    /// Creates an accumulator for `nChannels` channels (`0` to `nChannels - 1`).
+    explicit LitePhotonAccumulator(std::size_t nChannels = 0) : fChannels(nChannels) {}
+
+    /// Returns the number of channels.
+    std::size_t nChannels() const { return fChannels.size(); }
+
+    /// Sets the number of channels; counts of channels beyond the new number are lost.
+    void resize(std::size_t nChannels) { fChannels.resize(nChannels); }
+
+    /// Adds `nphotons` photons detected by `channel` at tick `time`.
+    void add(std::size_t channel, int time, int nphotons = 1)
+    {
+      Channel_t& ch = fChannels[channel];
+      int const page = time >> PageBits; // rounds down also negative times
+      if (page != ch.lastPage) {
+        ch.lastOffset = pageOffset(ch, page);
+        ch.lastPage = page;
+      }
+      fBins[ch.lastOffset + (time & (PageTicks - 1))] += nphotons;
+    }
+
+    /// Returns whether no photon was added to `channel`.
+    bool empty(std::size_t channel) const { return fChannels[channel].pages.empty(); }
+
+    /// Returns the time -> count map of the photons of `channel`.
+    std::map<int, int> toMap(std::size_t channel) const;
+
+    /**
+     * @brief Adds the photons of each channel into the corresponding element.
+     * @param photons collection of `sim::SimPhotonsLite`, indexed by channel
+     *
+     * The counts of channel `c` are added to `photons[c].DetectedPhotons`;
+     * `photons` must have at least `nChannels()` elements.
+     */
+    void fill(std::vector<sim::SimPhotonsLite>& photons) const;
+
+    /// Removes all the photons, keeping the allocated memory.
+    void clear();
+
+  private:
+    /// Value of `Channel_t::lastPage` when no page is cached.
+    static constexpr int NoPage = std::numeric_limits<int>::min();
+
+    struct Channel_t {
+      /// Pages of the channel: (page number, offset of its first bin), sorted.
+      std::vector<std::pair<int, std::size_t>> pages;
+      int lastPage = NoPage;      ///< Number of the last used page.
+      std::size_t lastOffset = 0; ///< Offset of the first bin of the last used page.
+    };
+
+    std::vector<Channel_t> fChannels; ///< Page tables, by channel.
+    std::vector<int> fBins;           ///< Counts of all the pages.
+
+    /// Returns the offset of `page` of channel `ch`, allocating it if needed.
+    std::size_t pageOffset(Channel_t& ch, int page);
+
+    /// Calls `f(time, count)` for each time with photons in `ch`, in time order.
+    template <typename F>
+    void forEachCount(Channel_t const& ch, F&& f) const;
+
+  }; // class LitePhotonAccumulator
+
+} // namespace sim
+
+#endif // LARSIM_SIMULATION_LITEPHOTONACCUMULATOR_H
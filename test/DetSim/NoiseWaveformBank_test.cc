@@ -0,0 +1,223 @@
+/**
+ * @file   NoiseWaveformBank_test.cc
+ * @brief  Unit test for `detsim::NoiseWaveformBank`.
+ *
+ * The waveforms synthesized from the bank are compared with the inverse
+ * Fourier transform of the shifted and rotated spectra, computed directly.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (NoiseWaveformBank_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "larsim/DetSim/NoiseWaveformBank.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max()
+#include <cmath>
+#include <complex>
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+  constexpr double Pi = 3.14159265358979323846;
+
+  /// Random spectra of `nWaveforms` waveforms of `nTicks` samples.
+  struct Spectra_t {
+    std::size_t nTicks;
+    std::vector<double> re, im;
+
+    Spectra_t(std::size_t nTicks, std::size_t nWaveforms, std::mt19937& rng) : nTicks{nTicks}
+    {
+      std::size_t const nFreq = nTicks / 2 + 1;
+      std::normal_distribution<double> gauss{0.0, 1.0};
+      for (std::size_t i = 0; i < nWaveforms * nFreq; ++i) {
+        // the power falls with the frequency, as noise does
+        double const scale = 10.0 / (1.0 + (i % nFreq));
+        re.push_back(scale * gauss(rng));
+        im.push_back(scale * gauss(rng));
+      }
+    }
+
+    std::complex<double> component(std::size_t b, std::size_t k) const
+    {
+      std::size_t const i = b * (nTicks / 2 + 1) + k;
+      return {re[i], im[i]};
+    }
+  };
+
+  /// Unnormalized inverse transform of the spectrum `b` with components
+  /// rotated by `-phase` (but the constant and Nyquist ones), at sample `u`.
+  double expected(Spectra_t const& spectra, std::size_t b, double phase, std::size_t u)
+  {
+    std::size_t const n = spectra.nTicks;
+    std::size_t const nFreq = n / 2 + 1;
+    bool const hasNyquist = (n % 2 == 0);
+    std::complex<double> const rotation = std::polar(1.0, -phase);
+
+    // only the real part of the constant and Nyquist components contributes
+    double x = spectra.component(b, 0).real();
+    if (hasNyquist) x += ((u % 2) ? -1.0 : 1.0) * spectra.component(b, nFreq - 1).real();
+    std::size_t const kEnd = hasNyquist ? nFreq - 1 : nFreq;
+    for (std::size_t k = 1; k < kEnd; ++k) {
+      x += 2.0 * (spectra.component(b, k) * rotation * std::polar(1.0, 2.0 * Pi * k * u / n)).real();
+    }
+    return x;
+  }
+
+  /// Power of the component `k` of the waveform `noise`.
+  double power(std::vector<float> const& noise, std::size_t k)
+  {
+    std::size_t const n = noise.size();
+    std::complex<double> c;
+    for (std::size_t t = 0; t < n; ++t)
+      c += double(noise[t]) * std::polar(1.0, -2.0 * Pi * k * t / n);
+    return std::norm(c);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Synthesis_test)
+{
+  std::mt19937 rng{1234};
+  for (std::size_t const nTicks : {64U, 63U}) {
+    BOOST_TEST_CONTEXT(nTicks << " ticks")
+    {
+      Spectra_t const spectra{nTicks, 4, rng};
+      detsim::NoiseWaveformBank bank{nTicks};
+      bank.build(spectra.re, spectra.im);
+      BOOST_TEST(bank.size() == 4U);
+
+      std::vector<float> noise(nTicks);
+      for (std::size_t b = 0; b < bank.size(); ++b) {
+        // no shift, no rotation: the waveform itself
+        bank.synthesize(noise.data(), b, 0, 0.0);
+        for (std::size_t t = 0; t < nTicks; ++t)
+          BOOST_TEST(noise[t] == expected(spectra, b, 0.0, t), boost::test_tools::tolerance(1e-4));
+
+        // quarter and arbitrary rotations, with and without shift
+        for (double const phase : {Pi / 2.0, 1.0, 4.0}) {
+          for (std::size_t const shift : {std::size_t(0), std::size_t(17), nTicks - 1}) {
+            bank.synthesize(noise.data(), b, shift, phase);
+            for (std::size_t t = 0; t < nTicks; ++t) {
+              BOOST_TEST(noise[t] == expected(spectra, b, phase, (t + shift) % nTicks),
+                         boost::test_tools::tolerance(1e-4));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Spectrum_test)
+{
+  // shift and rotation keep the power spectrum of the waveform, and averaged
+  // over the phases the synthesized noise is just the constant and Nyquist part
+  constexpr std::size_t nTicks = 128;
+  std::mt19937 rng{4321};
+  Spectra_t const spectra{nTicks, 2, rng};
+  detsim::NoiseWaveformBank bank{nTicks};
+  bank.build(spectra.re, spectra.im);
+
+  std::vector<float> base(nTicks), noise(nTicks);
+  bank.synthesize(base.data(), 1, 0, 0.0);
+
+  std::uniform_real_distribution<double> pickPhase{0.0, 2.0 * Pi};
+  std::uniform_int_distribution<std::size_t> pickShift{0, nTicks - 1};
+  std::vector<double> average(nTicks, 0.0);
+  constexpr int nSamples = 4000;
+  for (int i = 0; i < nSamples; ++i) {
+    double const phase = pickPhase(rng);
+    bank.synthesize(noise.data(), 1, 0, phase);
+    for (std::size_t t = 0; t < nTicks; ++t)
+      average[t] += noise[t] / nSamples;
+    if (i < 10) {
+      bank.synthesize(noise.data(), 1, pickShift(rng), phase);
+      for (std::size_t k = 0; k <= nTicks / 2; ++k)
+        BOOST_TEST(power(noise, k) == power(base, k), boost::test_tools::tolerance(1e-3));
+    }
+  }
+
+  // the rotated components average out as 1/sqrt(nSamples) of their amplitude
+  double amplitude = 0.0;
+  for (float x : base)
+    amplitude = std::max(amplitude, std::abs(double(x)));
+  for (std::size_t t = 0; t < nTicks; ++t) {
+    // the phase-independent part is (x(0) + x(pi)) / 2
+    double const phaseIndependent =
+      0.5 * (expected(spectra, 1, 0.0, t) + expected(spectra, 1, Pi, t));
+    BOOST_TEST(std::abs(average[t] - phaseIndependent) < 0.1 * amplitude);
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Threads_test)
+{
+  constexpr std::size_t nTicks = 256;
+  std::mt19937 rng{2468};
+  Spectra_t const spectra{nTicks, 50, rng};
+
+  detsim::NoiseWaveformBank serial{nTicks}, parallel{nTicks};
+  serial.build(spectra.re, spectra.im, 0);
+  parallel.build(spectra.re, spectra.im, 4);
+
+  std::vector<float> a(nTicks), b(nTicks);
+  for (std::size_t w = 0; w < serial.size(); ++w) {
+    serial.synthesize(a.data(), w, w, 0.1 * w);
+    parallel.synthesize(b.data(), w, w, 0.1 * w);
+    BOOST_TEST(a == b, boost::test_tools::per_element());
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Cache_test)
+{
+  constexpr std::size_t nTicks = 64;
+  std::mt19937 rng{1357};
+  Spectra_t const spectra{nTicks, 3, rng};
+  detsim::NoiseWaveformBank bank{nTicks};
+  bank.build(spectra.re, spectra.im);
+
+  std::string const fileName = "NoiseWaveformBank_test.bin";
+  BOOST_TEST(bank.write(fileName, "model A"));
+
+  detsim::NoiseWaveformBank cached{nTicks};
+  BOOST_TEST(cached.read(fileName, 3, "model A"));
+  BOOST_TEST(cached.size() == 3U);
+  std::vector<float> a(nTicks), b(nTicks);
+  for (std::size_t w = 0; w < bank.size(); ++w) {
+    bank.synthesize(a.data(), w, 5, 2.0);
+    cached.synthesize(b.data(), w, 5, 2.0);
+    BOOST_TEST(a == b, boost::test_tools::per_element());
+  }
+
+  // a bank of another configuration or size is not read
+  BOOST_TEST(!cached.read(fileName, 3, "model B"));
+  BOOST_TEST(cached.empty());
+  BOOST_TEST(!cached.read(fileName, 4, "model A"));
+  detsim::NoiseWaveformBank longer{2 * nTicks};
+  BOOST_TEST(!longer.read(fileName, 3, "model A"));
+
+  // nor a truncated one
+  {
+    std::ifstream in(fileName, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    in.close();
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), content.size() - 10);
+  }
+  BOOST_TEST(!cached.read(fileName, 3, "model A"));
+  BOOST_TEST(cached.empty());
+
+  std::remove(fileName.c_str());
+  BOOST_TEST(!cached.read(fileName, 3, "model A"));
+}
@@ -0,0 +1,187 @@
+/**
+ * @file   SimChannelAccumulator_test.cc
+ * @brief  Unit test for `detsim::SimChannelAccumulator`.
+ *
+ * The `sim::SimChannel` filled by the accumulator are compared with the ones
+ * filled by adding each cluster directly, in drift order, to a channel
+ * created when first hit, which is how `detsim::SimDriftElectrons` filled
+ * them before the accumulator.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (SimChannelAccumulator_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "lardataobj/Simulation/SimChannel.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "larsim/ElectronDrift/SimChannelAccumulator.h"
+
+// C/C++ standard libraries
+#include <array>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// A cluster of electrons drifted to a channel.
+  struct Cluster_t {
+    raw::ChannelID_t channel;
+    std::size_t deposit;
+    int trackID;
+    unsigned int tdc;
+    double numElectrons;
+    double energy;
+  };
+
+  /// Returns random deposits.
+  std::vector<sim::SimEnergyDeposit> makeDeposits(std::mt19937& rng, std::size_t n)
+  {
+    std::uniform_real_distribution<double> uniform{0.0, 100.0};
+    std::vector<sim::SimEnergyDeposit> deposits;
+    for (std::size_t i = 0; i < n; ++i) {
+      geo::Point_t const start{uniform(rng), uniform(rng), uniform(rng)};
+      geo::Point_t const end{start.X() + 0.1, start.Y() - 0.2, start.Z() + 0.3};
+      deposits.emplace_back(1000, 800, 0.2, 0.05, start, end, 0.0, 1.0, int(i % 7) + 1, 13);
+    }
+    return deposits;
+  }
+
+  /// Returns random clusters in drift order: deposit by deposit, each one
+  /// spreading on a few neighbouring channels and TDC.
+  std::vector<Cluster_t> makeClusters(std::mt19937& rng,
+                                      std::vector<sim::SimEnergyDeposit> const& deposits)
+  {
+    std::uniform_int_distribution<raw::ChannelID_t> pickChannel{0, 80};
+    std::uniform_int_distribution<unsigned int> pickTDC{0, 3000};
+    std::uniform_int_distribution<int> pickSpread{0, 3};
+    std::uniform_int_distribution<int> pickNClusters{1, 40};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    std::vector<Cluster_t> clusters;
+    for (std::size_t iDep = 0; iDep < deposits.size(); ++iDep) {
+      raw::ChannelID_t const channel = pickChannel(rng);
+      unsigned int const tdc = pickTDC(rng);
+      int const nClusters = pickNClusters(rng);
+      for (int k = 0; k < nClusters; ++k) {
+        clusters.push_back({channel + pickSpread(rng),
+                            iDep,
+                            deposits[iDep].TrackID(),
+                            tdc + pickSpread(rng),
+                            600.0 * uniform(rng),
+                            0.01 * uniform(rng)});
+      }
+    }
+    return clusters;
+  }
+
+  /// Fills channels as `SimDriftElectrons` did before the accumulator.
+  std::vector<sim::SimChannel> fillDirectly(std::vector<Cluster_t> const& clusters,
+                                            std::vector<sim::SimEnergyDeposit> const& deposits)
+  {
+    std::vector<sim::SimChannel> channels;
+    std::map<raw::ChannelID_t, std::size_t> channelIndex;
+    for (Cluster_t const& cluster : clusters) {
+      auto const [iChannel, isNew] = channelIndex.try_emplace(cluster.channel, channels.size());
+      if (isNew) channels.emplace_back(cluster.channel);
+      std::array<double, 3> xyz;
+      deposits[cluster.deposit].MidPoint().GetCoordinates(xyz.data());
+      channels[iChannel->second].AddIonizationElectrons(
+        cluster.trackID, cluster.tdc, cluster.numElectrons, xyz.data(), cluster.energy);
+    }
+    return channels;
+  }
+
+  /// Checks that two channel collections have the very same content.
+  void checkSameChannels(std::vector<sim::SimChannel> const& channels,
+                         std::vector<sim::SimChannel> const& expected)
+  {
+    BOOST_TEST_REQUIRE(channels.size() == expected.size());
+    for (std::size_t i = 0; i < channels.size(); ++i) {
+      BOOST_TEST_CONTEXT("channel #" << i)
+      {
+        BOOST_TEST_REQUIRE(channels[i].Channel() == expected[i].Channel());
+        auto const& tdcides = channels[i].TDCIDEMap();
+        auto const& expectedTDCIDEs = expected[i].TDCIDEMap();
+        BOOST_TEST_REQUIRE(tdcides.size() == expectedTDCIDEs.size());
+        for (std::size_t j = 0; j < tdcides.size(); ++j) {
+          BOOST_TEST(tdcides[j].first == expectedTDCIDEs[j].first);
+          auto const& ides = tdcides[j].second;
+          auto const& expectedIDEs = expectedTDCIDEs[j].second;
+          BOOST_TEST_REQUIRE(ides.size() == expectedIDEs.size());
+          for (std::size_t k = 0; k < ides.size(); ++k) {
+            // same operations in the same order: the results are identical
+            BOOST_TEST(ides[k].trackID == expectedIDEs[k].trackID);
+            BOOST_TEST(ides[k].numElectrons == expectedIDEs[k].numElectrons);
+            BOOST_TEST(ides[k].energy == expectedIDEs[k].energy);
+            BOOST_TEST(ides[k].x == expectedIDEs[k].x);
+            BOOST_TEST(ides[k].y == expectedIDEs[k].y);
+            BOOST_TEST(ides[k].z == expectedIDEs[k].z);
+          }
+        }
+      }
+    }
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Flush_test)
+{
+  std::mt19937 rng{1234};
+  // a table shorter than the channel IDs, which must grow
+  detsim::SimChannelAccumulator accumulator{20U};
+
+  for (int event = 0; event < 3; ++event) {
+    BOOST_TEST_CONTEXT("event " << event)
+    {
+      auto const deposits = makeDeposits(rng, 500);
+      auto const clusters = makeClusters(rng, deposits);
+      auto const expected = fillDirectly(clusters, deposits);
+
+      BOOST_TEST(accumulator.empty());
+      for (Cluster_t const& cluster : clusters) {
+        accumulator.add(cluster.channel,
+                        cluster.deposit,
+                        cluster.trackID,
+                        cluster.tdc,
+                        cluster.numElectrons,
+                        cluster.energy);
+      }
+      BOOST_TEST(accumulator.NChannels() == expected.size());
+
+      std::vector<sim::SimChannel> channels;
+      accumulator.flush(channels, deposits);
+      BOOST_TEST(accumulator.empty());
+      checkSameChannels(channels, expected);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Clear_test)
+{
+  std::mt19937 rng{4321};
+  auto const deposits = makeDeposits(rng, 50);
+  auto const clusters = makeClusters(rng, deposits);
+
+  // clusters dropped by clear() do not show up in the next flush
+  detsim::SimChannelAccumulator accumulator{100U};
+  accumulator.add(5, 0, 1, 10, 100.0, 0.1);
+  accumulator.add(90, 0, 1, 12, 100.0, 0.1);
+  accumulator.clear();
+  BOOST_TEST(accumulator.empty());
+
+  for (Cluster_t const& cluster : clusters) {
+    accumulator.add(cluster.channel,
+                    cluster.deposit,
+                    cluster.trackID,
+                    cluster.tdc,
+                    cluster.numElectrons,
+                    cluster.energy);
+  }
+  std::vector<sim::SimChannel> channels;
+  accumulator.flush(channels, deposits);
+  checkSameChannels(channels, fillDirectly(clusters, deposits));
+}
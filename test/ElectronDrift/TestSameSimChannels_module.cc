@@ -0,0 +1,95 @@
+/**
+ * @file   TestSameSimChannels_module.cc
+ * @brief  Checks that two producers stored the very same `sim::SimChannel`.
+ *
+ * The channels from the `Reference` and `Test` producers are compared value
+ * by value, without tolerance, including their order. An exception is thrown
+ * on the first difference, and if the reference has no channel at all (the
+ * comparison would then prove nothing).
+ *
+ * Configuration:
+ * * `Reference` (input tag): the expected channels
+ * * `Test` (input tag): the channels to be checked
+ */
+
+// LArSoft libraries
+#include "lardataobj/Simulation/SimChannel.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <vector>
+
+class TestSameSimChannels : public art::EDAnalyzer {
+public:
+  explicit TestSameSimChannels(fhicl::ParameterSet const& pset);
+
+private:
+  void analyze(art::Event const& event) override;
+
+  art::InputTag const fReference;
+  art::InputTag const fTest;
+};
+
+//------------------------------------------------------------------------------
+TestSameSimChannels::TestSameSimChannels(fhicl::ParameterSet const& pset)
+  : EDAnalyzer(pset)
+  , fReference(pset.get<art::InputTag>("Reference"))
+  , fTest(pset.get<art::InputTag>("Test"))
+{
+  consumes<std::vector<sim::SimChannel>>(fReference);
+  consumes<std::vector<sim::SimChannel>>(fTest);
+}
+
+//------------------------------------------------------------------------------
+void TestSameSimChannels::analyze(art::Event const& event)
+{
+  auto const& reference = event.getProduct<std::vector<sim::SimChannel>>(fReference);
+  auto const& test = event.getProduct<std::vector<sim::SimChannel>>(fTest);
+
+  if (reference.empty()) {
+    throw cet::exception("TestSameSimChannels") << fReference.encode() << " has no channel\n";
+  }
+  if (test.size() != reference.size()) {
+    throw cet::exception("TestSameSimChannels")
+      << fTest.encode() << " has " << test.size() << " channels, " << fReference.encode() << " "
+      << reference.size() << "\n";
+  }
+
+  std::size_t nIDEs = 0;
+  for (std::size_t i = 0; i < reference.size(); ++i) {
+    auto const& refTDCIDEs = reference[i].TDCIDEMap();
+    auto const& testTDCIDEs = test[i].TDCIDEMap();
+    bool same =
+      (test[i].Channel() == reference[i].Channel()) && (testTDCIDEs.size() == refTDCIDEs.size());
+    for (std::size_t j = 0; same && (j < refTDCIDEs.size()); ++j) {
+      auto const& refIDEs = refTDCIDEs[j].second;
+      auto const& testIDEs = testTDCIDEs[j].second;
+      same = (testTDCIDEs[j].first == refTDCIDEs[j].first) && (testIDEs.size() == refIDEs.size());
+      for (std::size_t k = 0; same && (k < refIDEs.size()); ++k) {
+        sim::IDE const& a = refIDEs[k];
+        sim::IDE const& b = testIDEs[k];
+        same = (a.trackID == b.trackID) && (a.origTrackID == b.origTrackID) &&
+               (a.numElectrons == b.numElectrons) && (a.energy == b.energy) && (a.x == b.x) &&
+               (a.y == b.y) && (a.z == b.z);
+      }
+      nIDEs += refIDEs.size();
+    }
+    if (!same) {
+      throw cet::exception("TestSameSimChannels")
+        << "Channel #" << i << " (" << reference[i].Channel() << ") differs\n";
+    }
+  }
+  mf::LogInfo("TestSameSimChannels")
+    << nIDEs << " IDEs on " << reference.size() << " channels are the same";
+}
+
+DEFINE_ART_MODULE(TestSameSimChannels)
@@ -0,0 +1,260 @@
+/**
+ * @file   CORSIKAShowerFile_test.cc
+ * @brief  Unit test for `evgen::CORSIKAShowerFile`.
+ * @see    larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h
+ *
+ * Small shower files are written by hand in the columnar format, some of them
+ * deliberately corrupted, and one is converted from a small SQLite database.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (CORSIKAShowerFile_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/EventGenerator/CORSIKA/CORSIKAShowerFile.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+#include <sqlite3.h>
+
+// C/C++ standard libraries
+#include <algorithm> // std::copy(), std::sort()
+#include <cstdint>
+#include <cstdio> // std::remove()
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using evgen::CORSIKAShowerFile;
+
+  /// Content of a shower file.
+  struct ShowerSample_t {
+    std::vector<std::uint64_t> index;
+    std::vector<std::int32_t> pdg;
+    std::vector<double> columns[CORSIKAShowerFile::NColumns];
+  };
+
+  /// Returns a sample of three showers, the second one with no particle.
+  ShowerSample_t makeSample()
+  {
+    ShowerSample_t sample;
+    sample.index = {0, 3, 3, 5};
+    sample.pdg = {13, -13, 22, 2212, 11};
+    for (unsigned int column = 0; column < CORSIKAShowerFile::NColumns; ++column)
+      for (std::size_t i = 0; i < sample.pdg.size(); ++i)
+        sample.columns[column].push_back(100.0 * column + i + 0.25);
+    return sample;
+  }
+
+  std::uint64_t alignBlock(std::uint64_t offset)
+  {
+    return ((offset + 4095) / 4096) * 4096;
+  }
+
+  /// Writes `sample` into a shower file of the current format.
+  void writeShowerFile(std::string const& fileName,
+                       ShowerSample_t const& sample,
+                       std::uint64_t nParticles)
+  {
+    CORSIKAShowerFile::FileHeader_t header{};
+    std::copy(CORSIKAShowerFile::MagicString,
+              CORSIKAShowerFile::MagicString + sizeof(header.magic),
+              header.magic);
+    header.byteOrder = CORSIKAShowerFile::ByteOrderMark;
+    header.version = CORSIKAShowerFile::FormatVersion;
+    header.nShowers = sample.index.size() - 1;
+    header.nParticles = nParticles;
+    header.erangeHigh = 1e5;
+    header.erangeLow = 1.0;
+    header.eslope = -2.7;
+    header.nShow = 1000;
+    header.minTime = -12.5;
+
+    std::uint64_t offset = alignBlock(sizeof(header));
+    header.indexOffset = offset;
+    offset = alignBlock(offset + sample.index.size() * sizeof(std::uint64_t));
+    header.pdgOffset = offset;
+    offset = alignBlock(offset + sample.pdg.size() * sizeof(std::int32_t));
+    for (unsigned int column = 0; column < CORSIKAShowerFile::NColumns; ++column) {
+      header.columnOffset[column] = offset;
+      offset = alignBlock(offset + sample.columns[column].size() * sizeof(double));
+    }
+
+    std::vector<char> buffer(offset, '\0');
+    auto writeAt = [&buffer](std::uint64_t pos, void const* data, std::size_t size) {
+      std::memcpy(buffer.data() + pos, data, size);
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.indexOffset, sample.index.data(), sample.index.size() * sizeof(std::uint64_t));
+    writeAt(header.pdgOffset, sample.pdg.data(), sample.pdg.size() * sizeof(std::int32_t));
+    for (unsigned int column = 0; column < CORSIKAShowerFile::NColumns; ++column) {
+      writeAt(header.columnOffset[column],
+              sample.columns[column].data(),
+              sample.columns[column].size() * sizeof(double));
+    }
+    std::ofstream{fileName, std::ios::binary}.write(buffer.data(), buffer.size());
+  }
+
+  void writeShowerFile(std::string const& fileName, ShowerSample_t const& sample)
+  {
+    writeShowerFile(fileName, sample, sample.pdg.size());
+  }
+
+  /// Checks that `file` holds the content of `sample`.
+  void checkSample(CORSIKAShowerFile const& file, ShowerSample_t const& sample)
+  {
+    BOOST_TEST_REQUIRE(file.NShowers() == sample.index.size() - 1);
+    BOOST_TEST_REQUIRE(file.NParticles() == sample.pdg.size());
+    for (std::size_t iShower = 0; iShower < file.NShowers(); ++iShower) {
+      auto const [begin, end] = file.showerParticles(iShower);
+      BOOST_TEST(begin == sample.index[iShower]);
+      BOOST_TEST(end == sample.index[iShower + 1]);
+    }
+    for (std::size_t i = 0; i < file.NParticles(); ++i) {
+      BOOST_TEST(file.pdg(i) == sample.pdg[i]);
+      for (unsigned int column = 0; column < CORSIKAShowerFile::NColumns; ++column) {
+        BOOST_TEST(file.value(CORSIKAShowerFile::Column_t(column), i) ==
+                   sample.columns[column][i]);
+      }
+    }
+  }
+
+  /// Runs a statement on the database, failing the test on error.
+  void execute(sqlite3* db, std::string const& statement)
+  {
+    char* errMsg = nullptr;
+    int const res = sqlite3_exec(db, statement.c_str(), nullptr, nullptr, &errMsg);
+    BOOST_TEST_REQUIRE(res == SQLITE_OK, statement << ": " << (errMsg ? errMsg : ""));
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Read_test)
+{
+  std::string const fileName = "CORSIKAShowerFile_test_read.showers";
+  ShowerSample_t const sample = makeSample();
+  writeShowerFile(fileName, sample);
+
+  BOOST_TEST(CORSIKAShowerFile::isShowerFile(fileName));
+  CORSIKAShowerFile const file{fileName};
+  checkSample(file, sample);
+  BOOST_TEST(file.ERangeHigh() == 1e5);
+  BOOST_TEST(file.ERangeLow() == 1.0);
+  BOOST_TEST(file.ESlope() == -2.7);
+  BOOST_TEST(file.NShow() == 1000U);
+  BOOST_TEST(file.MinTime() == -12.5);
+
+  std::remove(fileName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CorruptedIndex_test)
+{
+  std::string const fileName = "CORSIKAShowerFile_test_index.showers";
+
+  // shower 1 would start after it ends
+  ShowerSample_t sample = makeSample();
+  sample.index = {0, 4, 2, 5};
+  writeShowerFile(fileName, sample);
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  // shower 0 would end past the last particle
+  sample.index = {0, 7, 3, 5};
+  writeShowerFile(fileName, sample);
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  // the index does not cover all the particles
+  sample.index = {0, 3, 3, 4};
+  writeShowerFile(fileName, sample);
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  // the header claims more particles than the columns hold
+  writeShowerFile(fileName, makeSample(), 1000000);
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  std::remove(fileName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(NotShowerFile_test)
+{
+  std::string const fileName = "CORSIKAShowerFile_test_other.showers";
+
+  // long enough for a header
+  std::ofstream{fileName} << std::string(4096, 'x');
+  BOOST_TEST(!CORSIKAShowerFile::isShowerFile(fileName));
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  std::ofstream{fileName} << "short";
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+
+  std::remove(fileName.c_str());
+  BOOST_TEST(!CORSIKAShowerFile::isShowerFile(fileName));
+  BOOST_CHECK_THROW(CORSIKAShowerFile{fileName}, cet::exception);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ConvertFromSQLite_test)
+{
+  std::string const dbName = "CORSIKAShowerFile_test.db";
+  std::string const fileName = "CORSIKAShowerFile_test_converted.showers";
+  std::remove(dbName.c_str());
+
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(sqlite3_open(dbName.c_str(), &db) == SQLITE_OK);
+  execute(db, "create table input (erange_high, erange_low, eslope, nshow)");
+  execute(db, "insert into input values (1e5, 1.0, -2.7, 1000)");
+  execute(db, "create table showers (id)");
+  execute(db, "insert into showers values (4), (7), (9)");
+  execute(db, "create table particles (shower, pdg, px, py, pz, x, z, t, e)");
+  // shower 7 has no particle, shower 8 is not in the showers table
+  execute(db,
+          "insert into particles values "
+          "(9, 11, 0.1, 0.2, 0.3, 10.0, 20.0, 5.0, 0.5), "
+          "(4, 13, 1.1, 1.2, 1.3, 11.0, 21.0, -3.0, 1.5), "
+          "(8, 22, 2.1, 2.2, 2.3, 12.0, 22.0, -9.0, 2.5), "
+          "(4, -13, 3.1, 3.2, 3.3, 13.0, 23.0, 7.0, 3.5)");
+  sqlite3_close(db);
+
+  CORSIKAShowerFile::ConvertFromSQLite(dbName, fileName);
+  CORSIKAShowerFile const file{fileName};
+
+  BOOST_TEST(file.NShowers() == 3U);
+  BOOST_TEST(file.NParticles() == 3U);
+  BOOST_TEST(file.ERangeHigh() == 1e5);
+  BOOST_TEST(file.ERangeLow() == 1.0);
+  BOOST_TEST(file.ESlope() == -2.7);
+  BOOST_TEST(file.NShow() == 1000U);
+  BOOST_TEST(file.MinTime() == -9.0); // as the database query: all particles
+
+  auto const [begin4, end4] = file.showerParticles(0);
+  BOOST_TEST(end4 - begin4 == 2U);
+  auto const [begin7, end7] = file.showerParticles(1);
+  BOOST_TEST(end7 == begin7);
+  auto const [begin9, end9] = file.showerParticles(2);
+  BOOST_TEST_REQUIRE(end9 - begin9 == 1U);
+  BOOST_TEST(file.pdg(begin9) == 11);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cPx, begin9) == 0.1);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cPy, begin9) == 0.2);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cPz, begin9) == 0.3);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cX, begin9) == 10.0);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cZ, begin9) == 20.0);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cT, begin9) == 5.0);
+  BOOST_TEST(file.value(CORSIKAShowerFile::cE, begin9) == 0.5);
+
+  // the order of the particles within a shower is not specified
+  std::vector<int> pdgs;
+  for (std::size_t i = begin4; i < end4; ++i)
+    pdgs.push_back(file.pdg(i));
+  std::sort(pdgs.begin(), pdgs.end());
+  BOOST_TEST(pdgs == (std::vector<int>{-13, 13}), boost::test_tools::per_element());
+
+  std::remove(dbName.c_str());
+  std::remove(fileName.c_str());
+}
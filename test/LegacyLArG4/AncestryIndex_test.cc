@@ -0,0 +1,142 @@
+/**
+ * @file   AncestryIndex_test.cc
+ * @brief  Unit test for `larg4::AncestryIndex`.
+ *
+ * The ultimate ancestors from the index are compared with the ones from a
+ * walk of a `std::map`, which is how `larg4::ParticleListAction` resolved
+ * them before the index.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (AncestryIndex_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "lardataobj/Simulation/sim.h" // sim::NoParticleId
+#include "larsim/LegacyLArG4/AncestryIndex.h"
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// Ultimate ancestor as resolved by the original `std::map` walk.
+  int mapAncestor(std::map<int, int> const& parents, int trackID)
+  {
+    int parentID = sim::NoParticleId;
+    auto it = parents.find(trackID);
+    while (it != parents.end()) {
+      parentID = it->second;
+      it = parents.find(parentID);
+    }
+    return parentID;
+  }
+
+  /// Registers tracks of a random tree in `order`, checking some ancestors after each one.
+  void checkRandomTree(larg4::AncestryIndex& index,
+                       std::mt19937& rng,
+                       int nTracks,
+                       std::vector<int> const& order)
+  {
+    // each track has a parent with smaller ID; some IDs are never registered,
+    // like tracks stored in the particle list
+    std::vector<int> parentOf(nTracks + 1);
+    for (int trackID = 2; trackID <= nTracks; ++trackID)
+      parentOf[trackID] = std::uniform_int_distribution<int>{1, trackID - 1}(rng);
+
+    std::map<int, int> parents;
+    std::vector<int> registered;
+    for (int const trackID : order) {
+      index.setParent(trackID, parentOf[trackID]);
+      parents[trackID] = parentOf[trackID];
+      registered.push_back(trackID);
+
+      for (int i = 0; i < 4; ++i) {
+        int const queried = registered[std::uniform_int_distribution<std::size_t>{
+          0, registered.size() - 1}(rng)];
+        BOOST_TEST(index.ultimateAncestor(queried) == mapAncestor(parents, queried));
+      }
+    }
+
+    for (int trackID = 0; trackID <= nTracks + 1; ++trackID)
+      BOOST_TEST(index.ultimateAncestor(trackID) == mapAncestor(parents, trackID));
+  }
+
+  /// Returns a random subset of `[2, nTracks]` in increasing order.
+  std::vector<int> randomSubset(std::mt19937& rng, int nTracks, double fraction)
+  {
+    std::bernoulli_distribution keep{fraction};
+    std::vector<int> tracks;
+    for (int trackID = 2; trackID <= nTracks; ++trackID)
+      if (keep(rng)) tracks.push_back(trackID);
+    return tracks;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(EmptyIndexTest)
+{
+  larg4::AncestryIndex index;
+  BOOST_TEST(index.ultimateAncestor(0) == sim::NoParticleId);
+  BOOST_TEST(index.ultimateAncestor(5) == sim::NoParticleId);
+  BOOST_TEST(index.ultimateAncestor(-3) == sim::NoParticleId);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ChainTest)
+{
+  larg4::AncestryIndex index;
+  index.setParent(2, 1);
+  index.setParent(3, 2);
+  index.setParent(4, 3);
+  BOOST_TEST(index.ultimateAncestor(4) == 1);
+  BOOST_TEST(index.ultimateAncestor(2) == 1);
+
+  // a parent registered after its descendants were resolved
+  index.setParent(1, 7);
+  BOOST_TEST(index.ultimateAncestor(4) == 7);
+  BOOST_TEST(index.ultimateAncestor(3) == 7);
+
+  // a parent changed after its descendants were resolved
+  index.setParent(2, 9);
+  BOOST_TEST(index.ultimateAncestor(4) == 9);
+  BOOST_TEST(index.ultimateAncestor(1) == 7);
+
+  index.clear();
+  BOOST_TEST(index.ultimateAncestor(4) == sim::NoParticleId);
+  index.setParent(4, 3);
+  BOOST_TEST(index.ultimateAncestor(4) == 3);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RandomTreeInOrderTest)
+{
+  std::mt19937 rng{12345};
+  larg4::AncestryIndex index;
+  for (int event = 0; event < 20; ++event) {
+    index.clear();
+    int const nTracks = 500 + 50 * event;
+    checkRandomTree(index, rng, nTracks, randomSubset(rng, nTracks, 0.7));
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RandomTreeOutOfOrderTest)
+{
+  std::mt19937 rng{54321};
+  larg4::AncestryIndex index;
+  for (int event = 0; event < 20; ++event) {
+    index.clear();
+    int const nTracks = 500 + 50 * event;
+    std::vector<int> order = randomSubset(rng, nTracks, 0.7);
+    // swap some tracks, so that a few are registered after their descendants
+    for (std::size_t i = 1; i < order.size(); i += 7)
+      std::swap(order[i], order[std::uniform_int_distribution<std::size_t>{0, i}(rng)]);
+    checkRandomTree(index, rng, nTracks, order);
+  }
+}
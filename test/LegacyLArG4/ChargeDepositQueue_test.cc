@@ -0,0 +1,185 @@
+/**
+ * @file   ChargeDepositQueue_test.cc
+ * @brief  Unit test for `larg4::ChargeDepositQueue`.
+ *
+ * The `sim::SimChannel` filled from the queue are compared with the ones
+ * filled by adding the charge of each step directly, which is how
+ * `larg4::LArVoxelReadout` stored it before the queue.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (ChargeDepositQueue_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "lardataobj/Simulation/SimChannel.h"
+#include "larsim/LegacyLArG4/ChargeDepositQueue.h"
+
+// C/C++ standard libraries
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+  using ChannelMap_t = larg4::ChargeDepositQueue::ChannelMap_t;
+  using ChargeDeposit_t = larg4::ChargeDepositQueue::ChargeDeposit_t;
+
+  /// A step with its electron clusters.
+  struct Step_t {
+    int trackID;
+    int origTrackID;
+    double xyz[3];
+    std::vector<ChargeDeposit_t> clusters;
+  };
+
+  /// Returns random steps, with clusters often on the same channel and TDC.
+  std::vector<Step_t> makeSteps(std::mt19937& rng, int nSteps)
+  {
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    std::uniform_int_distribution<int> pickTrack{1, 20};
+    std::uniform_int_distribution<raw::ChannelID_t> pickChannel{0, 60};
+    std::uniform_int_distribution<unsigned int> pickTDC{0, 40};
+    std::uniform_int_distribution<int> pickNClusters{1, 30};
+
+    std::vector<Step_t> steps;
+    for (int i = 0; i < nSteps; ++i) {
+      int const trackID = pickTrack(rng);
+      Step_t step{trackID, -trackID, {uniform(rng), uniform(rng), uniform(rng)}, {}};
+      // the clusters of a step are close to each other
+      raw::ChannelID_t const channel = pickChannel(rng);
+      unsigned int const tdc = pickTDC(rng);
+      int const nClusters = pickNClusters(rng);
+      for (int k = 0; k < nClusters; ++k) {
+        step.clusters.push_back({channel + pickChannel(rng) % 3,
+                                 tdc + pickTDC(rng) % 4,
+                                 static_cast<std::uint32_t>(k),
+                                 0.01 * uniform(rng),
+                                 200.0 * uniform(rng)});
+      }
+      steps.push_back(std::move(step));
+    }
+    return steps;
+  }
+
+  /// Adds the charge of `step` to `channels` as `LArVoxelReadout` used to.
+  void addStepDirectly(ChannelMap_t& channels, Step_t const& step)
+  {
+    struct Deposit_t {
+      double energy = 0.0;
+      double electrons = 0.0;
+    };
+    std::map<raw::ChannelID_t, std::map<unsigned int, Deposit_t>> depositsToStore;
+    for (ChargeDeposit_t const& cluster : step.clusters) {
+      Deposit_t& deposit = depositsToStore[cluster.channel][cluster.tdc];
+      deposit.energy += cluster.energy;
+      deposit.electrons += cluster.electrons;
+    }
+
+    for (auto const& [channel, deposits] : depositsToStore) {
+      auto iChannelData = channels.find(channel);
+      sim::SimChannel& channelData = (iChannelData == channels.end()) ?
+                                       (channels[channel] = sim::SimChannel(channel)) :
+                                       iChannelData->second;
+      for (auto const& [tdc, deposit] : deposits) {
+        channelData.AddIonizationElectrons(
+          step.trackID, tdc, deposit.electrons, step.xyz, deposit.energy, step.origTrackID);
+      }
+    }
+  }
+
+  /// Checks that two channel maps have the very same content.
+  void checkSameChannels(ChannelMap_t const& channels, ChannelMap_t const& expected)
+  {
+    BOOST_TEST_REQUIRE(channels.size() == expected.size());
+    auto iExpected = expected.cbegin();
+    for (auto const& [channel, simChannel] : channels) {
+      BOOST_TEST_CONTEXT("channel " << channel)
+      {
+        BOOST_TEST_REQUIRE(channel == iExpected->first);
+        auto const& tdcides = simChannel.TDCIDEMap();
+        auto const& expectedTDCIDEs = iExpected->second.TDCIDEMap();
+        BOOST_TEST_REQUIRE(tdcides.size() == expectedTDCIDEs.size());
+        for (std::size_t i = 0; i < tdcides.size(); ++i) {
+          BOOST_TEST(tdcides[i].first == expectedTDCIDEs[i].first);
+          auto const& ides = tdcides[i].second;
+          auto const& expectedIDEs = expectedTDCIDEs[i].second;
+          BOOST_TEST_REQUIRE(ides.size() == expectedIDEs.size());
+          for (std::size_t j = 0; j < ides.size(); ++j) {
+            // same operations in the same order: the results are identical
+            BOOST_TEST(ides[j].trackID == expectedIDEs[j].trackID);
+            BOOST_TEST(ides[j].origTrackID == expectedIDEs[j].origTrackID);
+            BOOST_TEST(ides[j].numElectrons == expectedIDEs[j].numElectrons);
+            BOOST_TEST(ides[j].energy == expectedIDEs[j].energy);
+            BOOST_TEST(ides[j].x == expectedIDEs[j].x);
+            BOOST_TEST(ides[j].y == expectedIDEs[j].y);
+            BOOST_TEST(ides[j].z == expectedIDEs[j].z);
+          }
+        }
+      }
+      ++iExpected;
+    }
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AllAtOnce_test)
+{
+  std::mt19937 rng{1234};
+  std::vector<Step_t> const steps = makeSteps(rng, 2000);
+
+  ChannelMap_t expected;
+  for (Step_t const& step : steps)
+    addStepDirectly(expected, step);
+
+  larg4::ChargeDepositQueue queue;
+  std::vector<ChargeDeposit_t> clusters;
+  for (Step_t const& step : steps) {
+    clusters = step.clusters;
+    queue.addStep(step.trackID, step.origTrackID, step.xyz, clusters);
+  }
+  BOOST_TEST(!queue.empty());
+
+  ChannelMap_t channels;
+  queue.moveInto(channels);
+  BOOST_TEST(queue.empty());
+  checkSameChannels(channels, expected);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Bounded_test)
+{
+  // charge moved into the channels whenever the queue gets long, as
+  // `LArVoxelReadout` does, and over two events
+  std::mt19937 rng{4321};
+  larg4::ChargeDepositQueue queue;
+  std::vector<ChargeDeposit_t> clusters;
+
+  for (int event = 0; event < 2; ++event) {
+    std::vector<Step_t> const steps = makeSteps(rng, 3000);
+
+    ChannelMap_t expected;
+    for (Step_t const& step : steps)
+      addStepDirectly(expected, step);
+
+    ChannelMap_t channels;
+    for (Step_t const& step : steps) {
+      clusters = step.clusters;
+      queue.addStep(step.trackID, step.origTrackID, step.xyz, clusters);
+      if (queue.size() >= 500) queue.moveInto(channels);
+    }
+    queue.moveInto(channels);
+    checkSameChannels(channels, expected);
+  }
+
+  // charge dropped at the start of an event does not show up
+  clusters = makeSteps(rng, 1).front().clusters;
+  double const xyz[3] = {0.0, 0.0, 0.0};
+  queue.addStep(1, 1, xyz, clusters);
+  queue.clear();
+  ChannelMap_t channels;
+  queue.moveInto(channels);
+  BOOST_TEST(channels.empty());
+}
@@ -0,0 +1,208 @@
+/**
+ * @file   BackTrackerIndex_test.cc
+ * @brief  Unit test for the event indices of `cheat::BackTracker`.
+ *
+ * The track IDEs of a channel and time window, served from the TDC index, are
+ * compared with the ones from `sim::SimChannel::TrackIDsAndEnergies()`, and
+ * the IDEs of a track, served from the track ID index, with the ones from a
+ * scan of all the `sim::SimChannel` objects, which is how `cheat::BackTracker`
+ * found them before the indices.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (BackTrackerIndex_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "lardataalg/DetectorInfo/DetectorClocksData.h"
+#include "lardataalg/DetectorInfo/ElecClock.h"
+#include "lardataobj/Simulation/SimChannel.h"
+#include "lardataobj/Simulation/sim.h" // sim::NoParticleId
+#include "larsim/MCCheater/BackTracker.h"
+
+// framework libraries
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Utilities/InputTag.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort()
+#include <cstdlib>   // std::abs()
+#include <iterator>  // std::size()
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// Minimal handle to a collection, enough to make `art::Ptr` to its elements.
+  template <typename Coll>
+  struct TestHandle {
+    Coll const* fProduct;
+    art::ProductID id() const { return art::ProductID{1U}; }
+    Coll const* product() const { return fProduct; }
+    Coll const* operator->() const { return fProduct; }
+    Coll const& operator*() const { return *fProduct; }
+    bool isValid() const { return fProduct != nullptr; }
+  };
+
+  /// Minimal event, as much as `cheat::BackTracker::PrepEvent()` needs.
+  struct TestEvent {
+    std::vector<sim::SimChannel> const* fSimChannels;
+    bool isRealData() const { return false; }
+    template <typename T>
+    TestHandle<T> getValidHandle(art::InputTag const&) const
+    {
+      return {fSimChannels};
+    }
+  };
+
+  /// Track IDs of the deposits: negative ones are EM shower particles.
+  constexpr int TrackIDs[] = {1, 2, 3, -3, 4, 7, -7, 12, sim::NoParticleId};
+
+  /// Returns channels with random deposits, some channels not in order.
+  std::vector<sim::SimChannel> makeSimChannels(std::mt19937& rng)
+  {
+    std::uniform_int_distribution<int> pickTrack{0, int(std::size(TrackIDs)) - 1};
+    std::uniform_int_distribution<unsigned int> pickTDC{0, 3000};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    std::vector<sim::SimChannel> channels;
+    for (raw::ChannelID_t channel : {4U, 2U, 7U, 8U, 9U, 15U, 16U, 40U}) {
+      sim::SimChannel& sc = channels.emplace_back(channel);
+      for (int i = 0; i < 400; ++i) {
+        double const xyz[3] = {uniform(rng), uniform(rng), uniform(rng)};
+        sc.AddIonizationElectrons(TrackIDs[pickTrack(rng)],
+                                  pickTDC(rng),
+                                  1000.0 * uniform(rng),
+                                  xyz,
+                                  0.1 * uniform(rng));
+      }
+    }
+    return channels;
+  }
+
+  /// Track IDEs as `cheat::BackTracker::ChannelToTrackIDEs()` used to compute them.
+  std::vector<sim::TrackIDE> scanTrackIDEs(detinfo::DetectorClocksData const& clockData,
+                                           std::vector<sim::SimChannel> const& channels,
+                                           raw::ChannelID_t channel,
+                                           double hit_start_time,
+                                           double hit_end_time)
+  {
+    sim::SimChannel const* schannel = nullptr;
+    for (sim::SimChannel const& sc : channels)
+      if (sc.Channel() == channel) schannel = &sc;
+    if (!schannel) return {};
+
+    int start_tdc = clockData.TPCTick2TDC(hit_start_time);
+    int end_tdc = clockData.TPCTick2TDC(hit_end_time);
+    if (start_tdc < 0) start_tdc = 0;
+    if (end_tdc < 0) end_tdc = 0;
+    std::vector<sim::IDE> simides = schannel->TrackIDsAndEnergies(start_tdc, end_tdc);
+
+    double totalE = 0.;
+    for (sim::IDE const& ide : simides)
+      totalE += ide.energy;
+    if (totalE < 1.e-5) totalE = 1.;
+
+    std::vector<sim::TrackIDE> trackIDEs;
+    for (sim::IDE const& ide : simides) {
+      if (ide.trackID == sim::NoParticleId) continue;
+      sim::TrackIDE info;
+      info.trackID = ide.trackID;
+      info.energyFrac = ide.energy / totalE;
+      info.energy = ide.energy;
+      info.numElectrons = ide.numElectrons;
+      trackIDEs.push_back(info);
+    }
+    return trackIDEs;
+  }
+
+  /// IDEs of a track as `cheat::BackTracker::TrackIdToSimIDEs_Ps()` used to find them.
+  std::vector<sim::IDE const*> scanTrackIDEs(std::vector<sim::SimChannel const*> const& sorted,
+                                             int id)
+  {
+    std::vector<sim::IDE const*> ideps;
+    for (sim::SimChannel const* sc : sorted) {
+      for (auto const& item : sc->TDCIDEMap()) {
+        for (sim::IDE const& ide : item.second)
+          if (std::abs(ide.trackID) == id) ideps.push_back(&ide);
+      }
+    }
+    return ideps;
+  }
+
+  struct BackTrackerFixture {
+    std::mt19937 rng{2024};
+    std::vector<sim::SimChannel> channels = makeSimChannels(rng);
+    cheat::BackTracker backTracker{fhicl::ParameterSet{}, nullptr, nullptr};
+
+    // with no offsets, one TDC per TPC tick
+    detinfo::ElecClock const clock{0.0, 1600.0, 2.0};
+    detinfo::DetectorClocksData const clockData{0.0, 0.0, 0.0, 0.0, clock, clock, clock, clock};
+
+    BackTrackerFixture() { backTracker.PrepEvent(TestEvent{&channels}); }
+  };
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_FIXTURE_TEST_CASE(ChannelToTrackIDEs_test, BackTrackerFixture)
+{
+  std::uniform_real_distribution<double> pickStart{-100.0, 3100.0};
+  std::uniform_real_distribution<double> pickWidth{-30.0, 200.0}; // some windows are reversed
+
+  for (int i = 0; i < 2000; ++i) {
+    raw::ChannelID_t const channel = std::uniform_int_distribution<raw::ChannelID_t>{0, 42}(rng);
+    double const start = pickStart(rng);
+    double const end = start + pickWidth(rng);
+
+    std::vector<sim::TrackIDE> const expected =
+      scanTrackIDEs(clockData, channels, channel, start, end);
+    std::vector<sim::TrackIDE> const trackIDEs =
+      backTracker.ChannelToTrackIDEs(clockData, channel, start, end);
+
+    // sim::IDE sums in single precision, the index in double precision
+    BOOST_TEST_CONTEXT("channel " << channel << " [ " << start << " ; " << end << " ]")
+    {
+      BOOST_TEST_REQUIRE(trackIDEs.size() == expected.size());
+      for (std::size_t j = 0; j < expected.size(); ++j) {
+        BOOST_TEST(trackIDEs[j].trackID == expected[j].trackID);
+        BOOST_TEST(trackIDEs[j].energy == expected[j].energy, boost::test_tools::tolerance(1e-4f));
+        BOOST_TEST(trackIDEs[j].numElectrons == expected[j].numElectrons,
+                   boost::test_tools::tolerance(1e-4f));
+        BOOST_TEST(trackIDEs[j].energyFrac == expected[j].energyFrac,
+                   boost::test_tools::tolerance(1e-4f));
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_FIXTURE_TEST_CASE(TrackIdToSimIDEs_test, BackTrackerFixture)
+{
+  std::vector<sim::SimChannel const*> sorted;
+  for (sim::SimChannel const& sc : channels)
+    sorted.push_back(&sc);
+  std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->Channel() < b->Channel(); });
+
+  for (int const id : {1, 2, 3, 4, 5, 7, 12, std::abs(sim::NoParticleId)}) {
+    std::vector<sim::IDE const*> const expected = scanTrackIDEs(sorted, id);
+    std::vector<sim::IDE const*> const ideps = backTracker.TrackIdToSimIDEs_Ps(id);
+    BOOST_TEST_CONTEXT("track ID " << id)
+    {
+      BOOST_TEST(ideps == expected, boost::test_tools::per_element());
+    }
+  }
+
+  // a new event rebuilds the index
+  channels = makeSimChannels(rng);
+  backTracker.ClearEvent();
+  backTracker.PrepEvent(TestEvent{&channels});
+  sorted.clear();
+  for (sim::SimChannel const& sc : channels)
+    sorted.push_back(&sc);
+  std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->Channel() < b->Channel(); });
+  BOOST_TEST(backTracker.TrackIdToSimIDEs_Ps(3) == scanTrackIDEs(sorted, 3),
+             boost::test_tools::per_element());
+}
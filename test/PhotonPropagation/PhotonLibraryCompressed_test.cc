@@ -0,0 +1,228 @@
+/**
+ * @file    PhotonLibraryCompressed_test.cc
+ * @brief   Unit test for `phot::PhotonLibraryCompressed`.
+ * @see     `larsim/PhotonPropagation/PhotonLibraryCompressed.h`
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (PhotonLibraryCompressed_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/PhotonLibraryCompressed.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max()
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+
+  using phot::PhotonLibraryCompressed;
+  using Encoding_t = PhotonLibraryCompressed::Encoding_t;
+
+  /// An uncompressed library in memory, with visibilities spanning
+  /// `[ vmin, vmax ]` on a log scale and about one in four of them zero.
+  class TestLibrary : public phot::IPhotonLibrary {
+  public:
+    TestLibrary(std::size_t nVoxels, std::size_t nChannels, float vmin, float vmax)
+      : fNVoxels(nVoxels), fNChannels(nChannels)
+    {
+      std::mt19937 rng{2468};
+      std::uniform_real_distribution<double> pickLog{std::log(vmin), std::log(vmax)};
+      std::uniform_int_distribution<int> pickZero{0, 3};
+      for (std::vector<float>* values : {&fCounts, &fReflCounts}) {
+        values->resize(nVoxels * nChannels);
+        for (float& value : *values)
+          value = (pickZero(rng) == 0) ? 0.0f : float(std::exp(pickLog(rng)));
+        // the range limits are in the library
+        (*values)[1] = vmin;
+        (*values)[2] = vmax;
+      }
+      fReflT0s.resize(nVoxels * nChannels);
+      for (std::size_t i = 0; i < fReflT0s.size(); ++i)
+        fReflT0s[i] = 10.0f + 0.5f * (i % 37);
+    }
+
+    float GetCount(size_t Voxel, size_t OpChannel) const override
+    {
+      return fCounts[Voxel * fNChannels + OpChannel];
+    }
+    float GetReflCount(size_t Voxel, size_t OpChannel) const override
+    {
+      return fReflCounts[Voxel * fNChannels + OpChannel];
+    }
+    float GetReflT0(size_t Voxel, size_t OpChannel) const override
+    {
+      return fReflT0s[Voxel * fNChannels + OpChannel];
+    }
+
+    Counts_t GetCounts(size_t Voxel) const override { return fCounts.data() + Voxel * fNChannels; }
+    Counts_t GetReflCounts(size_t Voxel) const override
+    {
+      return fReflCounts.data() + Voxel * fNChannels;
+    }
+    T0s_t GetReflT0s(size_t Voxel) const override { return fReflT0s.data() + Voxel * fNChannels; }
+
+    bool hasReflected() const override { return true; }
+    bool hasReflectedT0() const override { return true; }
+
+    int NOpChannels() const override { return fNChannels; }
+    int NVoxels() const override { return fNVoxels; }
+
+  private:
+    std::size_t fNVoxels;
+    std::size_t fNChannels;
+    std::vector<float> fCounts;
+    std::vector<float> fReflCounts;
+    std::vector<float> fReflT0s;
+  };
+
+  PhotonLibraryCompressed::Config_t makeConfig(Encoding_t encoding,
+                                               double maxRelError,
+                                               bool sparse)
+  {
+    PhotonLibraryCompressed::Config_t config;
+    config.encoding = encoding;
+    config.maxRelError = maxRelError;
+    config.sparse = sparse;
+    return config;
+  }
+
+  /// Checks every decoded value of `library` against `source`.
+  void checkRoundTrip(PhotonLibraryCompressed const& library,
+                      TestLibrary const& source,
+                      double maxRelError)
+  {
+    BOOST_TEST_REQUIRE(library.NVoxels() == source.NVoxels());
+    BOOST_TEST_REQUIRE(library.NOpChannels() == source.NOpChannels());
+    BOOST_TEST(library.GetCompressionReport().maxRelError <= maxRelError);
+    BOOST_TEST(library.GetCompressionReport(true).maxRelError <= maxRelError);
+
+    std::size_t const nChannels = source.NOpChannels();
+    std::vector<float> decoded(nChannels), reflDecoded(nChannels);
+    std::size_t nNonZero = 0;
+    double largestError = 0.0;
+    for (int v = 0; v < source.NVoxels(); ++v) {
+      BOOST_TEST_REQUIRE(library.DecodeCounts(v, decoded.data()));
+      BOOST_TEST_REQUIRE(library.DecodeReflCounts(v, reflDecoded.data()));
+      float const* counts = library.GetCounts(v);
+      float const* reflCounts = library.GetReflCounts(v);
+      BOOST_TEST_REQUIRE(counts);
+      BOOST_TEST_REQUIRE(reflCounts);
+      for (std::size_t ch = 0; ch < nChannels; ++ch) {
+        BOOST_TEST_CONTEXT("voxel " << v << " channel " << ch)
+        {
+          float const expected = source.GetCount(v, ch);
+          float const value = library.GetCount(v, ch);
+          BOOST_TEST(decoded[ch] == value);
+          BOOST_TEST(counts[ch] == value);
+          BOOST_TEST(reflDecoded[ch] == library.GetReflCount(v, ch));
+          BOOST_TEST(reflCounts[ch] == library.GetReflCount(v, ch));
+          BOOST_TEST(library.GetReflT0(v, ch) == source.GetReflT0(v, ch));
+          if (expected == 0.0f) {
+            BOOST_TEST(value == 0.0f); // zero stays zero
+            continue;
+          }
+          ++nNonZero;
+          double const relError = std::abs(value - expected) / expected;
+          BOOST_TEST(relError <= maxRelError);
+          largestError = std::max(largestError, relError);
+          float const reflExpected = source.GetReflCount(v, ch);
+          if (reflExpected > 0.0f) {
+            BOOST_TEST(std::abs(library.GetReflCount(v, ch) - reflExpected) / reflExpected <=
+                       maxRelError);
+          }
+        }
+      }
+    }
+    BOOST_TEST(library.GetCompressionReport().nNonZero == nNonZero);
+    // the report is the error actually measured
+    BOOST_TEST(library.GetCompressionReport().maxRelError == largestError);
+
+    // out of range
+    BOOST_TEST(library.GetCounts(source.NVoxels()) == nullptr);
+    BOOST_TEST(!library.DecodeCounts(source.NVoxels(), decoded.data()));
+    BOOST_TEST(library.GetCount(0, nChannels) == 0.0f);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RoundTrip_test)
+{
+  TestLibrary const source{40, 30, 1e-7f, 2e-2f};
+  for (Encoding_t encoding : {Encoding_t::Log8, Encoding_t::Log16, Encoding_t::Auto}) {
+    // 8-bit codes on this range are good to about 3%
+    double const maxRelError = (encoding == Encoding_t::Log8) ? 0.05 : 1e-3;
+    for (bool sparse : {false, true}) {
+      BOOST_TEST_CONTEXT("encoding " << int(encoding) << (sparse ? " (sparse)" : ""))
+      {
+        PhotonLibraryCompressed const library{source, makeConfig(encoding, maxRelError, sparse)};
+        BOOST_TEST((library.GetEncoding() != Encoding_t::Auto));
+        checkRoundTrip(library, source, maxRelError);
+        if (sparse) {
+          BOOST_TEST(library.GetCompressionReport().nStored ==
+                     library.GetCompressionReport().nNonZero);
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ErrorBound_test)
+{
+  TestLibrary const source{10, 20, 1e-7f, 2e-2f};
+
+  // the default bound can't be met by 8-bit codes on this range...
+  PhotonLibraryCompressed::Config_t config;
+  BOOST_TEST(config.maxRelError == 1e-3);
+  config.encoding = Encoding_t::Log8;
+  BOOST_CHECK_THROW(PhotonLibraryCompressed(source, config), cet::exception);
+
+  // ... so the default encoding falls back to 16-bit codes
+  PhotonLibraryCompressed const library{source, PhotonLibraryCompressed::Config_t{}};
+  BOOST_TEST((library.GetEncoding() == Encoding_t::Log16));
+  checkRoundTrip(library, source, 1e-3);
+
+  // too tight for 16-bit codes as well
+  BOOST_CHECK_THROW(PhotonLibraryCompressed(source, makeConfig(Encoding_t::Auto, 1e-5, false)),
+                    cet::exception);
+
+  // not above the float precision
+  BOOST_CHECK_THROW(PhotonLibraryCompressed(source, makeConfig(Encoding_t::Log16, 1e-8, false)),
+                    cet::exception);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AutoEncoding_test)
+{
+  // a range of a factor 10 is stored by 8-bit codes within about 0.5%
+  TestLibrary const narrow{10, 20, 1e-3f, 1e-2f};
+  PhotonLibraryCompressed const narrowLibrary{narrow, makeConfig(Encoding_t::Auto, 1e-2, false)};
+  BOOST_TEST((narrowLibrary.GetEncoding() == Encoding_t::Log8));
+  checkRoundTrip(narrowLibrary, narrow, 1e-2);
+
+  TestLibrary const wide{10, 20, 1e-9f, 1e-2f};
+  PhotonLibraryCompressed const wideLibrary{wide, makeConfig(Encoding_t::Auto, 1e-2, false)};
+  BOOST_TEST((wideLibrary.GetEncoding() == Encoding_t::Log16));
+  checkRoundTrip(wideLibrary, wide, 1e-2);
+
+  BOOST_TEST(narrowLibrary.GetCompressionReport().memoryBytes <
+             wideLibrary.GetCompressionReport().memoryBytes);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ParseEncoding_test)
+{
+  BOOST_TEST((PhotonLibraryCompressed::parseEncoding("Log8") == Encoding_t::Log8));
+  BOOST_TEST((PhotonLibraryCompressed::parseEncoding("Log16") == Encoding_t::Log16));
+  BOOST_TEST((PhotonLibraryCompressed::parseEncoding("Auto") == Encoding_t::Auto));
+  BOOST_CHECK_THROW(PhotonLibraryCompressed::parseEncoding("Log12"), cet::exception);
+}
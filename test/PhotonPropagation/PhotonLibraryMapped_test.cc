@@ -0,0 +1,349 @@
+/**
+ * @file    PhotonLibraryMapped_test.cc
+ * @brief   Unit test for `phot::PhotonLibraryMapped`.
+ * @see     `larsim/PhotonPropagation/PhotonLibraryMapped.h`
+ *
+ * Small libraries are stored in the mapped format and read back, some of the
+ * files deliberately corrupted; one is converted from a small ROOT tree
+ * library the way `ConvertPhotonLibraryToMapped` does.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (PhotonLibraryMapped_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/PhotonLibrary.h"
+#include "larsim/PhotonPropagation/PhotonLibraryMapped.h"
+#include "larsim/Simulation/PhotonVoxels.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// ROOT
+#include "RooDouble.h"
+#include "RooInt.h"
+#include "TFile.h"
+#include "TTree.h"
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <string>
+#include <vector>
+
+namespace {
+
+  using phot::PhotonLibraryMapped;
+
+  /// Voxelization of the test libraries: 4 x 3 x 2 voxels.
+  sim::PhotonVoxelDef const VoxelDef{-20.0, 20.0, 4, -15.0, 15.0, 3, 0.0, 50.0, 2};
+
+  constexpr std::size_t NOpChannels = 5;
+
+  float directValue(std::size_t v, std::size_t ch)
+  {
+    return (ch == 2) ? 0.0f : 1e-4f * (v + 1) / (ch + 1);
+  }
+  float reflValue(std::size_t v, std::size_t ch)
+  {
+    return 2e-5f * (ch + 1) + 1e-6f * v;
+  }
+  float reflT0Value(std::size_t v, std::size_t ch)
+  {
+    return 10.0f + 0.5f * v + 0.25f * ch;
+  }
+
+  /// A library in memory, with the values of the functions above.
+  class TestLibrary : public phot::IPhotonLibrary {
+  public:
+    TestLibrary(std::size_t nVoxels, std::size_t nChannels)
+      : fNVoxels(nVoxels), fNChannels(nChannels)
+    {
+      for (std::size_t v = 0; v < nVoxels; ++v) {
+        for (std::size_t ch = 0; ch < nChannels; ++ch) {
+          fCounts.push_back(directValue(v, ch));
+          fReflCounts.push_back(reflValue(v, ch));
+          fReflT0s.push_back(reflT0Value(v, ch));
+        }
+      }
+    }
+
+    float GetCount(size_t Voxel, size_t OpChannel) const override
+    {
+      return fCounts[Voxel * fNChannels + OpChannel];
+    }
+    float GetReflCount(size_t Voxel, size_t OpChannel) const override
+    {
+      return fReflCounts[Voxel * fNChannels + OpChannel];
+    }
+    float GetReflT0(size_t Voxel, size_t OpChannel) const override
+    {
+      return fReflT0s[Voxel * fNChannels + OpChannel];
+    }
+
+    Counts_t GetCounts(size_t Voxel) const override { return fCounts.data() + Voxel * fNChannels; }
+    Counts_t GetReflCounts(size_t Voxel) const override
+    {
+      return fReflCounts.data() + Voxel * fNChannels;
+    }
+    T0s_t GetReflT0s(size_t Voxel) const override { return fReflT0s.data() + Voxel * fNChannels; }
+
+    bool hasReflected() const override { return true; }
+    bool hasReflectedT0() const override { return true; }
+
+    int NOpChannels() const override { return fNChannels; }
+    int NVoxels() const override { return fNVoxels; }
+
+  private:
+    std::size_t fNVoxels;
+    std::size_t fNChannels;
+    std::vector<float> fCounts;
+    std::vector<float> fReflCounts;
+    std::vector<float> fReflT0s;
+  };
+
+  /// Checks that `library` holds the values of the test library.
+  void checkLibrary(PhotonLibraryMapped const& library, bool withReflected, bool withReflT0)
+  {
+    std::size_t const nVoxels = VoxelDef.GetNVoxels();
+    BOOST_TEST_REQUIRE(library.NVoxels() == int(nVoxels));
+    BOOST_TEST_REQUIRE(library.NOpChannels() == int(NOpChannels));
+    BOOST_TEST(library.hasReflected() == withReflected);
+    BOOST_TEST(library.hasReflectedT0() == withReflT0);
+    BOOST_TEST(library.GetVoxelDef() == VoxelDef);
+
+    for (std::size_t v = 0; v < nVoxels; ++v) {
+      float const* counts = library.GetCounts(v);
+      BOOST_TEST_REQUIRE(counts);
+      float const* reflCounts = library.GetReflCounts(v);
+      float const* reflT0s = library.GetReflT0s(v);
+      BOOST_TEST(bool(reflCounts) == withReflected);
+      BOOST_TEST(bool(reflT0s) == withReflT0);
+      for (std::size_t ch = 0; ch < NOpChannels; ++ch) {
+        BOOST_TEST_CONTEXT("voxel " << v << " channel " << ch)
+        {
+          // stored as they are: no tolerance
+          BOOST_TEST(library.GetCount(v, ch) == directValue(v, ch));
+          BOOST_TEST(counts[ch] == directValue(v, ch));
+          if (withReflected) {
+            BOOST_TEST(library.GetReflCount(v, ch) == reflValue(v, ch));
+            BOOST_TEST(reflCounts[ch] == reflValue(v, ch));
+          }
+          else
+            BOOST_TEST(library.GetReflCount(v, ch) == 0.0f);
+          if (withReflT0) {
+            BOOST_TEST(library.GetReflT0(v, ch) == reflT0Value(v, ch));
+            BOOST_TEST(reflT0s[ch] == reflT0Value(v, ch));
+          }
+          else
+            BOOST_TEST(library.GetReflT0(v, ch) == 0.0f);
+        }
+      }
+    }
+
+    // out of range
+    BOOST_TEST(library.GetCounts(nVoxels) == nullptr);
+    BOOST_TEST(library.GetCount(nVoxels, 0) == 0.0f);
+    BOOST_TEST(library.GetCount(0, NOpChannels) == 0.0f);
+    BOOST_TEST(!library.isVoxelValid(nVoxels));
+  }
+
+  std::vector<char> readFile(std::string const& fileName)
+  {
+    std::ifstream in{fileName, std::ios::binary};
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  }
+
+  void writeFile(std::string const& fileName, std::vector<char> const& content)
+  {
+    std::ofstream{fileName, std::ios::binary | std::ios::trunc}.write(content.data(),
+                                                                       content.size());
+  }
+
+  /// Returns a copy of the `content` of a library file with its header modified.
+  template <typename Modify>
+  std::vector<char> withHeader(std::vector<char> content, Modify modify)
+  {
+    auto* header = reinterpret_cast<PhotonLibraryMapped::FileHeader_t*>(content.data());
+    modify(*header);
+    return content;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RoundTrip_test)
+{
+  std::string const fileName = "PhotonLibraryMapped_test_roundtrip.bin";
+  TestLibrary const source{VoxelDef.GetNVoxels(), NOpChannels};
+
+  for (bool withReflected : {false, true}) {
+    for (bool withReflT0 : {false, true}) {
+      BOOST_TEST_CONTEXT("reflected: " << withReflected << ", T0: " << withReflT0)
+      {
+        PhotonLibraryMapped::StoreLibraryToFile(
+          source, VoxelDef, fileName, withReflected, withReflT0);
+        PhotonLibraryMapped const library{fileName};
+        checkLibrary(library, withReflected, withReflT0);
+      }
+    }
+  }
+
+  // the voxelization must match the library
+  sim::PhotonVoxelDef const wrongDef{-20.0, 20.0, 4, -15.0, 15.0, 3, 0.0, 50.0, 3};
+  BOOST_CHECK_THROW(PhotonLibraryMapped::StoreLibraryToFile(source, wrongDef, fileName),
+                    cet::exception);
+
+  std::remove(fileName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CorruptedHeader_test)
+{
+  std::string const goodName = "PhotonLibraryMapped_test_good.bin";
+  std::string const fileName = "PhotonLibraryMapped_test_corrupted.bin";
+  TestLibrary const source{VoxelDef.GetNVoxels(), NOpChannels};
+  PhotonLibraryMapped::StoreLibraryToFile(source, VoxelDef, goodName, true, true);
+  std::vector<char> const good = readFile(goodName);
+  using FileHeader_t = PhotonLibraryMapped::FileHeader_t;
+
+  // the unmodified copy is fine
+  writeFile(fileName, good);
+  BOOST_CHECK_NO_THROW(PhotonLibraryMapped{fileName});
+
+  writeFile(fileName, withHeader(good, [](FileHeader_t& header) { header.magic[3] = 'X'; }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  writeFile(fileName,
+            withHeader(good, [](FileHeader_t& header) { header.byteOrder = 0x04030201; }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  writeFile(fileName, withHeader(good, [](FileHeader_t& header) {
+              header.version = PhotonLibraryMapped::FormatVersion + 1;
+            }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // the block size does not fit 64 bits
+  writeFile(fileName, withHeader(good, [](FileHeader_t& header) {
+              header.nVoxels = std::uint64_t(1) << 40;
+              header.nOpChannels = std::uint64_t(1) << 30;
+            }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // more voxels than the file holds
+  writeFile(fileName, withHeader(good, [](FileHeader_t& header) { header.nVoxels *= 100; }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // a block past the end of the file
+  writeFile(fileName, withHeader(good, [&good](FileHeader_t& header) {
+              header.reflT0Offset = good.size();
+            }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // a block overlapping the header
+  writeFile(fileName, withHeader(good, [](FileHeader_t& header) { header.reflOffset = 8; }));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  std::remove(goodName.c_str());
+  std::remove(fileName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Truncated_test)
+{
+  std::string const goodName = "PhotonLibraryMapped_test_good.bin";
+  std::string const fileName = "PhotonLibraryMapped_test_truncated.bin";
+  TestLibrary const source{VoxelDef.GetNVoxels(), NOpChannels};
+  PhotonLibraryMapped::StoreLibraryToFile(source, VoxelDef, goodName, true, true);
+  std::vector<char> const good = readFile(goodName);
+
+  // missing the last value
+  writeFile(fileName, std::vector<char>(good.begin(), good.end() - sizeof(float)));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // just the header
+  writeFile(
+    fileName,
+    std::vector<char>(good.begin(), good.begin() + sizeof(PhotonLibraryMapped::FileHeader_t)));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // not even the header
+  writeFile(fileName, std::vector<char>(good.begin(), good.begin() + 16));
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // empty
+  writeFile(fileName, {});
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  // missing
+  std::remove(fileName.c_str());
+  BOOST_CHECK_THROW(PhotonLibraryMapped{fileName}, cet::exception);
+
+  std::remove(goodName.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ConvertFromROOT_test)
+{
+  std::string const sourceName = "PhotonLibraryMapped_test_source.root";
+  std::string const fileName = "PhotonLibraryMapped_test_converted.bin";
+
+  // a ROOT tree library with its voxel metadata, as written by `PhotonLibrary`;
+  // the entries are not in voxel order
+  {
+    TFile file{sourceName.c_str(), "RECREATE"};
+    auto* tree = new TTree{"PhotonLibraryData", "PhotonLibraryData"}; // owned by `file`
+    Int_t voxel;
+    Int_t opChannel;
+    Float_t visibility;
+    Float_t reflVisibility;
+    Float_t reflTfirst;
+    tree->Branch("Voxel", &voxel, "Voxel/I");
+    tree->Branch("OpChannel", &opChannel, "OpChannel/I");
+    tree->Branch("Visibility", &visibility, "Visibility/F");
+    tree->Branch("ReflVisibility", &reflVisibility, "ReflVisibility/F");
+    tree->Branch("ReflTfirst", &reflTfirst, "ReflTfirst/F");
+    for (std::size_t ch = 0; ch < NOpChannels; ++ch) {
+      for (std::size_t v = 0; v < VoxelDef.GetNVoxels(); ++v) {
+        voxel = v;
+        opChannel = ch;
+        visibility = directValue(v, ch);
+        reflVisibility = reflValue(v, ch);
+        reflTfirst = reflT0Value(v, ch);
+        tree->Fill();
+      }
+    }
+    tree->Write();
+
+    geo::Point_t const& lower = VoxelDef.GetRegionLowerCorner();
+    geo::Point_t const& upper = VoxelDef.GetRegionUpperCorner();
+    auto const steps = VoxelDef.GetSteps();
+    RooDouble{lower.X()}.Write("MinX");
+    RooDouble{lower.Y()}.Write("MinY");
+    RooDouble{lower.Z()}.Write("MinZ");
+    RooDouble{upper.X()}.Write("MaxX");
+    RooDouble{upper.Y()}.Write("MaxY");
+    RooDouble{upper.Z()}.Write("MaxZ");
+    RooInt{Int_t(steps[0])}.Write("NDivX");
+    RooInt{Int_t(steps[1])}.Write("NDivY");
+    RooInt{Int_t(steps[2])}.Write("NDivZ");
+    file.Close();
+  }
+
+  // what `ConvertPhotonLibraryToMapped --reflected --reflT0` does
+  phot::PhotonLibrary source;
+  source.LoadLibraryFromFile(sourceName, VoxelDef.GetNVoxels(), true, true);
+  BOOST_TEST_REQUIRE(source.hasVoxelDef());
+  BOOST_TEST(source.GetVoxelDef() == VoxelDef);
+  PhotonLibraryMapped::StoreLibraryToFile(source, source.GetVoxelDef(), fileName, true, true);
+
+  PhotonLibraryMapped const library{fileName};
+  checkLibrary(library, true, true);
+
+  std::remove(sourceName.c_str());
+  std::remove(fileName.c_str());
+}
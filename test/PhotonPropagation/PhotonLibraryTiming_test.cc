@@ -0,0 +1,190 @@
+/**
+ * @file    PhotonLibraryTiming_test.cc
+ * @brief   Unit test for `phot::PhotonLibraryTiming` and its samplers.
+ * @see     `larsim/PhotonPropagation/PhotonLibraryTiming.h`
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (PhotonLibraryTiming_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/PhotonLibraryTiming.h"
+
+// C/C++ standard libraries
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t NVoxels = 50;
+  constexpr std::size_t NOpChannels = 6;
+  constexpr double MaxTime = 100.0; // [ns]
+
+  /// Probabilities the samplers are checked at.
+  std::vector<double> const Probabilities{0.0, 1e-4, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.999, 1.0};
+
+  /// Exponential distribution: the first parameter is the time lower bound,
+  /// the second one the decay time.
+  constexpr char const* Formula = "exp(-x/[1])";
+
+  /// Sets the parameters of the distributions; channel 0 of every third
+  /// voxel is left missing.
+  void fillLibrary(phot::PhotonLibraryTiming& library)
+  {
+    for (std::size_t v = 0; v < NVoxels; ++v) {
+      for (std::size_t ch = 0; ch < NOpChannels; ++ch) {
+        if ((ch == 0) && (v % 3 == 0)) continue;
+        std::array<float, 2> const pars{{float(2.0 + v), float(5.0 + 3.0 * ch)}};
+        library.SetParameters(v, ch, pars.data());
+      }
+    }
+  }
+
+  /// Returns the sampled times of all the channels of `Voxel` at `Probabilities`.
+  std::vector<double> sampleVoxel(phot::PhotonLibraryTiming const& library, std::size_t Voxel)
+  {
+    std::vector<double> times;
+    phot::PhotonLibraryTimingSampler const* samplers = library.GetSamplers(Voxel);
+    for (std::size_t ch = 0; ch < NOpChannels; ++ch) {
+      if (!samplers[ch].isValid()) continue;
+      for (double u : Probabilities)
+        times.push_back(samplers[ch].sample(u));
+    }
+    return times;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Sampler_test)
+{
+  // uniform distribution on [ 10, 50 ] ns, in 4 bins
+  std::array<float, 5> const uniform{{0.0f, 0.25f, 0.5f, 0.75f, 1.0f}};
+  std::array<std::uint32_t, 2> const uniformGuide{{0, 1}};
+  phot::PhotonLibraryTimingSampler const sampler{
+    uniform.data(), uniformGuide.data(), 4, 2, 10.0, 10.0};
+  BOOST_TEST(sampler.isValid());
+  for (double u : Probabilities)
+    BOOST_TEST(sampler.sample(u) == 10.0 + 40.0 * u, boost::test_tools::tolerance(1e-6));
+
+  // no probability in the second bin: it is never sampled
+  std::array<float, 4> const gap{{0.0f, 0.5f, 0.5f, 1.0f}};
+  std::array<std::uint32_t, 2> const gapGuide{{0, 0}};
+  phot::PhotonLibraryTimingSampler const gapSampler{gap.data(), gapGuide.data(), 3, 2, 0.0, 1.0};
+  BOOST_TEST(gapSampler.sample(0.25) == 0.5, boost::test_tools::tolerance(1e-6));
+  BOOST_TEST(gapSampler.sample(0.5) == 1.0, boost::test_tools::tolerance(1e-6));
+  BOOST_TEST(gapSampler.sample(0.75) == 2.5, boost::test_tools::tolerance(1e-6));
+  BOOST_TEST(gapSampler.sample(1.0) == 3.0, boost::test_tools::tolerance(1e-6));
+
+  BOOST_TEST(!phot::PhotonLibraryTimingSampler{}.isValid());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Tabulation_test)
+{
+  phot::PhotonLibraryTiming library{Formula, 2, NVoxels, NOpChannels, MaxTime};
+  fillLibrary(library);
+  BOOST_TEST(library.NParameters() == 2U);
+  BOOST_TEST(library.GetSamplers(NVoxels) == nullptr);
+  BOOST_TEST(library.GetParameters(0, 0) == nullptr);
+  BOOST_TEST(library.Eval(0, 0, 50.0) == 0.0);
+
+  for (std::size_t v = 0; v < NVoxels; ++v) {
+    phot::PhotonLibraryTimingSampler const* samplers = library.GetSamplers(v);
+    BOOST_TEST_REQUIRE(samplers);
+    for (std::size_t ch = 0; ch < NOpChannels; ++ch) {
+      BOOST_TEST_CONTEXT("voxel " << v << " channel " << ch)
+      {
+        if ((ch == 0) && (v % 3 == 0)) {
+          BOOST_TEST(!samplers[ch].isValid());
+          continue;
+        }
+        BOOST_TEST_REQUIRE(samplers[ch].isValid());
+        double const tMin = 2.0 + v;
+        double const tau = 5.0 + 3.0 * ch;
+        BOOST_TEST(library.Eval(v, ch, tMin - 0.5) == 0.0);
+        BOOST_TEST(library.Eval(v, ch, MaxTime + 0.5) == 0.0);
+        BOOST_TEST(library.Eval(v, ch, 60.0) == std::exp(-60.0 / tau),
+                   boost::test_tools::tolerance(1e-12));
+
+        // the cumulative of the exponential truncated to [ tMin, MaxTime ]
+        // at the sampled time is the requested probability (the times are
+        // compared in probability, since the tail of the distribution is too
+        // thin for the float tables to tell apart its times)
+        double const low = std::exp(-tMin / tau);
+        double const high = std::exp(-MaxTime / tau);
+        for (double u : Probabilities) {
+          double const t = samplers[ch].sample(u);
+          BOOST_TEST(t >= tMin);
+          BOOST_TEST(t <= MaxTime);
+          double const cumulative = (low - std::exp(-t / tau)) / (low - high);
+          BOOST_TEST(std::abs(cumulative - u) < 1e-3);
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Cache_test)
+{
+  phot::PhotonLibraryTiming library{Formula, 2, NVoxels, NOpChannels, MaxTime};
+  fillLibrary(library);
+  std::vector<double> const expected = sampleVoxel(library, 1);
+
+  // the samplers of a voxel stay valid while fewer other voxels are requested
+  phot::PhotonLibraryTimingSampler const* samplers = library.GetSamplers(1);
+  for (std::size_t v = 2; v < phot::PhotonLibraryTiming::CachedVoxelsPerThread + 1; ++v)
+    library.GetSamplers(v);
+  BOOST_TEST(library.GetSamplers(1) == samplers);
+  std::vector<double> times;
+  for (std::size_t ch = 0; ch < NOpChannels; ++ch)
+    for (double u : Probabilities)
+      times.push_back(samplers[ch].sample(u));
+  BOOST_TEST(times == expected, boost::test_tools::per_element());
+
+  // and are rebuilt the same after being dropped
+  for (std::size_t v = 20; v < 20 + 2 * phot::PhotonLibraryTiming::CachedVoxelsPerThread; ++v)
+    library.GetSamplers(v);
+  BOOST_TEST(sampleVoxel(library, 1) == expected, boost::test_tools::per_element());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Threads_test)
+{
+  phot::PhotonLibraryTiming serialLibrary{Formula, 2, NVoxels, NOpChannels, MaxTime};
+  fillLibrary(serialLibrary);
+  std::vector<std::vector<double>> expected;
+  for (std::size_t v = 0; v < NVoxels; ++v)
+    expected.push_back(sampleVoxel(serialLibrary, v));
+
+  // many threads build the samplers of the same voxels at the same time,
+  // each voxel many times since the caches are small
+  phot::PhotonLibraryTiming library{Formula, 2, NVoxels, NOpChannels, MaxTime};
+  fillLibrary(library);
+  std::size_t const nRequests = 20 * NVoxels;
+  std::vector<std::vector<double>> results(nRequests);
+  constexpr std::size_t NThreads = 8;
+  std::vector<std::thread> threads;
+  for (std::size_t iThread = 0; iThread < NThreads; ++iThread) {
+    threads.emplace_back([&, iThread]() {
+      for (std::size_t i = iThread; i < nRequests; i += NThreads)
+        results[i] = sampleVoxel(library, (i * 7) % NVoxels);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (std::size_t i = 0; i < nRequests; ++i) {
+    BOOST_TEST_CONTEXT("request " << i)
+    {
+      // same operations on the same values: the results are identical
+      BOOST_TEST(results[i] == expected[(i * 7) % NVoxels], boost::test_tools::per_element());
+    }
+  }
+}
@@ -0,0 +1,145 @@
+/**
+ * @file   ScintTimeLAr_test.cc
+ * @brief  Unit test for the scintillation time sampling of `phot::ScintTimeLAr`.
+ *
+ * The sampled times are compared with the analytic cumulative distribution
+ * with a Kolmogorov-Smirnov test.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (ScintTimeLAr_test)
+#include <boost/test/unit_test.hpp>
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/ScintTimeTools/ScintTimeLAr.h"
+
+// framework libraries
+#include "fhiclcpp/ParameterSet.h"
+
+// CLHEP libraries
+#include "CLHEP/Random/HepJamesRandom.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort()
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t NSamples = 100000;
+
+  /// Critical KS distance at 0.1% significance level for `NSamples` samples.
+  double const MaxKSDistance = 1.95 / std::sqrt(double(NSamples));
+
+  /// Returns the Kolmogorov-Smirnov distance of `times` from `cdf`.
+  double ksDistance(std::vector<double> times, std::function<double(double)> const& cdf)
+  {
+    std::sort(times.begin(), times.end());
+    double const n = times.size();
+    double maxDistance = 0.0;
+    for (std::size_t i = 0; i < times.size(); ++i) {
+      double const F = cdf(times[i]);
+      maxDistance = std::max({maxDistance, F - i / n, (i + 1) / n - F});
+    }
+    return maxDistance;
+  }
+
+  /// Cumulative of an exponential distribution with decay time `tau`.
+  double expCDF(double t, double tau) { return (t < 0.0) ? 0.0 : 1.0 - std::exp(-t / tau); }
+
+  /// Cumulative of the distribution with rise time `tau1` and decay time `tau2`.
+  double riseCDF(double t, double tau1, double tau2)
+  {
+    if (t < 0.0) return 0.0;
+    double const tauRise = tau1 * tau2 / (tau1 + tau2);
+    return (tau1 + tau2) / tau2 * expCDF(t, tau2) - tau1 / tau2 * expCDF(t, tauRise);
+  }
+
+  fhicl::ParameterSet makeConfig(double fastRise,
+                                 double fastDecay,
+                                 double slowRise,
+                                 double slowDecay)
+  {
+    fhicl::ParameterSet pset;
+    pset.put("LogLevel", 0);
+    pset.put("FastRisingTime", fastRise);
+    pset.put("FastDecayTime", fastDecay);
+    pset.put("SlowRisingTime", slowRise);
+    pset.put("SlowDecayTime", slowDecay);
+    return pset;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(NoRisingTime_test)
+{
+  phot::ScintTimeLAr scintTime{makeConfig(0.0, 6.0, 0.0, 1500.0)};
+  CLHEP::HepJamesRandom engine{12345};
+  scintTime.initRand(engine);
+
+  std::vector<double> fastTimes(NSamples);
+  for (double& t : fastTimes)
+    t = scintTime.fastScintTime();
+  BOOST_TEST(ksDistance(fastTimes, [](double t) { return expCDF(t, 6.0); }) < MaxKSDistance);
+
+  std::vector<double> slowTimes(NSamples);
+  scintTime.slowScintTimes(slowTimes);
+  BOOST_TEST(ksDistance(slowTimes, [](double t) { return expCDF(t, 1500.0); }) < MaxKSDistance);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RisingTime_test)
+{
+  constexpr double FastRise = 2.0, FastDecay = 6.0, SlowRise = 10.0, SlowDecay = 1500.0;
+  phot::ScintTimeLAr scintTime{makeConfig(FastRise, FastDecay, SlowRise, SlowDecay)};
+  CLHEP::HepJamesRandom engine{12345};
+  scintTime.initRand(engine);
+
+  auto const fastCDF = [](double t) { return riseCDF(t, FastRise, FastDecay); };
+  auto const slowCDF = [](double t) { return riseCDF(t, SlowRise, SlowDecay); };
+
+  std::vector<double> times(NSamples);
+  for (double& t : times)
+    t = scintTime.fastScintTime();
+  BOOST_TEST(ksDistance(times, fastCDF) < MaxKSDistance);
+
+  scintTime.fastScintTimes(times);
+  BOOST_TEST(ksDistance(times, fastCDF) < MaxKSDistance);
+
+  scintTime.slowScintTimes(times);
+  BOOST_TEST(ksDistance(times, slowCDF) < MaxKSDistance);
+
+  for (double& t : times) {
+    scintTime.GenScintTime(false, engine);
+    t = scintTime.GetScintTime();
+  }
+  BOOST_TEST(ksDistance(times, slowCDF) < MaxKSDistance);
+
+  // the sampler must tell apart the distribution without rise time
+  for (double& t : times)
+    t = scintTime.fastScintTime();
+  BOOST_TEST(ksDistance(times, [](double t) { return expCDF(t, FastDecay); }) > MaxKSDistance);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(BatchSequence_test)
+{
+  // the batch sampling draws the same sequence as the single photon one
+  phot::ScintTimeLAr scintTime{makeConfig(2.0, 6.0, 0.0, 1500.0)};
+
+  CLHEP::HepJamesRandom engine{54321};
+  scintTime.initRand(engine);
+  std::vector<double> single(1000);
+  for (double& t : single)
+    t = scintTime.fastScintTime();
+
+  engine.setSeed(54321, 0);
+  scintTime.initRand(engine);
+  std::vector<double> batch(single.size());
+  scintTime.fastScintTimes(batch);
+
+  for (std::size_t i = 0; i < single.size(); ++i)
+    BOOST_TEST(batch[i] == single[i], boost::test_tools::tolerance(1e-12));
+}
@@ -0,0 +1,87 @@
+/**
+ * @file    SolidAngleTable_test.cc
+ * @brief   Unit test for `phot::SolidAngleTable`.
+ * @see     `larsim/PhotonPropagation/SolidAngleTable.h`
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (SolidAngleTable_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/PhotonPropagation/SolidAngleTable.h"
+
+// C/C++ standard libraries
+#include <cmath>
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <string>
+
+namespace {
+
+  constexpr double Radius = 10.0; // [cm]
+
+  /// Solid angle of a sphere of radius `Radius`, a smooth stand-in for a detector.
+  double sphereSolidAngle(double offset, double distance)
+  {
+    double const r2 = offset * offset + distance * distance;
+    return 2.0 * M_PI * (1.0 - std::sqrt(1.0 - Radius * Radius / r2));
+  }
+
+  phot::SolidAngleTable::Config_t testConfig()
+  {
+    phot::SolidAngleTable::Config_t config;
+    config.maxOffset = 300.0;
+    config.minDistance = 5.0 * Radius;
+    config.maxDistance = 400.0;
+    config.step = 1.0;
+    return config;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AccuracyTest)
+{
+  phot::SolidAngleTable const table{sphereSolidAngle, testConfig(), Radius};
+
+  BOOST_TEST(!table.FromCache());
+  BOOST_TEST(table.NBins() == 301U * 351U);
+  BOOST_TEST(table.MaxRelativeError() < 1e-4);
+
+  // grid points are exact
+  BOOST_TEST(table(20.0, 60.0) == sphereSolidAngle(20.0, 60.0), boost::test_tools::tolerance(1e-12));
+
+  // points out of the table are evaluated with the exact function
+  BOOST_TEST(table(3.3, 20.0) == sphereSolidAngle(3.3, 20.0));
+  BOOST_TEST(table(3.3, 450.5) == sphereSolidAngle(3.3, 450.5));
+  BOOST_TEST(table(320.5, 70.0) == sphereSolidAngle(320.5, 70.0));
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CacheTest)
+{
+  std::string const cacheFile = "SolidAngleTable_test.cache";
+  std::remove(cacheFile.c_str());
+
+  phot::SolidAngleTable const built{sphereSolidAngle, testConfig(), Radius, cacheFile};
+  BOOST_TEST(!built.FromCache());
+  BOOST_TEST(std::ifstream{cacheFile}.good());
+
+  phot::SolidAngleTable const cached{sphereSolidAngle, testConfig(), Radius, cacheFile};
+  BOOST_TEST(cached.FromCache());
+  for (double offset : {0.0, 12.3, 150.7, 299.9})
+    for (double distance : {50.0, 77.7, 399.5})
+      BOOST_TEST(cached(offset, distance) == built(offset, distance));
+
+  // a table for a different detector or grid is not taken from the cache
+  phot::SolidAngleTable const otherKey{sphereSolidAngle, testConfig(), 2.0 * Radius, cacheFile};
+  BOOST_TEST(!otherKey.FromCache());
+
+  auto config = testConfig();
+  config.step = 2.0;
+  phot::SolidAngleTable const otherStep{sphereSolidAngle, config, Radius, cacheFile};
+  BOOST_TEST(!otherStep.FromCache());
+
+  std::remove(cacheFile.c_str());
+}
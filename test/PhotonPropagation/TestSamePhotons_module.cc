@@ -0,0 +1,176 @@
+/**
+ * @file   TestSamePhotons_module.cc
+ * @brief  Checks that two producers stored the very same photons.
+ *
+ * The `sim::SimPhotons`, or the `sim::SimPhotonsLite` and
+ * `sim::OpDetBacktrackerRecord`, from the `Reference` and `Test` producers
+ * are compared value by value, without tolerance. An exception is thrown on
+ * the first difference, and if the reference has no photon at all (the
+ * comparison would then prove nothing).
+ *
+ * Configuration:
+ * * `Reference` (input tag): the expected photons
+ * * `Test` (input tag): the photons to be checked
+ * * `UseLitePhotons` (boolean): compare the "lite" photons and their records
+ */
+
+// LArSoft libraries
+#include "lardataobj/Simulation/OpDetBacktrackerRecord.h"
+#include "lardataobj/Simulation/SimPhotons.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <vector>
+
+class TestSamePhotons : public art::EDAnalyzer {
+public:
+  explicit TestSamePhotons(fhicl::ParameterSet const& pset);
+
+private:
+  void analyze(art::Event const& event) override;
+
+  void compareSimPhotons(art::Event const& event) const;
+  void compareLitePhotons(art::Event const& event) const;
+
+  art::InputTag const fReference;
+  art::InputTag const fTest;
+  bool const fUseLitePhotons;
+};
+
+//------------------------------------------------------------------------------
+TestSamePhotons::TestSamePhotons(fhicl::ParameterSet const& pset)
+  : EDAnalyzer(pset)
+  , fReference(pset.get<art::InputTag>("Reference"))
+  , fTest(pset.get<art::InputTag>("Test"))
+  , fUseLitePhotons(pset.get<bool>("UseLitePhotons"))
+{
+  if (fUseLitePhotons) {
+    consumes<std::vector<sim::SimPhotonsLite>>(fReference);
+    consumes<std::vector<sim::SimPhotonsLite>>(fTest);
+    consumes<std::vector<sim::OpDetBacktrackerRecord>>(fReference);
+    consumes<std::vector<sim::OpDetBacktrackerRecord>>(fTest);
+  }
+  else {
+    consumes<std::vector<sim::SimPhotons>>(fReference);
+    consumes<std::vector<sim::SimPhotons>>(fTest);
+  }
+}
+
+//------------------------------------------------------------------------------
+void TestSamePhotons::analyze(art::Event const& event)
+{
+  if (fUseLitePhotons)
+    compareLitePhotons(event);
+  else
+    compareSimPhotons(event);
+}
+
+//------------------------------------------------------------------------------
+void TestSamePhotons::compareSimPhotons(art::Event const& event) const
+{
+  auto const& reference = event.getProduct<std::vector<sim::SimPhotons>>(fReference);
+  auto const& test = event.getProduct<std::vector<sim::SimPhotons>>(fTest);
+
+  if (test.size() != reference.size()) {
+    throw cet::exception("TestSamePhotons") << fTest.encode() << " has " << test.size()
+                                            << " channels, " << fReference.encode() << " "
+                                            << reference.size() << "\n";
+  }
+  std::size_t nPhotons = 0;
+  for (std::size_t i = 0; i < reference.size(); ++i) {
+    sim::SimPhotons const& ref = reference[i];
+    sim::SimPhotons const& tst = test[i];
+    if ((tst.OpChannel() != ref.OpChannel()) || (tst.size() != ref.size())) {
+      throw cet::exception("TestSamePhotons")
+        << "Channel #" << i << ": " << tst.size() << " photons on channel " << tst.OpChannel()
+        << ", expected " << ref.size() << " on channel " << ref.OpChannel() << "\n";
+    }
+    for (std::size_t j = 0; j < ref.size(); ++j) {
+      sim::OnePhoton const& a = ref[j];
+      sim::OnePhoton const& b = tst[j];
+      if ((a.SetInSD != b.SetInSD) || (a.InitialPosition != b.InitialPosition) ||
+          (a.FinalLocalPosition != b.FinalLocalPosition) || (a.Time != b.Time) ||
+          (a.Energy != b.Energy) || (a.MotherTrackID != b.MotherTrackID)) {
+        throw cet::exception("TestSamePhotons")
+          << "Channel " << ref.OpChannel() << ", photon #" << j << " differs: time " << b.Time
+          << " (expected " << a.Time << "), track ID " << b.MotherTrackID << " (expected "
+          << a.MotherTrackID << ")\n";
+      }
+    }
+    nPhotons += ref.size();
+  }
+  if (nPhotons == 0) {
+    throw cet::exception("TestSamePhotons") << fReference.encode() << " has no photon\n";
+  }
+  mf::LogInfo("TestSamePhotons") << nPhotons << " photons on " << reference.size()
+                                 << " channels are the same";
+}
+
+//------------------------------------------------------------------------------
+void TestSamePhotons::compareLitePhotons(art::Event const& event) const
+{
+  auto const& reference = event.getProduct<std::vector<sim::SimPhotonsLite>>(fReference);
+  auto const& test = event.getProduct<std::vector<sim::SimPhotonsLite>>(fTest);
+
+  if (test.size() != reference.size()) {
+    throw cet::exception("TestSamePhotons") << fTest.encode() << " has " << test.size()
+                                            << " channels, " << fReference.encode() << " "
+                                            << reference.size() << "\n";
+  }
+  std::size_t nPhotons = 0;
+  for (std::size_t i = 0; i < reference.size(); ++i) {
+    if ((test[i].OpChannel != reference[i].OpChannel) ||
+        (test[i].DetectedPhotons != reference[i].DetectedPhotons)) {
+      throw cet::exception("TestSamePhotons")
+        << "Channel #" << i << " (" << reference[i].OpChannel << "): different photons\n";
+    }
+    for (auto const& [time, count] : reference[i].DetectedPhotons)
+      nPhotons += count;
+  }
+  if (nPhotons == 0) {
+    throw cet::exception("TestSamePhotons") << fReference.encode() << " has no photon\n";
+  }
+
+  auto const& refBTRs = event.getProduct<std::vector<sim::OpDetBacktrackerRecord>>(fReference);
+  auto const& testBTRs = event.getProduct<std::vector<sim::OpDetBacktrackerRecord>>(fTest);
+  if (testBTRs.size() != refBTRs.size()) {
+    throw cet::exception("TestSamePhotons")
+      << fTest.encode() << " has " << testBTRs.size() << " backtracking records, "
+      << fReference.encode() << " " << refBTRs.size() << "\n";
+  }
+  for (std::size_t i = 0; i < refBTRs.size(); ++i) {
+    auto const& refSDPs = refBTRs[i].timePDclockSDPsMap();
+    auto const& testSDPs = testBTRs[i].timePDclockSDPsMap();
+    bool same = (testBTRs[i].OpDetNum() == refBTRs[i].OpDetNum()) &&
+                (testSDPs.size() == refSDPs.size());
+    for (std::size_t j = 0; same && (j < refSDPs.size()); ++j) {
+      same = (testSDPs[j].first == refSDPs[j].first) &&
+             (testSDPs[j].second.size() == refSDPs[j].second.size());
+      for (std::size_t k = 0; same && (k < refSDPs[j].second.size()); ++k) {
+        sim::SDP const& a = refSDPs[j].second[k];
+        sim::SDP const& b = testSDPs[j].second[k];
+        same = (a.trackID == b.trackID) && (a.numPhotons == b.numPhotons) &&
+               (a.energy == b.energy) && (a.x == b.x) && (a.y == b.y) && (a.z == b.z);
+      }
+    }
+    if (!same) {
+      throw cet::exception("TestSamePhotons")
+        << "Backtracking record #" << i << " (optical detector " << refBTRs[i].OpDetNum()
+        << ") differs\n";
+    }
+  }
+  mf::LogInfo("TestSamePhotons") << nPhotons << " photons on " << reference.size()
+                                 << " channels and " << refBTRs.size()
+                                 << " backtracking records are the same";
+}
+
+DEFINE_ART_MODULE(TestSamePhotons)
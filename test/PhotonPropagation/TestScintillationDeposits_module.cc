@@ -0,0 +1,95 @@
+/**
+ * @file   TestScintillationDeposits_module.cc
+ * @brief  Produces random scintillating energy deposits in the active volume.
+ *
+ * The deposits are short steps at random points of the active volume of a
+ * random TPC, with random energy, number of electrons and photons, and time.
+ * The same seed and event number always yield the same deposits.
+ *
+ * Configuration:
+ * * `NDeposits` (default: 2000): number of deposits per event
+ * * `Seed` (default: 1234): seed of the deposits, combined with the event number
+ */
+
+// LArSoft libraries
+#include "larcore/CoreUtils/ServiceUtil.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+
+// framework libraries
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+class TestScintillationDeposits : public art::EDProducer {
+public:
+  explicit TestScintillationDeposits(fhicl::ParameterSet const& pset);
+
+private:
+  void produce(art::Event& event) override;
+
+  unsigned int const fNDeposits;
+  unsigned int const fSeed;
+  std::vector<geo::BoxBoundedGeo> fActiveVolumes; ///< Of all the TPCs.
+};
+
+//------------------------------------------------------------------------------
+TestScintillationDeposits::TestScintillationDeposits(fhicl::ParameterSet const& pset)
+  : EDProducer(pset)
+  , fNDeposits(pset.get<unsigned int>("NDeposits", 2000U))
+  , fSeed(pset.get<unsigned int>("Seed", 1234U))
+{
+  for (geo::TPCGeo const& tpc : lar::providerFrom<geo::Geometry>()->Iterate<geo::TPCGeo>())
+    fActiveVolumes.push_back(tpc.ActiveBoundingBox());
+  produces<std::vector<sim::SimEnergyDeposit>>();
+}
+
+//------------------------------------------------------------------------------
+void TestScintillationDeposits::produce(art::Event& event)
+{
+  std::seed_seq seeds{fSeed, static_cast<unsigned int>(event.event())};
+  std::mt19937 gen{seeds};
+  std::uniform_int_distribution<std::size_t> pickTPC{0, fActiveVolumes.size() - 1};
+  std::uniform_real_distribution<double> uniform{0.0, 1.0};
+  std::uniform_real_distribution<double> pickStep{-0.2, 0.2}; // cm
+  std::uniform_real_distribution<double> pickEnergy{0.05, 2.0}; // MeV
+  std::uniform_real_distribution<double> pickTime{-1000.0, 5000.0}; // ns
+  std::uniform_int_distribution<int> pickTrack{1, 50};
+
+  auto deposits = std::make_unique<std::vector<sim::SimEnergyDeposit>>();
+  deposits->reserve(fNDeposits);
+  for (unsigned int i = 0; i < fNDeposits; ++i) {
+    geo::BoxBoundedGeo const& box = fActiveVolumes[pickTPC(gen)];
+    geo::Point_t const start{box.MinX() + uniform(gen) * box.SizeX(),
+                             box.MinY() + uniform(gen) * box.SizeY(),
+                             box.MinZ() + uniform(gen) * box.SizeZ()};
+    geo::Point_t const end{start.X() + pickStep(gen), start.Y() + pickStep(gen), start.Z()};
+    double const energy = pickEnergy(gen);
+    double const time = pickTime(gen);
+    // about 24000 photons and 20000 electrons per MeV
+    deposits->emplace_back(static_cast<int>(24000.0 * energy),
+                           static_cast<int>(20000.0 * energy),
+                           0.23,
+                           energy,
+                           start,
+                           end,
+                           time,
+                           time + 1.0,
+                           pickTrack(gen),
+                           13);
+  }
+  event.put(std::move(deposits));
+}
+
+DEFINE_ART_MODULE(TestScintillationDeposits)
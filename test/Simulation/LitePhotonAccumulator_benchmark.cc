@@ -0,0 +1,121 @@
+/**
+ * @file    LitePhotonAccumulator_benchmark.cc
+ * @brief   Benchmark of `sim::LitePhotonAccumulator` on a cosmic ray event.
+ * @see     `larsim/Simulation/LitePhotonAccumulator.h`
+ *
+ * The photons of a synthetic cosmic ray event are filled both in
+ * `sim::SimPhotonsLite` maps directly and through the accumulator, the results
+ * are checked to be the same and the time taken by each is printed.
+ *
+ * This is not a unit test and it is not run by `ctest`; run it by hand:
+ *
+ *     LitePhotonAccumulator_benchmark [nChannels] [nDepositsPerMuon]
+ *
+ * (defaults: 300 channels and 1000 deposits per muon, about 6 million photons).
+ */
+
+// LArSoft libraries
+#include "larsim/Simulation/LitePhotonAccumulator.h"
+
+// C/C++ standard libraries
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib> // std::strtoul()
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+namespace {
+
+  /// Returns a collection of empty `sim::SimPhotonsLite`, one per channel.
+  std::vector<sim::SimPhotonsLite> makeLiteCollection(std::size_t nChannels)
+  {
+    std::vector<sim::SimPhotonsLite> photons(nChannels);
+    for (std::size_t i = 0; i < nChannels; ++i)
+      photons[i].OpChannel = i;
+    return photons;
+  }
+
+  /// (channel, time) of detected photons, in the order of a fast simulation.
+  std::vector<std::pair<unsigned int, int>> cosmicEventPhotons(unsigned int nChannels,
+                                                               unsigned int nDepositsPerMuon)
+  {
+    // a few muons within a drift window, each made of deposits along ~10 ns
+    // seen by all the channels, followed by the fast and slow scintillation
+    // of argon; a muon crossing the detector has thousands of detected
+    // photons per channel
+    constexpr unsigned int nMuons = 5;
+    constexpr unsigned int nPhotonsPerChannel = 4;
+
+    std::mt19937 gen{12345};
+    std::uniform_real_distribution<double> muonTime{-1.6e6, 3.2e6};
+    std::uniform_real_distribution<double> depositTime{0.0, 10.0};
+    std::bernoulli_distribution isFast{0.25};
+    std::exponential_distribution<double> fastTime{1.0 / 6.0};
+    std::exponential_distribution<double> slowTime{1.0 / 1500.0};
+
+    std::vector<std::pair<unsigned int, int>> photons;
+    photons.reserve(std::size_t(nMuons) * nDepositsPerMuon * nChannels * nPhotonsPerChannel);
+    for (unsigned int iMuon = 0; iMuon < nMuons; ++iMuon) {
+      double const t0 = muonTime(gen);
+      for (unsigned int iDep = 0; iDep < nDepositsPerMuon; ++iDep) {
+        double const depT = t0 + depositTime(gen);
+        for (unsigned int channel = 0; channel < nChannels; ++channel) {
+          for (unsigned int i = 0; i < nPhotonsPerChannel; ++i) {
+            double const t = depT + (isFast(gen) ? fastTime(gen) : slowTime(gen));
+            photons.emplace_back(channel, static_cast<int>(std::round(t)));
+          }
+        }
+      }
+    }
+    return photons;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  using Clock_t = std::chrono::steady_clock;
+  unsigned int const nChannels = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 300;
+  unsigned int const nDepositsPerMuon = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1000;
+  if ((nChannels == 0) || (nDepositsPerMuon == 0)) {
+    std::cerr << "Usage: " << argv[0] << " [nChannels] [nDepositsPerMuon]" << std::endl;
+    return 1;
+  }
+
+  auto const photons = cosmicEventPhotons(nChannels, nDepositsPerMuon);
+
+  // the pattern the photon simulation modules used
+  auto const mapStart = Clock_t::now();
+  auto mapLite = makeLiteCollection(nChannels);
+  for (auto const& [channel, time] : photons)
+    ++mapLite[channel].DetectedPhotons[time];
+  auto const mapTime = Clock_t::now() - mapStart;
+
+  auto const accStart = Clock_t::now();
+  auto accLite = makeLiteCollection(nChannels);
+  sim::LitePhotonAccumulator accumulator{nChannels};
+  for (auto const& [channel, time] : photons)
+    accumulator.add(channel, time);
+  accumulator.fill(accLite);
+  auto const accTime = Clock_t::now() - accStart;
+
+  for (unsigned int channel = 0; channel < nChannels; ++channel) {
+    if (accLite[channel].DetectedPhotons != mapLite[channel].DetectedPhotons) {
+      std::cerr << "Channel " << channel << ": the accumulator and std::map disagree!"
+                << std::endl;
+      return 2;
+    }
+  }
+
+  using ms = std::chrono::duration<double, std::milli>;
+  std::cout << photons.size() << " photons on " << nChannels << " channels:"
+            << "\n  std::map:              " << ms(mapTime).count() << " ms"
+            << "\n  LitePhotonAccumulator: " << ms(accTime).count() << " ms (including fill)"
+            << std::endl;
+  return 0;
+}
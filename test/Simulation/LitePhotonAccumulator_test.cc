@@ -0,0 +1,146 @@
+/**
+ * @file    LitePhotonAccumulator_test.cc
+ * @brief   Unit test for `sim::LitePhotonAccumulator`.
+ * @see     `larsim/Simulation/LitePhotonAccumulator.h`
+ *
+ * Besides small hand-made cases, the photons of a synthetic cosmic ray event
+ * are filled both in `sim::SimPhotonsLite` maps directly and through the
+ * accumulator, and the results are checked to be the same. The timing of
+ * the same comparison on a full size event is in
+ * `LitePhotonAccumulator_benchmark.cc`, which is not run by `ctest`.
+ */
+
+// Boost libraries
+#define BOOST_TEST_MODULE (LitePhotonAccumulator_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larsim/Simulation/LitePhotonAccumulator.h"
+
+// C/C++ standard libraries
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+namespace {
+
+  /// Returns a collection of empty `sim::SimPhotonsLite`, one per channel.
+  std::vector<sim::SimPhotonsLite> makeLiteCollection(std::size_t nChannels)
+  {
+    std::vector<sim::SimPhotonsLite> photons(nChannels);
+    for (std::size_t i = 0; i < nChannels; ++i)
+      photons[i].OpChannel = i;
+    return photons;
+  }
+
+  /// (channel, time) of detected photons, in the order of a fast simulation.
+  std::vector<std::pair<unsigned int, int>> cosmicEventPhotons(unsigned int nChannels)
+  {
+    // a few muons within a drift window, each made of deposits along ~10 ns
+    // seen by all the channels, followed by the fast and slow scintillation
+    // of argon; the times span many pages, both before and after 0
+    constexpr unsigned int nMuons = 5;
+    constexpr unsigned int nDepositsPerMuon = 50;
+    constexpr unsigned int nPhotonsPerChannel = 4;
+
+    std::mt19937 gen{12345};
+    std::uniform_real_distribution<double> muonTime{-1.6e6, 3.2e6};
+    std::uniform_real_distribution<double> depositTime{0.0, 10.0};
+    std::bernoulli_distribution isFast{0.25};
+    std::exponential_distribution<double> fastTime{1.0 / 6.0};
+    std::exponential_distribution<double> slowTime{1.0 / 1500.0};
+
+    std::vector<std::pair<unsigned int, int>> photons;
+    photons.reserve(nMuons * nDepositsPerMuon * nChannels * nPhotonsPerChannel);
+    for (unsigned int iMuon = 0; iMuon < nMuons; ++iMuon) {
+      double const t0 = muonTime(gen);
+      for (unsigned int iDep = 0; iDep < nDepositsPerMuon; ++iDep) {
+        double const depT = t0 + depositTime(gen);
+        for (unsigned int channel = 0; channel < nChannels; ++channel) {
+          for (unsigned int i = 0; i < nPhotonsPerChannel; ++i) {
+            double const t = depT + (isFast(gen) ? fastTime(gen) : slowTime(gen));
+            photons.emplace_back(channel, static_cast<int>(std::round(t)));
+          }
+        }
+      }
+    }
+    return photons;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(FillTest)
+{
+  constexpr int PageTicks = sim::LitePhotonAccumulator::PageTicks;
+  std::vector<std::pair<unsigned int, int>> const photons{{0, 5},
+                                                          {0, 5},
+                                                          {2, -1},
+                                                          {2, -PageTicks},
+                                                          {2, -PageTicks - 1},
+                                                          {0, PageTicks - 1},
+                                                          {0, PageTicks},
+                                                          {2, 1000000},
+                                                          {0, 5},
+                                                          {2, -1}};
+
+  sim::LitePhotonAccumulator accumulator{3};
+  BOOST_TEST(accumulator.nChannels() == 3U);
+  std::vector<std::map<int, int>> expected(3);
+  for (auto const& [channel, time] : photons) {
+    accumulator.add(channel, time);
+    ++expected[channel][time];
+  }
+  accumulator.add(1, 42, 3);
+  expected[1][42] += 3;
+
+  for (unsigned int channel = 0; channel < 3; ++channel) {
+    BOOST_TEST(!accumulator.empty(channel));
+    BOOST_TEST(accumulator.toMap(channel) == expected[channel]);
+  }
+
+  // filling adds to the existing counts
+  auto lite = makeLiteCollection(3);
+  lite[1].DetectedPhotons[42] = 1;
+  lite[1].DetectedPhotons[-7] = 2;
+  accumulator.fill(lite);
+  expected[1][42] += 1;
+  expected[1][-7] += 2;
+  for (unsigned int channel = 0; channel < 3; ++channel)
+    BOOST_TEST(lite[channel].DetectedPhotons == expected[channel]);
+
+  accumulator.clear();
+  for (unsigned int channel = 0; channel < 3; ++channel) {
+    BOOST_TEST(accumulator.empty(channel));
+    BOOST_TEST(accumulator.toMap(channel).empty());
+  }
+  accumulator.add(2, 5);
+  BOOST_TEST((accumulator.toMap(2) == std::map<int, int>{{5, 1}}));
+  BOOST_TEST(accumulator.toMap(0).empty());
+} // BOOST_AUTO_TEST_CASE(FillTest)
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CosmicEventTest)
+{
+  constexpr unsigned int nChannels = 20;
+
+  auto const photons = cosmicEventPhotons(nChannels);
+
+  // the pattern the photon simulation modules used
+  auto mapLite = makeLiteCollection(nChannels);
+  for (auto const& [channel, time] : photons)
+    ++mapLite[channel].DetectedPhotons[time];
+
+  auto accLite = makeLiteCollection(nChannels);
+  sim::LitePhotonAccumulator accumulator{nChannels};
+  for (auto const& [channel, time] : photons)
+    accumulator.add(channel, time);
+  accumulator.fill(accLite);
+
+  for (unsigned int channel = 0; channel < nChannels; ++channel)
+    BOOST_TEST(accLite[channel].DetectedPhotons == mapLite[channel].DetectedPhotons);
+} // BOOST_AUTO_TEST_CASE(CosmicEventTest)